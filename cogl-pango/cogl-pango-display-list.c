@@ -405,6 +405,67 @@ _cogl_framebuffer_draw_display_list_texture (CoglFramebuffer *fb,
     emit_vertex_buffer_geometry (fb, pipeline, node);
 }
 
+static void
+_cogl_pango_display_list_node_ensure_pipeline (CoglPangoDisplayList *dl,
+                                               CoglPangoDisplayListNode *node)
+{
+  if (node->pipeline == NULL)
+    {
+      if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE)
+        node->pipeline =
+          _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
+                                          node->d.texture.texture);
+      else
+        node->pipeline =
+          _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
+                                          NULL);
+    }
+}
+
+static void
+_cogl_pango_display_list_node_get_color (CoglPangoDisplayListNode *node,
+                                         const CoglColor *color,
+                                         CoglColor *draw_color)
+{
+  if (node->color_override)
+    /* Use the override color but preserve the alpha from the
+       draw color */
+    cogl_color_init_from_4ub (draw_color,
+                              cogl_color_get_red_byte (&node->color),
+                              cogl_color_get_green_byte (&node->color),
+                              cogl_color_get_blue_byte (&node->color),
+                              cogl_color_get_alpha_byte (color));
+  else
+    *draw_color = *color;
+  cogl_color_premultiply (draw_color);
+}
+
+static void
+_cogl_pango_display_list_render_node (CoglFramebuffer *fb,
+                                      CoglPangoDisplayListNode *node)
+{
+  switch (node->type)
+    {
+    case COGL_PANGO_DISPLAY_LIST_TEXTURE:
+      _cogl_framebuffer_draw_display_list_texture (fb, node->pipeline, node);
+      break;
+
+    case COGL_PANGO_DISPLAY_LIST_RECTANGLE:
+      cogl_framebuffer_draw_rectangle (fb,
+                                       node->pipeline,
+                                       node->d.rectangle.x_1,
+                                       node->d.rectangle.y_1,
+                                       node->d.rectangle.x_2,
+                                       node->d.rectangle.y_2);
+      break;
+
+    case COGL_PANGO_DISPLAY_LIST_TRAPEZOID:
+      cogl_primitive_draw (node->d.trapezoid.primitive,
+                           fb, node->pipeline);
+      break;
+    }
+}
+
 void
 _cogl_pango_display_list_render (CoglFramebuffer *fb,
                                  CoglPangoDisplayList *dl,
@@ -417,53 +478,226 @@ _cogl_pango_display_list_render (CoglFramebuffer *fb,
       CoglPangoDisplayListNode *node = l->data;
       CoglColor draw_color;
 
-      if (node->pipeline == NULL)
+      _cogl_pango_display_list_node_ensure_pipeline (dl, node);
+
+      _cogl_pango_display_list_node_get_color (node, color, &draw_color);
+      cogl_pipeline_set_color (node->pipeline, &draw_color);
+
+      _cogl_pango_display_list_render_node (fb, node);
+    }
+}
+
+/* The largest number of glyph quads that can be drawn with a single
+ * primitive using the shared rectangle indices */
+#define BATCH_MAX_RECTANGLES (65536 / 4)
+
+typedef struct
+{
+  /* A reference to the pipeline of the first node using this texture
+     in the batch. All of the nodes using the same texture from a
+     single pipeline cache share the same pipeline */
+  CoglPipeline *pipeline;
+  /* Array of CoglVertexP2T2C4 */
+  GArray *vertices;
+} CoglPangoDisplayListBatchGroup;
+
+typedef struct
+{
+  CoglPangoDisplayListNode *node;
+  float x, y;
+  CoglColor draw_color;
+} CoglPangoDisplayListBatchDeferred;
+
+static void
+_cogl_pango_display_list_batch_add_node (CoglPangoDisplayListBatchGroup *group,
+                                         CoglPangoDisplayListNode *node,
+                                         float x,
+                                         float y,
+                                         const CoglColor *draw_color)
+{
+  GArray *rectangles = node->d.texture.rectangles;
+  CoglVertexP2T2C4 *v;
+  uint8_t r = cogl_color_get_red_byte (draw_color);
+  uint8_t g = cogl_color_get_green_byte (draw_color);
+  uint8_t b = cogl_color_get_blue_byte (draw_color);
+  uint8_t a = cogl_color_get_alpha_byte (draw_color);
+  int first_vertex = group->vertices->len;
+  int i;
+
+  g_array_set_size (group->vertices, first_vertex + rectangles->len * 4);
+  v = &g_array_index (group->vertices, CoglVertexP2T2C4, first_vertex);
+
+#define EMIT_VERTEX(X, Y, S, T)                 \
+  G_STMT_START {                                \
+    v->x = (X) + x;                             \
+    v->y = (Y) + y;                             \
+    v->s = (S);                                 \
+    v->t = (T);                                 \
+    v->r = r;                                   \
+    v->g = g;                                   \
+    v->b = b;                                   \
+    v->a = a;                                   \
+    v++;                                        \
+  } G_STMT_END
+
+  /* Same vertex order as emit_vertex_buffer_geometry() so that the
+     shared rectangle indices can be used */
+  for (i = 0; i < rectangles->len; i++)
+    {
+      const CoglPangoDisplayListRectangle *rectangle
+        = &g_array_index (rectangles, CoglPangoDisplayListRectangle, i);
+
+      EMIT_VERTEX (rectangle->x_1, rectangle->y_1,
+                   rectangle->s_1, rectangle->t_1);
+      EMIT_VERTEX (rectangle->x_1, rectangle->y_2,
+                   rectangle->s_1, rectangle->t_2);
+      EMIT_VERTEX (rectangle->x_2, rectangle->y_2,
+                   rectangle->s_2, rectangle->t_2);
+      EMIT_VERTEX (rectangle->x_2, rectangle->y_1,
+                   rectangle->s_2, rectangle->t_1);
+    }
+
+#undef EMIT_VERTEX
+}
+
+static void
+_cogl_pango_display_list_batch_draw_group (CoglFramebuffer *fb,
+                                           CoglPangoDisplayListBatchGroup *group)
+{
+  CoglContext *ctx = fb->context;
+  CoglVertexP2T2C4 *vertices = (CoglVertexP2T2C4 *) group->vertices->data;
+  int n_rectangles = group->vertices->len / 4;
+
+  while (n_rectangles > 0)
+    {
+      int n_batch_rectangles = MIN (n_rectangles, BATCH_MAX_RECTANGLES);
+      CoglIndices *indices =
+        cogl_get_rectangle_indices (ctx, n_batch_rectangles);
+      CoglPrimitive *prim =
+        cogl_primitive_new_p2t2c4 (ctx,
+                                   COGL_VERTICES_MODE_TRIANGLES,
+                                   n_batch_rectangles * 4,
+                                   vertices);
+
+      cogl_primitive_set_indices (prim, indices, n_batch_rectangles * 6);
+      cogl_primitive_draw (prim, fb, group->pipeline);
+      cogl_object_unref (prim);
+
+      vertices += n_batch_rectangles * 4;
+      n_rectangles -= n_batch_rectangles;
+    }
+}
+
+static void
+_cogl_pango_display_list_batch_group_free (void *data)
+{
+  CoglPangoDisplayListBatchGroup *group = data;
+
+  cogl_object_unref (group->pipeline);
+  g_array_free (group->vertices, TRUE);
+  g_slice_free (CoglPangoDisplayListBatchGroup, group);
+}
+
+void
+_cogl_pango_display_list_render_batch (CoglFramebuffer *fb,
+                                       CoglPangoDisplayList **lists,
+                                       const float *positions,
+                                       const CoglColor *colors,
+                                       int n_lists)
+{
+  GHashTable *group_hash;
+  GPtrArray *groups;
+  GArray *deferred;
+  int i;
+
+  /* All of the glyph nodes from every display list are merged into
+   * one vertex buffer per pipeline. The per-layout position is
+   * applied to the vertices on the CPU and the per-layout color is
+   * stored as a per-vertex attribute so that layouts with different
+   * colors and positions can still be drawn together. The groups are
+   * kept in an array as well as the hash table so that they are
+   * drawn in a predictable order. */
+  group_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
+  groups =
+    g_ptr_array_new_with_free_func (_cogl_pango_display_list_batch_group_free);
+  deferred = g_array_new (FALSE, FALSE,
+                          sizeof (CoglPangoDisplayListBatchDeferred));
+
+  for (i = 0; i < n_lists; i++)
+    {
+      CoglPangoDisplayList *dl = lists[i];
+      float x = positions[i * 2];
+      float y = positions[i * 2 + 1];
+      GSList *l;
+
+      for (l = dl->nodes; l; l = l->next)
         {
+          CoglPangoDisplayListNode *node = l->data;
+          CoglColor draw_color;
+
+          _cogl_pango_display_list_node_ensure_pipeline (dl, node);
+          _cogl_pango_display_list_node_get_color (node,
+                                                   &colors[i],
+                                                   &draw_color);
+
           if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE)
-            node->pipeline =
-              _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
-                                              node->d.texture.texture);
+            {
+              CoglPangoDisplayListBatchGroup *group =
+                g_hash_table_lookup (group_hash, node->pipeline);
+
+              if (group == NULL)
+                {
+                  group = g_slice_new (CoglPangoDisplayListBatchGroup);
+                  group->pipeline = cogl_object_ref (node->pipeline);
+                  group->vertices =
+                    g_array_new (FALSE, FALSE, sizeof (CoglVertexP2T2C4));
+                  g_hash_table_insert (group_hash, node->pipeline, group);
+                  g_ptr_array_add (groups, group);
+                }
+
+              _cogl_pango_display_list_batch_add_node (group,
+                                                       node,
+                                                       x, y,
+                                                       &draw_color);
+            }
           else
-            node->pipeline =
-              _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
-                                              NULL);
+            {
+              CoglPangoDisplayListBatchDeferred *d;
+
+              /* Underlines and strikethroughs are rare enough that
+                 they are just drawn individually after the glyphs */
+              g_array_set_size (deferred, deferred->len + 1);
+              d = &g_array_index (deferred,
+                                  CoglPangoDisplayListBatchDeferred,
+                                  deferred->len - 1);
+              d->node = node;
+              d->x = x;
+              d->y = y;
+              d->draw_color = draw_color;
+            }
         }
+    }
 
-      if (node->color_override)
-        /* Use the override color but preserve the alpha from the
-           draw color */
-        cogl_color_init_from_4ub (&draw_color,
-                                  cogl_color_get_red_byte (&node->color),
-                                  cogl_color_get_green_byte (&node->color),
-                                  cogl_color_get_blue_byte (&node->color),
-                                  cogl_color_get_alpha_byte (color));
-      else
-        draw_color = *color;
-      cogl_color_premultiply (&draw_color);
+  for (i = 0; i < groups->len; i++)
+    _cogl_pango_display_list_batch_draw_group (fb, g_ptr_array_index (groups,
+                                                                      i));
 
-      cogl_pipeline_set_color (node->pipeline, &draw_color);
+  for (i = 0; i < deferred->len; i++)
+    {
+      CoglPangoDisplayListBatchDeferred *d =
+        &g_array_index (deferred, CoglPangoDisplayListBatchDeferred, i);
 
-      switch (node->type)
-        {
-        case COGL_PANGO_DISPLAY_LIST_TEXTURE:
-          _cogl_framebuffer_draw_display_list_texture (fb, node->pipeline, node);
-          break;
-
-        case COGL_PANGO_DISPLAY_LIST_RECTANGLE:
-          cogl_framebuffer_draw_rectangle (fb,
-                                           node->pipeline,
-                                           node->d.rectangle.x_1,
-                                           node->d.rectangle.y_1,
-                                           node->d.rectangle.x_2,
-                                           node->d.rectangle.y_2);
-          break;
-
-        case COGL_PANGO_DISPLAY_LIST_TRAPEZOID:
-          cogl_primitive_draw (node->d.trapezoid.primitive,
-                               fb, node->pipeline);
-          break;
-        }
+      cogl_pipeline_set_color (d->node->pipeline, &d->draw_color);
+
+      cogl_framebuffer_push_matrix (fb);
+      cogl_framebuffer_translate (fb, d->x, d->y, 0);
+      _cogl_pango_display_list_render_node (fb, d->node);
+      cogl_framebuffer_pop_matrix (fb);
     }
+
+  g_array_free (deferred, TRUE);
+  g_ptr_array_free (groups, TRUE);
+  g_hash_table_destroy (group_hash);
 }
 
 static void
@@ -73,6 +73,13 @@ _cogl_pango_display_list_render (CoglFramebuffer *framebuffer,
                                  CoglPangoDisplayList *dl,
                                  const CoglColor *color);
 
+void
+_cogl_pango_display_list_render_batch (CoglFramebuffer *framebuffer,
+                                       CoglPangoDisplayList **lists,
+                                       const float *positions,
+                                       const CoglColor *colors,
+                                       int n_lists);
+
 void
 _cogl_pango_display_list_clear (CoglPangoDisplayList *dl);
 
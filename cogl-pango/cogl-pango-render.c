@@ -82,6 +82,10 @@ struct _CoglPangoRenderer
 
   /* The current display list that is being built */
   CoglPangoDisplayList *display_list;
+
+  /* Used to clear the glyph caches when the context goes over its
+     memory budget */
+  CoglMemoryPressureClosure *memory_pressure_closure;
 };
 
 struct _CoglPangoRendererClass
@@ -209,6 +213,19 @@ _cogl_pango_renderer_init (CoglPangoRenderer *priv)
 {
 }
 
+static void
+memory_pressure_cb (CoglContext *context,
+                    const CoglMemoryStats *stats,
+                    void *user_data)
+{
+  CoglPangoRenderer *renderer = user_data;
+
+  /* Display lists keep their own references to the glyph textures
+     so it is safe to drop the whole cache. The glyphs will be
+     recreated the next time they are drawn */
+  _cogl_pango_renderer_clear_glyph_cache (renderer);
+}
+
 static void
 _cogl_pango_renderer_constructed (GObject *gobject)
 {
@@ -227,6 +244,12 @@ _cogl_pango_renderer_constructed (GObject *gobject)
 
   _cogl_pango_renderer_set_use_mipmapping (renderer, FALSE);
 
+  renderer->memory_pressure_closure =
+    cogl_context_add_memory_pressure_callback (ctx,
+                                               memory_pressure_cb,
+                                               renderer,
+                                               NULL);
+
   if (G_OBJECT_CLASS (_cogl_pango_renderer_parent_class)->constructed)
     G_OBJECT_CLASS (_cogl_pango_renderer_parent_class)->constructed (gobject);
 }
@@ -282,7 +305,11 @@ cogl_pango_renderer_dispose (GObject *object)
   CoglPangoRenderer *priv = COGL_PANGO_RENDERER (object);
 
   if (priv->ctx)
-    priv->ctx = NULL;
+    {
+      cogl_context_remove_memory_pressure_callback
+        (priv->ctx, priv->memory_pressure_closure);
+      priv->ctx = NULL;
+    }
 }
 
 static void
@@ -358,12 +385,8 @@ cogl_pango_render_qdata_destroy (CoglPangoLayoutQdata *qdata)
   g_slice_free (CoglPangoLayoutQdata, qdata);
 }
 
-void
-cogl_pango_show_layout (CoglFramebuffer *fb,
-                        PangoLayout *layout,
-                        float x,
-                        float y,
-                        const CoglColor *color)
+static CoglPangoLayoutQdata *
+cogl_pango_layout_ensure_display_list (PangoLayout *layout)
 {
   PangoContext *context;
   CoglPangoRenderer *priv;
@@ -372,7 +395,7 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
   context = pango_layout_get_context (layout);
   priv = cogl_pango_get_renderer_from_context (context);
   if (G_UNLIKELY (!priv))
-    return;
+    return NULL;
 
   qdata = g_object_get_qdata (G_OBJECT (layout),
                               cogl_pango_layout_get_qdata_key ());
@@ -422,15 +445,13 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
       qdata->mipmapping_used = priv->use_mipmapping;
     }
 
-  cogl_framebuffer_push_matrix (fb);
-  cogl_framebuffer_translate (fb, x, y, 0);
-
-  _cogl_pango_display_list_render (fb,
-                                   qdata->display_list,
-                                   color);
-
-  cogl_framebuffer_pop_matrix (fb);
+  return qdata;
+}
 
+static void
+cogl_pango_layout_qdata_update_first_line (CoglPangoLayoutQdata *qdata,
+                                           PangoLayout *layout)
+{
   /* Keep a reference to the first line of the layout so we can detect
      changes */
   if (qdata->first_line)
@@ -445,6 +466,91 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
     }
 }
 
+void
+cogl_pango_show_layout (CoglFramebuffer *fb,
+                        PangoLayout *layout,
+                        float x,
+                        float y,
+                        const CoglColor *color)
+{
+  CoglPangoLayoutQdata *qdata;
+
+  qdata = cogl_pango_layout_ensure_display_list (layout);
+  if (G_UNLIKELY (!qdata))
+    return;
+
+  cogl_framebuffer_push_matrix (fb);
+  cogl_framebuffer_translate (fb, x, y, 0);
+
+  _cogl_pango_display_list_render (fb,
+                                   qdata->display_list,
+                                   color);
+
+  cogl_framebuffer_pop_matrix (fb);
+
+  cogl_pango_layout_qdata_update_first_line (qdata, layout);
+}
+
+void
+cogl_pango_show_layouts (CoglFramebuffer *fb,
+                         PangoLayout **layouts,
+                         const float *positions,
+                         const CoglColor *colors,
+                         int n_layouts)
+{
+  CoglPangoLayoutQdata **qdatas;
+  CoglPangoDisplayList **lists;
+  float *batch_positions;
+  CoglColor *batch_colors;
+  int n_lists = 0;
+  int i;
+
+  _COGL_RETURN_IF_FAIL (n_layouts >= 0);
+
+  if (n_layouts == 0)
+    return;
+
+  /* Reserving space for the glyphs of one layout can reorganize the
+     glyph cache which would throw away the display lists that have
+     already been built for the other layouts so we need to make sure
+     all of the glyphs are available before building any of them */
+  for (i = 0; i < n_layouts; i++)
+    cogl_pango_ensure_glyph_cache_for_layout (layouts[i]);
+
+  qdatas = g_new (CoglPangoLayoutQdata *, n_layouts);
+  lists = g_new (CoglPangoDisplayList *, n_layouts);
+  batch_positions = g_new (float, 2 * n_layouts);
+  batch_colors = g_new (CoglColor, n_layouts);
+
+  for (i = 0; i < n_layouts; i++)
+    {
+      qdatas[i] = cogl_pango_layout_ensure_display_list (layouts[i]);
+      if (G_UNLIKELY (!qdatas[i]))
+        continue;
+
+      lists[n_lists] = qdatas[i]->display_list;
+      batch_positions[n_lists * 2] = positions[i * 2];
+      batch_positions[n_lists * 2 + 1] = positions[i * 2 + 1];
+      batch_colors[n_lists] = colors[i];
+      n_lists++;
+    }
+
+  _cogl_pango_display_list_render_batch (fb,
+                                         lists,
+                                         batch_positions,
+                                         batch_colors,
+                                         n_lists);
+
+  for (i = 0; i < n_layouts; i++)
+    if (qdatas[i])
+      cogl_pango_layout_qdata_update_first_line (qdatas[i], layouts[i]);
+
+  g_free (batch_colors);
+  g_free (batch_positions);
+  g_free (lists);
+  g_free (qdatas);
+}
+
 void
 cogl_pango_show_layout_line (CoglFramebuffer *fb,
                              PangoLayoutLine *line,
@@ -170,6 +170,40 @@ cogl_pango_show_layout (CoglFramebuffer *framebuffer,
                         float y,
                         const CoglColor *color);
 
+/**
+ * cogl_pango_show_layouts:
+ * @framebuffer: A #CoglFramebuffer to draw too.
+ * @layouts: (array length=n_layouts): An array of #PangoLayout<!-- -->s
+ * @positions: (array): An array of 2 * @n_layouts floats containing
+ *             the x and y coordinates to render each layout at
+ * @colors: (array length=n_layouts): An array of @n_layouts colors to
+ *          use when rendering each layout
+ * @n_layouts: The number of layouts to draw
+ *
+ * Draws a number of solidly coloured layouts on the given
+ * @framebuffer. This is equivalent to calling
+ * cogl_pango_show_layout() for each layout in turn but the glyphs of
+ * all of the layouts that share a glyph cache texture are merged
+ * into a single draw call, using a per-vertex color to distinguish
+ * the layouts. This can be considerably cheaper than drawing the
+ * layouts separately when a large number of short labels need to be
+ * drawn.
+ *
+ * The layouts are drawn within the @framebuffer<!-- -->'s current
+ * model-view coordinate space. Note that any underlines or
+ * strikethroughs are drawn after all of the glyphs of all of the
+ * layouts.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_pango_show_layouts (CoglFramebuffer *framebuffer,
+                         PangoLayout **layouts,
+                         const float *positions,
+                         const CoglColor *colors,
+                         int n_layouts);
+
 /**
  * cogl_pango_render_layout_line:
  * @framebuffer: A #CoglFramebuffer to draw too.
@@ -62,6 +62,59 @@ typedef struct _CoglBezCubic
   floatVec2 p4;
 } CoglBezCubic;
 
+typedef enum
+{
+  COGL_PATH_CURVE_TYPE_CUBIC,
+  COGL_PATH_CURVE_TYPE_ARC
+} CoglPathCurveType;
+
+/* The control points of each curve are kept along with the range of
+   path nodes that were generated when it was flattened at a scale of
+   1 so that the curve can be flattened again with a tolerance that
+   suits the scale that the path is drawn at */
+typedef struct _CoglPathCurve
+{
+  CoglPathCurveType type;
+
+  unsigned int first_node;
+  unsigned int n_nodes;
+
+  union
+  {
+    CoglBezCubic cubic;
+
+    struct
+    {
+      floatVec2 center;
+      floatVec2 radius;
+      float angle_1;
+      float angle_2;
+      float angle_step;
+    } arc;
+  } d;
+} CoglPathCurve;
+
+/* The scale is rounded to the nearest power of two and the exponent
+   is used to look up the tessellation. Bucket 0 uses the path nodes
+   directly */
+#define COGL_PATH_MAX_SCALE_BUCKET 8
+
+/* The number of fill primitives that are kept for each path other
+   than the tessellation at a scale of 1 */
+#define COGL_PATH_FILL_CACHE_SIZE 4
+
+typedef struct _CoglPathFillCacheEntry
+{
+  /* The entry is either a tessellation or the triangle fans that are
+     drawn into the stencil buffer */
+  CoglPathFillMode mode;
+  int scale_bucket;
+  /* Value of fill_cache_age when the entry was last used so that the
+     least recently used entry can be replaced */
+  unsigned int age;
+  CoglPrimitive *primitive;
+} CoglPathFillCacheEntry;
+
 typedef struct _CoglPathData CoglPathData;
 
 struct _CoglPath
@@ -80,6 +133,7 @@ struct _CoglPathData
   CoglContext         *context;
 
   CoglPathFillRule     fill_rule;
+  CoglPathFillMode     fill_mode;
 
   GArray              *path_nodes;
 
@@ -95,6 +149,14 @@ struct _CoglPathData
   CoglAttribute       *fill_attributes[COGL_PATH_N_ATTRIBUTES + 1];
   CoglPrimitive       *fill_primitive;
 
+  /* Array of CoglPathCurves in the order of their nodes */
+  GArray              *curves;
+
+  /* Fill primitives with the curves flattened for other scales and
+     the stencil fans for every scale */
+  CoglPathFillCacheEntry fill_cache[COGL_PATH_FILL_CACHE_SIZE];
+  unsigned int         fill_cache_age;
+
   CoglAttributeBuffer *stroke_attribute_buffer;
   CoglAttribute      **stroke_attributes;
   unsigned int         stroke_n_attributes;
@@ -123,6 +185,13 @@ _cogl_path_get_bounds (CoglPath *path,
 CoglBool
 _cogl_path_is_rectangle (CoglPath *path);
 
+/* Returns the number of vertices that are drawn to fill the path at
+   the given scale. For the stencil fill mode this is the size of the
+   triangle fans */
+int
+_cogl_path_get_n_fill_vertices (CoglPath *path,
+                                float scale);
+
 void
 _cogl_path_stroke_nodes (CoglPath *path,
                          CoglFramebuffer *framebuffer,
@@ -0,0 +1,62 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_PATH_TRIANGULATOR_PRIVATE_H
+#define __COGL_PATH_TRIANGULATOR_PRIVATE_H
+
+#include "cogl-path-private.h"
+
+/* Contours with more vertices than this that aren't convex are
+   always given to the GLU tesselator because the simplicity check
+   and the ear clipping are quadratic */
+#define COGL_PATH_TRIANGULATOR_MAX_VERTICES 256
+
+/*
+ * _cogl_path_triangulate:
+ * @path_nodes: An array of #CoglPathNode<!-- -->s
+ * @triangles: An array of ints to append the vertex indices to
+ *
+ * Tries to triangulate the path without the GLU tesselator. This only
+ * works when each sub-path is a simple polygon and the bounding boxes
+ * of the sub-paths don't overlap. In that case the fill rule makes no
+ * difference. Convex sub-paths are split into a fan and the others are
+ * triangulated by ear clipping.
+ *
+ * The indices refer to the position of the node in @path_nodes. No new
+ * vertices are created.
+ *
+ * Return value: %TRUE if the path was triangulated or %FALSE if it
+ *   needs the GLU tesselator, in which case @triangles is left as it
+ *   was.
+ */
+CoglBool
+_cogl_path_triangulate (GArray *path_nodes,
+                        GArray *triangles);
+
+#endif /* __COGL_PATH_TRIANGULATOR_PRIVATE_H */
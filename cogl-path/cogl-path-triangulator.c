@@ -0,0 +1,495 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+
+#include "cogl-util.h"
+#include "cogl-path.h"
+#include "cogl-path-triangulator-private.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Paths with more sub-paths than this are given to the GLU
+   tesselator rather than comparing all of the bounding boxes */
+#define _COGL_PATH_TRIANGULATOR_MAX_CONTOURS 32
+
+typedef struct
+{
+  float x_1, y_1, x_2, y_2;
+} CoglPathTriangulatorBox;
+
+typedef struct
+{
+  float y_1, y_2;
+  int index;
+} CoglPathTriangulatorEdge;
+
+/* Twice the signed area of the triangle abc. This is positive if the
+   points are counter-clockwise in a y-up coordinate system */
+static double
+orient (const CoglPathNode *a,
+        const CoglPathNode *b,
+        const CoglPathNode *c)
+{
+  return (((double) b->x - a->x) * ((double) c->y - a->y) -
+          ((double) b->y - a->y) * ((double) c->x - a->x));
+}
+
+static CoglBool
+nodes_equal (const CoglPathNode *a,
+             const CoglPathNode *b)
+{
+  return a->x == b->x && a->y == b->y;
+}
+
+static CoglBool
+on_segment (const CoglPathNode *a,
+            const CoglPathNode *b,
+            const CoglPathNode *p)
+{
+  return (p->x >= MIN (a->x, b->x) && p->x <= MAX (a->x, b->x) &&
+          p->y >= MIN (a->y, b->y) && p->y <= MAX (a->y, b->y));
+}
+
+/* Touching segments count as intersecting so that any doubt sends
+   the path to the GLU tesselator */
+static CoglBool
+segments_intersect (const CoglPathNode *a,
+                    const CoglPathNode *b,
+                    const CoglPathNode *c,
+                    const CoglPathNode *d)
+{
+  double d1 = orient (c, d, a);
+  double d2 = orient (c, d, b);
+  double d3 = orient (a, b, c);
+  double d4 = orient (a, b, d);
+
+  if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+      ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+    return TRUE;
+
+  return ((d1 == 0 && on_segment (c, d, a)) ||
+          (d2 == 0 && on_segment (c, d, b)) ||
+          (d3 == 0 && on_segment (a, b, c)) ||
+          (d4 == 0 && on_segment (a, b, d)));
+}
+
+#define VERTEX(n) (nodes + verts[(n)])
+
+static CoglBool
+contour_is_convex (const CoglPathNode *nodes,
+                   const int *verts,
+                   int n_verts,
+                   double sign)
+{
+  int x_changes = 0, y_changes = 0;
+  int first_x = 0, first_y = 0;
+  int last_x = 0, last_y = 0;
+  int i;
+
+  for (i = 0; i < n_verts; i++)
+    {
+      const CoglPathNode *a = VERTEX (i);
+      const CoglPathNode *b = VERTEX ((i + 1) % n_verts);
+      const CoglPathNode *c = VERTEX ((i + 2) % n_verts);
+      int dx, dy;
+
+      if (orient (a, b, c) * sign < 0)
+        return FALSE;
+
+      /* A polygon that turns the same way at every vertex can still
+         wind around more than once, like a pentagram. A convex polygon
+         only changes direction twice along each axis */
+      dx = (b->x > a->x) - (b->x < a->x);
+      dy = (b->y > a->y) - (b->y < a->y);
+
+      if (dx)
+        {
+          if (last_x && dx != last_x)
+            x_changes++;
+          else if (!first_x)
+            first_x = dx;
+          last_x = dx;
+        }
+      if (dy)
+        {
+          if (last_y && dy != last_y)
+            y_changes++;
+          else if (!first_y)
+            first_y = dy;
+          last_y = dy;
+        }
+    }
+
+  if (last_x != first_x)
+    x_changes++;
+  if (last_y != first_y)
+    y_changes++;
+
+  return x_changes <= 2 && y_changes <= 2;
+}
+
+static int
+compare_edges (const void *a,
+               const void *b)
+{
+  const CoglPathTriangulatorEdge *edge_a = a;
+  const CoglPathTriangulatorEdge *edge_b = b;
+
+  return (edge_a->y_1 > edge_b->y_1) - (edge_a->y_1 < edge_b->y_1);
+}
+
+/* Sweeps down the y axis so that each edge is only compared with the
+   edges that span the same rows. For a typical outline this is only a
+   few edges at a time */
+static CoglBool
+contour_is_simple (const CoglPathNode *nodes,
+                   const int *verts,
+                   int n_verts)
+{
+  CoglPathTriangulatorEdge edges[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  int active[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  int n_active = 0;
+  int i, j;
+
+  for (i = 0; i < n_verts; i++)
+    {
+      const CoglPathNode *a = VERTEX (i);
+      const CoglPathNode *b = VERTEX ((i + 1) % n_verts);
+
+      edges[i].y_1 = MIN (a->y, b->y);
+      edges[i].y_2 = MAX (a->y, b->y);
+      edges[i].index = i;
+    }
+
+  qsort (edges, n_verts, sizeof (CoglPathTriangulatorEdge), compare_edges);
+
+  for (i = 0; i < n_verts; i++)
+    {
+      const CoglPathTriangulatorEdge *edge = edges + i;
+      int n_still_active = 0;
+
+      for (j = 0; j < n_active; j++)
+        {
+          const CoglPathTriangulatorEdge *other = edges + active[j];
+          int diff;
+
+          if (other->y_2 < edge->y_1)
+            continue;
+
+          active[n_still_active++] = active[j];
+
+          /* Adjacent edges always share a vertex so they are skipped */
+          diff = ABS (edge->index - other->index);
+          if (diff == 1 || diff == n_verts - 1)
+            continue;
+
+          if (segments_intersect (VERTEX (edge->index),
+                                  VERTEX ((edge->index + 1) % n_verts),
+                                  VERTEX (other->index),
+                                  VERTEX ((other->index + 1) % n_verts)))
+            return FALSE;
+        }
+
+      n_active = n_still_active;
+      active[n_active++] = i;
+    }
+
+  return TRUE;
+}
+
+static void
+add_triangle (GArray *triangles,
+              int first_index,
+              const int *verts,
+              int a, int b, int c)
+{
+  int triangle[3];
+
+  triangle[0] = first_index + verts[a];
+  triangle[1] = first_index + verts[b];
+  triangle[2] = first_index + verts[c];
+
+  g_array_append_vals (triangles, triangle, 3);
+}
+
+static CoglBool
+is_reflex (const CoglPathNode *nodes,
+           const int *verts,
+           int p, int i, int q,
+           double sign)
+{
+  /* Vertices on a straight line are included so that they can't end
+     up on the edge of an ear */
+  return orient (VERTEX (p), VERTEX (i), VERTEX (q)) * sign <= 0;
+}
+
+static CoglBool
+ear_clip_contour (const CoglPathNode *nodes,
+                  const int *verts,
+                  int n_verts,
+                  double sign,
+                  int first_index,
+                  GArray *triangles)
+{
+  int prev[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  int next[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  CoglBool reflex[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  /* Only a reflex vertex can be inside an ear so these are the only
+     ones that need to be checked. Vertices stay in the list until the
+     next time it is walked after they stop being reflex */
+  int reflex_list[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  int n_reflex = 0;
+  int n_remaining = n_verts;
+  int n_misses = 0;
+  int i;
+
+  for (i = 0; i < n_verts; i++)
+    {
+      prev[i] = (i + n_verts - 1) % n_verts;
+      next[i] = (i + 1) % n_verts;
+    }
+
+  for (i = 0; i < n_verts; i++)
+    {
+      reflex[i] = is_reflex (nodes, verts, prev[i], i, next[i], sign);
+      if (reflex[i])
+        reflex_list[n_reflex++] = i;
+    }
+
+  i = 0;
+
+  while (n_remaining > 3)
+    {
+      int p = prev[i], q = next[i];
+      double turn = orient (VERTEX (p), VERTEX (i), VERTEX (q)) * sign;
+      CoglBool is_ear;
+
+      if (turn < 0)
+        is_ear = FALSE;
+      else if (turn == 0)
+        /* A vertex on a straight line doesn't contribute any area so
+           it can be dropped without adding a triangle */
+        is_ear = TRUE;
+      else
+        {
+          int n_still_reflex = 0;
+          int j;
+
+          is_ear = TRUE;
+
+          /* The triangle is only an ear if none of the other vertices
+             are inside it or on its edges */
+          for (j = 0; j < n_reflex; j++)
+            {
+              int r = reflex_list[j];
+              const CoglPathNode *point;
+
+              if (!reflex[r])
+                continue;
+
+              reflex_list[n_still_reflex++] = r;
+
+              if (r == p || r == q)
+                continue;
+
+              point = VERTEX (r);
+
+              if (orient (VERTEX (p), VERTEX (i), point) * sign >= 0 &&
+                  orient (VERTEX (i), VERTEX (q), point) * sign >= 0 &&
+                  orient (VERTEX (q), VERTEX (p), point) * sign >= 0)
+                {
+                  is_ear = FALSE;
+                  break;
+                }
+            }
+
+          /* Keep the part of the list that wasn't walked */
+          if (j < n_reflex)
+            {
+              memmove (reflex_list + n_still_reflex,
+                       reflex_list + j,
+                       (n_reflex - j) * sizeof (int));
+              n_still_reflex += n_reflex - j;
+            }
+          n_reflex = n_still_reflex;
+
+          if (is_ear)
+            add_triangle (triangles, first_index, verts, p, i, q);
+        }
+
+      if (is_ear)
+        {
+          next[p] = q;
+          prev[q] = p;
+          reflex[i] = FALSE;
+          n_remaining--;
+          n_misses = 0;
+
+          /* Removing an ear can only make its neighbours convex */
+          if (reflex[p])
+            reflex[p] = is_reflex (nodes, verts, prev[p], p, q, sign);
+          if (reflex[q])
+            reflex[q] = is_reflex (nodes, verts, p, q, next[q], sign);
+
+          i = q;
+        }
+      else if (++n_misses > n_remaining)
+        /* This can only happen because of rounding errors */
+        return FALSE;
+      else
+        i = q;
+    }
+
+  add_triangle (triangles, first_index, verts, prev[i], i, next[i]);
+
+  return TRUE;
+}
+
+static CoglBool
+triangulate_contour (const CoglPathNode *nodes,
+                     int n_nodes,
+                     int first_index,
+                     GArray *triangles)
+{
+  int verts_buf[COGL_PATH_TRIANGULATOR_MAX_VERTICES];
+  int *verts;
+  int n_verts = 0;
+  double area = 0.0;
+  double sign;
+  CoglBool ret = FALSE;
+  int i;
+
+  if (n_nodes <= COGL_PATH_TRIANGULATOR_MAX_VERTICES)
+    verts = verts_buf;
+  else
+    verts = g_new (int, n_nodes);
+
+  /* Skip repeated points. A closed sub-path ends with a copy of the
+     first point */
+  for (i = 0; i < n_nodes; i++)
+    if (n_verts == 0 || !nodes_equal (nodes + i, VERTEX (n_verts - 1)))
+      verts[n_verts++] = i;
+  while (n_verts > 1 && nodes_equal (VERTEX (n_verts - 1), VERTEX (0)))
+    n_verts--;
+
+  /* Nothing would be drawn for a line or a point */
+  if (n_verts < 3)
+    {
+      ret = TRUE;
+      goto done;
+    }
+
+  for (i = 0; i < n_verts; i++)
+    {
+      const CoglPathNode *a = VERTEX (i);
+      const CoglPathNode *b = VERTEX ((i + 1) % n_verts);
+
+      area += (double) a->x * b->y - (double) b->x * a->y;
+    }
+
+  /* A figure of eight can have no area overall */
+  if (area == 0.0)
+    goto done;
+
+  sign = area > 0.0 ? 1.0 : -1.0;
+
+  if (contour_is_convex (nodes, verts, n_verts, sign))
+    {
+      for (i = 1; i < n_verts - 1; i++)
+        add_triangle (triangles, first_index, verts, 0, i, i + 1);
+
+      ret = TRUE;
+    }
+  else if (n_verts <= COGL_PATH_TRIANGULATOR_MAX_VERTICES &&
+           contour_is_simple (nodes, verts, n_verts))
+    ret = ear_clip_contour (nodes, verts, n_verts, sign,
+                            first_index, triangles);
+
+ done:
+  if (verts != verts_buf)
+    g_free (verts);
+
+  return ret;
+}
+
+#undef VERTEX
+
+CoglBool
+_cogl_path_triangulate (GArray *path_nodes,
+                        GArray *triangles)
+{
+  CoglPathTriangulatorBox boxes[_COGL_PATH_TRIANGULATOR_MAX_CONTOURS];
+  unsigned int old_length = triangles->len;
+  int n_contours = 0;
+  unsigned int path_start;
+  CoglPathNode *node;
+  int i;
+
+  for (path_start = 0;
+       path_start < path_nodes->len;
+       path_start += node->path_size)
+    {
+      CoglPathTriangulatorBox *box = boxes + n_contours;
+
+      node = &g_array_index (path_nodes, CoglPathNode, path_start);
+
+      if (n_contours >= _COGL_PATH_TRIANGULATOR_MAX_CONTOURS)
+        goto fail;
+
+      box->x_1 = box->x_2 = node->x;
+      box->y_1 = box->y_2 = node->y;
+      for (i = 1; i < node->path_size; i++)
+        {
+          box->x_1 = MIN (box->x_1, node[i].x);
+          box->y_1 = MIN (box->y_1, node[i].y);
+          box->x_2 = MAX (box->x_2, node[i].x);
+          box->y_2 = MAX (box->y_2, node[i].y);
+        }
+
+      /* Sub-paths that might overlap depend on the fill rule */
+      for (i = 0; i < n_contours; i++)
+        if (box->x_1 <= boxes[i].x_2 && box->x_2 >= boxes[i].x_1 &&
+            box->y_1 <= boxes[i].y_2 && box->y_2 >= boxes[i].y_1)
+          goto fail;
+
+      n_contours++;
+
+      if (!triangulate_contour (node, node->path_size, path_start, triangles))
+        goto fail;
+    }
+
+  return TRUE;
+
+ fail:
+  g_array_set_size (triangles, old_length);
+  return FALSE;
+}
@@ -42,6 +42,7 @@
 #include "cogl-framebuffer-private.h"
 #include "cogl-path.h"
 #include "cogl-path-private.h"
+#include "cogl-path-triangulator-private.h"
 #include "cogl-texture-private.h"
 #include "cogl-primitives-private.h"
 #include "cogl-private.h"
@@ -54,11 +55,21 @@
 
 #define _COGL_MAX_BEZ_RECURSE_DEPTH 16
 
+/* Arcs that are drawn smaller than their natural size won't use
+   steps larger than this when they are flattened again */
+#define _COGL_MAX_ARC_STEP 45.0f
+
+typedef void (* CoglPathAddPointFunc) (float x, float y, void *user_data);
+
 static void _cogl_path_free (CoglPath *path);
 
 static void _cogl_path_build_fill_attribute_buffer (CoglPath *path);
-static CoglPrimitive *_cogl_path_get_fill_primitive (CoglPath *path);
+static CoglPrimitive *_cogl_path_get_fill_primitive (CoglPath *path,
+                                                     int scale_bucket);
 static void _cogl_path_build_stroke_attribute_buffer (CoglPath *path);
+static void _cogl_path_push_clip (CoglFramebuffer *framebuffer,
+                                  CoglPath *path,
+                                  CoglBool transient);
 
 COGL_OBJECT_DEFINE (Path, path);
 
@@ -84,6 +95,13 @@ _cogl_path_data_clear_vbos (CoglPathData *data)
       data->fill_primitive = NULL;
     }
 
+  for (i = 0; i < COGL_PATH_FILL_CACHE_SIZE; i++)
+    if (data->fill_cache[i].primitive)
+      {
+        cogl_object_unref (data->fill_cache[i].primitive);
+        data->fill_cache[i].primitive = NULL;
+      }
+
   if (data->stroke_attribute_buffer)
     {
       cogl_object_unref (data->stroke_attribute_buffer);
@@ -105,6 +123,7 @@ _cogl_path_data_unref (CoglPathData *data)
       _cogl_path_data_clear_vbos (data);
 
       g_array_free (data->path_nodes, TRUE);
+      g_array_free (data->curves, TRUE);
 
       g_slice_free (CoglPathData, data);
     }
@@ -128,9 +147,14 @@ _cogl_path_modify (CoglPath *path)
       g_array_append_vals (path->data->path_nodes,
                            old_data->path_nodes->data,
                            old_data->path_nodes->len);
+      path->data->curves = g_array_new (FALSE, FALSE, sizeof (CoglPathCurve));
+      g_array_append_vals (path->data->curves,
+                           old_data->curves->data,
+                           old_data->curves->len);
 
       path->data->fill_attribute_buffer = NULL;
       path->data->fill_primitive = NULL;
+      memset (path->data->fill_cache, 0, sizeof (path->data->fill_cache));
       path->data->stroke_attribute_buffer = NULL;
       path->data->ref_count = 1;
 
@@ -163,6 +187,32 @@ cogl_path_get_fill_rule (CoglPath *path)
   return path->data->fill_rule;
 }
 
+void
+cogl_path_set_fill_mode (CoglPath *path,
+                         CoglPathFillMode fill_mode)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_path (path));
+
+  if (path->data->fill_mode != fill_mode)
+    {
+      /* The cached primitives are still valid for the new mode so the
+         data only needs to be touched if it is shared with a copy */
+      if (path->data->ref_count != 1)
+        _cogl_path_modify (path);
+
+      path->data->fill_mode = fill_mode;
+    }
+}
+
+CoglPathFillMode
+cogl_path_get_fill_mode (CoglPath *path)
+{
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_path (path),
+                            COGL_PATH_FILL_MODE_TESSELLATE);
+
+  return path->data->fill_mode;
+}
+
 static void
 _cogl_path_add_node (CoglPath *path,
                      CoglBool new_sub_path,
@@ -287,26 +337,18 @@ _cogl_path_get_bounds (CoglPath *path,
     }
 }
 
+/* The stencil clip needs a scratch bit and at least one bit to hold
+   the silhouette */
+#define _COGL_PATH_MIN_STENCIL_BITS 2
+
 static void
 _cogl_path_fill_nodes_with_clipped_rectangle (CoglPath *path,
                                               CoglFramebuffer *framebuffer,
                                               CoglPipeline *pipeline)
 {
-  /* We need at least three stencil bits to combine clips */
-  if (_cogl_framebuffer_get_stencil_bits (framebuffer) >= 3)
-    {
-      static CoglBool seen_warning = FALSE;
-
-      if (!seen_warning)
-        {
-          g_warning ("Paths can not be filled using materials with "
-                     "sliced textures unless there is a stencil "
-                     "buffer");
-          seen_warning = TRUE;
-        }
-    }
-
-  cogl_framebuffer_push_path_clip (framebuffer, path);
+  /* The clip is popped again straight after drawing so it is marked
+     as transient to keep it out of the stencil clip cache */
+  _cogl_path_push_clip (framebuffer, path, TRUE);
   cogl_framebuffer_draw_rectangle (framebuffer,
                                    pipeline,
                                    path->data->path_nodes_min.x,
@@ -316,6 +358,54 @@ _cogl_path_fill_nodes_with_clipped_rectangle (CoglPath *path,
   cogl_framebuffer_pop_clip (framebuffer);
 }
 
+static int
+_cogl_path_get_scale_bucket_for_scale (float scale)
+{
+  int bucket;
+
+  if (!(scale > 0.0f))
+    return 0;
+
+  bucket = floorf (logf (scale) / G_LN2 + 0.5f);
+
+  return CLAMP (bucket,
+                -COGL_PATH_MAX_SCALE_BUCKET,
+                COGL_PATH_MAX_SCALE_BUCKET);
+}
+
+static int
+_cogl_path_get_scale_bucket (CoglPath *path,
+                             CoglMatrixEntry *modelview_entry)
+{
+  CoglMatrix matrix;
+  float scale_x, scale_y;
+
+  /* Paths without curves look the same at every scale */
+  if (path->data->curves->len == 0)
+    return 0;
+
+  cogl_matrix_entry_get (modelview_entry, &matrix);
+
+  /* Use the longest of the transformed axes so that the curves are
+     flattened finely enough in both directions */
+  scale_x = sqrtf (matrix.xx * matrix.xx + matrix.yx * matrix.yx);
+  scale_y = sqrtf (matrix.xy * matrix.xy + matrix.yy * matrix.yy);
+
+  return _cogl_path_get_scale_bucket_for_scale (MAX (scale_x, scale_y));
+}
+
+static CoglBool
+_cogl_path_can_use_stencil_fans (CoglPath *path,
+                                 CoglFramebuffer *framebuffer)
+{
+  /* The fans are drawn by inverting a single stencil bit so they can
+     only give the even-odd fill rule */
+  return (path->data->fill_mode == COGL_PATH_FILL_MODE_STENCIL &&
+          path->data->fill_rule == COGL_PATH_FILL_RULE_EVEN_ODD &&
+          (_cogl_framebuffer_get_stencil_bits (framebuffer) >=
+           _COGL_PATH_MIN_STENCIL_BITS));
+}
+
 static CoglBool
 validate_layer_cb (CoglPipelineLayer *layer, void *user_data)
 {
@@ -364,18 +454,46 @@ _cogl_path_fill_nodes (CoglPath *path,
       CoglBool needs_fallback = FALSE;
       CoglPrimitive *primitive;
 
+      /* Pushing the path as a clip draws its triangle fans into the
+         stencil buffer so covering the bounding box fills the path */
+      if (flags == 0 && _cogl_path_can_use_stencil_fans (path, framebuffer))
+        {
+          _cogl_path_fill_nodes_with_clipped_rectangle (path,
+                                                        framebuffer,
+                                                        pipeline);
+          return;
+        }
+
       _cogl_pipeline_foreach_layer_internal (pipeline,
                                              validate_layer_cb,
                                              &needs_fallback);
       if (needs_fallback)
         {
+          if (_cogl_framebuffer_get_stencil_bits (framebuffer) <
+              _COGL_PATH_MIN_STENCIL_BITS)
+            {
+              static CoglBool seen_warning = FALSE;
+
+              if (!seen_warning)
+                {
+                  g_warning ("Paths can not be filled using materials with "
+                             "sliced textures unless there is a stencil "
+                             "buffer");
+                  seen_warning = TRUE;
+                }
+            }
+
           _cogl_path_fill_nodes_with_clipped_rectangle (path,
                                                         framebuffer,
                                                         pipeline);
           return;
         }
 
-      primitive = _cogl_path_get_fill_primitive (path);
+      primitive =
+        _cogl_path_get_fill_primitive
+        (path,
+         _cogl_path_get_scale_bucket
+         (path, _cogl_framebuffer_get_modelview_entry (framebuffer)));
 
       _cogl_primitive_draw (primitive,
                             framebuffer,
@@ -542,15 +660,15 @@ _cogl_path_is_rectangle (CoglPath *path)
 }
 
 static void
-_cogl_path_arc (CoglPath *path,
-                float center_x,
-	        float center_y,
-                float radius_x,
-                float radius_y,
-                float angle_1,
-                float angle_2,
-                float angle_step,
-                unsigned int move_first)
+_cogl_path_flatten_arc (float center_x,
+                        float center_y,
+                        float radius_x,
+                        float radius_y,
+                        float angle_1,
+                        float angle_2,
+                        float angle_step,
+                        CoglPathAddPointFunc add_point,
+                        void *user_data)
 {
   float a = 0x0;
   float cosa = 0x0;
@@ -558,14 +676,6 @@ _cogl_path_arc (CoglPath *path,
   float px = 0x0;
   float py = 0x0;
 
-  /* Fix invalid angles */
-
-  if (angle_1 == angle_2 || angle_step == 0x0)
-    return;
-
-  if (angle_step < 0x0)
-    angle_step = -angle_step;
-
   /* Walk the arc by given step */
 
   a = angle_1;
@@ -577,10 +687,7 @@ _cogl_path_arc (CoglPath *path,
       px = center_x + (cosa * radius_x);
       py = center_y + (sina * radius_y);
 
-      if (a == angle_1 && move_first)
-	cogl_path_move_to (path, px, py);
-      else
-	cogl_path_line_to (path, px, py);
+      add_point (px, py, user_data);
 
       if (G_LIKELY (angle_2 > angle_1))
         {
@@ -604,7 +711,87 @@ _cogl_path_arc (CoglPath *path,
   px = center_x + (cosa * radius_x);
   py = center_y + (sina * radius_y);
 
-  cogl_path_line_to (path, px, py);
+  add_point (px, py, user_data);
+}
+
+typedef struct
+{
+  CoglPath *path;
+  CoglBool move_first;
+} CoglPathArcState;
+
+static void
+_cogl_path_add_arc_point_cb (float x, float y, void *user_data)
+{
+  CoglPathArcState *state = user_data;
+
+  if (state->move_first)
+    {
+      cogl_path_move_to (state->path, x, y);
+      state->move_first = FALSE;
+    }
+  else
+    cogl_path_line_to (state->path, x, y);
+}
+
+static void
+_cogl_path_add_curve (CoglPath *path,
+                      CoglPathCurve *curve,
+                      unsigned int first_node)
+{
+  CoglPathData *data = path->data;
+
+  curve->first_node = first_node;
+  curve->n_nodes = data->path_nodes->len - first_node;
+
+  if (curve->n_nodes > 0)
+    g_array_append_val (data->curves, *curve);
+}
+
+static void
+_cogl_path_arc (CoglPath *path,
+                float center_x,
+	        float center_y,
+                float radius_x,
+                float radius_y,
+                float angle_1,
+                float angle_2,
+                float angle_step,
+                unsigned int move_first)
+{
+  CoglPathArcState state;
+  CoglPathCurve curve;
+  unsigned int first_node;
+
+  /* Fix invalid angles */
+
+  if (angle_1 == angle_2 || angle_step == 0x0)
+    return;
+
+  if (angle_step < 0x0)
+    angle_step = -angle_step;
+
+  state.path = path;
+  state.move_first = move_first;
+
+  first_node = path->data->path_nodes->len;
+
+  _cogl_path_flatten_arc (center_x, center_y,
+                          radius_x, radius_y,
+                          angle_1, angle_2,
+                          angle_step,
+                          _cogl_path_add_arc_point_cb,
+                          &state);
+
+  curve.type = COGL_PATH_CURVE_TYPE_ARC;
+  curve.d.arc.center.x = center_x;
+  curve.d.arc.center.y = center_y;
+  curve.d.arc.radius.x = radius_x;
+  curve.d.arc.radius.y = radius_y;
+  curve.d.arc.angle_1 = angle_1;
+  curve.d.arc.angle_2 = angle_2;
+  curve.d.arc.angle_step = angle_step;
+  _cogl_path_add_curve (path, &curve, first_node);
 }
 
 void
@@ -732,9 +919,14 @@ cogl_path_round_rectangle (CoglPath *path,
   cogl_path_close (path);
 }
 
+/* Calls add_point for each subdivision point of the curve, not
+   including the end points. The curve is subdivided until the control
+   points are within tolerance of the line between the end points */
 static void
-_cogl_path_bezier3_sub (CoglPath *path,
-                        CoglBezCubic *cubic)
+_cogl_path_flatten_cubic (const CoglBezCubic *cubic,
+                          float tolerance,
+                          CoglPathAddPointFunc add_point,
+                          void *user_data)
 {
   CoglBezCubic cubics[_COGL_MAX_BEZ_RECURSE_DEPTH];
   CoglBezCubic *cleft;
@@ -781,14 +973,14 @@ _cogl_path_bezier3_sub (CoglPath *path,
       if (dif1.y < dif2.y) dif1.y = dif2.y;
 
       /* Cancel if the curve is flat enough */
-      if (dif1.x + dif1.y <= 1.0 ||
+      if (dif1.x + dif1.y <= tolerance ||
 	  cindex == _COGL_MAX_BEZ_RECURSE_DEPTH-1)
 	{
 	  /* Add subdivision point (skip last) */
 	  if (cindex == 0)
             return;
 
-	  _cogl_path_add_node (path, FALSE, c->p4.x, c->p4.y);
+	  add_point (c->p4.x, c->p4.y, user_data);
 
 	  --cindex;
 
@@ -828,6 +1020,12 @@ _cogl_path_bezier3_sub (CoglPath *path,
     }
 }
 
+static void
+_cogl_path_add_cubic_point_cb (float x, float y, void *user_data)
+{
+  _cogl_path_add_node (user_data, FALSE, x, y);
+}
+
 void
 cogl_path_curve_to (CoglPath *path,
                     float x_1,
@@ -838,9 +1036,13 @@ cogl_path_curve_to (CoglPath *path,
                     float y_3)
 {
   CoglBezCubic cubic;
+  CoglPathCurve curve;
+  unsigned int first_node;
 
   _COGL_RETURN_IF_FAIL (cogl_is_path (path));
 
+  first_node = path->data->path_nodes->len;
+
   /* Prepare cubic curve */
   cubic.p1 = path->data->path_pen;
   cubic.p2.x = x_1;
@@ -851,11 +1053,17 @@ cogl_path_curve_to (CoglPath *path,
   cubic.p4.y = y_3;
 
   /* Run subdivision */
-  _cogl_path_bezier3_sub (path, &cubic);
+  _cogl_path_flatten_cubic (&cubic, 1.0f,
+                            _cogl_path_add_cubic_point_cb,
+                            path);
 
   /* Add last point */
   _cogl_path_add_node (path, FALSE, cubic.p4.x, cubic.p4.y);
   path->data->path_pen = cubic.p4;
+
+  curve.type = COGL_PATH_CURVE_TYPE_CUBIC;
+  curve.d.cubic = cubic;
+  _cogl_path_add_curve (path, &curve, first_node);
 }
 
 void
@@ -894,11 +1102,15 @@ cogl_path_new (CoglContext *context)
   data->ref_count = 1;
   data->context = context;
   data->fill_rule = COGL_PATH_FILL_RULE_EVEN_ODD;
+  data->fill_mode = COGL_PATH_FILL_MODE_TESSELLATE;
   data->path_nodes = g_array_new (FALSE, FALSE, sizeof (CoglPathNode));
+  data->curves = g_array_new (FALSE, FALSE, sizeof (CoglPathCurve));
   data->last_path = 0;
   data->fill_attribute_buffer = NULL;
   data->stroke_attribute_buffer = NULL;
   data->fill_primitive = NULL;
+  memset (data->fill_cache, 0, sizeof (data->fill_cache));
+  data->fill_cache_age = 0;
   data->is_rectangle = FALSE;
 
   return _cogl_path_object_new (path);
@@ -1277,26 +1489,102 @@ _cogl_path_tesselator_combine (double coords[3],
 }
 
 static void
-_cogl_path_build_fill_attribute_buffer (CoglPath *path)
+_cogl_path_triangulate_with_glu (CoglPathTesselator *tess,
+                                 CoglPathData *data,
+                                 GArray *path_nodes)
 {
-  CoglPathTesselator tess;
   unsigned int path_start = 0;
-  CoglPathData *data = path->data;
   int i;
 
-  /* If we've already got a vbo then we don't need to do anything */
-  if (data->fill_attribute_buffer)
-    return;
+  tess->glu_tess = gluNewTess ();
+
+  if (data->fill_rule == COGL_PATH_FILL_RULE_EVEN_ODD)
+    gluTessProperty (tess->glu_tess, GLU_TESS_WINDING_RULE,
+                     GLU_TESS_WINDING_ODD);
+  else
+    gluTessProperty (tess->glu_tess, GLU_TESS_WINDING_RULE,
+                     GLU_TESS_WINDING_NONZERO);
+
+  /* All vertices are on the xy-plane */
+  gluTessNormal (tess->glu_tess, 0.0, 0.0, 1.0);
+
+  gluTessCallback (tess->glu_tess, GLU_TESS_BEGIN_DATA,
+                   _cogl_path_tesselator_begin);
+  gluTessCallback (tess->glu_tess, GLU_TESS_VERTEX_DATA,
+                   _cogl_path_tesselator_vertex);
+  gluTessCallback (tess->glu_tess, GLU_TESS_END_DATA,
+                   _cogl_path_tesselator_end);
+  gluTessCallback (tess->glu_tess, GLU_TESS_COMBINE_DATA,
+                   _cogl_path_tesselator_combine);
+
+  gluTessBeginPolygon (tess->glu_tess, tess);
+
+  while (path_start < path_nodes->len)
+    {
+      CoglPathNode *node =
+        &g_array_index (path_nodes, CoglPathNode, path_start);
+
+      gluTessBeginContour (tess->glu_tess);
+
+      for (i = 0; i < node->path_size; i++)
+        {
+          double vertex[3] = { node[i].x, node[i].y, 0.0 };
+          gluTessVertex (tess->glu_tess, vertex,
+                         GINT_TO_POINTER (i + path_start));
+        }
+
+      gluTessEndContour (tess->glu_tess);
+
+      path_start += node->path_size;
+    }
+
+  gluTessEndPolygon (tess->glu_tess);
+
+  gluDeleteTess (tess->glu_tess);
+}
+
+/* Simple paths can be triangulated without the overhead of the GLU
+   tesselator. This never creates new vertices */
+static CoglBool
+_cogl_path_triangulate_simple (CoglPathTesselator *tess,
+                               GArray *path_nodes)
+{
+  GArray *triangles = g_array_new (FALSE, FALSE, sizeof (int));
+  CoglBool ret;
+  int i;
+
+  ret = _cogl_path_triangulate (path_nodes, triangles);
+
+  for (i = 0; i < triangles->len; i++)
+    _cogl_path_tesselator_add_index (tess,
+                                     g_array_index (triangles, int, i));
+
+  g_array_free (triangles, TRUE);
+
+  return ret;
+}
+
+static void
+_cogl_path_tessellate_nodes (CoglPathData *data,
+                             GArray *path_nodes,
+                             CoglAttributeBuffer **attribute_buffer_out,
+                             CoglAttribute **attributes_out,
+                             CoglIndices **indices_out,
+                             unsigned int *n_indices_out)
+{
+  CoglPathTesselator tess;
+  CoglAttributeBuffer *attribute_buffer;
+  int i;
 
   tess.primitive_type = FALSE;
 
   /* Generate a vertex for each point on the path */
   tess.vertices = g_array_new (FALSE, FALSE, sizeof (CoglPathTesselatorVertex));
-  g_array_set_size (tess.vertices, data->path_nodes->len);
-  for (i = 0; i < data->path_nodes->len; i++)
+  g_array_set_size (tess.vertices, path_nodes->len);
+  for (i = 0; i < path_nodes->len; i++)
     {
       CoglPathNode *node =
-        &g_array_index (data->path_nodes, CoglPathNode, i);
+        &g_array_index (path_nodes, CoglPathNode, i);
       CoglPathTesselatorVertex *vertex =
         &g_array_index (tess.vertices, CoglPathTesselatorVertex, i);
 
@@ -1319,108 +1607,372 @@ _cogl_path_build_fill_attribute_buffer (CoglPath *path)
     }
 
   tess.indices_type =
-    _cogl_path_tesselator_get_indices_type_for_size (data->path_nodes->len);
+    _cogl_path_tesselator_get_indices_type_for_size (path_nodes->len);
   _cogl_path_tesselator_allocate_indices_array (&tess);
 
-  tess.glu_tess = gluNewTess ();
+  if (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FAST_PATH_FILL) ||
+      !_cogl_path_triangulate_simple (&tess, path_nodes))
+    _cogl_path_triangulate_with_glu (&tess, data, path_nodes);
 
-  if (data->fill_rule == COGL_PATH_FILL_RULE_EVEN_ODD)
-    gluTessProperty (tess.glu_tess, GLU_TESS_WINDING_RULE,
-                     GLU_TESS_WINDING_ODD);
-  else
-    gluTessProperty (tess.glu_tess, GLU_TESS_WINDING_RULE,
-                     GLU_TESS_WINDING_NONZERO);
-
-  /* All vertices are on the xy-plane */
-  gluTessNormal (tess.glu_tess, 0.0, 0.0, 1.0);
-
-  gluTessCallback (tess.glu_tess, GLU_TESS_BEGIN_DATA,
-                   _cogl_path_tesselator_begin);
-  gluTessCallback (tess.glu_tess, GLU_TESS_VERTEX_DATA,
-                   _cogl_path_tesselator_vertex);
-  gluTessCallback (tess.glu_tess, GLU_TESS_END_DATA,
-                   _cogl_path_tesselator_end);
-  gluTessCallback (tess.glu_tess, GLU_TESS_COMBINE_DATA,
-                   _cogl_path_tesselator_combine);
-
-  gluTessBeginPolygon (tess.glu_tess, &tess);
-
-  while (path_start < data->path_nodes->len)
-    {
-      CoglPathNode *node =
-        &g_array_index (data->path_nodes, CoglPathNode, path_start);
-
-      gluTessBeginContour (tess.glu_tess);
-
-      for (i = 0; i < node->path_size; i++)
-        {
-          double vertex[3] = { node[i].x, node[i].y, 0.0 };
-          gluTessVertex (tess.glu_tess, vertex,
-                         GINT_TO_POINTER (i + path_start));
-        }
-
-      gluTessEndContour (tess.glu_tess);
-
-      path_start += node->path_size;
-    }
-
-  gluTessEndPolygon (tess.glu_tess);
-
-  gluDeleteTess (tess.glu_tess);
-
-  data->fill_attribute_buffer =
+  attribute_buffer =
     cogl_attribute_buffer_new (data->context,
                                sizeof (CoglPathTesselatorVertex) *
                                tess.vertices->len,
                                tess.vertices->data);
   g_array_free (tess.vertices, TRUE);
 
-  data->fill_attributes[0] =
-    cogl_attribute_new (data->fill_attribute_buffer,
+  attributes_out[0] =
+    cogl_attribute_new (attribute_buffer,
                         "cogl_position_in",
                         sizeof (CoglPathTesselatorVertex),
                         G_STRUCT_OFFSET (CoglPathTesselatorVertex, x),
                         2, /* n_components */
                         COGL_ATTRIBUTE_TYPE_FLOAT);
-  data->fill_attributes[1] =
-    cogl_attribute_new (data->fill_attribute_buffer,
+  attributes_out[1] =
+    cogl_attribute_new (attribute_buffer,
                         "cogl_tex_coord0_in",
                         sizeof (CoglPathTesselatorVertex),
                         G_STRUCT_OFFSET (CoglPathTesselatorVertex, s),
                         2, /* n_components */
                         COGL_ATTRIBUTE_TYPE_FLOAT);
 
-  data->fill_vbo_indices = cogl_indices_new (data->context,
-                                             tess.indices_type,
-                                             tess.indices->data,
-                                             tess.indices->len);
-  data->fill_vbo_n_indices = tess.indices->len;
+  *attribute_buffer_out = attribute_buffer;
+  *indices_out = cogl_indices_new (data->context,
+                                   tess.indices_type,
+                                   tess.indices->data,
+                                   tess.indices->len);
+  *n_indices_out = tess.indices->len;
   g_array_free (tess.indices, TRUE);
 }
 
+static void
+_cogl_path_build_fill_attribute_buffer (CoglPath *path)
+{
+  CoglPathData *data = path->data;
+
+  /* If we've already got a vbo then we don't need to do anything */
+  if (data->fill_attribute_buffer)
+    return;
+
+  _cogl_path_tessellate_nodes (data,
+                               data->path_nodes,
+                               &data->fill_attribute_buffer,
+                               data->fill_attributes,
+                               &data->fill_vbo_indices,
+                               &data->fill_vbo_n_indices);
+}
+
+static void
+_cogl_path_add_flattened_node_cb (float x, float y, void *user_data)
+{
+  GArray *path_nodes = user_data;
+  CoglPathNode node;
+
+  node.x = x;
+  node.y = y;
+  node.path_size = 0;
+
+  g_array_append_val (path_nodes, node);
+}
+
+static void
+_cogl_path_flatten_curve (CoglPathCurve *curve,
+                          float scale,
+                          GArray *path_nodes)
+{
+  switch (curve->type)
+    {
+    case COGL_PATH_CURVE_TYPE_CUBIC:
+      /* The flatness is measured in path coordinates so the tolerance
+         is shrunk by the scale to keep it at about a pixel */
+      _cogl_path_flatten_cubic (&curve->d.cubic,
+                                1.0f / scale,
+                                _cogl_path_add_flattened_node_cb,
+                                path_nodes);
+      _cogl_path_add_flattened_node_cb (curve->d.cubic.p4.x,
+                                        curve->d.cubic.p4.y,
+                                        path_nodes);
+      break;
+
+    case COGL_PATH_CURVE_TYPE_ARC:
+      {
+        float angle_step = curve->d.arc.angle_step;
+
+        /* The distance between a chord and the arc grows with the
+           square of the step so this keeps the error the same as it
+           would be at a scale of 1 */
+        angle_step /= sqrtf (scale);
+        if (scale < 1.0f)
+          angle_step = MIN (angle_step,
+                            MAX (curve->d.arc.angle_step, _COGL_MAX_ARC_STEP));
+
+        _cogl_path_flatten_arc (curve->d.arc.center.x,
+                                curve->d.arc.center.y,
+                                curve->d.arc.radius.x,
+                                curve->d.arc.radius.y,
+                                curve->d.arc.angle_1,
+                                curve->d.arc.angle_2,
+                                angle_step,
+                                _cogl_path_add_flattened_node_cb,
+                                path_nodes);
+      }
+      break;
+    }
+}
+
+/* Creates a copy of the path nodes where the nodes for each curve
+   are replaced with the curve flattened for the given scale */
+static GArray *
+_cogl_path_flatten_nodes_for_scale (CoglPathData *data,
+                                    float scale)
+{
+  GArray *path_nodes = g_array_sized_new (FALSE, FALSE,
+                                          sizeof (CoglPathNode),
+                                          data->path_nodes->len);
+  unsigned int curve_num = 0;
+  unsigned int path_start;
+  CoglPathNode *node;
+
+  for (path_start = 0;
+       path_start < data->path_nodes->len;
+       path_start += node->path_size)
+    {
+      unsigned int new_path_start = path_nodes->len;
+      unsigned int i = 0;
+
+      node = &g_array_index (data->path_nodes, CoglPathNode, path_start);
+
+      while (i < node->path_size)
+        {
+          CoglPathCurve *curve = NULL;
+
+          if (curve_num < data->curves->len)
+            curve = &g_array_index (data->curves, CoglPathCurve, curve_num);
+
+          if (curve && curve->first_node == path_start + i)
+            {
+              _cogl_path_flatten_curve (curve, scale, path_nodes);
+              i += curve->n_nodes;
+              curve_num++;
+            }
+          else
+            {
+              _cogl_path_add_flattened_node_cb (node[i].x, node[i].y,
+                                                path_nodes);
+              i++;
+            }
+        }
+
+      g_array_index (path_nodes, CoglPathNode, new_path_start).path_size =
+        path_nodes->len - new_path_start;
+    }
+
+  return path_nodes;
+}
+
 static CoglPrimitive *
-_cogl_path_get_fill_primitive (CoglPath *path)
+_cogl_path_create_fill_primitive_for_scale (CoglPath *path,
+                                            int scale_bucket)
 {
-  if (path->data->fill_primitive)
-    return path->data->fill_primitive;
+  CoglPathData *data = path->data;
+  CoglAttributeBuffer *attribute_buffer;
+  CoglAttribute *attributes[COGL_PATH_N_ATTRIBUTES];
+  CoglIndices *indices;
+  unsigned int n_indices;
+  CoglPrimitive *primitive;
+  GArray *path_nodes;
+  int i;
+
+  path_nodes = _cogl_path_flatten_nodes_for_scale (data,
+                                                   ldexpf (1.0f,
+                                                           scale_bucket));
+
+  _cogl_path_tessellate_nodes (data,
+                               path_nodes,
+                               &attribute_buffer,
+                               attributes,
+                               &indices,
+                               &n_indices);
+
+  g_array_free (path_nodes, TRUE);
+
+  primitive =
+    cogl_primitive_new_with_attributes (COGL_VERTICES_MODE_TRIANGLES,
+                                        n_indices,
+                                        attributes,
+                                        COGL_PATH_N_ATTRIBUTES);
+  cogl_primitive_set_indices (primitive, indices, n_indices);
+
+  /* The primitive keeps its own references */
+  cogl_object_unref (attribute_buffer);
+  cogl_object_unref (indices);
+  for (i = 0; i < COGL_PATH_N_ATTRIBUTES; i++)
+    cogl_object_unref (attributes[i]);
+
+  return primitive;
+}
+
+/* Creates a primitive with a triangle for each edge of the path that
+   joins the edge to the first node. Drawing this with the stencil
+   bits inverted leaves the bits set for the pixels that are covered
+   an odd number of times which are the ones inside the path */
+static CoglPrimitive *
+_cogl_path_create_stencil_primitive_for_scale (CoglPath *path,
+                                               int scale_bucket)
+{
+  CoglPathData *data = path->data;
+  CoglPrimitive *primitive;
+  CoglVertexP2 *vertices, *v;
+  GArray *path_nodes;
+  CoglPathNode *pivot;
+  unsigned int path_start;
+  CoglPathNode *node;
+  int i;
+
+  if (data->curves->len > 0)
+    path_nodes = _cogl_path_flatten_nodes_for_scale (data,
+                                                     ldexpf (1.0f,
+                                                             scale_bucket));
+  else
+    path_nodes = data->path_nodes;
+
+  pivot = &g_array_index (path_nodes, CoglPathNode, 0);
+  v = vertices = g_new (CoglVertexP2, path_nodes->len * 3);
+
+  for (path_start = 0;
+       path_start < path_nodes->len;
+       path_start += node->path_size)
+    {
+      node = &g_array_index (path_nodes, CoglPathNode, path_start);
+
+      /* The last edge implicitly closes the sub-path */
+      for (i = 0; i < node->path_size; i++)
+        {
+          CoglPathNode *next = node + (i + 1) % node->path_size;
+
+          v[0].x = pivot->x;
+          v[0].y = pivot->y;
+          v[1].x = node[i].x;
+          v[1].y = node[i].y;
+          v[2].x = next->x;
+          v[2].y = next->y;
+          v += 3;
+        }
+    }
+
+  primitive = cogl_primitive_new_p2 (data->context,
+                                     COGL_VERTICES_MODE_TRIANGLES,
+                                     v - vertices,
+                                     vertices);
+
+  g_free (vertices);
+
+  if (path_nodes != data->path_nodes)
+    g_array_free (path_nodes, TRUE);
+
+  return primitive;
+}
+
+static CoglPrimitive *
+_cogl_path_get_cached_primitive (CoglPath *path,
+                                 CoglPathFillMode mode,
+                                 int scale_bucket)
+{
+  CoglPathData *data = path->data;
+  CoglPathFillCacheEntry *entry = NULL;
+  int i;
+
+  /* Look for a cached primitive for this scale or otherwise pick the
+     least recently used entry to replace */
+  for (i = 0; i < COGL_PATH_FILL_CACHE_SIZE; i++)
+    {
+      CoglPathFillCacheEntry *cache_entry = data->fill_cache + i;
+
+      if (cache_entry->primitive &&
+          cache_entry->mode == mode &&
+          cache_entry->scale_bucket == scale_bucket)
+        {
+          cache_entry->age = ++data->fill_cache_age;
+          return cache_entry->primitive;
+        }
+
+      if (entry == NULL ||
+          (entry->primitive && (cache_entry->primitive == NULL ||
+                                cache_entry->age < entry->age)))
+        entry = cache_entry;
+    }
+
+  if (entry->primitive)
+    cogl_object_unref (entry->primitive);
+
+  entry->mode = mode;
+  entry->scale_bucket = scale_bucket;
+  entry->age = ++data->fill_cache_age;
+
+  if (mode == COGL_PATH_FILL_MODE_STENCIL)
+    entry->primitive =
+      _cogl_path_create_stencil_primitive_for_scale (path, scale_bucket);
+  else
+    entry->primitive =
+      _cogl_path_create_fill_primitive_for_scale (path, scale_bucket);
+
+  return entry->primitive;
+}
+
+static CoglPrimitive *
+_cogl_path_get_fill_primitive (CoglPath *path,
+                               int scale_bucket)
+{
+  CoglPathData *data = path->data;
+
+  if (scale_bucket != 0)
+    return _cogl_path_get_cached_primitive (path,
+                                            COGL_PATH_FILL_MODE_TESSELLATE,
+                                            scale_bucket);
+
+  if (data->fill_primitive)
+    return data->fill_primitive;
 
   _cogl_path_build_fill_attribute_buffer (path);
 
-  path->data->fill_primitive =
+  data->fill_primitive =
     cogl_primitive_new_with_attributes (COGL_VERTICES_MODE_TRIANGLES,
-                                        path->data->fill_vbo_n_indices,
-                                        path->data->fill_attributes,
+                                        data->fill_vbo_n_indices,
+                                        data->fill_attributes,
                                         COGL_PATH_N_ATTRIBUTES);
-  cogl_primitive_set_indices (path->data->fill_primitive,
-                              path->data->fill_vbo_indices,
-                              path->data->fill_vbo_n_indices);
+  cogl_primitive_set_indices (data->fill_primitive,
+                              data->fill_vbo_indices,
+                              data->fill_vbo_n_indices);
 
-  return path->data->fill_primitive;
+  return data->fill_primitive;
+}
+
+int
+_cogl_path_get_n_fill_vertices (CoglPath *path,
+                                float scale)
+{
+  int scale_bucket = _cogl_path_get_scale_bucket_for_scale (scale);
+  CoglPrimitive *primitive;
+
+  if (path->data->path_nodes->len == 0)
+    return 0;
+
+  if (path->data->fill_mode == COGL_PATH_FILL_MODE_STENCIL &&
+      path->data->fill_rule == COGL_PATH_FILL_RULE_EVEN_ODD)
+    primitive = _cogl_path_get_cached_primitive (path,
+                                                 COGL_PATH_FILL_MODE_STENCIL,
+                                                 scale_bucket);
+  else
+    primitive = _cogl_path_get_fill_primitive (path, scale_bucket);
+
+  return cogl_primitive_get_n_vertices (primitive);
 }
 
 static CoglClipStack *
 _cogl_clip_stack_push_from_path (CoglClipStack *stack,
                                  CoglPath *path,
+                                 CoglBool use_stencil_fans,
+                                 CoglBool transient,
                                  CoglMatrixEntry *modelview_entry,
                                  CoglMatrixEntry *projection_entry,
                                  const float *viewport)
@@ -1441,20 +1993,37 @@ _cogl_clip_stack_push_from_path (CoglClipStack *stack,
                                             viewport);
   else
     {
-      CoglPrimitive *primitive = _cogl_path_get_fill_primitive (path);
-
-      return _cogl_clip_stack_push_primitive (stack,
-                                              primitive,
-                                              x_1, y_1, x_2, y_2,
-                                              modelview_entry,
-                                              projection_entry,
-                                              viewport);
+      int scale_bucket = _cogl_path_get_scale_bucket (path, modelview_entry);
+      CoglPrimitive *primitive;
+      CoglClipStackPrimitive *entry;
+
+      /* The clip stack draws the primitive into the stencil buffer by
+         inverting the bits so the fans can be used directly */
+      if (use_stencil_fans)
+        primitive =
+          _cogl_path_get_cached_primitive (path,
+                                           COGL_PATH_FILL_MODE_STENCIL,
+                                           scale_bucket);
+      else
+        primitive = _cogl_path_get_fill_primitive (path, scale_bucket);
+
+      entry = (CoglClipStackPrimitive *)
+        _cogl_clip_stack_push_primitive (stack,
+                                         primitive,
+                                         x_1, y_1, x_2, y_2,
+                                         modelview_entry,
+                                         projection_entry,
+                                         viewport);
+      entry->transient = transient;
+
+      return (CoglClipStack *) entry;
     }
 }
 
-void
-cogl_framebuffer_push_path_clip (CoglFramebuffer *framebuffer,
-                                 CoglPath *path)
+static void
+_cogl_path_push_clip (CoglFramebuffer *framebuffer,
+                      CoglPath *path,
+                      CoglBool transient)
 {
   CoglMatrixEntry *modelview_entry =
     _cogl_framebuffer_get_modelview_entry (framebuffer);
@@ -1472,6 +2041,9 @@ cogl_framebuffer_push_path_clip (CoglFramebuffer *framebuffer,
   framebuffer->clip_stack =
     _cogl_clip_stack_push_from_path (framebuffer->clip_stack,
                                      path,
+                                     _cogl_path_can_use_stencil_fans
+                                     (path, framebuffer),
+                                     transient,
                                      modelview_entry,
                                      projection_entry,
                                      viewport);
@@ -1481,6 +2053,13 @@ cogl_framebuffer_push_path_clip (CoglFramebuffer *framebuffer,
       COGL_FRAMEBUFFER_STATE_CLIP;
 }
 
+void
+cogl_framebuffer_push_path_clip (CoglFramebuffer *framebuffer,
+                                 CoglPath *path)
+{
+  _cogl_path_push_clip (framebuffer, path, FALSE);
+}
+
 static void
 _cogl_path_build_stroke_attribute_buffer (CoglPath *path)
 {
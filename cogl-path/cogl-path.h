@@ -466,6 +466,65 @@ cogl_path_set_fill_rule (CoglPath *path, CoglPathFillRule fill_rule);
 CoglPathFillRule
 cogl_path_get_fill_rule (CoglPath *path);
 
+/**
+ * CoglPathFillMode:
+ * @COGL_PATH_FILL_MODE_TESSELLATE: The interior of the path is split
+ *   into triangles on the CPU. The triangles are cached with the path
+ *   so this is the best choice for paths that are drawn many times.
+ * @COGL_PATH_FILL_MODE_STENCIL: A triangle fan for each sub-path is
+ *   drawn into the stencil buffer to mark the pixels inside the path
+ *   and then the bounding box of the path is drawn with the stencil
+ *   test enabled. There is no tessellation so this is the better
+ *   choice for paths that change every frame, such as charts.
+ *
+ * #CoglPathFillMode is used to choose how the interior of a path is
+ * found when it is filled or used as a clip.
+ *
+ * The stencil mode is only used for paths with the
+ * %COGL_PATH_FILL_RULE_EVEN_ODD fill rule when the framebuffer has a
+ * stencil buffer. Otherwise the path is tessellated as usual.
+ *
+ * The default fill mode when creating a path is
+ * %COGL_PATH_FILL_MODE_TESSELLATE.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef enum {
+  COGL_PATH_FILL_MODE_TESSELLATE,
+  COGL_PATH_FILL_MODE_STENCIL
+} CoglPathFillMode;
+
+/**
+ * cogl_path_set_fill_mode:
+ * @path: A #CoglPath
+ * @fill_mode: The new fill mode.
+ *
+ * Sets how the interior of @path will be found when it is later
+ * filled with cogl_path_fill() or used as a clip with
+ * cogl_framebuffer_push_path_clip(). See %CoglPathFillMode for
+ * details.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_path_set_fill_mode (CoglPath *path, CoglPathFillMode fill_mode);
+
+/**
+ * cogl_path_get_fill_mode:
+ * @path: A #CoglPath
+ *
+ * Retrieves the fill mode set using cogl_path_set_fill_mode().
+ *
+ * Return value: the fill mode that is used for the current path.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglPathFillMode
+cogl_path_get_fill_mode (CoglPath *path);
+
 /**
  * cogl_framebuffer_fill_path:
  * @path: The #CoglPath to fill
@@ -478,6 +537,14 @@ cogl_path_get_fill_rule (CoglPath *path);
  * The tesselated interior of the path is determined using the fill
  * rule of the path. See %CoglPathFillRule for details.
  *
+ * Curves and arcs in the path are flattened with a tolerance that
+ * depends on the scale of the framebuffer's modelview matrix so that
+ * they stay smooth when the path is drawn enlarged. The tesselation
+ * for each scale is cached with the path.
+ *
+ * Paths that change every frame can avoid the tesselation by using
+ * the stencil buffer instead. See cogl_path_set_fill_mode().
+ *
  * <note>The result of referencing sliced textures in your current
  * pipeline when filling a path are undefined. You should pass
  * the %COGL_TEXTURE_NO_SLICING flag when loading any texture you will
@@ -308,6 +308,8 @@ _cogl_atlas_create_texture (CoglAtlas *atlas,
 
       _cogl_texture_set_internal_format (COGL_TEXTURE (tex),
                                          atlas->texture_format);
+      _cogl_texture_set_memory_type (COGL_TEXTURE (tex),
+                                     COGL_MEMORY_TYPE_ATLAS);
 
       if (!cogl_texture_allocate (COGL_TEXTURE (tex), &ignore_error))
         {
@@ -326,6 +328,8 @@ _cogl_atlas_create_texture (CoglAtlas *atlas,
 
       _cogl_texture_set_internal_format (COGL_TEXTURE (tex),
                                          atlas->texture_format);
+      _cogl_texture_set_memory_type (COGL_TEXTURE (tex),
+                                     COGL_MEMORY_TYPE_ATLAS);
 
       if (!cogl_texture_allocate (COGL_TEXTURE (tex), &ignore_error))
         {
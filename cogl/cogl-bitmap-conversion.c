@@ -542,18 +542,11 @@ driver_can_convert (CoglContext *ctx,
   return TRUE;
 }
 
-CoglBitmap *
-_cogl_bitmap_convert_for_upload (CoglBitmap *src_bmp,
-                                 CoglPixelFormat internal_format,
-                                 CoglBool can_convert_in_place,
-                                 CoglError **error)
+CoglPixelFormat
+_cogl_bitmap_get_upload_format (CoglContext *ctx,
+                                CoglPixelFormat src_format,
+                                CoglPixelFormat internal_format)
 {
-  CoglContext *ctx = _cogl_bitmap_get_context (src_bmp);
-  CoglPixelFormat src_format = cogl_bitmap_get_format (src_bmp);
-  CoglBitmap *dst_bmp;
-
-  _COGL_RETURN_VAL_IF_FAIL (internal_format != COGL_PIXEL_FORMAT_ANY, NULL);
-
   /* OpenGL supports specifying a different format for the internal
      format when uploading texture data. We should use this to convert
      formats because it is likely to be faster and support more types
@@ -568,47 +561,51 @@ _cogl_bitmap_convert_for_upload (CoglBitmap *src_bmp,
          internal_format then we need to copy and convert it */
       if (_cogl_texture_needs_premult_conversion (src_format,
                                                   internal_format))
-        {
-          if (can_convert_in_place)
-            {
-              if (_cogl_bitmap_convert_premult_status (src_bmp,
-                                                       (src_format ^
-                                                        COGL_PREMULT_BIT),
-                                                       error))
-                {
-                  dst_bmp = cogl_object_ref (src_bmp);
-                }
-              else
-                return NULL;
-            }
-          else
-            {
-              dst_bmp = _cogl_bitmap_convert (src_bmp,
-                                              src_format ^ COGL_PREMULT_BIT,
-                                              error);
-              if (dst_bmp == NULL)
-                return NULL;
-            }
-        }
+        return src_format ^ COGL_PREMULT_BIT;
       else
-        dst_bmp = cogl_object_ref (src_bmp);
+        return src_format;
     }
   else
-    {
-      CoglPixelFormat closest_format;
+    return ctx->driver_vtable->pixel_format_to_gl (ctx,
+                                                   internal_format,
+                                                   NULL, /* ignore gl intformat */
+                                                   NULL, /* ignore gl format */
+                                                   NULL); /* ignore gl type */
+}
+
+CoglBitmap *
+_cogl_bitmap_convert_for_upload (CoglBitmap *src_bmp,
+                                 CoglPixelFormat internal_format,
+                                 CoglBool can_convert_in_place,
+                                 CoglError **error)
+{
+  CoglContext *ctx = _cogl_bitmap_get_context (src_bmp);
+  CoglPixelFormat src_format = cogl_bitmap_get_format (src_bmp);
+  CoglPixelFormat upload_format;
+  CoglBitmap *dst_bmp;
+
+  _COGL_RETURN_VAL_IF_FAIL (internal_format != COGL_PIXEL_FORMAT_ANY, NULL);
 
-      closest_format =
-        ctx->driver_vtable->pixel_format_to_gl (ctx,
-                                                internal_format,
-                                                NULL, /* ignore gl intformat */
-                                                NULL, /* ignore gl format */
-                                                NULL); /* ignore gl type */
+  upload_format = _cogl_bitmap_get_upload_format (ctx,
+                                                  src_format,
+                                                  internal_format);
 
-      if (closest_format != src_format)
-        dst_bmp = _cogl_bitmap_convert (src_bmp, closest_format, error);
-      else
+  if (upload_format == src_format)
+    dst_bmp = cogl_object_ref (src_bmp);
+  else if (upload_format == (src_format ^ COGL_PREMULT_BIT) &&
+           can_convert_in_place)
+    {
+      /* Only the premult status differs so we can convert the bitmap
+         in-place */
+      if (_cogl_bitmap_convert_premult_status (src_bmp,
+                                               upload_format,
+                                               error))
         dst_bmp = cogl_object_ref (src_bmp);
+      else
+        return NULL;
     }
+  else
+    dst_bmp = _cogl_bitmap_convert (src_bmp, upload_format, error);
 
   return dst_bmp;
 }
@@ -110,6 +110,13 @@ _cogl_bitmap_convert (CoglBitmap *bmp,
 		      CoglPixelFormat dst_format,
                       CoglError **error);
 
+/* Gets the format that a bitmap in @src_format would be converted to
+ * by _cogl_bitmap_convert_for_upload() */
+CoglPixelFormat
+_cogl_bitmap_get_upload_format (CoglContext *ctx,
+                                CoglPixelFormat src_format,
+                                CoglPixelFormat internal_format);
+
 CoglBitmap *
 _cogl_bitmap_convert_for_upload (CoglBitmap *src_bmp,
                                  CoglPixelFormat internal_format,
@@ -164,6 +164,8 @@ _cogl_buffer_initialize (CoglBuffer *buffer,
 
       buffer->flags |= COGL_BUFFER_FLAG_BUFFER_OBJECT;
     }
+
+  _cogl_memory_add (ctx, COGL_MEMORY_TYPE_BUFFER, size);
 }
 
 void
@@ -176,6 +178,10 @@ _cogl_buffer_fini (CoglBuffer *buffer)
     buffer->context->driver_vtable->buffer_destroy (buffer);
   else
     g_free (buffer->data);
+
+  _cogl_memory_remove (buffer->context,
+                       COGL_MEMORY_TYPE_BUFFER,
+                       buffer->size);
 }
 
 unsigned int
@@ -281,6 +281,8 @@ _cogl_clip_stack_push_primitive (CoglClipStack *stack,
   entry->bounds_x2 = bounds_x2;
   entry->bounds_y2 = bounds_y2;
 
+  entry->transient = FALSE;
+
   cogl_matrix_entry_get (modelview_entry, &modelview);
   cogl_matrix_entry_get (projection_entry, &projection);
 
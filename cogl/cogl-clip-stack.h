@@ -44,6 +44,10 @@
    of the reference on the old entry. Therefore unrefing the top entry
    effectively loses ownership of all entries in the stack */
 
+/* The maximum number of rectangles that a driver may clip to using
+   the fragment shader instead of the stencil buffer */
+#define COGL_MAX_SHADER_CLIP_RECTS 4
+
 typedef struct _CoglClipStack CoglClipStack;
 typedef struct _CoglClipStackRect CoglClipStackRect;
 typedef struct _CoglClipStackWindowRect CoglClipStackWindowRect;
@@ -160,6 +164,12 @@ struct _CoglClipStackPrimitive
   float bounds_y1;
   float bounds_x2;
   float bounds_y2;
+
+  /* This is set when the entry is only pushed for the duration of a
+     single draw, such as when filling a path. The GL driver won't
+     cache the silhouette of a stack with a transient entry on top
+     because it would never be used again */
+  CoglBool transient;
 };
 
 CoglClipStack *
@@ -0,0 +1,104 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_COMMAND_BUFFER_PRIVATE_H
+#define __COGL_COMMAND_BUFFER_PRIVATE_H
+
+#include <glib.h>
+
+#include "cogl-command-buffer.h"
+#include "cogl-object-private.h"
+
+typedef enum
+{
+  COGL_COMMAND_SET_MODELVIEW,
+  COGL_COMMAND_PUSH_RECTANGLE_CLIP,
+  COGL_COMMAND_POP_CLIP,
+  COGL_COMMAND_DRAW_PRIMITIVE,
+  COGL_COMMAND_DRAW_RECTANGLES
+} CoglCommandType;
+
+typedef struct _CoglCommand
+{
+  CoglCommandType type;
+
+  /* Only set for the draw commands. This is borrowed from the caller
+   * until the buffer is submitted and then the buffer owns a
+   * reference */
+  CoglPipeline *pipeline;
+  /* Only set for COGL_COMMAND_DRAW_PRIMITIVE. This is borrowed until
+   * the buffer is submitted and then the buffer owns a reference and
+   * an immutable reference */
+  CoglPrimitive *primitive;
+
+  /* For COGL_COMMAND_SET_MODELVIEW this is an index into the matrices
+   * array. For the clip and rectangle commands it is the offset of
+   * the first coordinate in the float data */
+  int data_index;
+
+  /* For COGL_COMMAND_DRAW_RECTANGLES. The coordinates are 4 floats
+   * per rectangle, or 8 if they are textured. first_rect is the index
+   * of the first rectangle in the rects array */
+  int first_rect;
+  int n_rectangles;
+  CoglBool textured;
+} CoglCommand;
+
+struct _CoglCommandBuffer
+{
+  CoglObject _parent;
+
+  CoglContext *context;
+
+  /* Array of CoglCommands */
+  GArray *commands;
+  /* Array of CoglMatrix for COGL_COMMAND_SET_MODELVIEW */
+  GArray *matrices;
+  /* Array of floats for the clip and rectangle coordinates */
+  GArray *float_data;
+
+  /* Array of CoglMultiTexturedRects pointing into float_data for
+   * all of the rectangle commands. This is built on the first
+   * submission after recording so that a buffer which is submitted
+   * every frame doesn't need to convert its rectangles again */
+  GArray *rects;
+  CoglBool rects_valid;
+  int n_rects;
+
+  /* The number of clips pushed so far while recording */
+  int clip_depth;
+
+  /* Recording may happen on a thread that doesn't use the context
+   * and object references aren't thread safe so the references are
+   * only taken when submitting. This is the number of commands at
+   * the start of the array whose objects have been referenced */
+  int n_referenced_commands;
+};
+
+#endif /* __COGL_COMMAND_BUFFER_PRIVATE_H */
@@ -0,0 +1,406 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "cogl-context-private.h"
+#include "cogl-command-buffer-private.h"
+#include "cogl-primitive-private.h"
+#include "cogl-primitives-private.h"
+#include "cogl-framebuffer.h"
+
+static void _cogl_command_buffer_free (CoglCommandBuffer *buffer);
+
+COGL_OBJECT_DEFINE (CommandBuffer, command_buffer);
+
+CoglCommandBuffer *
+cogl_command_buffer_new (CoglContext *context)
+{
+  CoglCommandBuffer *buffer = g_slice_new0 (CoglCommandBuffer);
+
+  buffer->context = context;
+  buffer->commands = g_array_new (FALSE, FALSE, sizeof (CoglCommand));
+  buffer->matrices = g_array_new (FALSE, FALSE, sizeof (CoglMatrix));
+  buffer->float_data = g_array_new (FALSE, FALSE, sizeof (float));
+  buffer->rects = g_array_new (FALSE, FALSE, sizeof (CoglMultiTexturedRect));
+
+  return _cogl_command_buffer_object_new (buffer);
+}
+
+void
+cogl_command_buffer_clear (CoglCommandBuffer *buffer)
+{
+  int i;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+
+  /* The objects of commands that were never submitted are still
+   * borrowed from the caller */
+  for (i = 0; i < buffer->n_referenced_commands; i++)
+    {
+      CoglCommand *command =
+        &g_array_index (buffer->commands, CoglCommand, i);
+
+      if (command->pipeline)
+        cogl_object_unref (command->pipeline);
+
+      if (command->primitive)
+        {
+          _cogl_primitive_immutable_unref (command->primitive);
+          cogl_object_unref (command->primitive);
+        }
+    }
+
+  g_array_set_size (buffer->commands, 0);
+  g_array_set_size (buffer->matrices, 0);
+  g_array_set_size (buffer->float_data, 0);
+  g_array_set_size (buffer->rects, 0);
+  buffer->rects_valid = FALSE;
+  buffer->n_rects = 0;
+  buffer->clip_depth = 0;
+  buffer->n_referenced_commands = 0;
+}
+
+static void
+_cogl_command_buffer_free (CoglCommandBuffer *buffer)
+{
+  cogl_command_buffer_clear (buffer);
+
+  g_array_free (buffer->commands, TRUE);
+  g_array_free (buffer->matrices, TRUE);
+  g_array_free (buffer->float_data, TRUE);
+  g_array_free (buffer->rects, TRUE);
+
+  g_slice_free (CoglCommandBuffer, buffer);
+}
+
+static CoglCommand *
+add_command (CoglCommandBuffer *buffer,
+             CoglCommandType type)
+{
+  CoglCommand *command;
+
+  g_array_set_size (buffer->commands, buffer->commands->len + 1);
+  command = &g_array_index (buffer->commands,
+                            CoglCommand,
+                            buffer->commands->len - 1);
+
+  memset (command, 0, sizeof (CoglCommand));
+  command->type = type;
+
+  return command;
+}
+
+void
+cogl_command_buffer_set_modelview_matrix (CoglCommandBuffer *buffer,
+                                          const CoglMatrix *matrix)
+{
+  CoglCommand *command;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+
+  command = add_command (buffer, COGL_COMMAND_SET_MODELVIEW);
+  command->data_index = buffer->matrices->len;
+  g_array_append_val (buffer->matrices, *matrix);
+}
+
+void
+cogl_command_buffer_push_rectangle_clip (CoglCommandBuffer *buffer,
+                                         float x_1,
+                                         float y_1,
+                                         float x_2,
+                                         float y_2)
+{
+  const float coords[4] = { x_1, y_1, x_2, y_2 };
+  CoglCommand *command;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+
+  command = add_command (buffer, COGL_COMMAND_PUSH_RECTANGLE_CLIP);
+  command->data_index = buffer->float_data->len;
+  g_array_append_vals (buffer->float_data, coords, 4);
+
+  buffer->clip_depth++;
+}
+
+void
+cogl_command_buffer_pop_clip (CoglCommandBuffer *buffer)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+  _COGL_RETURN_IF_FAIL (buffer->clip_depth > 0);
+
+  add_command (buffer, COGL_COMMAND_POP_CLIP);
+
+  buffer->clip_depth--;
+}
+
+void
+cogl_command_buffer_draw_primitive (CoglCommandBuffer *buffer,
+                                    CoglPipeline *pipeline,
+                                    CoglPrimitive *primitive)
+{
+  CoglCommand *command;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+  _COGL_RETURN_IF_FAIL (cogl_is_pipeline (pipeline));
+  _COGL_RETURN_IF_FAIL (cogl_is_primitive (primitive));
+
+  command = add_command (buffer, COGL_COMMAND_DRAW_PRIMITIVE);
+  command->pipeline = pipeline;
+  command->primitive = primitive;
+}
+
+static void
+add_rectangles (CoglCommandBuffer *buffer,
+                CoglPipeline *pipeline,
+                const float *coordinates,
+                unsigned int n_rectangles,
+                CoglBool textured)
+{
+  int n_floats = n_rectangles * (textured ? 8 : 4);
+  CoglCommand *command = NULL;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+  _COGL_RETURN_IF_FAIL (cogl_is_pipeline (pipeline));
+
+  if (n_rectangles == 0)
+    return;
+
+  /* If the last command draws rectangles in the same way then its
+   * coordinates are at the end of the float data so we can just
+   * extend it */
+  if (buffer->commands->len > 0)
+    {
+      command = &g_array_index (buffer->commands,
+                                CoglCommand,
+                                buffer->commands->len - 1);
+
+      if (command->type != COGL_COMMAND_DRAW_RECTANGLES ||
+          command->pipeline != pipeline ||
+          command->textured != textured)
+        command = NULL;
+    }
+
+  if (command)
+    command->n_rectangles += n_rectangles;
+  else
+    {
+      command = add_command (buffer, COGL_COMMAND_DRAW_RECTANGLES);
+      command->pipeline = pipeline;
+      command->data_index = buffer->float_data->len;
+      command->first_rect = buffer->n_rects;
+      command->n_rectangles = n_rectangles;
+      command->textured = textured;
+    }
+
+  g_array_append_vals (buffer->float_data, coordinates, n_floats);
+  buffer->n_rects += n_rectangles;
+
+  /* The float data may have moved so the rects need to be rebuilt */
+  buffer->rects_valid = FALSE;
+}
+
+void
+cogl_command_buffer_draw_rectangles (CoglCommandBuffer *buffer,
+                                     CoglPipeline *pipeline,
+                                     const float *coordinates,
+                                     unsigned int n_rectangles)
+{
+  add_rectangles (buffer, pipeline, coordinates, n_rectangles, FALSE);
+}
+
+void
+cogl_command_buffer_draw_textured_rectangles (CoglCommandBuffer *buffer,
+                                              CoglPipeline *pipeline,
+                                              const float *coordinates,
+                                              unsigned int n_rectangles)
+{
+  add_rectangles (buffer, pipeline, coordinates, n_rectangles, TRUE);
+}
+
+int
+cogl_command_buffer_get_n_commands (CoglCommandBuffer *buffer)
+{
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_command_buffer (buffer), 0);
+
+  return buffer->commands->len;
+}
+
+static void
+ensure_rects (CoglCommandBuffer *buffer)
+{
+  CoglMultiTexturedRect *rects;
+  const float *float_data;
+  int i, j;
+
+  if (buffer->rects_valid)
+    return;
+
+  g_array_set_size (buffer->rects, buffer->n_rects);
+  rects = (CoglMultiTexturedRect *) buffer->rects->data;
+  float_data = (const float *) buffer->float_data->data;
+
+  for (i = 0; i < buffer->commands->len; i++)
+    {
+      const CoglCommand *command =
+        &g_array_index (buffer->commands, CoglCommand, i);
+      int stride = command->textured ? 8 : 4;
+
+      if (command->type != COGL_COMMAND_DRAW_RECTANGLES)
+        continue;
+
+      for (j = 0; j < command->n_rectangles; j++)
+        {
+          CoglMultiTexturedRect *rect = rects + command->first_rect + j;
+          const float *coords = float_data + command->data_index + j * stride;
+
+          rect->position = coords;
+
+          if (command->textured)
+            {
+              rect->tex_coords = coords + 4;
+              rect->tex_coords_len = 4;
+            }
+          else
+            {
+              rect->tex_coords = NULL;
+              rect->tex_coords_len = 0;
+            }
+        }
+    }
+
+  buffer->rects_valid = TRUE;
+}
+
+/* Takes the references for the commands recorded since the last
+ * submission. This is done here rather than while recording because
+ * it has to happen on the thread that uses the context */
+static void
+reference_new_commands (CoglCommandBuffer *buffer)
+{
+  int i;
+
+  for (i = buffer->n_referenced_commands; i < buffer->commands->len; i++)
+    {
+      CoglCommand *command =
+        &g_array_index (buffer->commands, CoglCommand, i);
+
+      if (command->pipeline)
+        cogl_object_ref (command->pipeline);
+
+      /* The immutable reference makes the primitive warn if it is
+       * modified while the buffer could still be submitted */
+      if (command->primitive)
+        _cogl_primitive_immutable_ref (cogl_object_ref (command->primitive));
+    }
+
+  buffer->n_referenced_commands = buffer->commands->len;
+}
+
+void
+cogl_command_buffer_submit (CoglCommandBuffer *buffer,
+                            CoglFramebuffer *framebuffer)
+{
+  const CoglCommand *commands;
+  const float *float_data;
+  int clip_depth = 0;
+  int i;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_command_buffer (buffer));
+  _COGL_RETURN_IF_FAIL (cogl_is_framebuffer (framebuffer));
+
+  reference_new_commands (buffer);
+  ensure_rects (buffer);
+
+  commands = (const CoglCommand *) buffer->commands->data;
+  float_data = (const float *) buffer->float_data->data;
+
+  cogl_framebuffer_push_matrix (framebuffer);
+
+  for (i = 0; i < buffer->commands->len; i++)
+    {
+      const CoglCommand *command = commands + i;
+
+      switch (command->type)
+        {
+        case COGL_COMMAND_SET_MODELVIEW:
+          {
+            const CoglMatrix *matrix = &g_array_index (buffer->matrices,
+                                                       CoglMatrix,
+                                                       command->data_index);
+
+            cogl_framebuffer_set_modelview_matrix (framebuffer, matrix);
+          }
+          break;
+
+        case COGL_COMMAND_PUSH_RECTANGLE_CLIP:
+          {
+            const float *coords = float_data + command->data_index;
+
+            cogl_framebuffer_push_rectangle_clip (framebuffer,
+                                                  coords[0], coords[1],
+                                                  coords[2], coords[3]);
+            clip_depth++;
+          }
+          break;
+
+        case COGL_COMMAND_POP_CLIP:
+          cogl_framebuffer_pop_clip (framebuffer);
+          clip_depth--;
+          break;
+
+        case COGL_COMMAND_DRAW_PRIMITIVE:
+          _cogl_primitive_draw (command->primitive,
+                                framebuffer,
+                                command->pipeline,
+                                0 /* flags */);
+          break;
+
+        case COGL_COMMAND_DRAW_RECTANGLES:
+          _cogl_framebuffer_draw_multitextured_rectangles (
+                                  framebuffer,
+                                  command->pipeline,
+                                  &g_array_index (buffer->rects,
+                                                  CoglMultiTexturedRect,
+                                                  command->first_rect),
+                                  command->n_rectangles);
+          break;
+        }
+    }
+
+  /* Leave the clip stack as it was before the buffer was submitted */
+  while (clip_depth-- > 0)
+    cogl_framebuffer_pop_clip (framebuffer);
+
+  cogl_framebuffer_pop_matrix (framebuffer);
+}
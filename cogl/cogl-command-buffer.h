@@ -0,0 +1,283 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_COMMAND_BUFFER_H__
+#define __COGL_COMMAND_BUFFER_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-framebuffer.h>
+#include <cogl/cogl-pipeline.h>
+#include <cogl/cogl-primitive.h>
+#include <cogl/cogl-matrix.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-command-buffer
+ * @short_description: Functions for recording drawing commands to
+ *   submit later
+ *
+ * A #CoglCommandBuffer records a sequence of drawing commands
+ * without drawing anything. The commands can later be submitted to a
+ * #CoglFramebuffer with cogl_command_buffer_submit() which has the
+ * same effect as making the equivalent #CoglFramebuffer calls at that
+ * point.
+ *
+ * Recording doesn't touch the #CoglContext, any framebuffer or the
+ * GPU and it doesn't change the reference count of any object. The
+ * buffer only stores pointers to the pipelines and primitives it is
+ * given along with copies of the other arguments. This means a buffer
+ * can be recorded on a different thread from the one that uses the
+ * #CoglContext, for example while traversing a scene graph in
+ * parallel with drawing the previous frame, as long as only one
+ * thread uses the buffer at a time. Creating, submitting, clearing
+ * and destroying the buffer must still happen on the thread that
+ * uses the #CoglContext.
+ *
+ * The pipelines and primitives are borrowed from the caller until the
+ * buffer is submitted for the first time. Until then the caller must
+ * keep them alive and must not modify them. Submitting the buffer
+ * takes a reference on each of them which is kept until the buffer is
+ * cleared or destroyed.
+ *
+ * The buffer is not cleared by submitting it so a buffer containing
+ * static content can be recorded once and submitted every frame.
+ * The pipelines and primitives must not be modified while they are
+ * referenced by a buffer. Primitives will warn if this happens.
+ */
+
+typedef struct _CoglCommandBuffer CoglCommandBuffer;
+#define COGL_COMMAND_BUFFER(X) ((CoglCommandBuffer *)(X))
+
+/**
+ * cogl_command_buffer_new:
+ * @context: A #CoglContext
+ *
+ * Creates a new empty command buffer.
+ *
+ * Return value: (transfer full): A newly allocated #CoglCommandBuffer
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglCommandBuffer *
+cogl_command_buffer_new (CoglContext *context);
+
+/**
+ * cogl_is_command_buffer:
+ * @object: A #CoglObject pointer
+ *
+ * Gets whether the given object references a #CoglCommandBuffer.
+ *
+ * Return value: %TRUE if the object references a #CoglCommandBuffer
+ *   and %FALSE otherwise.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_is_command_buffer (void *object);
+
+/**
+ * cogl_command_buffer_set_modelview_matrix:
+ * @buffer: A #CoglCommandBuffer
+ * @matrix: The new modelview matrix
+ *
+ * Records a command to replace the modelview matrix of the
+ * framebuffer with @matrix like
+ * cogl_framebuffer_set_modelview_matrix(). Commands recorded before
+ * the first call to this function use the modelview matrix that the
+ * framebuffer had when the buffer was submitted.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_set_modelview_matrix (CoglCommandBuffer *buffer,
+                                          const CoglMatrix *matrix);
+
+/**
+ * cogl_command_buffer_push_rectangle_clip:
+ * @buffer: A #CoglCommandBuffer
+ * @x_1: x coordinate for top left corner of the clip rectangle
+ * @y_1: y coordinate for top left corner of the clip rectangle
+ * @x_2: x coordinate for bottom right corner of the clip rectangle
+ * @y_2: y coordinate for bottom right corner of the clip rectangle
+ *
+ * Records a command to push a clip rectangle like
+ * cogl_framebuffer_push_rectangle_clip(). The rectangle is
+ * transformed by the modelview matrix that is current when the
+ * command is submitted.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_push_rectangle_clip (CoglCommandBuffer *buffer,
+                                         float x_1,
+                                         float y_1,
+                                         float x_2,
+                                         float y_2);
+
+/**
+ * cogl_command_buffer_pop_clip:
+ * @buffer: A #CoglCommandBuffer
+ *
+ * Records a command to remove the clip that was last pushed to the
+ * buffer. Any clips that are still pushed at the end of the buffer
+ * are popped automatically when it is submitted.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_pop_clip (CoglCommandBuffer *buffer);
+
+/**
+ * cogl_command_buffer_draw_primitive:
+ * @buffer: A #CoglCommandBuffer
+ * @pipeline: A #CoglPipeline state object
+ * @primitive: The #CoglPrimitive to draw
+ *
+ * Records a command to draw @primitive with @pipeline like
+ * cogl_primitive_draw(). Both objects are borrowed until the buffer
+ * is first submitted. After that the buffer keeps a reference on them
+ * until it is cleared or destroyed.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_draw_primitive (CoglCommandBuffer *buffer,
+                                    CoglPipeline *pipeline,
+                                    CoglPrimitive *primitive);
+
+/**
+ * cogl_command_buffer_draw_rectangles:
+ * @buffer: A #CoglCommandBuffer
+ * @pipeline: A #CoglPipeline state object
+ * @coordinates: (array length=n_rectangles) (element-type float): an
+ *   array of coordinates containing groups of 4 float values:
+ *   [x_1, y_1, x_2, y_2] that are interpreted as two position
+ *   coordinates; one for the top left of the rectangle (x1, y1), and
+ *   one for the bottom right of the rectangle (x2, y2).
+ * @n_rectangles: number of rectangles defined in @coordinates.
+ *
+ * Records a command to draw rectangles like
+ * cogl_framebuffer_draw_rectangles(). The coordinates are copied so
+ * they can be freed as soon as this function returns. Consecutive
+ * calls with the same pipeline are merged into a single command.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_draw_rectangles (CoglCommandBuffer *buffer,
+                                     CoglPipeline *pipeline,
+                                     const float *coordinates,
+                                     unsigned int n_rectangles);
+
+/**
+ * cogl_command_buffer_draw_textured_rectangles:
+ * @buffer: A #CoglCommandBuffer
+ * @pipeline: A #CoglPipeline state object
+ * @coordinates: (array) (element-type float): an array containing
+ *   groups of 8 float values: [x_1, y_1, x_2, y_2, s_1, t_1, s_2, t_2]
+ *   that have the same meaning as the arguments for
+ *   cogl_framebuffer_draw_textured_rectangle().
+ * @n_rectangles: number of rectangles defined in @coordinates.
+ *
+ * Records a command to draw textured rectangles like
+ * cogl_framebuffer_draw_textured_rectangles(). The coordinates are
+ * copied so they can be freed as soon as this function
+ * returns. Consecutive calls with the same pipeline are merged into
+ * a single command.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_draw_textured_rectangles (CoglCommandBuffer *buffer,
+                                              CoglPipeline *pipeline,
+                                              const float *coordinates,
+                                              unsigned int n_rectangles);
+
+/**
+ * cogl_command_buffer_clear:
+ * @buffer: A #CoglCommandBuffer
+ *
+ * Removes all of the commands from the buffer and drops the
+ * references it holds so that it can be recorded again.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_clear (CoglCommandBuffer *buffer);
+
+/**
+ * cogl_command_buffer_get_n_commands:
+ * @buffer: A #CoglCommandBuffer
+ *
+ * Gets the number of commands in the buffer after merging
+ * consecutive rectangle draws.
+ *
+ * Return value: The number of recorded commands
+ * Since: 2.0
+ * Stability: Unstable
+ */
+int
+cogl_command_buffer_get_n_commands (CoglCommandBuffer *buffer);
+
+/**
+ * cogl_command_buffer_submit:
+ * @buffer: A #CoglCommandBuffer
+ * @framebuffer: The #CoglFramebuffer to draw to
+ *
+ * Replays all of the commands in @buffer on @framebuffer. This must
+ * be called from the thread that uses the #CoglContext. Any objects
+ * recorded since the last submission are referenced at this point so
+ * the caller no longer needs to keep them alive afterwards. The
+ * modelview matrix and the clip stack of @framebuffer are restored
+ * to their original state afterwards. The buffer is left unchanged
+ * so it can be submitted again.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_command_buffer_submit (CoglCommandBuffer *buffer,
+                            CoglFramebuffer *framebuffer);
+
+COGL_END_DECLS
+
+#endif /* __COGL_COMMAND_BUFFER_H__ */
@@ -0,0 +1,156 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_COMPRESSED_IMAGE_PRIVATE_H
+#define __COGL_COMPRESSED_IMAGE_PRIVATE_H
+
+#include "cogl-types.h"
+#include "cogl-error.h"
+
+/* The largest number of mipmap levels a container can describe. This
+ * is enough for a 32768x32768 image */
+#define COGL_COMPRESSED_IMAGE_MAX_LEVELS 16
+
+typedef enum
+{
+  COGL_COMPRESSED_FORMAT_RGB_DXT1,
+  COGL_COMPRESSED_FORMAT_RGBA_DXT1,
+  COGL_COMPRESSED_FORMAT_RGBA_DXT3,
+  COGL_COMPRESSED_FORMAT_RGBA_DXT5,
+  COGL_COMPRESSED_FORMAT_RGB_ETC1,
+  COGL_COMPRESSED_FORMAT_RGB_ETC2,
+  COGL_COMPRESSED_FORMAT_RGBA_ETC2_EAC,
+  /* The block size for ASTC is stored separately in the image */
+  COGL_COMPRESSED_FORMAT_RGBA_ASTC
+} CoglCompressedFormat;
+
+typedef struct _CoglCompressedImageLevel
+{
+  int width;
+  int height;
+  /* Points into the memory that the image was parsed from */
+  const uint8_t *data;
+  size_t size;
+} CoglCompressedImageLevel;
+
+typedef struct _CoglCompressedImage
+{
+  CoglCompressedFormat format;
+  int block_width;
+  int block_height;
+  int block_size;
+
+  int width;
+  int height;
+
+  int n_levels;
+  CoglCompressedImageLevel levels[COGL_COMPRESSED_IMAGE_MAX_LEVELS];
+
+  /* If the image was loaded from a file then this is the memory
+   * backing it. It is either a read-only mapping of the file or a
+   * copy of its contents if mapping isn't available */
+  void *contents;
+  size_t contents_size;
+  CoglBool contents_mapped;
+} CoglCompressedImage;
+
+/*
+ * _cogl_compressed_image_parse:
+ * @image: The image to initialize
+ * @data: The contents of a KTX or DDS container
+ * @size: The size of @data in bytes
+ * @error: A #CoglError to report invalid data
+ *
+ * Validates the header of the container and fills in the format and
+ * the location of each mipmap level. The levels point directly into
+ * @data so it must stay valid for as long as the image is used. No
+ * memory is allocated so the image doesn't need to be destroyed.
+ *
+ * Return value: %TRUE if the container is valid or %FALSE otherwise
+ */
+CoglBool
+_cogl_compressed_image_parse (CoglCompressedImage *image,
+                              const uint8_t *data,
+                              size_t size,
+                              CoglError **error);
+
+/*
+ * _cogl_compressed_image_load_file:
+ * @image: The image to initialize
+ * @filename: The name of a KTX or DDS file
+ * @error: A #CoglError to report errors
+ *
+ * Maps the file into memory and parses it with
+ * _cogl_compressed_image_parse(). The image must be released with
+ * _cogl_compressed_image_destroy() if this function succeeds.
+ */
+CoglBool
+_cogl_compressed_image_load_file (CoglCompressedImage *image,
+                                  const char *filename,
+                                  CoglError **error);
+
+void
+_cogl_compressed_image_destroy (CoglCompressedImage *image);
+
+CoglBool
+_cogl_compressed_format_has_alpha (CoglCompressedFormat format);
+
+/* Returns the GL enum to pass to glCompressedTexImage2D */
+uint32_t
+_cogl_compressed_image_get_gl_internal_format (const CoglCompressedImage *image);
+
+/*
+ * _cogl_compressed_image_can_decompress:
+ * @image: A #CoglCompressedImage
+ *
+ * Return value: %TRUE if the image is in a format that
+ *   _cogl_compressed_image_decompress_level() can decode on the CPU
+ */
+CoglBool
+_cogl_compressed_image_can_decompress (const CoglCompressedImage *image);
+
+/*
+ * _cogl_compressed_image_decompress_level:
+ * @image: A #CoglCompressedImage
+ * @level: The mipmap level to decode
+ * @rowstride: The rowstride of @dst
+ * @dst: Where to write the pixels
+ *
+ * Decodes a mipmap level as %COGL_PIXEL_FORMAT_RGBA_8888 pixels. This
+ * is used as a fallback when the GPU can't sample from the format
+ * directly. Formats with no alpha channel are written with an opaque
+ * alpha component.
+ */
+void
+_cogl_compressed_image_decompress_level (const CoglCompressedImage *image,
+                                         int level,
+                                         int rowstride,
+                                         uint8_t *dst);
+
+#endif /* __COGL_COMPRESSED_IMAGE_PRIVATE_H */
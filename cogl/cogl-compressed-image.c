@@ -0,0 +1,1374 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <test-fixtures/test-unit.h>
+
+#include "cogl-util.h"
+#include "cogl-bitmap.h"
+#include "cogl-error-private.h"
+#include "cogl-compressed-image-private.h"
+
+#define KTX_HEADER_SIZE 64
+#define KTX_ENDIANNESS 0x04030201
+#define KTX_ENDIANNESS_SWAPPED 0x01020304
+
+#define DDS_HEADER_SIZE 128
+#define DDS_DX10_HEADER_SIZE 20
+#define DDS_FLAG_MIPMAP_COUNT 0x20000
+#define DDS_PIXEL_FORMAT_FLAG_FOURCC 0x4
+#define DDS_CAPS2_CUBEMAP 0x200
+#define DDS_CAPS2_VOLUME 0x200000
+#define DDS_DIMENSION_TEXTURE_2D 3
+
+#define DDS_FOURCC(a, b, c, d) \
+  ((uint32_t) (a) | ((uint32_t) (b) << 8) | \
+   ((uint32_t) (c) << 16) | ((uint32_t) (d) << 24))
+
+static const uint8_t
+ktx_identifier[] =
+  {
+    0xab, 'K', 'T', 'X', ' ', '1', '1', 0xbb, '\r', '\n', 0x1a, '\n'
+  };
+
+typedef struct
+{
+  uint32_t gl_internal_format;
+  CoglCompressedFormat format;
+  int block_width;
+  int block_height;
+  int block_size;
+} CoglCompressedFormatInfo;
+
+static const CoglCompressedFormatInfo
+format_infos[] =
+  {
+    { 0x83f0, COGL_COMPRESSED_FORMAT_RGB_DXT1, 4, 4, 8 },
+    { 0x83f1, COGL_COMPRESSED_FORMAT_RGBA_DXT1, 4, 4, 8 },
+    { 0x83f2, COGL_COMPRESSED_FORMAT_RGBA_DXT3, 4, 4, 16 },
+    { 0x83f3, COGL_COMPRESSED_FORMAT_RGBA_DXT5, 4, 4, 16 },
+    { 0x8d64, COGL_COMPRESSED_FORMAT_RGB_ETC1, 4, 4, 8 },
+    { 0x9274, COGL_COMPRESSED_FORMAT_RGB_ETC2, 4, 4, 8 },
+    { 0x9278, COGL_COMPRESSED_FORMAT_RGBA_ETC2_EAC, 4, 4, 16 },
+    { 0x93b0, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 4, 4, 16 },
+    { 0x93b1, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 5, 4, 16 },
+    { 0x93b2, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 5, 5, 16 },
+    { 0x93b3, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 6, 5, 16 },
+    { 0x93b4, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 6, 6, 16 },
+    { 0x93b5, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 8, 5, 16 },
+    { 0x93b6, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 8, 6, 16 },
+    { 0x93b7, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 8, 8, 16 },
+    { 0x93b8, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 10, 5, 16 },
+    { 0x93b9, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 10, 6, 16 },
+    { 0x93ba, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 10, 8, 16 },
+    { 0x93bb, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 10, 10, 16 },
+    { 0x93bc, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 12, 10, 16 },
+    { 0x93bd, COGL_COMPRESSED_FORMAT_RGBA_ASTC, 12, 12, 16 }
+  };
+
+/* Modifier tables for ETC1 and the individual and differential modes
+ * of ETC2. Only the positive values are stored */
+static const int
+etc_modifier_table[8][2] =
+  {
+    { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 },
+    { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+  };
+
+/* Distances used by the T and H modes of ETC2 */
+static const int
+etc2_distance_table[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int
+eac_modifier_table[16][8] =
+  {
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 }
+  };
+
+static uint32_t
+read_uint32 (const uint8_t *p,
+             CoglBool swap)
+{
+  if (swap)
+    return (((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+            ((uint32_t) p[2] << 8) | (uint32_t) p[3]);
+  else
+    return (((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) |
+            ((uint32_t) p[1] << 8) | (uint32_t) p[0]);
+}
+
+static uint64_t
+read_uint64_be (const uint8_t *p)
+{
+  uint64_t value = 0;
+  int i;
+
+  for (i = 0; i < 8; i++)
+    value = (value << 8) | p[i];
+
+  return value;
+}
+
+static const CoglCompressedFormatInfo *
+find_format_info (uint32_t gl_internal_format)
+{
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (format_infos); i++)
+    if (format_infos[i].gl_internal_format == gl_internal_format)
+      return format_infos + i;
+
+  return NULL;
+}
+
+static size_t
+get_level_size (const CoglCompressedImage *image,
+                int width,
+                int height)
+{
+  size_t blocks_x = (width + image->block_width - 1) / image->block_width;
+  size_t blocks_y = (height + image->block_height - 1) / image->block_height;
+
+  return blocks_x * blocks_y * image->block_size;
+}
+
+static CoglBool
+init_image (CoglCompressedImage *image,
+            const CoglCompressedFormatInfo *info,
+            uint32_t width,
+            uint32_t height,
+            uint32_t n_levels,
+            CoglError **error)
+{
+  uint32_t max_levels;
+
+  /* Limiting the size to the number of levels we can store also
+   * keeps the size calculations well away from overflowing */
+  if (width < 1 || height < 1 ||
+      width > 1 << (COGL_COMPRESSED_IMAGE_MAX_LEVELS - 1) ||
+      height > 1 << (COGL_COMPRESSED_IMAGE_MAX_LEVELS - 1))
+    {
+      _cogl_set_error (error,
+                       COGL_BITMAP_ERROR,
+                       COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                       "Invalid compressed image size %ux%u",
+                       width, height);
+      return FALSE;
+    }
+
+  for (max_levels = 1; (width >> max_levels) | (height >> max_levels);
+       max_levels++)
+    ;
+
+  if (n_levels > max_levels)
+    {
+      _cogl_set_error (error,
+                       COGL_BITMAP_ERROR,
+                       COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                       "Compressed image has %u mipmap levels but only %u "
+                       "are possible for its size",
+                       n_levels, max_levels);
+      return FALSE;
+    }
+
+  image->format = info->format;
+  image->block_width = info->block_width;
+  image->block_height = info->block_height;
+  image->block_size = info->block_size;
+  image->width = width;
+  image->height = height;
+  image->n_levels = n_levels;
+
+  return TRUE;
+}
+
+static void
+set_level (CoglCompressedImage *image,
+           int level,
+           const uint8_t *data,
+           size_t size)
+{
+  CoglCompressedImageLevel *image_level = image->levels + level;
+
+  image_level->width = MAX (image->width >> level, 1);
+  image_level->height = MAX (image->height >> level, 1);
+  image_level->data = data;
+  image_level->size = size;
+}
+
+static CoglBool
+parse_ktx (CoglCompressedImage *image,
+           const uint8_t *data,
+           size_t size,
+           CoglError **error)
+{
+  const CoglCompressedFormatInfo *info;
+  uint32_t endianness;
+  uint32_t gl_type, gl_format, gl_internal_format;
+  uint32_t width, height, depth, n_array_elements, n_faces, n_levels;
+  uint32_t key_value_size;
+  CoglBool swap;
+  size_t offset;
+  int level;
+
+  if (size < KTX_HEADER_SIZE)
+    goto truncated;
+
+  endianness = read_uint32 (data + 12, FALSE);
+  if (endianness == KTX_ENDIANNESS)
+    swap = FALSE;
+  else if (endianness == KTX_ENDIANNESS_SWAPPED)
+    swap = TRUE;
+  else
+    {
+      _cogl_set_error_literal (error,
+                               COGL_BITMAP_ERROR,
+                               COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                               "Invalid endianness in KTX header");
+      return FALSE;
+    }
+
+  gl_type = read_uint32 (data + 16, swap);
+  gl_format = read_uint32 (data + 24, swap);
+  gl_internal_format = read_uint32 (data + 28, swap);
+  width = read_uint32 (data + 36, swap);
+  height = read_uint32 (data + 40, swap);
+  depth = read_uint32 (data + 44, swap);
+  n_array_elements = read_uint32 (data + 48, swap);
+  n_faces = read_uint32 (data + 52, swap);
+  n_levels = read_uint32 (data + 56, swap);
+  key_value_size = read_uint32 (data + 60, swap);
+
+  /* The type and format are only zero for compressed data */
+  info = find_format_info (gl_internal_format);
+  if (gl_type != 0 || gl_format != 0 || info == NULL)
+    {
+      _cogl_set_error (error,
+                       COGL_BITMAP_ERROR,
+                       COGL_BITMAP_ERROR_UNKNOWN_TYPE,
+                       "Unsupported KTX internal format 0x%x",
+                       gl_internal_format);
+      return FALSE;
+    }
+
+  if (depth > 1 || n_array_elements != 0 || n_faces != 1)
+    {
+      _cogl_set_error_literal (error,
+                               COGL_BITMAP_ERROR,
+                               COGL_BITMAP_ERROR_UNKNOWN_TYPE,
+                               "Only 2D KTX textures are supported");
+      return FALSE;
+    }
+
+  /* Zero levels means the application should generate the mipmaps */
+  if (!init_image (image, info, width, height, MAX (n_levels, 1), error))
+    return FALSE;
+
+  if (key_value_size > size - KTX_HEADER_SIZE)
+    goto truncated;
+
+  offset = KTX_HEADER_SIZE + key_value_size;
+
+  for (level = 0; level < image->n_levels; level++)
+    {
+      size_t expected_size;
+      uint32_t image_size;
+
+      set_level (image, level, NULL, 0);
+
+      if (size - offset < 4)
+        goto truncated;
+
+      image_size = read_uint32 (data + offset, swap);
+      offset += 4;
+
+      expected_size = get_level_size (image,
+                                      image->levels[level].width,
+                                      image->levels[level].height);
+      if (image_size != expected_size)
+        {
+          _cogl_set_error (error,
+                           COGL_BITMAP_ERROR,
+                           COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                           "KTX mipmap level %i has size %u but %u bytes "
+                           "were expected",
+                           level, image_size, (unsigned int) expected_size);
+          return FALSE;
+        }
+
+      if (size - offset < image_size)
+        goto truncated;
+
+      set_level (image, level, data + offset, image_size);
+
+      /* Each level is padded to a multiple of 4 bytes */
+      offset += (image_size + 3) & ~(size_t) 3;
+      offset = MIN (offset, size);
+    }
+
+  return TRUE;
+
+ truncated:
+  _cogl_set_error_literal (error,
+                           COGL_BITMAP_ERROR,
+                           COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                           "KTX file is truncated");
+  return FALSE;
+}
+
+static const CoglCompressedFormatInfo *
+get_dds_format_info (const uint8_t *data,
+                     size_t size,
+                     size_t *header_size)
+{
+  uint32_t pixel_format_flags = read_uint32 (data + 80, FALSE);
+  uint32_t fourcc = read_uint32 (data + 84, FALSE);
+
+  *header_size = DDS_HEADER_SIZE;
+
+  if (!(pixel_format_flags & DDS_PIXEL_FORMAT_FLAG_FOURCC))
+    return NULL;
+
+  /* DDS doesn't distinguish between DXT1 with and without alpha so
+   * it is always treated as having an alpha bit like Direct3D does */
+  if (fourcc == DDS_FOURCC ('D', 'X', 'T', '1'))
+    return find_format_info (0x83f1);
+  else if (fourcc == DDS_FOURCC ('D', 'X', 'T', '3'))
+    return find_format_info (0x83f2);
+  else if (fourcc == DDS_FOURCC ('D', 'X', 'T', '5'))
+    return find_format_info (0x83f3);
+  else if (fourcc == DDS_FOURCC ('D', 'X', '1', '0') &&
+           size >= DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE)
+    {
+      uint32_t dxgi_format = read_uint32 (data + 128, FALSE);
+      uint32_t dimension = read_uint32 (data + 132, FALSE);
+      uint32_t array_size = read_uint32 (data + 140, FALSE);
+
+      if (dimension != DDS_DIMENSION_TEXTURE_2D || array_size > 1)
+        return NULL;
+
+      *header_size += DDS_DX10_HEADER_SIZE;
+
+      switch (dxgi_format)
+        {
+        case 71: /* DXGI_FORMAT_BC1_UNORM */
+        case 72: /* DXGI_FORMAT_BC1_UNORM_SRGB */
+          return find_format_info (0x83f1);
+        case 74: /* DXGI_FORMAT_BC2_UNORM */
+        case 75: /* DXGI_FORMAT_BC2_UNORM_SRGB */
+          return find_format_info (0x83f2);
+        case 77: /* DXGI_FORMAT_BC3_UNORM */
+        case 78: /* DXGI_FORMAT_BC3_UNORM_SRGB */
+          return find_format_info (0x83f3);
+        }
+    }
+
+  return NULL;
+}
+
+static CoglBool
+parse_dds (CoglCompressedImage *image,
+           const uint8_t *data,
+           size_t size,
+           CoglError **error)
+{
+  const CoglCompressedFormatInfo *info;
+  uint32_t flags, width, height, n_levels, caps2;
+  size_t header_size;
+  size_t offset;
+  int level;
+
+  if (size < DDS_HEADER_SIZE)
+    goto truncated;
+
+  if (read_uint32 (data + 4, FALSE) != 124 ||
+      read_uint32 (data + 76, FALSE) != 32)
+    {
+      _cogl_set_error_literal (error,
+                               COGL_BITMAP_ERROR,
+                               COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                               "Invalid DDS header");
+      return FALSE;
+    }
+
+  flags = read_uint32 (data + 8, FALSE);
+  height = read_uint32 (data + 12, FALSE);
+  width = read_uint32 (data + 16, FALSE);
+  n_levels = read_uint32 (data + 28, FALSE);
+  caps2 = read_uint32 (data + 112, FALSE);
+
+  info = get_dds_format_info (data, size, &header_size);
+  if (info == NULL || (caps2 & (DDS_CAPS2_CUBEMAP | DDS_CAPS2_VOLUME)))
+    {
+      _cogl_set_error_literal (error,
+                               COGL_BITMAP_ERROR,
+                               COGL_BITMAP_ERROR_UNKNOWN_TYPE,
+                               "Only 2D DDS textures compressed with DXT1, "
+                               "DXT3 or DXT5 are supported");
+      return FALSE;
+    }
+
+  if (!(flags & DDS_FLAG_MIPMAP_COUNT))
+    n_levels = 1;
+
+  if (!init_image (image, info, width, height, MAX (n_levels, 1), error))
+    return FALSE;
+
+  /* The levels are stored one after another without any padding */
+  offset = header_size;
+
+  for (level = 0; level < image->n_levels; level++)
+    {
+      size_t level_size;
+
+      set_level (image, level, NULL, 0);
+
+      level_size = get_level_size (image,
+                                   image->levels[level].width,
+                                   image->levels[level].height);
+      if (size - offset < level_size)
+        goto truncated;
+
+      set_level (image, level, data + offset, level_size);
+
+      offset += level_size;
+    }
+
+  return TRUE;
+
+ truncated:
+  _cogl_set_error_literal (error,
+                           COGL_BITMAP_ERROR,
+                           COGL_BITMAP_ERROR_CORRUPT_IMAGE,
+                           "DDS file is truncated");
+  return FALSE;
+}
+
+CoglBool
+_cogl_compressed_image_parse (CoglCompressedImage *image,
+                              const uint8_t *data,
+                              size_t size,
+                              CoglError **error)
+{
+  memset (image, 0, sizeof (CoglCompressedImage));
+
+  if (size >= sizeof (ktx_identifier) &&
+      !memcmp (data, ktx_identifier, sizeof (ktx_identifier)))
+    return parse_ktx (image, data, size, error);
+
+  if (size >= 4 && !memcmp (data, "DDS ", 4))
+    return parse_dds (image, data, size, error);
+
+  _cogl_set_error_literal (error,
+                           COGL_BITMAP_ERROR,
+                           COGL_BITMAP_ERROR_UNKNOWN_TYPE,
+                           "Unknown compressed image container");
+  return FALSE;
+}
+
+CoglBool
+_cogl_compressed_image_load_file (CoglCompressedImage *image,
+                                  const char *filename,
+                                  CoglError **error)
+{
+  void *contents;
+  size_t contents_size;
+  CoglBool contents_mapped;
+
+#ifdef HAVE_SYS_MMAN_H
+  struct stat buf;
+  int fd;
+
+  /* Mapping the file lets the upload read the data straight out of
+   * the page cache without copying the whole file first */
+  fd = open (filename, O_RDONLY);
+  if (fd == -1 || fstat (fd, &buf) == -1)
+    {
+      _cogl_set_error (error,
+                       COGL_BITMAP_ERROR,
+                       COGL_BITMAP_ERROR_FAILED,
+                       "Failed to open %s: %s",
+                       filename, strerror (errno));
+      if (fd != -1)
+        close (fd);
+      return FALSE;
+    }
+
+  contents_size = buf.st_size;
+  contents = (contents_size > 0 ?
+              mmap (NULL, contents_size, PROT_READ, MAP_PRIVATE, fd, 0) :
+              NULL);
+
+  close (fd);
+
+  if (contents == MAP_FAILED)
+    {
+      _cogl_set_error (error,
+                       COGL_BITMAP_ERROR,
+                       COGL_BITMAP_ERROR_FAILED,
+                       "Failed to map %s: %s",
+                       filename, strerror (errno));
+      return FALSE;
+    }
+
+  contents_mapped = contents != NULL;
+#else /* HAVE_SYS_MMAN_H */
+  GError *glib_error = NULL;
+  char *file_contents;
+  gsize file_size;
+
+  if (!g_file_get_contents (filename,
+                            &file_contents,
+                            &file_size,
+                            &glib_error))
+    {
+      _cogl_set_error_literal (error,
+                               COGL_BITMAP_ERROR,
+                               COGL_BITMAP_ERROR_FAILED,
+                               glib_error->message);
+      g_error_free (glib_error);
+      return FALSE;
+    }
+
+  contents = file_contents;
+  contents_size = file_size;
+  contents_mapped = FALSE;
+#endif /* HAVE_SYS_MMAN_H */
+
+  if (!_cogl_compressed_image_parse (image, contents, contents_size, error))
+    {
+      image->contents = contents;
+      image->contents_size = contents_size;
+      image->contents_mapped = contents_mapped;
+      _cogl_compressed_image_destroy (image);
+      return FALSE;
+    }
+
+  image->contents = contents;
+  image->contents_size = contents_size;
+  image->contents_mapped = contents_mapped;
+
+  return TRUE;
+}
+
+void
+_cogl_compressed_image_destroy (CoglCompressedImage *image)
+{
+#ifdef HAVE_SYS_MMAN_H
+  if (image->contents_mapped)
+    munmap (image->contents, image->contents_size);
+  else
+#endif
+    g_free (image->contents);
+
+  image->contents = NULL;
+  image->contents_size = 0;
+  image->contents_mapped = FALSE;
+}
+
+CoglBool
+_cogl_compressed_format_has_alpha (CoglCompressedFormat format)
+{
+  switch (format)
+    {
+    case COGL_COMPRESSED_FORMAT_RGB_DXT1:
+    case COGL_COMPRESSED_FORMAT_RGB_ETC1:
+    case COGL_COMPRESSED_FORMAT_RGB_ETC2:
+      return FALSE;
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT1:
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT3:
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT5:
+    case COGL_COMPRESSED_FORMAT_RGBA_ETC2_EAC:
+    case COGL_COMPRESSED_FORMAT_RGBA_ASTC:
+      return TRUE;
+    }
+
+  g_return_val_if_reached (TRUE);
+}
+
+uint32_t
+_cogl_compressed_image_get_gl_internal_format (const CoglCompressedImage *image)
+{
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (format_infos); i++)
+    if (format_infos[i].format == image->format &&
+        format_infos[i].block_width == image->block_width &&
+        format_infos[i].block_height == image->block_height)
+      return format_infos[i].gl_internal_format;
+
+  g_return_val_if_reached (0);
+}
+
+CoglBool
+_cogl_compressed_image_can_decompress (const CoglCompressedImage *image)
+{
+  /* ASTC is only supported when the GPU can sample from it directly */
+  return image->format != COGL_COMPRESSED_FORMAT_RGBA_ASTC;
+}
+
+static uint8_t
+clamp_component (int value)
+{
+  return CLAMP (value, 0, 255);
+}
+
+static void
+set_pixel (uint8_t *pixel,
+           int r, int g, int b)
+{
+  pixel[0] = clamp_component (r);
+  pixel[1] = clamp_component (g);
+  pixel[2] = clamp_component (b);
+}
+
+static void
+unpack_rgb_565 (uint16_t value,
+                int *rgb)
+{
+  int r = value >> 11, g = (value >> 5) & 0x3f, b = value & 0x1f;
+
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+/* Decodes the colour part of a DXT block into a 4x4 block of RGBA
+ * pixels. The alpha is only written for DXT1 */
+static void
+decode_dxt_color_block (const uint8_t *block,
+                        CoglCompressedFormat format,
+                        uint8_t *pixels)
+{
+  uint16_t c0 = block[0] | (block[1] << 8);
+  uint16_t c1 = block[2] | (block[3] << 8);
+  uint32_t indices = read_uint32 (block + 4, FALSE);
+  int colors[4][4];
+  int i, j;
+
+  unpack_rgb_565 (c0, colors[0]);
+  unpack_rgb_565 (c1, colors[1]);
+  colors[0][3] = colors[1][3] = colors[2][3] = colors[3][3] = 255;
+
+  /* The three colour mode with a transparent black entry is only
+   * available in DXT1 */
+  if (c0 > c1 ||
+      format == COGL_COMPRESSED_FORMAT_RGBA_DXT3 ||
+      format == COGL_COMPRESSED_FORMAT_RGBA_DXT5)
+    {
+      for (j = 0; j < 3; j++)
+        {
+          colors[2][j] = (2 * colors[0][j] + colors[1][j]) / 3;
+          colors[3][j] = (colors[0][j] + 2 * colors[1][j]) / 3;
+        }
+    }
+  else
+    {
+      for (j = 0; j < 3; j++)
+        {
+          colors[2][j] = (colors[0][j] + colors[1][j]) / 2;
+          colors[3][j] = 0;
+        }
+      if (format == COGL_COMPRESSED_FORMAT_RGBA_DXT1)
+        colors[3][3] = 0;
+    }
+
+  for (i = 0; i < 16; i++)
+    {
+      const int *color = colors[(indices >> (i * 2)) & 3];
+
+      set_pixel (pixels + i * 4, color[0], color[1], color[2]);
+      if (format == COGL_COMPRESSED_FORMAT_RGB_DXT1 ||
+          format == COGL_COMPRESSED_FORMAT_RGBA_DXT1)
+        pixels[i * 4 + 3] = color[3];
+    }
+}
+
+static void
+decode_dxt3_alpha_block (const uint8_t *block,
+                         uint8_t *pixels)
+{
+  int i;
+
+  for (i = 0; i < 16; i++)
+    {
+      int alpha = (block[i / 2] >> ((i & 1) * 4)) & 0xf;
+
+      pixels[i * 4 + 3] = alpha * 17;
+    }
+}
+
+static void
+decode_dxt5_alpha_block (const uint8_t *block,
+                         uint8_t *pixels)
+{
+  int a0 = block[0], a1 = block[1];
+  uint64_t indices = 0;
+  int alphas[8];
+  int i;
+
+  alphas[0] = a0;
+  alphas[1] = a1;
+
+  if (a0 > a1)
+    {
+      for (i = 1; i < 7; i++)
+        alphas[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    }
+  else
+    {
+      for (i = 1; i < 5; i++)
+        alphas[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+      alphas[6] = 0;
+      alphas[7] = 255;
+    }
+
+  /* 48 bits of little-endian indices */
+  for (i = 7; i >= 2; i--)
+    indices = (indices << 8) | block[i];
+
+  for (i = 0; i < 16; i++)
+    pixels[i * 4 + 3] = alphas[(indices >> (i * 3)) & 7];
+}
+
+static int
+extend_4 (int value)
+{
+  return (value << 4) | value;
+}
+
+static int
+extend_5 (int value)
+{
+  return (value << 3) | (value >> 2);
+}
+
+static int
+extend_6 (int value)
+{
+  return (value << 2) | (value >> 4);
+}
+
+static int
+extend_7 (int value)
+{
+  return (value << 1) | (value >> 6);
+}
+
+static int
+sign_extend_3 (int value)
+{
+  return (value & 4) ? value - 8 : value;
+}
+
+/* ETC pixels are numbered in column-major order so this converts to
+ * the row-major offset used for the decoded block */
+static int
+etc_pixel_offset (int i)
+{
+  return ((i & 3) * 4 + (i >> 2)) * 4;
+}
+
+static int
+etc_pixel_index (uint64_t bits,
+                 int i)
+{
+  return (((bits >> (i + 16)) & 1) << 1) | ((bits >> i) & 1);
+}
+
+static void
+decode_etc_subblocks (uint64_t bits,
+                      const int base_colors[2][3],
+                      uint8_t *pixels)
+{
+  CoglBool flip = (bits >> 32) & 1;
+  int i;
+
+  for (i = 0; i < 16; i++)
+    {
+      int x = i >> 2, y = i & 3;
+      int subblock = flip ? y >= 2 : x >= 2;
+      int table = (bits >> (subblock ? 34 : 37)) & 7;
+      int index = etc_pixel_index (bits, i);
+      int modifier = etc_modifier_table[table][index & 1];
+      const int *color = base_colors[subblock];
+
+      if (index & 2)
+        modifier = -modifier;
+
+      set_pixel (pixels + etc_pixel_offset (i),
+                 color[0] + modifier,
+                 color[1] + modifier,
+                 color[2] + modifier);
+    }
+}
+
+static void
+decode_etc2_paint_colors (uint64_t bits,
+                          int paint_colors[4][3],
+                          uint8_t *pixels)
+{
+  int i;
+
+  for (i = 0; i < 16; i++)
+    {
+      const int *color = paint_colors[etc_pixel_index (bits, i)];
+
+      set_pixel (pixels + etc_pixel_offset (i),
+                 color[0], color[1], color[2]);
+    }
+}
+
+static void
+decode_etc2_t_mode (uint64_t bits,
+                    uint8_t *pixels)
+{
+  int paint_colors[4][3];
+  int distance;
+  int j;
+
+  paint_colors[0][0] = extend_4 ((((bits >> 59) & 3) << 2) |
+                                 ((bits >> 56) & 3));
+  paint_colors[0][1] = extend_4 ((bits >> 52) & 0xf);
+  paint_colors[0][2] = extend_4 ((bits >> 48) & 0xf);
+  paint_colors[2][0] = extend_4 ((bits >> 44) & 0xf);
+  paint_colors[2][1] = extend_4 ((bits >> 40) & 0xf);
+  paint_colors[2][2] = extend_4 ((bits >> 36) & 0xf);
+
+  distance = etc2_distance_table[(((bits >> 34) & 3) << 1) |
+                                 ((bits >> 32) & 1)];
+
+  for (j = 0; j < 3; j++)
+    {
+      paint_colors[1][j] = paint_colors[2][j] + distance;
+      paint_colors[3][j] = paint_colors[2][j] - distance;
+    }
+
+  decode_etc2_paint_colors (bits, paint_colors, pixels);
+}
+
+static void
+decode_etc2_h_mode (uint64_t bits,
+                    uint8_t *pixels)
+{
+  int paint_colors[4][3];
+  int r1, g1, b1, r2, g2, b2;
+  int distance_index;
+  int distance;
+  int j;
+
+  r1 = (bits >> 59) & 0xf;
+  g1 = (((bits >> 56) & 7) << 1) | ((bits >> 52) & 1);
+  b1 = (((bits >> 51) & 1) << 3) | ((bits >> 47) & 7);
+  r2 = (bits >> 43) & 0xf;
+  g2 = (bits >> 39) & 0xf;
+  b2 = (bits >> 35) & 0xf;
+
+  /* The lowest bit of the distance index is implied by the order of
+   * the two base colours */
+  distance_index = ((((bits >> 34) & 1) << 2) |
+                    (((bits >> 32) & 1) << 1) |
+                    (((r1 << 8) | (g1 << 4) | b1) >=
+                     ((r2 << 8) | (g2 << 4) | b2)));
+  distance = etc2_distance_table[distance_index];
+
+  paint_colors[0][0] = extend_4 (r1);
+  paint_colors[0][1] = extend_4 (g1);
+  paint_colors[0][2] = extend_4 (b1);
+  paint_colors[2][0] = extend_4 (r2);
+  paint_colors[2][1] = extend_4 (g2);
+  paint_colors[2][2] = extend_4 (b2);
+
+  for (j = 0; j < 3; j++)
+    {
+      paint_colors[1][j] = paint_colors[0][j] - distance;
+      paint_colors[0][j] += distance;
+      paint_colors[3][j] = paint_colors[2][j] - distance;
+      paint_colors[2][j] += distance;
+    }
+
+  decode_etc2_paint_colors (bits, paint_colors, pixels);
+}
+
+static void
+decode_etc2_planar_mode (uint64_t bits,
+                         uint8_t *pixels)
+{
+  int o[3], h[3], v[3];
+  int x, y, j;
+
+  o[0] = extend_6 ((bits >> 57) & 0x3f);
+  o[1] = extend_7 ((((bits >> 56) & 1) << 6) | ((bits >> 49) & 0x3f));
+  o[2] = extend_6 ((((bits >> 48) & 1) << 5) |
+                   (((bits >> 43) & 3) << 3) |
+                   ((bits >> 39) & 7));
+  h[0] = extend_6 ((((bits >> 34) & 0x1f) << 1) | ((bits >> 32) & 1));
+  h[1] = extend_7 ((bits >> 25) & 0x7f);
+  h[2] = extend_6 ((bits >> 19) & 0x3f);
+  v[0] = extend_6 ((bits >> 13) & 0x3f);
+  v[1] = extend_7 ((bits >> 6) & 0x7f);
+  v[2] = extend_6 (bits & 0x3f);
+
+  for (y = 0; y < 4; y++)
+    for (x = 0; x < 4; x++)
+      {
+        uint8_t *pixel = pixels + (y * 4 + x) * 4;
+
+        for (j = 0; j < 3; j++)
+          pixel[j] = clamp_component ((x * (h[j] - o[j]) +
+                                       y * (v[j] - o[j]) +
+                                       4 * o[j] + 2) >> 2);
+      }
+}
+
+static void
+decode_etc_block (const uint8_t *block,
+                  CoglCompressedFormat format,
+                  uint8_t *pixels)
+{
+  uint64_t bits = read_uint64_be (block);
+  int base_colors[2][3];
+  int j;
+
+  if ((bits >> 33) & 1)
+    {
+      int base[3], delta[3];
+      CoglBool overflow[3];
+
+      for (j = 0; j < 3; j++)
+        {
+          base[j] = (bits >> (59 - j * 8)) & 0x1f;
+          delta[j] = sign_extend_3 ((bits >> (56 - j * 8)) & 7);
+          overflow[j] = base[j] + delta[j] < 0 || base[j] + delta[j] > 31;
+        }
+
+      /* ETC2 reuses the combinations that are invalid in ETC1 to
+       * encode three extra modes */
+      if (format != COGL_COMPRESSED_FORMAT_RGB_ETC1)
+        {
+          if (overflow[0])
+            {
+              decode_etc2_t_mode (bits, pixels);
+              return;
+            }
+          else if (overflow[1])
+            {
+              decode_etc2_h_mode (bits, pixels);
+              return;
+            }
+          else if (overflow[2])
+            {
+              decode_etc2_planar_mode (bits, pixels);
+              return;
+            }
+        }
+
+      for (j = 0; j < 3; j++)
+        {
+          base_colors[0][j] = extend_5 (base[j]);
+          base_colors[1][j] = extend_5 ((base[j] + delta[j]) & 0x1f);
+        }
+    }
+  else
+    {
+      for (j = 0; j < 3; j++)
+        {
+          base_colors[0][j] = extend_4 ((bits >> (60 - j * 8)) & 0xf);
+          base_colors[1][j] = extend_4 ((bits >> (56 - j * 8)) & 0xf);
+        }
+    }
+
+  decode_etc_subblocks (bits, base_colors, pixels);
+}
+
+static void
+decode_eac_alpha_block (const uint8_t *block,
+                        uint8_t *pixels)
+{
+  uint64_t bits = read_uint64_be (block);
+  int base = block[0];
+  int multiplier = block[1] >> 4;
+  const int *modifiers = eac_modifier_table[block[1] & 0xf];
+  int i;
+
+  for (i = 0; i < 16; i++)
+    {
+      int index = (bits >> (45 - i * 3)) & 7;
+
+      pixels[etc_pixel_offset (i) + 3] =
+        clamp_component (base + modifiers[index] * multiplier);
+    }
+}
+
+static void
+decode_block (const CoglCompressedImage *image,
+              const uint8_t *block,
+              uint8_t *pixels)
+{
+  int i;
+
+  /* Formats without alpha are opaque */
+  for (i = 0; i < 16; i++)
+    pixels[i * 4 + 3] = 255;
+
+  switch (image->format)
+    {
+    case COGL_COMPRESSED_FORMAT_RGB_DXT1:
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT1:
+      decode_dxt_color_block (block, image->format, pixels);
+      break;
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT3:
+      decode_dxt_color_block (block + 8, image->format, pixels);
+      decode_dxt3_alpha_block (block, pixels);
+      break;
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT5:
+      decode_dxt_color_block (block + 8, image->format, pixels);
+      decode_dxt5_alpha_block (block, pixels);
+      break;
+    case COGL_COMPRESSED_FORMAT_RGB_ETC1:
+    case COGL_COMPRESSED_FORMAT_RGB_ETC2:
+      decode_etc_block (block, image->format, pixels);
+      break;
+    case COGL_COMPRESSED_FORMAT_RGBA_ETC2_EAC:
+      decode_etc_block (block + 8, image->format, pixels);
+      decode_eac_alpha_block (block, pixels);
+      break;
+    case COGL_COMPRESSED_FORMAT_RGBA_ASTC:
+      g_warn_if_reached ();
+      memset (pixels, 0, 16 * 4);
+      break;
+    }
+}
+
+void
+_cogl_compressed_image_decompress_level (const CoglCompressedImage *image,
+                                         int level,
+                                         int rowstride,
+                                         uint8_t *dst)
+{
+  const CoglCompressedImageLevel *image_level = image->levels + level;
+  const uint8_t *block = image_level->data;
+  int block_x, block_y;
+  uint8_t pixels[4 * 4 * 4];
+
+  _COGL_RETURN_IF_FAIL (_cogl_compressed_image_can_decompress (image));
+  _COGL_RETURN_IF_FAIL (level >= 0 && level < image->n_levels);
+
+  for (block_y = 0; block_y < image_level->height; block_y += 4)
+    for (block_x = 0; block_x < image_level->width; block_x += 4)
+      {
+        /* Blocks on the right and bottom edges can extend past the
+         * size of the level so only the covered part is copied */
+        int width = MIN (4, image_level->width - block_x);
+        int height = MIN (4, image_level->height - block_y);
+        int y;
+
+        decode_block (image, block, pixels);
+        block += image->block_size;
+
+        for (y = 0; y < height; y++)
+          memcpy (dst + (block_y + y) * rowstride + block_x * 4,
+                  pixels + y * 4 * 4,
+                  width * 4);
+      }
+}
+
+static void
+write_uint32 (uint8_t *p,
+              uint32_t value,
+              CoglBool swap)
+{
+  int i;
+
+  for (i = 0; i < 4; i++)
+    p[swap ? 3 - i : i] = value >> (i * 8);
+}
+
+/* Writes a KTX header for a 2D texture. The level data has to be
+ * written by the caller */
+static void
+write_test_ktx_header (uint8_t *data,
+                       uint32_t gl_internal_format,
+                       int width,
+                       int height,
+                       int n_levels,
+                       CoglBool swap)
+{
+  memset (data, 0, KTX_HEADER_SIZE);
+  memcpy (data, ktx_identifier, sizeof (ktx_identifier));
+  write_uint32 (data + 12, KTX_ENDIANNESS, swap);
+  write_uint32 (data + 28, gl_internal_format, swap);
+  write_uint32 (data + 36, width, swap);
+  write_uint32 (data + 40, height, swap);
+  write_uint32 (data + 52, 1, swap); /* faces */
+  write_uint32 (data + 56, n_levels, swap);
+}
+
+static void
+check_parse_error (const uint8_t *data,
+                   size_t size,
+                   int expected_code)
+{
+  CoglCompressedImage image;
+  CoglError *error = NULL;
+
+  g_assert (!_cogl_compressed_image_parse (&image, data, size, &error));
+  g_assert (error != NULL);
+  g_assert_cmpint (error->domain, ==, COGL_BITMAP_ERROR);
+  g_assert_cmpint (error->code, ==, expected_code);
+  cogl_error_free (error);
+}
+
+UNIT_TEST (check_compressed_image_parsing,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  /* A 4x4 ETC1 image with two mipmap levels. Each level is a single
+   * 8 byte block preceded by its size */
+  uint8_t ktx[KTX_HEADER_SIZE + (4 + 8) * 2];
+  uint8_t dds[DDS_HEADER_SIZE + 16 + 8 + 8 + 8];
+  uint8_t astc[KTX_HEADER_SIZE + 4 + 4 * 16];
+  CoglCompressedImage image;
+  CoglBool swap;
+
+  for (swap = FALSE; swap <= TRUE; swap++)
+    {
+      memset (ktx, 0, sizeof (ktx));
+      write_test_ktx_header (ktx, 0x8d64, 4, 4, 2, swap);
+      write_uint32 (ktx + KTX_HEADER_SIZE, 8, swap);
+      write_uint32 (ktx + KTX_HEADER_SIZE + 12, 8, swap);
+
+      g_assert (_cogl_compressed_image_parse (&image,
+                                              ktx, sizeof (ktx),
+                                              NULL));
+      g_assert_cmpint (image.format, ==, COGL_COMPRESSED_FORMAT_RGB_ETC1);
+      g_assert_cmpint (image.width, ==, 4);
+      g_assert_cmpint (image.height, ==, 4);
+      g_assert_cmpint (image.n_levels, ==, 2);
+      g_assert (image.levels[0].data == ktx + KTX_HEADER_SIZE + 4);
+      g_assert_cmpint (image.levels[0].size, ==, 8);
+      g_assert (image.levels[1].data == ktx + KTX_HEADER_SIZE + 16);
+      g_assert_cmpint (image.levels[1].width, ==, 2);
+      g_assert_cmpint (image.levels[1].height, ==, 2);
+      g_assert_cmpint (image.levels[1].size, ==, 8);
+    }
+
+  /* Missing the last byte of the second level */
+  check_parse_error (ktx, sizeof (ktx) - 1, COGL_BITMAP_ERROR_CORRUPT_IMAGE);
+  /* Missing the header */
+  check_parse_error (ktx, 20, COGL_BITMAP_ERROR_CORRUPT_IMAGE);
+  /* Unrecognised magic */
+  check_parse_error (ktx + 1, sizeof (ktx) - 1,
+                     COGL_BITMAP_ERROR_UNKNOWN_TYPE);
+
+  /* A level size that doesn't match the block size */
+  write_test_ktx_header (ktx, 0x8d64, 4, 4, 2, FALSE);
+  write_uint32 (ktx + KTX_HEADER_SIZE, 7, FALSE);
+  check_parse_error (ktx, sizeof (ktx), COGL_BITMAP_ERROR_CORRUPT_IMAGE);
+  write_uint32 (ktx + KTX_HEADER_SIZE, 8, FALSE);
+
+  /* More levels than a 4x4 image can have */
+  write_test_ktx_header (ktx, 0x8d64, 4, 4, 4, FALSE);
+  check_parse_error (ktx, sizeof (ktx), COGL_BITMAP_ERROR_CORRUPT_IMAGE);
+
+  /* Uncompressed data isn't handled */
+  write_test_ktx_header (ktx, 0x8058 /* GL_RGBA8 */, 4, 4, 2, FALSE);
+  check_parse_error (ktx, sizeof (ktx), COGL_BITMAP_ERROR_UNKNOWN_TYPE);
+
+  /* A 16x16 ASTC image with 8x8 blocks can be parsed but only the GPU
+   * can decode it */
+  memset (astc, 0, sizeof (astc));
+  write_test_ktx_header (astc, 0x93b7, 16, 16, 1, FALSE);
+  write_uint32 (astc + KTX_HEADER_SIZE, 4 * 16, FALSE);
+  g_assert (_cogl_compressed_image_parse (&image, astc, sizeof (astc), NULL));
+  g_assert_cmpint (image.format, ==, COGL_COMPRESSED_FORMAT_RGBA_ASTC);
+  g_assert_cmpint (image.block_width, ==, 8);
+  g_assert_cmpint (image.block_height, ==, 8);
+  g_assert (!_cogl_compressed_image_can_decompress (&image));
+
+  /* An 8x4 DXT1 image with a full mipmap chain of 8x4, 4x2, 2x1 and
+   * 1x1 levels packed without padding */
+  memset (dds, 0, sizeof (dds));
+  memcpy (dds, "DDS ", 4);
+  write_uint32 (dds + 4, 124, FALSE);
+  write_uint32 (dds + 8, DDS_FLAG_MIPMAP_COUNT, FALSE);
+  write_uint32 (dds + 12, 4, FALSE); /* height */
+  write_uint32 (dds + 16, 8, FALSE); /* width */
+  write_uint32 (dds + 28, 4, FALSE); /* levels */
+  write_uint32 (dds + 76, 32, FALSE);
+  write_uint32 (dds + 80, DDS_PIXEL_FORMAT_FLAG_FOURCC, FALSE);
+  write_uint32 (dds + 84, DDS_FOURCC ('D', 'X', 'T', '1'), FALSE);
+
+  g_assert (_cogl_compressed_image_parse (&image, dds, sizeof (dds), NULL));
+  g_assert_cmpint (image.format, ==, COGL_COMPRESSED_FORMAT_RGBA_DXT1);
+  g_assert_cmpint (image.n_levels, ==, 4);
+  g_assert (image.levels[0].data == dds + DDS_HEADER_SIZE);
+  g_assert_cmpint (image.levels[0].size, ==, 16);
+  g_assert (image.levels[1].data == dds + DDS_HEADER_SIZE + 16);
+  g_assert (image.levels[3].data == dds + DDS_HEADER_SIZE + 32);
+  g_assert_cmpint (image.levels[3].width, ==, 1);
+  g_assert_cmpint (image.levels[3].height, ==, 1);
+
+  check_parse_error (dds, sizeof (dds) - 1, COGL_BITMAP_ERROR_CORRUPT_IMAGE);
+
+  /* Cube maps aren't supported */
+  write_uint32 (dds + 112, DDS_CAPS2_CUBEMAP, FALSE);
+  check_parse_error (dds, sizeof (dds), COGL_BITMAP_ERROR_UNKNOWN_TYPE);
+}
+
+static void
+decode_test_block (CoglCompressedFormat format,
+                   const uint8_t *block,
+                   uint8_t *pixels)
+{
+  CoglCompressedImage image;
+
+  memset (&image, 0, sizeof (image));
+  image.format = format;
+  image.block_width = 4;
+  image.block_height = 4;
+  image.width = 4;
+  image.height = 4;
+  image.n_levels = 1;
+  image.levels[0].width = 4;
+  image.levels[0].height = 4;
+  image.levels[0].data = block;
+
+  _cogl_compressed_image_decompress_level (&image, 0, 4 * 4, pixels);
+}
+
+static void
+check_decoded_pixel (const uint8_t *pixels,
+                     int x,
+                     int y,
+                     uint32_t expected)
+{
+  const uint8_t *pixel = pixels + (y * 4 + x) * 4;
+  uint32_t value = ((pixel[0] << 24) | (pixel[1] << 16) |
+                    (pixel[2] << 8) | pixel[3]);
+
+  if (value != expected)
+    {
+      g_print ("Pixel %i,%i was 0x%08x but 0x%08x was expected\n",
+               x, y, value, expected);
+      g_assert_not_reached ();
+    }
+}
+
+UNIT_TEST (check_compressed_image_decoding,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  /* Red and blue end points with each row using a different index */
+  static const uint8_t dxt1_block[] =
+    { 0x00, 0xf8, 0x1f, 0x00, 0x00, 0x55, 0xaa, 0xff };
+  /* Interpolated alpha indices 0, 1 and 2 in the first row followed
+   * by a white colour block */
+  static const uint8_t dxt5_block[] =
+    {
+      0xff, 0x00, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00
+    };
+  /* Individual mode with a red left half and a blue right half.
+   * Pixel 1,0 uses the largest negative modifier */
+  static const uint8_t etc1_block[] =
+    { 0xf0, 0x00, 0x0f, 0x00, 0x00, 0x10, 0x00, 0x10 };
+  /* Planar mode where the origin and both gradients are the same
+   * colour so it should be flat */
+  static const uint8_t etc2_planar_block[] =
+    { 0x41, 0x00, 0x14, 0x42, 0x80, 0x84, 0x10, 0x10 };
+  /* Alpha with a base of 128, a multiplier of 2 and table 0. Pixel 0
+   * uses the largest modifier and the rest use the first */
+  static const uint8_t etc2_eac_block[] =
+    {
+      0x80, 0x20, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+  uint8_t pixels[4 * 4 * 4];
+
+  decode_test_block (COGL_COMPRESSED_FORMAT_RGBA_DXT1, dxt1_block, pixels);
+  check_decoded_pixel (pixels, 0, 0, 0xff0000ff);
+  check_decoded_pixel (pixels, 3, 1, 0x0000ffff);
+  check_decoded_pixel (pixels, 1, 2, 0xaa0055ff);
+  check_decoded_pixel (pixels, 2, 3, 0x5500aaff);
+
+  decode_test_block (COGL_COMPRESSED_FORMAT_RGBA_DXT5, dxt5_block, pixels);
+  check_decoded_pixel (pixels, 0, 0, 0xffffffff);
+  check_decoded_pixel (pixels, 1, 0, 0xffffff00);
+  check_decoded_pixel (pixels, 2, 0, 0xffffffda);
+  check_decoded_pixel (pixels, 3, 3, 0xffffffff);
+
+  decode_test_block (COGL_COMPRESSED_FORMAT_RGB_ETC1, etc1_block, pixels);
+  check_decoded_pixel (pixels, 0, 0, 0xff0202ff);
+  check_decoded_pixel (pixels, 1, 0, 0xf70000ff);
+  check_decoded_pixel (pixels, 0, 3, 0xff0202ff);
+  check_decoded_pixel (pixels, 3, 3, 0x0202ffff);
+
+  decode_test_block (COGL_COMPRESSED_FORMAT_RGB_ETC2,
+                     etc2_planar_block,
+                     pixels);
+  check_decoded_pixel (pixels, 0, 0, 0x828141ff);
+  check_decoded_pixel (pixels, 3, 3, 0x828141ff);
+
+  decode_test_block (COGL_COMPRESSED_FORMAT_RGBA_ETC2_EAC,
+                     etc2_eac_block,
+                     pixels);
+  check_decoded_pixel (pixels, 0, 0, 0x0202029c);
+  check_decoded_pixel (pixels, 1, 0, 0x0202027a);
+  check_decoded_pixel (pixels, 0, 1, 0x0202027a);
+}
@@ -53,6 +53,8 @@
 #include "cogl-texture-3d.h"
 #include "cogl-texture-rectangle.h"
 #include "cogl-sampler-cache-private.h"
+#include "cogl-memory-stats-private.h"
+#include "cogl-trace-private.h"
 #include "cogl-gpu-info-private.h"
 #include "cogl-gl-header.h"
 #include "cogl-framebuffer-private.h"
@@ -68,6 +70,35 @@ typedef struct
   GLubyte c[4];
 } CoglTextureGLVertex;
 
+/* A shadow copy of the fixed function GL state that gets set while
+ * flushing a pipeline. Each value is compared against this before
+ * calling into GL so that flushing two pipelines with the same state
+ * doesn't make any redundant calls. The blend enable, depth and color
+ * mask state have their own members in CoglContext. */
+typedef struct
+{
+  GLenum blend_src_factor_rgb;
+  GLenum blend_dst_factor_rgb;
+  GLenum blend_src_factor_alpha;
+  GLenum blend_dst_factor_alpha;
+  GLenum blend_equation_rgb;
+  GLenum blend_equation_alpha;
+  CoglColor blend_constant;
+
+  GLenum alpha_func;
+  float alpha_func_reference;
+
+  CoglBool cull_face_enabled;
+  GLenum cull_face_mode;
+  GLenum front_face;
+
+  CoglBool program_point_size_enabled;
+
+  /* The number of GL calls that were skipped because the state was
+   * already set */
+  unsigned long n_calls_elided;
+} CoglGLStateCache;
+
 struct _CoglContext
 {
   CoglObject _parent;
@@ -154,6 +185,13 @@ struct _CoglContext
 
   CoglPipelineCache *pipeline_cache;
 
+  /* GLSL shaders for pipelines keyed by their source so that
+     pipelines which generate the same code share a shader */
+  GHashTable       *glsl_shader_cache;
+  /* Code generated for snippet lists. See
+     _cogl_pipeline_snippet_generate_code() */
+  GHashTable       *snippet_code_cache;
+
   /* Textures */
   CoglTexture2D *default_gl_texture_2d_tex;
   CoglTexture3D *default_gl_texture_3d_tex;
@@ -166,6 +204,12 @@ struct _CoglContext
   /* Global journal buffers */
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
+  /* The number of textures that the journal binds at once when
+   * COGL_PRIVATE_FEATURE_TEXTURE_BATCHING is available. This is set
+   * by the driver */
+  int               max_batched_textures;
+  /* A texture lookup snippet that picks between the batched textures */
+  CoglSnippet      *journal_texture_batch_snippet;
 
   /* Some simple caching, to minimize state changes... */
   CoglPipeline     *current_pipeline;
@@ -173,8 +217,10 @@ struct _CoglContext
   CoglBool          current_pipeline_with_color_attrib;
   CoglBool          current_pipeline_unknown_color_alpha;
   unsigned long     current_pipeline_age;
+  int               current_pipeline_n_shader_clip_rects;
 
   CoglBool          gl_blend_enable_cache;
+  CoglGLStateCache  gl_state_cache;
 
   CoglBool              depth_test_enabled_cache;
   CoglDepthTestFunction depth_test_function_cache;
@@ -190,6 +236,13 @@ struct _CoglContext
   CoglFramebuffer  *current_draw_buffer;
   CoglFramebuffer  *current_read_buffer;
 
+  /* Running totals of the data uploaded for the frame stats */
+  size_t            vertex_bytes_uploaded;
+  size_t            texture_bytes_uploaded;
+
+  /* Commands recorded by the NOP driver in place of GL calls */
+  struct _CoglNopCommandLog *nop_command_log;
+
   gboolean have_last_offscreen_allocate_flags;
   CoglOffscreenAllocateFlags last_offscreen_allocate_flags;
 
@@ -256,6 +309,17 @@ struct _CoglContext
      will hold a reference */
   CoglClipStack    *current_clip_stack;
 
+  /* Rectangle clips that the GL driver has decided to evaluate in the
+     fragment shader instead of with the stencil buffer. Each rectangle
+     is described by a 3x3 column-major matrix mapping window
+     coordinates to a homogeneous position within the unit square of
+     the rectangle. The number of rectangles selects a variant of the
+     generated GLSL program. The age is bumped whenever the matrices
+     change so that the progend knows when to reupload the uniform */
+  int               n_shader_clip_rects;
+  float             shader_clip_matrices[COGL_MAX_SHADER_CLIP_RECTS * 9];
+  unsigned int      shader_clip_age;
+
   /* This is used as a temporary buffer to fill a CoglBuffer when
      cogl_buffer_map fails and we only want to map to fill it with new
      data */
@@ -267,6 +331,12 @@ struct _CoglContext
 
   CoglSamplerCache *sampler_cache;
 
+  CoglMemoryAccounting memory;
+
+#ifdef COGL_ENABLE_TRACING
+  CoglTraceGpuState trace_gpu;
+#endif
+
   /* FIXME: remove these when we remove the last xlib based clutter
    * backend. they should be tracked as part of the renderer but e.g.
    * the eglx backend doesn't yet have a corresponding Cogl winsys
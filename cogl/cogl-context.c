@@ -55,6 +55,8 @@
 #include "cogl-gpu-info-private.h"
 #include "cogl-config-private.h"
 #include "cogl-error-private.h"
+#include "cogl-glsl-shader-private.h"
+#include "cogl-pipeline-snippet-private.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -174,6 +176,8 @@ cogl_context_new (CoglDisplay *display,
    */
   _cogl_context = context;
 
+  _cogl_memory_accounting_init (context);
+
   /* Init default values */
   memset (context->features, 0, sizeof (context->features));
   memset (context->private_features, 0, sizeof (context->private_features));
@@ -270,6 +274,8 @@ cogl_context_new (CoglDisplay *display,
 
   context->current_clip_stack_valid = FALSE;
   context->current_clip_stack = NULL;
+  context->n_shader_clip_rects = 0;
+  context->shader_clip_age = 0;
 
   cogl_matrix_init_identity (&context->identity_matrix);
   cogl_matrix_init_identity (&context->y_flip_matrix);
@@ -314,6 +320,7 @@ cogl_context_new (CoglDisplay *display,
   context->current_pipeline = NULL;
   context->current_pipeline_changes_since_flush = 0;
   context->current_pipeline_with_color_attrib = FALSE;
+  context->current_pipeline_n_shader_clip_rects = 0;
 
   _cogl_bitmask_init (&context->enabled_builtin_attributes);
   _cogl_bitmask_init (&context->enable_builtin_attributes_tmp);
@@ -334,6 +341,7 @@ cogl_context_new (CoglDisplay *display,
   context->current_gl_color_mask = COGL_COLOR_MASK_ALL;
 
   context->gl_blend_enable_cache = FALSE;
+  _cogl_gl_state_cache_init (&context->gl_state_cache);
 
   context->depth_test_enabled_cache = FALSE;
   context->depth_test_function_cache = COGL_DEPTH_TEST_FUNCTION_LESS;
@@ -342,6 +350,8 @@ cogl_context_new (CoglDisplay *display,
   context->depth_range_far_cache = 1;
 
   context->pipeline_cache = _cogl_pipeline_cache_new ();
+  context->glsl_shader_cache = _cogl_glsl_shader_cache_new ();
+  context->snippet_code_cache = _cogl_pipeline_snippet_code_cache_new ();
 
   for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
     context->current_buffer[i] = NULL;
@@ -459,6 +469,12 @@ _cogl_context_free (CoglContext *context)
 {
   const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
 
+#ifdef COGL_ENABLE_TRACING
+  /* This needs the GL context so it has to be done before the winsys
+   * is deinitialized */
+  _cogl_trace_gpu_destroy (context);
+#endif
+
   winsys->context_deinit (context);
 
   if (context->default_gl_texture_2d_tex)
@@ -480,6 +496,8 @@ _cogl_context_free (CoglContext *context)
     g_array_free (context->journal_flush_attributes_array, TRUE);
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
+  if (context->journal_texture_batch_snippet)
+    cogl_object_unref (context->journal_texture_batch_snippet);
 
   if (context->rectangle_byte_indices)
     cogl_object_unref (context->rectangle_byte_indices);
@@ -518,6 +536,8 @@ _cogl_context_free (CoglContext *context)
   _cogl_matrix_entry_cache_destroy (&context->builtin_flushed_modelview);
 
   _cogl_pipeline_cache_free (context->pipeline_cache);
+  _cogl_glsl_shader_cache_free (context->glsl_shader_cache);
+  g_hash_table_destroy (context->snippet_code_cache);
 
   _cogl_sampler_cache_free (context->sampler_cache);
 
@@ -531,6 +551,10 @@ _cogl_context_free (CoglContext *context)
 
   g_byte_array_free (context->buffer_map_fallback_array, TRUE);
 
+  g_free (context->nop_command_log);
+
+  _cogl_memory_accounting_destroy (context);
+
   cogl_object_unref (context->display);
 
   g_free (context);
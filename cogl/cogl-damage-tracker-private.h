@@ -0,0 +1,70 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_DAMAGE_TRACKER_PRIVATE_H
+#define __COGL_DAMAGE_TRACKER_PRIVATE_H
+
+#include "cogl-damage-tracker.h"
+#include "cogl-object-private.h"
+#include "cogl-region-private.h"
+
+/* Buffer ages greater than this will cause a full repaint */
+#define COGL_DAMAGE_TRACKER_HISTORY_SIZE 4
+
+/* If a region has more rectangles than this it is replaced with its
+ * bounding box */
+#define COGL_DAMAGE_TRACKER_MAX_RECTANGLES 16
+
+struct _CoglDamageTracker
+{
+  CoglObject _parent;
+
+  CoglOnscreen *onscreen;
+
+  /* Size of the framebuffer when the last frame was swapped. If it
+   * changes the history is no longer valid */
+  int width;
+  int height;
+
+  /* Damage added for the next frame */
+  CoglRegion damage;
+
+  /* Damage of previously swapped frames, the most recent first */
+  CoglRegion history[COGL_DAMAGE_TRACKER_HISTORY_SIZE];
+  int n_history;
+
+  /* Region that needs repainting for the current frame and the same
+   * region flattened to 4-tuples for the public API */
+  CoglRegion repaint;
+  GArray *repaint_rectangles;
+
+  CoglBool in_frame;
+};
+
+#endif /* __COGL_DAMAGE_TRACKER_PRIVATE_H */
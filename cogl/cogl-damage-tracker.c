@@ -0,0 +1,247 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "cogl-damage-tracker-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-onscreen.h"
+
+static void _cogl_damage_tracker_free (CoglDamageTracker *tracker);
+
+COGL_OBJECT_DEFINE (DamageTracker, damage_tracker);
+
+CoglDamageTracker *
+cogl_damage_tracker_new (CoglOnscreen *onscreen)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  CoglDamageTracker *tracker;
+  int i;
+
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_onscreen (onscreen), NULL);
+
+  tracker = g_slice_new0 (CoglDamageTracker);
+
+  tracker->onscreen = cogl_object_ref (onscreen);
+  tracker->width = cogl_framebuffer_get_width (framebuffer);
+  tracker->height = cogl_framebuffer_get_height (framebuffer);
+
+  _cogl_region_init (&tracker->damage);
+  for (i = 0; i < COGL_DAMAGE_TRACKER_HISTORY_SIZE; i++)
+    _cogl_region_init (&tracker->history[i]);
+  _cogl_region_init (&tracker->repaint);
+  tracker->repaint_rectangles = g_array_new (FALSE, FALSE, sizeof (int));
+
+  /* Nothing has been drawn yet so the first frame always needs a full
+   * repaint */
+  cogl_damage_tracker_add_full_damage (tracker);
+
+  return _cogl_damage_tracker_object_new (tracker);
+}
+
+static void
+_cogl_damage_tracker_free (CoglDamageTracker *tracker)
+{
+  int i;
+
+  if (tracker->in_frame)
+    cogl_framebuffer_pop_clip (COGL_FRAMEBUFFER (tracker->onscreen));
+
+  _cogl_region_destroy (&tracker->damage);
+  for (i = 0; i < COGL_DAMAGE_TRACKER_HISTORY_SIZE; i++)
+    _cogl_region_destroy (&tracker->history[i]);
+  _cogl_region_destroy (&tracker->repaint);
+  g_array_free (tracker->repaint_rectangles, TRUE);
+
+  cogl_object_unref (tracker->onscreen);
+
+  g_slice_free (CoglDamageTracker, tracker);
+}
+
+void
+cogl_damage_tracker_add_damage (CoglDamageTracker *tracker,
+                                int x,
+                                int y,
+                                int width,
+                                int height)
+{
+  _cogl_region_union_rectangle (&tracker->damage, x, y, width, height);
+  _cogl_region_simplify (&tracker->damage,
+                         COGL_DAMAGE_TRACKER_MAX_RECTANGLES);
+}
+
+void
+cogl_damage_tracker_add_full_damage (CoglDamageTracker *tracker)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (tracker->onscreen);
+
+  _cogl_region_union_rectangle (&tracker->damage,
+                                0, 0,
+                                cogl_framebuffer_get_width (framebuffer),
+                                cogl_framebuffer_get_height (framebuffer));
+}
+
+CoglBool
+cogl_damage_tracker_begin_frame (CoglDamageTracker *tracker)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (tracker->onscreen);
+  int width = cogl_framebuffer_get_width (framebuffer);
+  int height = cogl_framebuffer_get_height (framebuffer);
+  const CoglRegionBox *boxes;
+  const CoglRegionBox *extents;
+  int age;
+  int i;
+
+  _COGL_RETURN_VAL_IF_FAIL (!tracker->in_frame, FALSE);
+
+  /* If the framebuffer has been resized then the damage from the
+   * previous frames doesn't cover the new parts of the buffer */
+  if (width != tracker->width || height != tracker->height)
+    {
+      tracker->width = width;
+      tracker->height = height;
+      tracker->n_history = 0;
+      cogl_damage_tracker_add_full_damage (tracker);
+    }
+
+  _cogl_region_intersect_rectangle (&tracker->damage, 0, 0, width, height);
+
+  if (_cogl_region_is_empty (&tracker->damage))
+    return FALSE;
+
+  age = cogl_onscreen_get_buffer_age (tracker->onscreen);
+
+  _cogl_region_clear (&tracker->repaint);
+
+  /* The back buffer contains the frame from age frames ago so it is
+   * missing the damage of the last age - 1 swapped frames */
+  if (age <= 0 || age - 1 > tracker->n_history)
+    _cogl_region_union_rectangle (&tracker->repaint, 0, 0, width, height);
+  else
+    {
+      _cogl_region_copy (&tracker->repaint, &tracker->damage);
+      for (i = 0; i < age - 1; i++)
+        _cogl_region_union (&tracker->repaint, &tracker->history[i]);
+      _cogl_region_simplify (&tracker->repaint,
+                             COGL_DAMAGE_TRACKER_MAX_RECTANGLES);
+    }
+
+  boxes = _cogl_region_get_boxes (&tracker->repaint);
+  g_array_set_size (tracker->repaint_rectangles,
+                    _cogl_region_get_n_boxes (&tracker->repaint) * 4);
+  for (i = 0; i < _cogl_region_get_n_boxes (&tracker->repaint); i++)
+    {
+      int *rect = &g_array_index (tracker->repaint_rectangles, int, i * 4);
+
+      rect[0] = boxes[i].x1;
+      rect[1] = boxes[i].y1;
+      rect[2] = boxes[i].x2 - boxes[i].x1;
+      rect[3] = boxes[i].y2 - boxes[i].y1;
+    }
+
+  /* The scissor can only represent a single rectangle so the bounding
+   * box is used. The parts of it outside the repaint region will just
+   * get redrawn with the same contents */
+  extents = &tracker->repaint.extents;
+  cogl_framebuffer_push_scissor_clip (framebuffer,
+                                      extents->x1,
+                                      extents->y1,
+                                      extents->x2 - extents->x1,
+                                      extents->y2 - extents->y1);
+
+  tracker->in_frame = TRUE;
+
+  return TRUE;
+}
+
+const int *
+cogl_damage_tracker_get_repaint_rectangles (CoglDamageTracker *tracker,
+                                            int *n_rectangles)
+{
+  if (!tracker->in_frame)
+    {
+      *n_rectangles = 0;
+      return NULL;
+    }
+
+  *n_rectangles = tracker->repaint_rectangles->len / 4;
+  return (const int *) tracker->repaint_rectangles->data;
+}
+
+void
+cogl_damage_tracker_swap_buffers (CoglDamageTracker *tracker)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (tracker->onscreen);
+  const CoglRegionBox *boxes = _cogl_region_get_boxes (&tracker->damage);
+  int n_boxes = _cogl_region_get_n_boxes (&tracker->damage);
+  CoglRegion oldest;
+  int *rectangles;
+  int i;
+
+  _COGL_RETURN_IF_FAIL (tracker->in_frame);
+
+  cogl_framebuffer_pop_clip (framebuffer);
+  tracker->in_frame = FALSE;
+
+  /* Reporting no rectangles means the whole buffer is damaged */
+  if (n_boxes == 1 &&
+      boxes[0].x1 == 0 && boxes[0].y1 == 0 &&
+      boxes[0].x2 == tracker->width && boxes[0].y2 == tracker->height)
+    n_boxes = 0;
+
+  rectangles = g_alloca (sizeof (int) * 4 * n_boxes);
+  for (i = 0; i < n_boxes; i++)
+    {
+      rectangles[i * 4 + 0] = boxes[i].x1;
+      rectangles[i * 4 + 1] = boxes[i].y1;
+      rectangles[i * 4 + 2] = boxes[i].x2 - boxes[i].x1;
+      rectangles[i * 4 + 3] = boxes[i].y2 - boxes[i].y1;
+    }
+
+  cogl_onscreen_swap_buffers_with_damage (tracker->onscreen,
+                                          rectangles,
+                                          n_boxes);
+
+  /* Rotate the history so that the oldest region gets reused for the
+   * damage of the frame that was just swapped */
+  oldest = tracker->history[COGL_DAMAGE_TRACKER_HISTORY_SIZE - 1];
+  memmove (tracker->history + 1,
+           tracker->history,
+           sizeof (CoglRegion) * (COGL_DAMAGE_TRACKER_HISTORY_SIZE - 1));
+  tracker->history[0] = tracker->damage;
+  tracker->damage = oldest;
+  _cogl_region_clear (&tracker->damage);
+
+  if (tracker->n_history < COGL_DAMAGE_TRACKER_HISTORY_SIZE)
+    tracker->n_history++;
+}
@@ -0,0 +1,202 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_DAMAGE_TRACKER_H__
+#define __COGL_DAMAGE_TRACKER_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-onscreen.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-damage-tracker
+ * @short_description: Utility for redrawing only the damaged parts
+ *   of an onscreen framebuffer
+ *
+ * A #CoglDamageTracker accumulates the regions of a #CoglOnscreen
+ * that an application has changed and uses
+ * cogl_onscreen_get_buffer_age() to work out which parts of the
+ * current back buffer are out of date. A frame is then drawn like
+ * this:
+ *
+ * |[
+ *   cogl_damage_tracker_add_damage (tracker, x, y, width, height);
+ *
+ *   if (cogl_damage_tracker_begin_frame (tracker))
+ *     {
+ *       paint_scene (onscreen);
+ *       cogl_damage_tracker_swap_buffers (tracker);
+ *     }
+ * ]|
+ *
+ * While the frame is being drawn a scissor clip is pushed on the
+ * framebuffer so that the whole scene can be painted and only the
+ * pixels that need updating are touched. The damage for the frame is
+ * passed to cogl_onscreen_swap_buffers_with_damage() so that a
+ * system compositor can also avoid redundant work.
+ *
+ * All of the rectangles are in framebuffer coordinates with the
+ * origin at the top left, the same as for
+ * cogl_framebuffer_push_scissor_clip().
+ */
+
+typedef struct _CoglDamageTracker CoglDamageTracker;
+#define COGL_DAMAGE_TRACKER(X) ((CoglDamageTracker *)(X))
+
+/**
+ * cogl_damage_tracker_new:
+ * @onscreen: A #CoglOnscreen framebuffer
+ *
+ * Creates a new damage tracker for @onscreen. The tracker keeps a
+ * reference on the onscreen. Initially the whole framebuffer is
+ * considered damaged.
+ *
+ * Return value: (transfer full): A newly allocated #CoglDamageTracker
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglDamageTracker *
+cogl_damage_tracker_new (CoglOnscreen *onscreen);
+
+/**
+ * cogl_is_damage_tracker:
+ * @object: A #CoglObject pointer
+ *
+ * Gets whether the given object references a #CoglDamageTracker.
+ *
+ * Return value: %TRUE if the object references a #CoglDamageTracker
+ *   and %FALSE otherwise.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_is_damage_tracker (void *object);
+
+/**
+ * cogl_damage_tracker_add_damage:
+ * @tracker: A #CoglDamageTracker
+ * @x: left edge of the damaged rectangle
+ * @y: top edge of the damaged rectangle
+ * @width: width of the damaged rectangle
+ * @height: height of the damaged rectangle
+ *
+ * Marks a rectangle of the framebuffer as changed for the next frame.
+ * This should be called before cogl_damage_tracker_begin_frame() for
+ * everything that will look different in the next frame, including
+ * the old position of any objects that have moved.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_damage_tracker_add_damage (CoglDamageTracker *tracker,
+                                int x,
+                                int y,
+                                int width,
+                                int height);
+
+/**
+ * cogl_damage_tracker_add_full_damage:
+ * @tracker: A #CoglDamageTracker
+ *
+ * Marks the whole framebuffer as changed for the next frame.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_damage_tracker_add_full_damage (CoglDamageTracker *tracker);
+
+/**
+ * cogl_damage_tracker_begin_frame:
+ * @tracker: A #CoglDamageTracker
+ *
+ * Works out which parts of the current back buffer need to be
+ * repainted. This combines the damage added for this frame with the
+ * damage of the previous frames that the back buffer hasn't seen yet
+ * according to cogl_onscreen_get_buffer_age(). If the age is unknown
+ * the whole buffer is repainted.
+ *
+ * If anything needs painting a scissor clip around the repaint
+ * region is pushed on the framebuffer and %TRUE is returned. The
+ * application should then paint the scene and call
+ * cogl_damage_tracker_swap_buffers(). Otherwise nothing has changed
+ * since the last frame and the application can skip it.
+ *
+ * Return value: %TRUE if the frame needs painting.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_damage_tracker_begin_frame (CoglDamageTracker *tracker);
+
+/**
+ * cogl_damage_tracker_get_repaint_rectangles:
+ * @tracker: A #CoglDamageTracker
+ * @n_rectangles: (out): Return location for the number of rectangles
+ *
+ * Gets the region of the back buffer that needs repainting for the
+ * current frame. This can be used to skip painting objects that
+ * don't intersect any of the rectangles. It is only valid between
+ * cogl_damage_tracker_begin_frame() and
+ * cogl_damage_tracker_swap_buffers().
+ *
+ * Return value: An array of @n_rectangles integer 4-tuples as
+ *   (x, y, width, height), owned by the tracker.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+const int *
+cogl_damage_tracker_get_repaint_rectangles (CoglDamageTracker *tracker,
+                                            int *n_rectangles);
+
+/**
+ * cogl_damage_tracker_swap_buffers:
+ * @tracker: A #CoglDamageTracker
+ *
+ * Finishes a frame started with cogl_damage_tracker_begin_frame().
+ * This pops the scissor clip and swaps the buffers of the onscreen
+ * with cogl_onscreen_swap_buffers_with_damage(), passing the damage
+ * added for this frame. The damage is then remembered so it can be
+ * used to repair older back buffers in later frames.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_damage_tracker_swap_buffers (CoglDamageTracker *tracker);
+
+COGL_END_DECLS
+
+#endif /* __COGL_DAMAGE_TRACKER_H__ */
@@ -161,6 +161,12 @@ OPT (DISABLE_SOFTWARE_CLIP,
      "disable-software-clip",
      N_("Disable software clipping"),
      N_("Disables Cogl's attempts to clip some rectangles in software."))
+OPT (DISABLE_SHADER_CLIP,
+     N_("Root Cause"),
+     "disable-shader-clip",
+     N_("Disable shader clipping"),
+     N_("Makes Cogl use the stencil buffer for transformed rectangle clips "
+        "instead of testing them in the fragment shader."))
 OPT (SHOW_SOURCE,
      N_("Cogl Tracing"),
      "show-source",
@@ -187,6 +193,12 @@ OPT (DISABLE_FAST_READ_PIXEL,
      N_("Disable read pixel optimization"),
      N_("Disable optimization for reading 1px for simple "
         "scenes of opaque rectangles"))
+OPT (DISABLE_FAST_PATH_FILL,
+     N_("Root Cause"),
+     "disable-fast-path-fill",
+     N_("Disable fast path filling"),
+     N_("Always use the GLU tesselator to fill paths instead of "
+        "triangulating simple polygons directly"))
 OPT (CLIPPING,
      N_("Cogl Tracing"),
      "clipping",
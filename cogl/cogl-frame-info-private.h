@@ -33,6 +33,7 @@
 
 #include "cogl-frame-info.h"
 #include "cogl-object-private.h"
+#include "cogl-frame-stats.h"
 
 struct _CoglFrameInfo
 {
@@ -43,6 +44,8 @@ struct _CoglFrameInfo
   float refresh_rate;
 
   CoglOutput *output;
+
+  CoglFrameStats frame_stats;
 };
 
 CoglFrameInfo *_cogl_frame_info_new (void);
@@ -77,3 +77,10 @@ cogl_frame_info_get_output (CoglFrameInfo *info)
 {
   return info->output;
 }
+
+void
+cogl_frame_info_get_frame_stats (CoglFrameInfo *info,
+                                 CoglFrameStats *stats)
+{
+  *stats = info->frame_stats;
+}
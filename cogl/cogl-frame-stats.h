@@ -0,0 +1,202 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_FRAME_STATS_H__
+#define __COGL_FRAME_STATS_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-framebuffer.h>
+#include <cogl/cogl-frame-info.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-frame-stats
+ * @short_description: Functions for counting the work done to draw
+ *   a frame
+ *
+ * Each #CoglFramebuffer keeps a set of counters describing the work
+ * that Cogl has done to draw to it since the start of the current
+ * frame. For a #CoglOnscreen a frame ends when the buffers are
+ * swapped. The counters for the frame are then stored in the
+ * #CoglFrameInfo for that swap and reset. For an offscreen
+ * framebuffer the application decides when a frame ends by calling
+ * cogl_framebuffer_reset_frame_stats().
+ *
+ * The counters are meant to be compared between runs of the same
+ * application, for example to catch a change that splits up
+ * batches or adds state changes. They only count the work that Cogl
+ * itself submits so they don't include anything done directly with
+ * GL.
+ */
+
+/**
+ * CoglFrameStats:
+ * @n_journal_flushes: The number of times the journal was flushed
+ * @n_journal_entries: The number of rectangles that went through the
+ *   journal
+ * @n_clip_batches: The number of batches after splitting the journal
+ *   by clip state
+ * @n_stride_batches: The number of batches after also splitting by the
+ *   vertex stride
+ * @n_layer_batches: The number of batches after also splitting by the
+ *   number of layers
+ * @n_pipeline_batches: The number of batches after also splitting by
+ *   the pipeline
+ * @n_modelview_batches: The number of batches after also splitting by
+ *   the modelview matrix. This is only non-zero if the journal isn't
+ *   transforming the vertices in software
+ * @n_draw_calls: The number of GL draw calls
+ * @n_pipeline_flushes: The number of times the pipeline state had to
+ *   be compared against the previous pipeline and flushed
+ * @n_program_changes: The number of times a different GLSL or ARBfp
+ *   program was bound
+ * @n_texture_changes: The number of times a texture was bound to a
+ *   texture unit while flushing a pipeline
+ * @n_blend_changes: The number of times the blend state changed
+ * @n_clip_flushes: The number of times the clip stack was flushed to
+ *   GL because it differed from the one that was already set
+ * @vertex_bytes_uploaded: The number of bytes written to attribute
+ *   and index buffers
+ * @texture_bytes_uploaded: The number of bytes uploaded to textures
+ * @n_shader_compiles: The number of GLSL shaders that were compiled
+ * @n_shader_cache_hits: The number of times a GLSL shader was reused
+ *   because another pipeline had already generated the same source
+ * @n_texture_batches: The number of pipeline batches that combined
+ *   rectangles with different textures. See
+ *   cogl_framebuffer_set_texture_batching_enabled()
+ * @n_stencil_clip_cache_hits: The number of times a clip stack was
+ *   flushed using a silhouette that was already in the stencil buffer
+ * @n_stencil_clip_cache_misses: The number of times a clip stack had
+ *   to be drawn into the stencil buffer
+ *
+ * The counters for one frame, filled in by
+ * cogl_framebuffer_get_frame_stats() or
+ * cogl_frame_info_get_frame_stats().
+ *
+ * The byte counts include every upload made through the
+ * #CoglContext during the frame because uploads aren't tied to a
+ * particular framebuffer.
+ *
+ * Applications allocate this struct themselves so it is padded to
+ * leave room for more counters without changing its size. New
+ * counters are added at the end.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef struct _CoglFrameStats
+{
+  int n_journal_flushes;
+  int n_journal_entries;
+
+  int n_clip_batches;
+  int n_stride_batches;
+  int n_layer_batches;
+  int n_pipeline_batches;
+  int n_modelview_batches;
+
+  int n_draw_calls;
+
+  int n_pipeline_flushes;
+  int n_program_changes;
+  int n_texture_changes;
+  int n_blend_changes;
+
+  int n_clip_flushes;
+
+  size_t vertex_bytes_uploaded;
+  size_t texture_bytes_uploaded;
+
+  int n_shader_compiles;
+  int n_shader_cache_hits;
+
+  int n_texture_batches;
+
+  int n_stencil_clip_cache_hits;
+  int n_stencil_clip_cache_misses;
+
+  /*< private >*/
+  /* New counters take their space from here */
+  int COGL_PRIVATE (padding)[14];
+} CoglFrameStats;
+
+/**
+ * cogl_framebuffer_get_frame_stats:
+ * @framebuffer: A #CoglFramebuffer
+ * @stats: (out): A #CoglFrameStats to fill in
+ *
+ * Retrieves the counters for the frame that is currently being drawn
+ * to @framebuffer. Any rectangles that are still waiting in the
+ * journal are not counted until it is flushed.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_get_frame_stats (CoglFramebuffer *framebuffer,
+                                  CoglFrameStats *stats);
+
+/**
+ * cogl_framebuffer_reset_frame_stats:
+ * @framebuffer: A #CoglFramebuffer
+ *
+ * Sets all of the counters for @framebuffer back to zero to start a
+ * new frame. This is done automatically for a #CoglOnscreen when its
+ * buffers are swapped.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_reset_frame_stats (CoglFramebuffer *framebuffer);
+
+/**
+ * cogl_frame_info_get_frame_stats:
+ * @info: A #CoglFrameInfo
+ * @stats: (out): A #CoglFrameStats to fill in
+ *
+ * Retrieves the counters for the frame that @info describes. These
+ * are the counters of the #CoglOnscreen at the time its buffers were
+ * swapped.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_frame_info_get_frame_stats (CoglFrameInfo *info,
+                                 CoglFrameStats *stats);
+
+COGL_END_DECLS
+
+#endif /* __COGL_FRAME_STATS_H__ */
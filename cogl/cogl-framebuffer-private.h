@@ -39,6 +39,8 @@
 #include "cogl-offscreen.h"
 #include "cogl-gl-header.h"
 #include "cogl-clip-stack.h"
+#include "cogl-list.h"
+#include "cogl-frame-stats.h"
 
 #ifdef COGL_HAS_XLIB_SUPPORT
 #include <X11/Xlib.h>
@@ -127,6 +129,25 @@ typedef struct
   int stencil;
 } CoglFramebufferBits;
 
+/* The maximum number of clip stacks whose stencil silhouettes can be
+   kept in the stencil buffer at the same time. Each one uses a
+   separate bit of the stencil buffer */
+#define COGL_STENCIL_CLIP_CACHE_SIZE 7
+
+typedef struct
+{
+  /* The clip stack whose silhouette is stored in this slot or NULL
+     if the slot is unused. A reference is held on the stack and on
+     the projection entry */
+  CoglClipStack *stack;
+  /* The silhouette also depends on the projection and viewport that
+     were used when it was drawn */
+  CoglMatrixEntry *projection_entry;
+  int viewport_age;
+  /* Used to find the least recently used slot */
+  unsigned int last_used;
+} CoglStencilClipCacheEntry;
+
 struct _CoglFramebuffer
 {
   CoglObject          _parent;
@@ -154,8 +175,14 @@ struct _CoglFramebuffer
 
   CoglClipStack      *clip_stack;
 
+  /* Clip stacks that have been drawn into the stencil buffer so that
+     switching back to one of them doesn't need to redraw it */
+  CoglStencilClipCacheEntry stencil_clip_cache[COGL_STENCIL_CLIP_CACHE_SIZE];
+  unsigned int        stencil_clip_cache_age;
+
   CoglBool            dither_enabled;
   CoglBool            depth_writing_enabled;
+  CoglBool            texture_batching_enabled;
   CoglColorMask       color_mask;
   CoglStereoMode      stereo_mode;
 
@@ -168,6 +195,10 @@ struct _CoglFramebuffer
    * framebuffers... */
   GList              *deps;
 
+  /* Reads started with cogl_framebuffer_read_pixels_async() that
+   * haven't been delivered yet */
+  CoglList            pending_read_pixels;
+
   /* As part of an optimization for reading-back single pixels from a
    * framebuffer in some simple cases where the geometry is still
    * available in the journal we need to track the bounds of the last
@@ -188,6 +219,13 @@ struct _CoglFramebuffer
    * swap buffers or swap region. */
   CoglBool            mid_scene;
 
+  /* Counters for the current frame. The byte counts are derived from
+   * the context-wide totals which are remembered here at the start
+   * of the frame */
+  CoglFrameStats      frame_stats;
+  size_t              frame_start_vertex_bytes;
+  size_t              frame_start_texture_bytes;
+
   /* driver specific */
   CoglBool            dirty_bitmasks;
   CoglFramebufferBits bits;
@@ -205,6 +243,8 @@ typedef struct _CoglGLFramebuffer
 {
   GLuint fbo_handle;
   GList *renderbuffers;
+  /* Estimated number of bytes used by the renderbuffers */
+  size_t renderbuffers_size;
   int samples_per_pixel;
 } CoglGLFramebuffer;
 
@@ -252,6 +292,15 @@ _cogl_framebuffer_set_internal_format (CoglFramebuffer *framebuffer,
 
 void _cogl_framebuffer_free (CoglFramebuffer *framebuffer);
 
+/* Increments one of the frame stats counters for the framebuffer
+ * that is currently bound for drawing. This is for code such as the
+ * pipeline flushing that doesn't know which framebuffer it is
+ * drawing to. */
+#define _COGL_FRAME_STATS_INC(ctx, counter) G_STMT_START {      \
+    if ((ctx)->current_draw_buffer)                             \
+      (ctx)->current_draw_buffer->frame_stats.counter++;        \
+  } G_STMT_END
+
 const CoglWinsysVtable *
 _cogl_framebuffer_get_winsys (CoglFramebuffer *framebuffer);
 
@@ -295,6 +344,18 @@ void
 _cogl_framebuffer_set_clip_stack (CoglFramebuffer *framebuffer,
                                   CoglClipStack *stack);
 
+/*
+ * _cogl_framebuffer_invalidate_stencil_clip_cache:
+ * @framebuffer: A #CoglFramebuffer
+ *
+ * Forgets any clip stacks that were cached in the stencil buffer of
+ * @framebuffer. This should be called whenever the contents of the
+ * stencil buffer are modified by something other than the clip
+ * stack code.
+ */
+void
+_cogl_framebuffer_invalidate_stencil_clip_cache (CoglFramebuffer *framebuffer);
+
 CoglMatrixStack *
 _cogl_framebuffer_get_modelview_stack (CoglFramebuffer *framebuffer);
 
@@ -54,6 +54,7 @@
 #include "cogl-primitives-private.h"
 #include "cogl-error-private.h"
 #include "cogl-texture-gl-private.h"
+#include "cogl-read-pixels-async-private.h"
 
 extern CoglObjectClass _cogl_onscreen_class;
 
@@ -112,6 +113,7 @@ _cogl_framebuffer_init (CoglFramebuffer *framebuffer,
   framebuffer->viewport_age_for_scissor_workaround = -1;
   framebuffer->dither_enabled = TRUE;
   framebuffer->depth_writing_enabled = TRUE;
+  framebuffer->texture_batching_enabled = FALSE;
 
   framebuffer->modelview_stack = cogl_matrix_stack_new (ctx);
   framebuffer->projection_stack = cogl_matrix_stack_new (ctx);
@@ -124,8 +126,16 @@ _cogl_framebuffer_init (CoglFramebuffer *framebuffer,
 
   framebuffer->clip_stack = NULL;
 
+  memset (framebuffer->stencil_clip_cache, 0,
+          sizeof (framebuffer->stencil_clip_cache));
+  framebuffer->stencil_clip_cache_age = 0;
+
   framebuffer->journal = _cogl_journal_new (framebuffer);
 
+  cogl_framebuffer_reset_frame_stats (framebuffer);
+
+  _cogl_list_init (&framebuffer->pending_read_pixels);
+
   /* Ensure we know the framebuffer->clear_color* members can't be
    * referenced for our fast-path read-pixel optimization (see
    * _cogl_journal_try_read_pixel()) until some region of the
@@ -174,10 +184,15 @@ _cogl_framebuffer_free (CoglFramebuffer *framebuffer)
 {
   CoglContext *ctx = framebuffer->context;
 
+  /* This has to be done first because pending reads hold fences */
+  _cogl_read_pixels_cancel_for_framebuffer (framebuffer);
+
   _cogl_fence_cancel_fences_for_framebuffer (framebuffer);
 
   _cogl_clip_stack_unref (framebuffer->clip_stack);
 
+  _cogl_framebuffer_invalidate_stencil_clip_cache (framebuffer);
+
   cogl_object_unref (framebuffer->modelview_stack);
   framebuffer->modelview_stack = NULL;
 
@@ -233,6 +248,9 @@ _cogl_framebuffer_clear_without_flush4f (CoglFramebuffer *framebuffer,
   ctx->driver_vtable->framebuffer_clear (framebuffer,
                                          buffers,
                                          red, green, blue, alpha);
+
+  if (buffers & COGL_BUFFER_BIT_STENCIL)
+    _cogl_framebuffer_invalidate_stencil_clip_cache (framebuffer);
 }
 
 void
@@ -459,6 +477,36 @@ cogl_framebuffer_get_height (CoglFramebuffer *framebuffer)
   return framebuffer->height;
 }
 
+void
+_cogl_framebuffer_invalidate_stencil_clip_cache (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx = framebuffer->context;
+  int i;
+
+  for (i = 0; i < COGL_STENCIL_CLIP_CACHE_SIZE; i++)
+    {
+      CoglStencilClipCacheEntry *entry = framebuffer->stencil_clip_cache + i;
+
+      if (entry->stack)
+        {
+          _cogl_clip_stack_unref (entry->stack);
+          cogl_matrix_entry_unref (entry->projection_entry);
+          entry->stack = NULL;
+          entry->projection_entry = NULL;
+        }
+    }
+
+  /* The currently flushed clip state might be relying on the stencil
+     buffer so it will need to be flushed again */
+  if (ctx->current_draw_buffer == framebuffer &&
+      ctx->current_clip_stack_valid)
+    {
+      _cogl_clip_stack_unref (ctx->current_clip_stack);
+      ctx->current_clip_stack_valid = FALSE;
+      ctx->current_draw_buffer_changes |= COGL_FRAMEBUFFER_STATE_CLIP;
+    }
+}
+
 CoglClipStack *
 _cogl_framebuffer_get_clip_stack (CoglFramebuffer *framebuffer)
 {
@@ -1102,6 +1150,21 @@ cogl_framebuffer_set_dither_enabled (CoglFramebuffer *framebuffer,
       COGL_FRAMEBUFFER_STATE_DITHER;
 }
 
+CoglBool
+cogl_framebuffer_get_texture_batching_enabled (CoglFramebuffer *framebuffer)
+{
+  return framebuffer->texture_batching_enabled;
+}
+
+void
+cogl_framebuffer_set_texture_batching_enabled (CoglFramebuffer *framebuffer,
+                                               CoglBool enabled)
+{
+  /* This is only looked at when the journal is flushed so there's no
+   * need to flush it here */
+  framebuffer->texture_batching_enabled = enabled;
+}
+
 void
 cogl_framebuffer_set_depth_texture_enabled (CoglFramebuffer *framebuffer,
                                             CoglBool enabled)
@@ -1363,6 +1426,118 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
   return ret;
 }
 
+/* If the bounding box of the points that can't be read from the
+ * journal has at most this many pixels per point then the whole box
+ * is read at once instead of reading each pixel separately */
+#define READ_POINTS_MAX_PIXELS_PER_POINT 64
+
+CoglBool
+cogl_framebuffer_read_pixels_at_points (CoglFramebuffer *framebuffer,
+                                        const int *points,
+                                        int n_points,
+                                        CoglPixelFormat format,
+                                        uint8_t *pixels)
+{
+  int bpp = _cogl_pixel_format_get_bytes_per_pixel (format);
+  GArray *missed;
+  CoglBool ret = TRUE;
+  int x0 = G_MAXINT, y0 = G_MAXINT, x1 = G_MININT, y1 = G_MININT;
+  int i;
+
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_framebuffer (framebuffer), FALSE);
+
+  if (!cogl_framebuffer_allocate (framebuffer, NULL))
+    return FALSE;
+
+  missed = g_array_new (FALSE, FALSE, sizeof (int));
+
+  for (i = 0; i < n_points; i++)
+    {
+      int x = points[i * 2];
+      int y = points[i * 2 + 1];
+
+      if (!framebuffer->clear_clip_dirty)
+        {
+          CoglBitmap *bitmap =
+            cogl_bitmap_new_for_data (framebuffer->context,
+                                      1, 1,
+                                      format,
+                                      bpp, /* rowstride */
+                                      pixels + i * bpp);
+          CoglBool found =
+            _cogl_framebuffer_try_fast_read_pixel (framebuffer,
+                                                   x, y,
+                                                   COGL_READ_PIXELS_COLOR_BUFFER,
+                                                   bitmap);
+
+          cogl_object_unref (bitmap);
+
+          if (found)
+            continue;
+        }
+
+      g_array_append_val (missed, i);
+
+      x0 = MIN (x0, x);
+      y0 = MIN (y0, y);
+      x1 = MAX (x1, x + 1);
+      y1 = MAX (y1, y + 1);
+    }
+
+  if (missed->len == 0)
+    goto done;
+
+  /* The remaining points have to be read from the framebuffer so the
+   * journal only needs to be flushed once for all of them */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  if ((int64_t) (x1 - x0) * (y1 - y0) <=
+      (int64_t) missed->len * READ_POINTS_MAX_PIXELS_PER_POINT)
+    {
+      int rowstride = (x1 - x0) * bpp;
+      uint8_t *region = g_malloc (rowstride * (y1 - y0));
+
+      ret = cogl_framebuffer_read_pixels (framebuffer,
+                                          x0, y0,
+                                          x1 - x0, y1 - y0,
+                                          format,
+                                          region);
+
+      if (ret)
+        for (i = 0; i < missed->len; i++)
+          {
+            int point = g_array_index (missed, int, i);
+            int x = points[point * 2] - x0;
+            int y = points[point * 2 + 1] - y0;
+
+            memcpy (pixels + point * bpp,
+                    region + y * rowstride + x * bpp,
+                    bpp);
+          }
+
+      g_free (region);
+    }
+  else
+    {
+      for (i = 0; i < missed->len && ret; i++)
+        {
+          int point = g_array_index (missed, int, i);
+
+          ret = cogl_framebuffer_read_pixels (framebuffer,
+                                              points[point * 2],
+                                              points[point * 2 + 1],
+                                              1, 1,
+                                              format,
+                                              pixels + point * bpp);
+        }
+    }
+
+done:
+  g_array_free (missed, TRUE);
+
+  return ret;
+}
+
 void
 _cogl_blit_framebuffer (CoglFramebuffer *src,
                         CoglFramebuffer *dest,
@@ -1422,6 +1597,9 @@ cogl_framebuffer_discard_buffers (CoglFramebuffer *framebuffer,
   _COGL_RETURN_IF_FAIL (buffers & COGL_BUFFER_BIT_COLOR);
 
   ctx->driver_vtable->framebuffer_discard_buffers (framebuffer, buffers);
+
+  if (buffers & COGL_BUFFER_BIT_STENCIL)
+    _cogl_framebuffer_invalidate_stencil_clip_cache (framebuffer);
 }
 
 void
@@ -2346,3 +2524,26 @@ cogl_framebuffer_draw_textured_rectangles (CoglFramebuffer *framebuffer,
                                                    rects,
                                                    n_rectangles);
 }
+
+void
+cogl_framebuffer_get_frame_stats (CoglFramebuffer *framebuffer,
+                                  CoglFrameStats *stats)
+{
+  CoglContext *ctx = framebuffer->context;
+
+  *stats = framebuffer->frame_stats;
+  stats->vertex_bytes_uploaded =
+    ctx->vertex_bytes_uploaded - framebuffer->frame_start_vertex_bytes;
+  stats->texture_bytes_uploaded =
+    ctx->texture_bytes_uploaded - framebuffer->frame_start_texture_bytes;
+}
+
+void
+cogl_framebuffer_reset_frame_stats (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx = framebuffer->context;
+
+  memset (&framebuffer->frame_stats, 0, sizeof (CoglFrameStats));
+  framebuffer->frame_start_vertex_bytes = ctx->vertex_bytes_uploaded;
+  framebuffer->frame_start_texture_bytes = ctx->texture_bytes_uploaded;
+}
@@ -778,6 +778,48 @@ void
 cogl_framebuffer_set_dither_enabled (CoglFramebuffer *framebuffer,
                                      CoglBool dither_enabled);
 
+/**
+ * cogl_framebuffer_get_texture_batching_enabled:
+ * @framebuffer: a pointer to a #CoglFramebuffer
+ *
+ * Queries whether rectangles drawn to @framebuffer with different
+ * textures may be combined into a single draw. See
+ * cogl_framebuffer_set_texture_batching_enabled().
+ *
+ * Return value: %TRUE if texture batching has been requested or
+ *   %FALSE if not.
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglBool
+cogl_framebuffer_get_texture_batching_enabled (CoglFramebuffer *framebuffer);
+
+/**
+ * cogl_framebuffer_set_texture_batching_enabled:
+ * @framebuffer: a pointer to a #CoglFramebuffer
+ * @enabled: %TRUE to enable texture batching or %FALSE to disable
+ *
+ * Normally Cogl can only combine rectangles into a single draw when
+ * they are drawn with equivalent pipelines. If texture batching is
+ * enabled then consecutive rectangles whose pipelines have a single
+ * 2D texture layer and only differ by that texture may also be
+ * combined. Cogl binds several of the textures at once and picks
+ * between them in the fragment shader using an index stored in the
+ * vertices.
+ *
+ * This is useful for drawing many small images that can't be put in
+ * an atlas, such as the windows of a compositor. It makes the
+ * fragment shader more expensive so it is disabled by default. It
+ * has no effect if the driver doesn't support GLSL or if the layer
+ * has a %COGL_SNIPPET_HOOK_TEXTURE_LOOKUP snippet.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_set_texture_batching_enabled (CoglFramebuffer *framebuffer,
+                                               CoglBool enabled);
+
 /**
  * cogl_framebuffer_get_depth_write_enabled:
  * @framebuffer: a pointer to a #CoglFramebuffer
@@ -1559,6 +1601,39 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
                               CoglPixelFormat format,
                               uint8_t *pixels);
 
+/**
+ * cogl_framebuffer_read_pixels_at_points:
+ * @framebuffer: A #CoglFramebuffer
+ * @points: (array length=n_points): An array of x, y pairs giving
+ *   the position of each pixel to read
+ * @n_points: The number of points in @points
+ * @format: The pixel format to store the data in
+ * @pixels: The address of a buffer big enough to store @n_points
+ *   pixels in @format
+ *
+ * Reads the color of a list of single pixels from the color buffer
+ * and stores them consecutively in @pixels. This is useful for
+ * picking where many points need to be tested at a time.
+ *
+ * Reading single pixels from a framebuffer that has only been
+ * cleared and filled with rectangles of an opaque color can often be
+ * answered from the geometry that Cogl has batched without rendering
+ * it first. This function tries that for every point before falling
+ * back to rendering the scene and reading the remaining pixels with
+ * as few reads as possible, so it is much cheaper than calling
+ * cogl_framebuffer_read_pixels() once for each point.
+ *
+ * Return value: %TRUE if the read succeeded or %FALSE otherwise.
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglBool
+cogl_framebuffer_read_pixels_at_points (CoglFramebuffer *framebuffer,
+                                        const int *points,
+                                        int n_points,
+                                        CoglPixelFormat format,
+                                        uint8_t *pixels);
+
 /**
  * cogl_get_draw_framebuffer:
  *
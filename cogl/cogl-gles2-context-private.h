@@ -40,6 +40,7 @@
 #include "cogl-object-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-list.h"
+#include "cogl-id-map.h"
 
 typedef struct _CoglGLES2Offscreen
 {
@@ -149,15 +150,16 @@ struct _CoglGLES2Context
 
   CoglGLES2Vtable *vtable;
 
-  /* Hash table mapping GL's IDs for shaders and objects to ShaderData
-   * and ProgramData so that we can maintain extra data for these
-   * objects. Although technically the IDs will end up global across
-   * all GLES2 contexts because they will all be in the same share
-   * list, we don't really want to expose this outside of the Cogl API
-   * so we will assume it is undefined behaviour if an application
-   * relies on this. */
-  GHashTable *shader_map;
-  GHashTable *program_map;
+  /* Maps from GL's IDs for shaders and objects to ShaderData and
+   * ProgramData so that we can maintain extra data for these
+   * objects. These are looked up by most of the wrappers so they use
+   * a CoglIdMap rather than a GHashTable. Although technically the
+   * IDs will end up global across all GLES2 contexts because they
+   * will all be in the same share list, we don't really want to
+   * expose this outside of the Cogl API so we will assume it is
+   * undefined behaviour if an application relies on this. */
+  CoglIdMap shader_map;
+  CoglIdMap program_map;
 
   /* Currently in use program. We need to keep track of this so that
    * we can keep a reference to the data for the program while it is
@@ -183,9 +185,9 @@ struct _CoglGLES2Context
    * results of glReadPixels read from a CoglOffscreen */
   int pack_alignment;
 
-  /* A hash table of CoglGLES2TextureObjects indexed by the texture
-   * object ID so that we can track some state */
-  GHashTable *texture_object_map;
+  /* A map of CoglGLES2TextureObjects indexed by the texture object
+   * ID so that we can track some state */
+  CoglIdMap texture_object_map;
 
   /* Array of CoglGLES2TextureUnits to keep track of state for each
    * texture unit */
@@ -106,18 +106,17 @@ shader_data_unref (CoglGLES2Context *context,
                    CoglGLES2ShaderData *shader_data)
 {
   if (--shader_data->ref_count < 1)
-    /* Removing the hash table entry should also destroy the data */
-    g_hash_table_remove (context->shader_map,
-                         GINT_TO_POINTER (shader_data->object_id));
+    /* Removing the map entry should also destroy the data */
+    _cogl_id_map_remove (&context->shader_map, shader_data->object_id);
 }
 
 static void
 program_data_unref (CoglGLES2ProgramData *program_data)
 {
   if (--program_data->ref_count < 1)
-    /* Removing the hash table entry should also destroy the data */
-    g_hash_table_remove (program_data->context->program_map,
-                         GINT_TO_POINTER (program_data->object_id));
+    /* Removing the map entry should also destroy the data */
+    _cogl_id_map_remove (&program_data->context->program_map,
+                         program_data->object_id);
 }
 
 static void
@@ -216,15 +215,15 @@ set_texture_object_data (CoglGLES2Context *gles2_ctx,
 
   /* We want to keep track of all texture objects where the data is
    * created by this context so that we can delete them later */
-  texture_object = g_hash_table_lookup (gles2_ctx->texture_object_map,
-                                        GUINT_TO_POINTER (texture_id));
+  texture_object = _cogl_id_map_lookup (&gles2_ctx->texture_object_map,
+                                        texture_id);
   if (texture_object == NULL)
     {
       texture_object = g_slice_new0 (CoglGLES2TextureObjectData);
       texture_object->object_id = texture_id;
 
-      g_hash_table_insert (gles2_ctx->texture_object_map,
-                           GUINT_TO_POINTER (texture_id),
+      _cogl_id_map_insert (&gles2_ctx->texture_object_map,
+                           texture_id,
                            texture_object);
     }
 
@@ -271,8 +270,8 @@ copy_flipped_texture (CoglGLES2Context *gles2_ctx,
   CoglTexture2D *dst_texture;
   CoglPixelFormat internal_format;
 
-  tex_object_data = g_hash_table_lookup (gles2_ctx->texture_object_map,
-                                         GUINT_TO_POINTER (tex_id));
+  tex_object_data = _cogl_id_map_lookup (&gles2_ctx->texture_object_map,
+                                         tex_id);
 
   /* We can't do anything if the application hasn't set a level 0
    * image on this texture object */
@@ -691,9 +690,7 @@ gl_create_shader_wrapper (GLenum type)
       data->ref_count = 1;
       data->deleted = FALSE;
 
-      g_hash_table_insert (gles2_ctx->shader_map,
-                           GINT_TO_POINTER (id),
-                           data);
+      _cogl_id_map_insert (&gles2_ctx->shader_map, id, data);
     }
 
   return id;
@@ -705,8 +702,8 @@ gl_delete_shader_wrapper (GLuint shader)
   CoglGLES2Context *gles2_ctx = current_gles2_context;
   CoglGLES2ShaderData *shader_data;
 
-  if ((shader_data = g_hash_table_lookup (gles2_ctx->shader_map,
-                                          GINT_TO_POINTER (shader))) &&
+  if ((shader_data = _cogl_id_map_lookup (&gles2_ctx->shader_map,
+                                          shader)) &&
       !shader_data->deleted)
     {
       shader_data->deleted = TRUE;
@@ -736,9 +733,7 @@ gl_create_program_wrapper (void)
       data->flip_vector_location = 0;
       data->flip_vector_state = COGL_GLES2_FLIP_STATE_UNKNOWN;
 
-      g_hash_table_insert (gles2_ctx->program_map,
-                           GINT_TO_POINTER (id),
-                           data);
+      _cogl_id_map_insert (&gles2_ctx->program_map, id, data);
     }
 
   return id;
@@ -750,8 +745,8 @@ gl_delete_program_wrapper (GLuint program)
   CoglGLES2Context *gles2_ctx = current_gles2_context;
   CoglGLES2ProgramData *program_data;
 
-  if ((program_data = g_hash_table_lookup (gles2_ctx->program_map,
-                                           GINT_TO_POINTER (program))) &&
+  if ((program_data = _cogl_id_map_lookup (&gles2_ctx->program_map,
+                                           program)) &&
       !program_data->deleted)
     {
       program_data->deleted = TRUE;
@@ -767,8 +762,16 @@ gl_use_program_wrapper (GLuint program)
   CoglGLES2Context *gles2_ctx = current_gles2_context;
   CoglGLES2ProgramData *program_data;
 
-  program_data = g_hash_table_lookup (gles2_ctx->program_map,
-                                      GINT_TO_POINTER (program));
+  /* Applications often make the same program current before every
+   * draw so we can skip the lookup and the reference juggling */
+  if (gles2_ctx->current_program &&
+      gles2_ctx->current_program->object_id == program)
+    {
+      gles2_ctx->context->glUseProgram (program);
+      return;
+    }
+
+  program_data = _cogl_id_map_lookup (&gles2_ctx->program_map, program);
 
   if (program_data)
     program_data->ref_count++;
@@ -788,10 +791,10 @@ gl_attach_shader_wrapper (GLuint program,
   CoglGLES2ProgramData *program_data;
   CoglGLES2ShaderData *shader_data;
 
-  if ((program_data = g_hash_table_lookup (gles2_ctx->program_map,
-                                           GINT_TO_POINTER (program))) &&
-      (shader_data = g_hash_table_lookup (gles2_ctx->shader_map,
-                                          GINT_TO_POINTER (shader))) &&
+  if ((program_data = _cogl_id_map_lookup (&gles2_ctx->program_map,
+                                           program)) &&
+      (shader_data = _cogl_id_map_lookup (&gles2_ctx->shader_map,
+                                          shader)) &&
       /* Ignore attempts to attach a shader that is already attached */
       g_list_find (program_data->attached_shaders, shader_data) == NULL)
     {
@@ -811,10 +814,10 @@ gl_detach_shader_wrapper (GLuint program,
   CoglGLES2ProgramData *program_data;
   CoglGLES2ShaderData *shader_data;
 
-  if ((program_data = g_hash_table_lookup (gles2_ctx->program_map,
-                                           GINT_TO_POINTER (program))) &&
-      (shader_data = g_hash_table_lookup (gles2_ctx->shader_map,
-                                          GINT_TO_POINTER (shader))))
+  if ((program_data = _cogl_id_map_lookup (&gles2_ctx->program_map,
+                                           program)) &&
+      (shader_data = _cogl_id_map_lookup (&gles2_ctx->shader_map,
+                                          shader)))
     detach_shader (program_data, shader_data);
 
   gles2_ctx->context->glDetachShader (program, shader);
@@ -829,8 +832,8 @@ gl_shader_source_wrapper (GLuint shader,
   CoglGLES2Context *gles2_ctx = current_gles2_context;
   CoglGLES2ShaderData *shader_data;
 
-  if ((shader_data = g_hash_table_lookup (gles2_ctx->shader_map,
-                                          GINT_TO_POINTER (shader))) &&
+  if ((shader_data = _cogl_id_map_lookup (&gles2_ctx->shader_map,
+                                          shader)) &&
       shader_data->type == GL_VERTEX_SHADER)
     {
       char **string_copy = g_alloca ((count + 1) * sizeof (char *));
@@ -892,8 +895,8 @@ gl_get_shader_source_wrapper (GLuint shader,
                                          &length,
                                          source);
 
-  if ((shader_data = g_hash_table_lookup (gles2_ctx->shader_map,
-                                          GINT_TO_POINTER (shader))) &&
+  if ((shader_data = _cogl_id_map_lookup (&gles2_ctx->shader_map,
+                                          shader)) &&
       shader_data->type == GL_VERTEX_SHADER)
     {
       GLsizei copy_length = MIN (length, buf_size - 1);
@@ -932,8 +935,7 @@ gl_link_program_wrapper (GLuint program)
 
   gles2_ctx->context->glLinkProgram (program);
 
-  program_data = g_hash_table_lookup (gles2_ctx->program_map,
-                                      GINT_TO_POINTER (program));
+  program_data = _cogl_id_map_lookup (&gles2_ctx->program_map, program);
 
   if (program_data)
     {
@@ -942,9 +944,14 @@ gl_link_program_wrapper (GLuint program)
       gles2_ctx->context->glGetProgramiv (program, GL_LINK_STATUS, &status);
 
       if (status)
-        program_data->flip_vector_location =
-          gles2_ctx->context->glGetUniformLocation (program,
-                                                    MAIN_WRAPPER_FLIP_UNIFORM);
+        {
+          program_data->flip_vector_location =
+            gles2_ctx->context->glGetUniformLocation
+              (program, MAIN_WRAPPER_FLIP_UNIFORM);
+          /* Linking resets all of the uniforms to zero so the cached
+           * flip vector is no longer valid */
+          program_data->flip_vector_state = COGL_GLES2_FLIP_STATE_UNKNOWN;
+        }
     }
 }
 
@@ -1384,8 +1391,8 @@ gl_delete_textures_wrapper (GLsizei n,
       /* Remove the binding. We can do this immediately because unlike
        * shader objects the deletion isn't delayed until the object is
        * unbound */
-      g_hash_table_remove (gles2_ctx->texture_object_map,
-                           GUINT_TO_POINTER (textures[texture_index]));
+      _cogl_id_map_remove (&gles2_ctx->texture_object_map,
+                           textures[texture_index]);
     }
 }
 
@@ -1489,29 +1496,29 @@ _cogl_gles2_context_free (CoglGLES2Context *gles2_context)
    * share list as Cogl's context these won't get deleted by default.
    * FIXME: we should do this for all of the other resources too, like
    * textures */
-  objects = g_hash_table_get_values (gles2_context->program_map);
+  objects = _cogl_id_map_get_values (&gles2_context->program_map);
   for (l = objects; l; l = l->next)
     force_delete_program_object (gles2_context, l->data);
   g_list_free (objects);
-  objects = g_hash_table_get_values (gles2_context->shader_map);
+  objects = _cogl_id_map_get_values (&gles2_context->shader_map);
   for (l = objects; l; l = l->next)
     force_delete_shader_object (gles2_context, l->data);
   g_list_free (objects);
-  objects = g_hash_table_get_values (gles2_context->texture_object_map);
+  objects = _cogl_id_map_get_values (&gles2_context->texture_object_map);
   for (l = objects; l; l = l->next)
     force_delete_texture_object (gles2_context, l->data);
   g_list_free (objects);
 
   /* All of the program and shader objects should now be destroyed */
-  if (g_hash_table_size (gles2_context->program_map) > 0)
+  if (_cogl_id_map_get_size (&gles2_context->program_map) > 0)
     g_warning ("Program objects have been leaked from a CoglGLES2Context");
-  if (g_hash_table_size (gles2_context->shader_map) > 0)
+  if (_cogl_id_map_get_size (&gles2_context->shader_map) > 0)
     g_warning ("Shader objects have been leaked from a CoglGLES2Context");
 
-  g_hash_table_destroy (gles2_context->program_map);
-  g_hash_table_destroy (gles2_context->shader_map);
+  _cogl_id_map_destroy (&gles2_context->program_map);
+  _cogl_id_map_destroy (&gles2_context->shader_map);
 
-  g_hash_table_destroy (gles2_context->texture_object_map);
+  _cogl_id_map_destroy (&gles2_context->texture_object_map);
   g_array_free (gles2_context->texture_units, TRUE);
 
   winsys = ctx->display->renderer->winsys_vtable;
@@ -1649,22 +1656,13 @@ cogl_gles2_context_new (CoglContext *ctx, CoglError **error)
   gles2_ctx->vtable->glBindTexture = gl_bind_texture_wrapper;
   gles2_ctx->vtable->glTexImage2D = gl_tex_image_2d_wrapper;
 
-  gles2_ctx->shader_map =
-    g_hash_table_new_full (g_direct_hash,
-                           g_direct_equal,
-                           NULL, /* key_destroy */
-                           (GDestroyNotify) free_shader_data);
-  gles2_ctx->program_map =
-    g_hash_table_new_full (g_direct_hash,
-                           g_direct_equal,
-                           NULL, /* key_destroy */
-                           (GDestroyNotify) free_program_data);
-
-  gles2_ctx->texture_object_map =
-    g_hash_table_new_full (g_direct_hash,
-                           g_direct_equal,
-                           NULL, /* key_destroy */
-                           (GDestroyNotify) free_texture_object_data);
+  _cogl_id_map_init (&gles2_ctx->shader_map,
+                     (GDestroyNotify) free_shader_data);
+  _cogl_id_map_init (&gles2_ctx->program_map,
+                     (GDestroyNotify) free_program_data);
+
+  _cogl_id_map_init (&gles2_ctx->texture_object_map,
+                     (GDestroyNotify) free_texture_object_data);
 
   gles2_ctx->texture_units = g_array_new (FALSE, /* not zero terminated */
                                           TRUE, /* clear */
@@ -1882,6 +1880,10 @@ cogl_push_gles2_context (CoglContext *ctx,
 
   current_gles2_context = gles2_ctx;
 
+  /* The application may modify the stencil buffer so we can't rely on
+   * any clip silhouettes that were cached there */
+  _cogl_framebuffer_invalidate_stencil_clip_cache (write_buffer);
+
   /* If this is the first time this gles2 context has been used then
    * we'll force the viewport and scissor to the right size. GL has
    * the semantics that the viewport and scissor default to the size
@@ -29,6 +29,16 @@
 #ifndef _COGL_GLSL_SHADER_PRIVATE_H_
 #define _COGL_GLSL_SHADER_PRIVATE_H_
 
+typedef struct
+{
+  /* The complete source of the shader including the type, or NULL if
+     the shader isn't in the cache because the program caches are
+     disabled */
+  char *source;
+  GLuint gl_shader;
+  unsigned int ref_count;
+} CoglGLSLShaderCacheEntry;
+
 void
 _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                GLuint shader_gl_handle,
@@ -37,4 +47,36 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
                                                const char **strings_in,
                                                const GLint *lengths_in);
 
+GHashTable *
+_cogl_glsl_shader_cache_new (void);
+
+void
+_cogl_glsl_shader_cache_free (GHashTable *cache);
+
+/*
+ * _cogl_glsl_shader_cache_get:
+ * @ctx: A #CoglContext
+ * @shader_gl_type: GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+ * @count: The number of source strings
+ * @strings: The source strings, not including the boilerplate
+ * @lengths: The length of each string
+ *
+ * Returns an entry containing a compiled shader for the given
+ * source. Pipelines that generate exactly the same source share the
+ * same GL shader object even if they were given different vertex or
+ * fragment templates, so the shader is only compiled once. The entry
+ * has a reference which should be released with
+ * _cogl_glsl_shader_cache_unref().
+ */
+CoglGLSLShaderCacheEntry *
+_cogl_glsl_shader_cache_get (CoglContext *ctx,
+                             GLenum shader_gl_type,
+                             GLsizei count,
+                             const char **strings,
+                             const GLint *lengths);
+
+void
+_cogl_glsl_shader_cache_unref (CoglContext *ctx,
+                               CoglGLSLShaderCacheEntry *entry);
+
 #endif /* _COGL_GLSL_SHADER_PRIVATE_H_ */
@@ -126,3 +126,140 @@ _cogl_glsl_shader_set_source_with_boilerplate (CoglContext *ctx,
 
   g_free (version_string);
 }
+
+GHashTable *
+_cogl_glsl_shader_cache_new (void)
+{
+  /* The entries are freed when their last reference is released so
+     the table doesn't own anything */
+  return g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+void
+_cogl_glsl_shader_cache_free (GHashTable *cache)
+{
+  g_hash_table_destroy (cache);
+}
+
+static GLuint
+compile_shader (CoglContext *ctx,
+                GLenum shader_gl_type,
+                GLsizei count,
+                const char **strings,
+                const GLint *lengths)
+{
+  GLint compile_status;
+  GLuint shader;
+
+  COGL_STATIC_COUNTER (glsl_shader_compile_counter,
+                       "glsl shader compile counter",
+                       "Increments each time a GLSL shader is "
+                       "compiled for a pipeline",
+                       0 /* no application private data */);
+  COGL_COUNTER_INC (_cogl_uprof_context, glsl_shader_compile_counter);
+
+  _COGL_FRAME_STATS_INC (ctx, n_shader_compiles);
+
+  GE_RET( shader, ctx, glCreateShader (shader_gl_type) );
+
+  _cogl_glsl_shader_set_source_with_boilerplate (ctx,
+                                                 shader, shader_gl_type,
+                                                 count,
+                                                 strings, lengths);
+
+  GE( ctx, glCompileShader (shader) );
+  GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
+      shader_log = g_alloca (len);
+      GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+    }
+
+  return shader;
+}
+
+CoglGLSLShaderCacheEntry *
+_cogl_glsl_shader_cache_get (CoglContext *ctx,
+                             GLenum shader_gl_type,
+                             GLsizei count,
+                             const char **strings,
+                             const GLint *lengths)
+{
+  CoglGLSLShaderCacheEntry *entry;
+  GString *source;
+  int i;
+
+  COGL_STATIC_COUNTER (glsl_shader_cache_hit_counter,
+                       "glsl shader cache hit counter",
+                       "Increments each time a pipeline reuses a "
+                       "GLSL shader with the same source",
+                       0 /* no application private data */);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES)))
+    {
+      entry = g_slice_new (CoglGLSLShaderCacheEntry);
+      entry->source = NULL;
+      entry->ref_count = 1;
+      entry->gl_shader = compile_shader (ctx,
+                                         shader_gl_type,
+                                         count,
+                                         strings,
+                                         lengths);
+      return entry;
+    }
+
+  /* The type is included in the key so that a vertex shader can't be
+     mistaken for a fragment shader with the same source */
+  source = g_string_new (shader_gl_type == GL_VERTEX_SHADER ? "v" : "f");
+  for (i = 0; i < count; i++)
+    g_string_append_len (source, strings[i], lengths[i]);
+
+  entry = g_hash_table_lookup (ctx->glsl_shader_cache, source->str);
+
+  if (entry)
+    {
+      COGL_COUNTER_INC (_cogl_uprof_context, glsl_shader_cache_hit_counter);
+      _COGL_FRAME_STATS_INC (ctx, n_shader_cache_hits);
+
+      g_string_free (source, TRUE);
+      entry->ref_count++;
+      return entry;
+    }
+
+  entry = g_slice_new (CoglGLSLShaderCacheEntry);
+  entry->source = g_string_free (source, FALSE);
+  entry->ref_count = 1;
+  entry->gl_shader = compile_shader (ctx,
+                                     shader_gl_type,
+                                     count,
+                                     strings,
+                                     lengths);
+
+  g_hash_table_insert (ctx->glsl_shader_cache, entry->source, entry);
+
+  return entry;
+}
+
+void
+_cogl_glsl_shader_cache_unref (CoglContext *ctx,
+                               CoglGLSLShaderCacheEntry *entry)
+{
+  if (--entry->ref_count > 0)
+    return;
+
+  if (entry->source)
+    {
+      g_hash_table_remove (ctx->glsl_shader_cache, entry->source);
+      g_free (entry->source);
+    }
+
+  GE( ctx, glDeleteShader (entry->gl_shader) );
+
+  g_slice_free (CoglGLSLShaderCacheEntry, entry);
+}
@@ -0,0 +1,295 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include <test-fixtures/test-unit.h>
+
+#include "cogl-id-map.h"
+#include "cogl-util.h"
+
+/* The table starts with this many bits worth of slots */
+#define COGL_ID_MAP_INITIAL_BITS 4
+
+static void
+set_n_bits (CoglIdMap *map,
+            int n_bits)
+{
+  map->entries = g_new0 (CoglIdMapEntry, 1 << n_bits);
+  map->mask = (1 << n_bits) - 1;
+  map->shift = 32 - n_bits;
+}
+
+void
+_cogl_id_map_init (CoglIdMap *map,
+                   GDestroyNotify value_destroy_func)
+{
+  set_n_bits (map, COGL_ID_MAP_INITIAL_BITS);
+  map->n_entries = 0;
+  map->value_destroy_func = value_destroy_func;
+}
+
+void
+_cogl_id_map_destroy (CoglIdMap *map)
+{
+  CoglIdMapEntry *entries = map->entries;
+  unsigned int n_slots = map->mask + 1;
+  unsigned int i;
+
+  /* Detach the entries first so that the map looks empty if the
+   * destroy function looks at it */
+  set_n_bits (map, COGL_ID_MAP_INITIAL_BITS);
+  map->n_entries = 0;
+
+  if (map->value_destroy_func)
+    for (i = 0; i < n_slots; i++)
+      if (entries[i].value)
+        map->value_destroy_func (entries[i].value);
+
+  g_free (entries);
+  g_free (map->entries);
+  map->entries = NULL;
+}
+
+static void
+insert_new (CoglIdMap *map,
+            unsigned int id,
+            void *value)
+{
+  unsigned int slot = _cogl_id_map_get_slot (map, id);
+
+  while (map->entries[slot].value)
+    slot = (slot + 1) & map->mask;
+
+  map->entries[slot].id = id;
+  map->entries[slot].value = value;
+  map->n_entries++;
+}
+
+static void
+grow (CoglIdMap *map)
+{
+  CoglIdMapEntry *old_entries = map->entries;
+  unsigned int old_n_slots = map->mask + 1;
+  unsigned int i;
+
+  set_n_bits (map, 33 - map->shift);
+  map->n_entries = 0;
+
+  for (i = 0; i < old_n_slots; i++)
+    if (old_entries[i].value)
+      insert_new (map, old_entries[i].id, old_entries[i].value);
+
+  g_free (old_entries);
+}
+
+void
+_cogl_id_map_insert (CoglIdMap *map,
+                     unsigned int id,
+                     void *value)
+{
+  unsigned int slot = _cogl_id_map_get_slot (map, id);
+
+  _COGL_RETURN_IF_FAIL (value != NULL);
+
+  while (map->entries[slot].value)
+    {
+      if (map->entries[slot].id == id)
+        {
+          void *old_value = map->entries[slot].value;
+
+          map->entries[slot].value = value;
+
+          if (map->value_destroy_func)
+            map->value_destroy_func (old_value);
+
+          return;
+        }
+
+      slot = (slot + 1) & map->mask;
+    }
+
+  /* Keep the load factor under 3/4 so that the probe sequences stay
+   * short */
+  if ((map->n_entries + 1) * 4 > (map->mask + 1) * 3)
+    {
+      grow (map);
+      insert_new (map, id, value);
+    }
+  else
+    {
+      map->entries[slot].id = id;
+      map->entries[slot].value = value;
+      map->n_entries++;
+    }
+}
+
+CoglBool
+_cogl_id_map_remove (CoglIdMap *map,
+                     unsigned int id)
+{
+  unsigned int slot = _cogl_id_map_get_slot (map, id);
+  unsigned int next;
+  void *value;
+
+  while (TRUE)
+    {
+      if (map->entries[slot].value == NULL)
+        return FALSE;
+      if (map->entries[slot].id == id)
+        break;
+
+      slot = (slot + 1) & map->mask;
+    }
+
+  value = map->entries[slot].value;
+  map->entries[slot].value = NULL;
+  map->n_entries--;
+
+  /* Instead of leaving a tombstone, move any following entries whose
+   * probe sequence passes through the empty slot back into it so
+   * that lookups never have to skip over deleted entries */
+  for (next = (slot + 1) & map->mask;
+       map->entries[next].value;
+       next = (next + 1) & map->mask)
+    {
+      unsigned int home = _cogl_id_map_get_slot (map, map->entries[next].id);
+
+      /* The entry can only move if its home slot isn't cyclically
+       * within (slot, next] */
+      if (((next - home) & map->mask) >= ((next - slot) & map->mask))
+        {
+          map->entries[slot] = map->entries[next];
+          map->entries[next].value = NULL;
+          slot = next;
+        }
+    }
+
+  if (map->value_destroy_func)
+    map->value_destroy_func (value);
+
+  return TRUE;
+}
+
+void
+_cogl_id_map_foreach (CoglIdMap *map,
+                      CoglIdMapCallback callback,
+                      void *user_data)
+{
+  unsigned int i;
+
+  for (i = 0; i <= map->mask; i++)
+    if (map->entries[i].value)
+      callback (map->entries[i].id, map->entries[i].value, user_data);
+}
+
+GList *
+_cogl_id_map_get_values (CoglIdMap *map)
+{
+  GList *values = NULL;
+  unsigned int i;
+
+  for (i = 0; i <= map->mask; i++)
+    if (map->entries[i].value)
+      values = g_list_prepend (values, map->entries[i].value);
+
+  return values;
+}
+
+static int destroy_count;
+
+static void
+count_value_cb (unsigned int id,
+                void *value,
+                void *user_data)
+{
+  int *count = user_data;
+
+  g_assert_cmpuint (id, ==, GPOINTER_TO_UINT (value) - 1);
+
+  (*count)++;
+}
+
+static void
+count_destroy_cb (void *value)
+{
+  destroy_count++;
+}
+
+UNIT_TEST (check_id_map,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  CoglIdMap map;
+  unsigned int id;
+  int count;
+
+  _cogl_id_map_init (&map, count_destroy_cb);
+  destroy_count = 0;
+
+  /* The values are the id plus one so that id 0 has a non-NULL
+   * value. The ids are spread out so that some of them collide */
+  for (id = 0; id < 1000; id++)
+    _cogl_id_map_insert (&map, id * 3, GUINT_TO_POINTER (id * 3 + 1));
+
+  g_assert_cmpint (_cogl_id_map_get_size (&map), ==, 1000);
+
+  for (id = 0; id < 3000; id++)
+    g_assert_cmpuint (GPOINTER_TO_UINT (_cogl_id_map_lookup (&map, id)),
+                      ==,
+                      id % 3 ? 0 : id + 1);
+
+  /* Remove every other entry to exercise moving entries back into
+   * the freed slots */
+  for (id = 0; id < 1000; id += 2)
+    g_assert (_cogl_id_map_remove (&map, id * 3));
+  g_assert (!_cogl_id_map_remove (&map, 0));
+  g_assert (!_cogl_id_map_remove (&map, 1));
+
+  g_assert_cmpint (destroy_count, ==, 500);
+  g_assert_cmpint (_cogl_id_map_get_size (&map), ==, 500);
+
+  for (id = 0; id < 1000; id++)
+    g_assert_cmpuint (GPOINTER_TO_UINT (_cogl_id_map_lookup (&map, id * 3)),
+                      ==,
+                      id & 1 ? id * 3 + 1 : 0);
+
+  count = 0;
+  _cogl_id_map_foreach (&map, count_value_cb, &count);
+  g_assert_cmpint (count, ==, 500);
+
+  /* Replacing a value should destroy the old one */
+  _cogl_id_map_insert (&map, 3, GUINT_TO_POINTER (4));
+  g_assert_cmpint (destroy_count, ==, 501);
+  g_assert_cmpint (_cogl_id_map_get_size (&map), ==, 500);
+
+  _cogl_id_map_destroy (&map);
+  g_assert_cmpint (destroy_count, ==, 1001);
+}
@@ -0,0 +1,136 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __COGL_ID_MAP_H
+#define __COGL_ID_MAP_H
+
+#include <glib.h>
+
+#include "cogl-types.h"
+
+/*
+ * CoglIdMap:
+ *
+ * Maps unsigned integer ids such as GL object names to pointers. This
+ * is used instead of a GHashTable where the lookup is on a hot path.
+ * The entries are stored inline in a single array using open
+ * addressing with linear probing so a lookup is normally one
+ * multiplication and a single cache line read.
+ *
+ * The values can't be %NULL because an empty slot is marked with a
+ * %NULL value. Any id, including 0, can be used as a key.
+ */
+
+typedef struct
+{
+  unsigned int id;
+  void *value;
+} CoglIdMapEntry;
+
+typedef struct
+{
+  CoglIdMapEntry *entries;
+  /* The number of slots minus one. The number of slots is always a
+   * power of two */
+  unsigned int mask;
+  /* The number of bits to shift the hashed id by to get a slot */
+  int shift;
+  int n_entries;
+  GDestroyNotify value_destroy_func;
+} CoglIdMap;
+
+typedef void (* CoglIdMapCallback) (unsigned int id,
+                                    void *value,
+                                    void *user_data);
+
+void
+_cogl_id_map_init (CoglIdMap *map,
+                   GDestroyNotify value_destroy_func);
+
+/* Calls the destroy function for each remaining value */
+void
+_cogl_id_map_destroy (CoglIdMap *map);
+
+/* Replaces any existing value for the id. The old value is destroyed
+ * with the destroy function like g_hash_table_insert() */
+void
+_cogl_id_map_insert (CoglIdMap *map,
+                     unsigned int id,
+                     void *value);
+
+/* Returns whether the id was in the map. The slot is freed before
+ * the value is destroyed so it's safe for the destroy function to
+ * modify the map */
+CoglBool
+_cogl_id_map_remove (CoglIdMap *map,
+                     unsigned int id);
+
+/* The callback must not modify the map */
+void
+_cogl_id_map_foreach (CoglIdMap *map,
+                      CoglIdMapCallback callback,
+                      void *user_data);
+
+/* Returns a newly allocated list of all the values so that the
+ * caller can remove them while iterating */
+GList *
+_cogl_id_map_get_values (CoglIdMap *map);
+
+static inline int
+_cogl_id_map_get_size (CoglIdMap *map)
+{
+  return map->n_entries;
+}
+
+static inline unsigned int
+_cogl_id_map_get_slot (CoglIdMap *map,
+                       unsigned int id)
+{
+  /* Fibonacci hashing. GL hands out names sequentially so this
+   * spreads runs of ids evenly across the table */
+  return ((uint32_t) (id * 2654435769u)) >> map->shift;
+}
+
+static inline void *
+_cogl_id_map_lookup (CoglIdMap *map,
+                     unsigned int id)
+{
+  unsigned int slot = _cogl_id_map_get_slot (map, id);
+
+  while (map->entries[slot].value)
+    {
+      if (map->entries[slot].id == id)
+        return map->entries[slot].value;
+
+      slot = (slot + 1) & map->mask;
+    }
+
+  return NULL;
+}
+
+#endif /* __COGL_ID_MAP_H */
@@ -38,6 +38,16 @@
 
 #define COGL_JOURNAL_VBO_POOL_SIZE 8
 
+/* The number of cells in each direction of the grid used to find the
+   journal entries under a point when reading pixels */
+#define COGL_JOURNAL_PICK_GRID_SIZE 16
+/* The number of journal entries needed before the grid is used */
+#define COGL_JOURNAL_PICK_INDEX_THRESHOLD 32
+
+/* The most textures that will be bound at once to draw quads with
+   different textures in a single batch */
+#define COGL_JOURNAL_MAX_BATCHED_TEXTURES 8
+
 typedef struct _CoglJournal
 {
   CoglObject _parent;
@@ -66,6 +76,22 @@ typedef struct _CoglJournal
 
   int fast_read_pixel_count;
 
+  /* A screen-space grid over the journal entries used to speed up
+     _cogl_journal_try_read_pixel() when there are a lot of entries.
+     It is built lazily and any entries logged since the last read
+     are added to it before the next read. Each cell lists the
+     indices of the entries whose screen bounds overlap the cell in
+     the order they were logged */
+  GArray *pick_cells[COGL_JOURNAL_PICK_GRID_SIZE *
+                     COGL_JOURNAL_PICK_GRID_SIZE];
+  /* The screen polygon of each indexed entry */
+  GArray *pick_polygons;
+  int pick_n_indexed_entries;
+  /* The index is only valid for the projection and viewport it was
+     built with */
+  CoglMatrixEntry *pick_projection_entry;
+  int pick_viewport_age;
+
   CoglList pending_fences;
 
 } CoglJournal;
@@ -81,6 +107,13 @@ typedef struct _CoglJournalEntry
   /* Offset into ctx->logged_vertices */
   size_t                   array_offset;
   int                      n_layers;
+  /* When the framebuffer has texture batching enabled, entries that
+   * only differ by their layer 0 texture are given the same batch
+   * number and the index of their texture within the batch. This is
+   * -1 for entries that are batched normally. These are only valid
+   * while the journal is being flushed */
+  int                      texture_batch;
+  int                      texture_index;
 } CoglJournalEntry;
 
 CoglJournal *
@@ -36,8 +36,11 @@
 #include "cogl-context-private.h"
 #include "cogl-journal-private.h"
 #include "cogl-texture-private.h"
+#include "cogl-texture-2d.h"
 #include "cogl-pipeline-private.h"
 #include "cogl-pipeline-state-private.h"
+#include "cogl-pipeline-layer-private.h"
+#include "cogl-snippet-private.h"
 #include "cogl-pipeline-opengl-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-profile.h"
@@ -115,6 +118,16 @@ typedef struct _CoglJournalFlushState
   size_t indices_type_size;
 
   CoglPipeline *pipeline;
+
+  /* If this is set then it is used instead of the pipeline of the
+   * first entry in a batch. This is used to draw texture batches */
+  CoglPipeline *batch_pipeline;
+
+  /* The pipeline created for the last texture batch and the pipeline
+   * of the entry that it was created from. It is reused for the next
+   * texture batch if the state matches */
+  CoglPipeline *texture_batch_pipeline;
+  CoglPipeline *texture_batch_source;
 } CoglJournalFlushState;
 
 typedef void (*CoglJournalBatchCallback) (CoglJournalEntry *start,
@@ -124,6 +137,7 @@ typedef CoglBool (*CoglJournalBatchTest) (CoglJournalEntry *entry0,
                                           CoglJournalEntry *entry1);
 
 static void _cogl_journal_free (CoglJournal *journal);
+static void _cogl_journal_invalidate_pick_index (CoglJournal *journal);
 
 COGL_OBJECT_INTERNAL_DEFINE (Journal, journal);
 
@@ -141,6 +155,14 @@ _cogl_journal_free (CoglJournal *journal)
     if (journal->vbo_pool[i])
       cogl_object_unref (journal->vbo_pool[i]);
 
+  for (i = 0; i < G_N_ELEMENTS (journal->pick_cells); i++)
+    if (journal->pick_cells[i])
+      g_array_free (journal->pick_cells[i], TRUE);
+  if (journal->pick_polygons)
+    g_array_free (journal->pick_polygons, TRUE);
+  if (journal->pick_projection_entry)
+    cogl_matrix_entry_unref (journal->pick_projection_entry);
+
   g_slice_free (CoglJournal, journal);
 }
 
@@ -297,8 +319,11 @@ _cogl_journal_flush_modelview_and_entries (CoglJournalEntry *batch_start,
     g_print ("BATCHING:     modelview batch len = %d\n", batch_len);
 
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
-    _cogl_context_set_current_modelview_entry (ctx,
-                                               batch_start->modelview_entry);
+    {
+      _cogl_context_set_current_modelview_entry (ctx,
+                                                 batch_start->modelview_entry);
+      framebuffer->frame_stats.n_modelview_batches++;
+    }
 
   attributes = (CoglAttribute **)state->attributes->data;
 
@@ -430,7 +455,12 @@ _cogl_journal_flush_pipeline_and_entries (CoglJournalEntry *batch_start,
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
     g_print ("BATCHING:    pipeline batch len = %d\n", batch_len);
 
-  state->pipeline = batch_start->pipeline;
+  state->journal->framebuffer->frame_stats.n_pipeline_batches++;
+
+  if (state->batch_pipeline)
+    state->pipeline = state->batch_pipeline;
+  else
+    state->pipeline = batch_start->pipeline;
 
   /* If we haven't transformed the quads in software then we need to also break
    * up batches according to changes in the modelview matrix... */
@@ -464,6 +494,202 @@ compare_entry_pipelines (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
     return FALSE;
 }
 
+static CoglSnippet *
+get_texture_batch_snippet (CoglContext *ctx)
+{
+  if (ctx->journal_texture_batch_snippet == NULL)
+    {
+      GString *source = g_string_new (NULL);
+      int i;
+
+      /* The index of the texture is stored in the texture coordinates
+       * of the second layer. It is the same for all of the vertices
+       * of a quad but the branches aren't uniform across a fragment
+       * quad that straddles two rectangles, so the implicit derivatives
+       * of texture2D are undefined. get_batchable_texture() only
+       * accepts layers whose filtering doesn't depend on them */
+      g_string_append (source,
+                       "  float cogl_texture_index = cogl_tex_coord1_in.x;\n"
+                       "  if (cogl_texture_index < 0.5)\n"
+                       "    cogl_texel = texture2D (cogl_sampler, "
+                       "cogl_tex_coord.st);\n");
+
+      for (i = 1; i < ctx->max_batched_textures - 1; i++)
+        g_string_append_printf (source,
+                                "  else if (cogl_texture_index < %i.5)\n"
+                                "    cogl_texel = texture2D (cogl_sampler%i, "
+                                "cogl_tex_coord.st);\n",
+                                i, i);
+
+      g_string_append_printf (source,
+                              "  else\n"
+                              "    cogl_texel = texture2D (cogl_sampler%i, "
+                              "cogl_tex_coord.st);\n",
+                              ctx->max_batched_textures - 1);
+
+      ctx->journal_texture_batch_snippet =
+        cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP, NULL, NULL);
+      cogl_snippet_set_replace (ctx->journal_texture_batch_snippet,
+                                source->str);
+
+      g_string_free (source, TRUE);
+    }
+
+  return ctx->journal_texture_batch_snippet;
+}
+
+static CoglBool
+compare_pipelines_except_texture (CoglPipeline *pipeline0,
+                                  CoglPipeline *pipeline1)
+{
+  return _cogl_pipeline_equal (pipeline0,
+                               pipeline1,
+                               (COGL_PIPELINE_STATE_ALL &
+                                ~COGL_PIPELINE_STATE_COLOR),
+                               (COGL_PIPELINE_LAYER_STATE_ALL &
+                                ~COGL_PIPELINE_LAYER_STATE_TEXTURE_DATA),
+                               0);
+}
+
+/* Returns a pipeline that draws all of the entries in a texture batch.
+ * The texture of each entry is bound to the layer with the number of
+ * its texture index and a snippet on the first layer picks between
+ * them. The extra layers just pass on the result of the first one.
+ *
+ * The pipeline is reused for the rest of the flush and only its
+ * textures are replaced as long as the rest of the state matches.
+ * Otherwise creating it would cost more than the draw calls that are
+ * saved */
+static CoglPipeline *
+get_texture_batch_pipeline (CoglJournalFlushState *state,
+                            CoglJournalEntry *batch_start,
+                            int batch_len)
+{
+  CoglContext *ctx = state->ctx;
+  CoglTexture *textures[COGL_JOURNAL_MAX_BATCHED_TEXTURES];
+  CoglPipeline *pipeline = state->texture_batch_pipeline;
+  CoglColor color;
+  int i;
+
+  if (pipeline == NULL ||
+      !compare_pipelines_except_texture (state->texture_batch_source,
+                                         batch_start->pipeline))
+    {
+      CoglPipelineFilter min_filter, mag_filter;
+      CoglPipelineWrapMode wrap_mode_s, wrap_mode_t, wrap_mode_p;
+
+      if (pipeline)
+        cogl_object_unref (pipeline);
+
+      pipeline = cogl_pipeline_copy (batch_start->pipeline);
+
+      min_filter = cogl_pipeline_get_layer_min_filter (pipeline, 0);
+      mag_filter = cogl_pipeline_get_layer_mag_filter (pipeline, 0);
+      wrap_mode_s = cogl_pipeline_get_layer_wrap_mode_s (pipeline, 0);
+      wrap_mode_t = cogl_pipeline_get_layer_wrap_mode_t (pipeline, 0);
+      wrap_mode_p = cogl_pipeline_get_layer_wrap_mode_p (pipeline, 0);
+
+      /* All of the layers are added even if a batch uses fewer
+       * textures so that every texture batch can use the same
+       * program */
+      for (i = 1; i < ctx->max_batched_textures; i++)
+        {
+          cogl_pipeline_set_layer_combine (pipeline, i,
+                                           "RGBA = REPLACE (PREVIOUS)",
+                                           NULL);
+          cogl_pipeline_set_layer_filters (pipeline, i,
+                                           min_filter, mag_filter);
+          cogl_pipeline_set_layer_wrap_mode_s (pipeline, i, wrap_mode_s);
+          cogl_pipeline_set_layer_wrap_mode_t (pipeline, i, wrap_mode_t);
+          cogl_pipeline_set_layer_wrap_mode_p (pipeline, i, wrap_mode_p);
+        }
+
+      cogl_pipeline_add_layer_snippet (pipeline, 0,
+                                       get_texture_batch_snippet (ctx));
+
+      /* The journal keeps the entry's pipeline alive until the end
+       * of the flush */
+      state->texture_batch_pipeline = pipeline;
+      state->texture_batch_source = batch_start->pipeline;
+    }
+
+  memset (textures, 0, sizeof (textures));
+
+  for (i = 0; i < batch_len; i++)
+    textures[batch_start[i].texture_index] =
+      cogl_pipeline_get_layer_texture (batch_start[i].pipeline, 0);
+
+  /* Unused layers just repeat the first texture */
+  for (i = 0; i < ctx->max_batched_textures; i++)
+    cogl_pipeline_set_layer_texture (pipeline, i,
+                                     textures[i] ?
+                                     textures[i] : textures[0]);
+
+  /* The color comes from the vertices but it can still affect
+   * whether blending is enabled */
+  cogl_pipeline_get_color (batch_start->pipeline, &color);
+  cogl_pipeline_set_color (pipeline, &color);
+
+  return pipeline;
+}
+
+static CoglBool
+compare_entry_texture_batches (CoglJournalEntry *entry0,
+                               CoglJournalEntry *entry1)
+{
+  return entry0->texture_batch == entry1->texture_batch;
+}
+
+static void
+_cogl_journal_flush_texture_batch_and_entries (CoglJournalEntry *batch_start,
+                                               int               batch_len,
+                                               void             *data)
+{
+  CoglJournalFlushState *state = data;
+  CoglAttribute *index_attribute;
+
+  /* Entries that aren't part of a texture batch are split up by
+   * their pipelines as usual */
+  if (batch_start->texture_batch == -1)
+    {
+      batch_and_call (batch_start,
+                      batch_len,
+                      compare_entry_pipelines,
+                      _cogl_journal_flush_pipeline_and_entries,
+                      data);
+      return;
+    }
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING:    texture batch len = %d\n", batch_len);
+
+  state->journal->framebuffer->frame_stats.n_texture_batches++;
+
+  /* The texture indices are stored where the texture coordinates of
+   * the second layer would be. This is always available because the
+   * vertices are padded to at least two layers */
+  index_attribute =
+    cogl_attribute_new (state->attribute_buffer,
+                        "cogl_tex_coord1_in",
+                        state->stride,
+                        state->array_offset +
+                        (POS_STRIDE + COLOR_STRIDE) * 4 +
+                        TEX_STRIDE * 4,
+                        2,
+                        COGL_ATTRIBUTE_TYPE_FLOAT);
+  g_array_append_val (state->attributes, index_attribute);
+
+  state->batch_pipeline =
+    get_texture_batch_pipeline (state, batch_start, batch_len);
+
+  _cogl_journal_flush_pipeline_and_entries (batch_start, batch_len, data);
+
+  state->batch_pipeline = NULL;
+
+  g_array_set_size (state->attributes, state->attributes->len - 1);
+  cogl_object_unref (index_attribute);
+}
+
 typedef struct _CreateAttributeState
 {
   int current;
@@ -546,6 +772,8 @@ _cogl_journal_flush_texcoord_vbo_offsets_and_entries (
 
   COGL_TIMER_START (_cogl_uprof_context, time_flush_texcoord_pipeline_entries);
 
+  state->journal->framebuffer->frame_stats.n_layer_batches++;
+
   /* NB: attributes 0 and 1 are position and color */
 
   for (i = 2; i < state->attributes->len; i++)
@@ -562,8 +790,8 @@ _cogl_journal_flush_texcoord_vbo_offsets_and_entries (
 
   batch_and_call (batch_start,
                   batch_len,
-                  compare_entry_pipelines,
-                  _cogl_journal_flush_pipeline_and_entries,
+                  compare_entry_texture_batches,
+                  _cogl_journal_flush_texture_batch_and_entries,
                   data);
   COGL_TIMER_STOP (_cogl_uprof_context, time_flush_texcoord_pipeline_entries);
 }
@@ -602,6 +830,8 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
     g_print ("BATCHING:   vbo offset batch len = %d\n", batch_len);
 
+  state->journal->framebuffer->frame_stats.n_stride_batches++;
+
   /* XXX NB:
    * Our journal's vertex data is arranged as follows:
    * 4 vertices per quad:
@@ -722,6 +952,8 @@ _cogl_journal_flush_clip_stacks_and_entries (CoglJournalEntry *batch_start,
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
     g_print ("BATCHING:  clip stack batch len = %d\n", batch_len);
 
+  framebuffer->frame_stats.n_clip_batches++;
+
   _cogl_clip_stack_flush (batch_start->clip_stack, framebuffer);
 
   /* XXX: Because we are manually flushing clip state here we need to
@@ -1035,6 +1267,122 @@ compare_entry_clip_stacks (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
   return entry0->clip_stack == entry1->clip_stack;
 }
 
+/* Returns the texture of the entry if it could be drawn as part of a
+ * texture batch or NULL otherwise */
+static CoglTexture *
+get_batchable_texture (CoglJournalEntry *entry)
+{
+  CoglPipelineLayer *layer;
+  CoglTexture *texture;
+  CoglPipelineFilter min_filter, mag_filter;
+  GList *l;
+
+  if (entry->n_layers != 1)
+    return NULL;
+
+  /* The other textures are added as layers after the first one */
+  layer = _cogl_pipeline_get_layer_with_flags (entry->pipeline,
+                                               0,
+                                               COGL_PIPELINE_GET_LAYER_NO_CREATE);
+  if (layer == NULL)
+    return NULL;
+
+  texture = _cogl_pipeline_layer_get_texture_real (layer);
+  if (texture == NULL || !cogl_is_texture_2d (texture))
+    return NULL;
+
+  /* The snippet samples inside non-uniform branches so the level of
+   * detail can't be relied on. Without mipmaps and with the same
+   * filter either way it doesn't change the result */
+  _cogl_pipeline_layer_get_filters (layer, &min_filter, &mag_filter);
+  if (min_filter != mag_filter ||
+      (min_filter != COGL_PIPELINE_FILTER_NEAREST &&
+       min_filter != COGL_PIPELINE_FILTER_LINEAR))
+    return NULL;
+
+  /* The texture lookup is replaced to pick the texture */
+  layer =
+    _cogl_pipeline_layer_get_authority (layer,
+                                        COGL_PIPELINE_LAYER_STATE_FRAGMENT_SNIPPETS);
+  for (l = layer->big_state->fragment_snippets.entries; l; l = l->next)
+    {
+      CoglSnippet *snippet = l->data;
+
+      if (snippet->hook == COGL_SNIPPET_HOOK_TEXTURE_LOOKUP)
+        return NULL;
+    }
+
+  return texture;
+}
+
+/* Groups runs of consecutive entries that would be drawn the same
+ * way apart from their texture into texture batches of up to
+ * ctx->max_batched_textures different textures. This has to be done
+ * before the vertices are uploaded because the texture index is
+ * stored in the vertices */
+static void
+assign_texture_batches (CoglJournal *journal)
+{
+  CoglContext *ctx = journal->framebuffer->context;
+  CoglJournalEntry *entries = (CoglJournalEntry *) journal->entries->data;
+  int n_entries = journal->entries->len;
+  CoglTexture *textures[COGL_JOURNAL_MAX_BATCHED_TEXTURES];
+  int next_batch = 0;
+  int i = 0;
+
+  while (i < n_entries)
+    {
+      CoglJournalEntry *batch_start = entries + i;
+      int n_textures, batch_len, j;
+
+      textures[0] = get_batchable_texture (batch_start);
+      if (textures[0] == NULL)
+        {
+          i++;
+          continue;
+        }
+
+      n_textures = 1;
+      batch_start->texture_index = 0;
+
+      for (batch_len = 1; i + batch_len < n_entries; batch_len++)
+        {
+          CoglJournalEntry *entry = batch_start + batch_len;
+          CoglTexture *texture = get_batchable_texture (entry);
+
+          if (texture == NULL ||
+              entry->clip_stack != batch_start->clip_stack ||
+              !compare_pipelines_except_texture (batch_start->pipeline,
+                                                 entry->pipeline))
+            break;
+
+          for (j = 0; j < n_textures; j++)
+            if (textures[j] == texture)
+              break;
+
+          if (j == n_textures)
+            {
+              if (n_textures >= ctx->max_batched_textures)
+                break;
+              textures[n_textures++] = texture;
+            }
+
+          entry->texture_index = j;
+        }
+
+      /* A run with only one texture is batched just as well by
+       * comparing the pipelines */
+      if (n_textures > 1)
+        {
+          for (j = 0; j < batch_len; j++)
+            batch_start[j].texture_batch = next_batch;
+          next_batch++;
+        }
+
+      i += batch_len;
+    }
+}
+
 /* Gets a new vertex array from the pool. A reference is taken on the
    array so it can be treated as if it was just newly allocated */
 static CoglAttributeBuffer *
@@ -1162,6 +1510,19 @@ upload_vertices (CoglJournal *journal,
           tout[vb_stride * 3 + 1 + i * 2] = tin[i * 2 + 1];
         }
 
+      /* Entries in a texture batch only have one layer so the index
+       * of their texture is stored in the padding for the second */
+      if (entry->texture_batch != -1)
+        {
+          float *iout = vout + POS_STRIDE + COLOR_STRIDE + TEX_STRIDE;
+
+          for (i = 0; i < 4; i++)
+            {
+              iout[vb_stride * i] = entry->texture_index;
+              iout[vb_stride * i + 1] = 0.0f;
+            }
+        }
+
       vin += array_stride * 2;
       vout += vb_stride * 4;
     }
@@ -1193,6 +1554,8 @@ _cogl_journal_discard (CoglJournal *journal)
   journal->needed_vbo_len = 0;
   journal->fast_read_pixel_count = 0;
 
+  _cogl_journal_invalidate_pick_index (journal);
+
   /* The journal only holds a reference to the framebuffer while the
      journal is not empty */
   cogl_object_unref (journal->framebuffer);
@@ -1318,10 +1681,14 @@ _cogl_journal_flush (CoglJournal *journal)
   /* Note: we start the timer after flushing dependency journals so
    * that the timer isn't started recursively. */
   COGL_TIMER_START (_cogl_uprof_context, flush_timer);
+  COGL_GPU_TIMER_START (ctx, flush_timer);
 
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
     g_print ("BATCHING: journal len = %d\n", journal->entries->len);
 
+  framebuffer->frame_stats.n_journal_flushes++;
+  framebuffer->frame_stats.n_journal_entries += journal->entries->len;
+
   /* NB: the journal deals with flushing the modelview stack and clip
      state manually */
   _cogl_framebuffer_flush_state (framebuffer,
@@ -1353,6 +1720,14 @@ _cogl_journal_flush (CoglJournal *journal)
                       &state); /* data */
     }
 
+  if (framebuffer->texture_batching_enabled &&
+      _cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_TEXTURE_BATCHING))
+    assign_texture_batches (journal);
+
+  state.batch_pipeline = NULL;
+  state.texture_batch_pipeline = NULL;
+  state.texture_batch_source = NULL;
+
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
   state.attribute_buffer =
@@ -1380,7 +1755,10 @@ _cogl_journal_flush (CoglJournal *journal)
    *      changes we need to call glTexCoordPointer to inform GL of new VBO
    *      offsets.
    * 4) We then split according to compatible Cogl pipelines:
-   *      This is where we flush pipeline state
+   *      This is where we flush pipeline state. If texture batching is
+   *      enabled then runs of entries that only differ by their texture
+   *      are drawn together with a pipeline that binds all of the
+   *      textures.
    * 5) Finally we split according to modelview matrix changes:
    *      This is when we finally tell GL to draw something.
    *      Note: Splitting by modelview changes is skipped when are doing the
@@ -1398,6 +1776,11 @@ _cogl_journal_flush (CoglJournal *journal)
 
   cogl_object_unref (state.attribute_buffer);
 
+  if (state.texture_batch_pipeline)
+    cogl_object_unref (state.texture_batch_pipeline);
+
+  COGL_GPU_TIMER_STOP (ctx, flush_timer);
+
   COGL_TIMER_START (_cogl_uprof_context, discard_timer);
   _cogl_journal_discard (journal);
   COGL_TIMER_STOP (_cogl_uprof_context, discard_timer);
@@ -1516,6 +1899,8 @@ _cogl_journal_log_quad (CoglJournal  *journal,
 
   entry->n_layers = n_layers;
   entry->array_offset = next_vert;
+  entry->texture_batch = -1;
+  entry->texture_index = 0;
 
   final_pipeline = pipeline;
 
@@ -1728,6 +2113,187 @@ try_checking_point_hits_entry_after_clipping (CoglFramebuffer *framebuffer,
   return TRUE;
 }
 
+static void
+_cogl_journal_invalidate_pick_index (CoglJournal *journal)
+{
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (journal->pick_cells); i++)
+    if (journal->pick_cells[i])
+      g_array_set_size (journal->pick_cells[i], 0);
+
+  if (journal->pick_polygons)
+    g_array_set_size (journal->pick_polygons, 0);
+
+  journal->pick_n_indexed_entries = 0;
+
+  if (journal->pick_projection_entry)
+    {
+      cogl_matrix_entry_unref (journal->pick_projection_entry);
+      journal->pick_projection_entry = NULL;
+    }
+}
+
+static int
+pick_grid_cell (float pos, int size)
+{
+  int cell;
+
+  /* This also catches NaNs from degenerate projections */
+  if (!(pos >= 0.0f))
+    return 0;
+
+  cell = pos * COGL_JOURNAL_PICK_GRID_SIZE / size;
+
+  return MIN (cell, COGL_JOURNAL_PICK_GRID_SIZE - 1);
+}
+
+static void
+_cogl_journal_update_pick_index (CoglJournal *journal)
+{
+  CoglFramebuffer *framebuffer = journal->framebuffer;
+  CoglMatrixEntry *projection_entry =
+    _cogl_framebuffer_get_projection_entry (framebuffer);
+  int width = cogl_framebuffer_get_width (framebuffer);
+  int height = cogl_framebuffer_get_height (framebuffer);
+  int i;
+
+  if (journal->pick_projection_entry != projection_entry ||
+      journal->pick_viewport_age != framebuffer->viewport_age)
+    {
+      _cogl_journal_invalidate_pick_index (journal);
+      journal->pick_projection_entry = cogl_matrix_entry_ref (projection_entry);
+      journal->pick_viewport_age = framebuffer->viewport_age;
+    }
+
+  if (journal->pick_polygons == NULL)
+    journal->pick_polygons = g_array_new (FALSE, FALSE, sizeof (float) * 16);
+
+  g_array_set_size (journal->pick_polygons, journal->entries->len);
+
+  for (i = journal->pick_n_indexed_entries; i < journal->entries->len; i++)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+      float *vertices = &g_array_index (journal->vertices, float,
+                                        entry->array_offset + 1);
+      float *poly = &g_array_index (journal->pick_polygons, float, i * 16);
+      float x0, y0, x1, y1;
+      int cx0, cy0, cx1, cy1, cx, cy;
+      int v;
+
+      entry_to_screen_polygon (framebuffer, entry, vertices, poly);
+
+      x0 = x1 = poly[0];
+      y0 = y1 = poly[1];
+      for (v = 1; v < 4; v++)
+        {
+          x0 = MIN (x0, poly[v * 4]);
+          x1 = MAX (x1, poly[v * 4]);
+          y0 = MIN (y0, poly[v * 4 + 1]);
+          y1 = MAX (y1, poly[v * 4 + 1]);
+        }
+
+      cx0 = pick_grid_cell (x0, width);
+      cx1 = pick_grid_cell (x1, width);
+      cy0 = pick_grid_cell (y0, height);
+      cy1 = pick_grid_cell (y1, height);
+
+      for (cy = cy0; cy <= cy1; cy++)
+        for (cx = cx0; cx <= cx1; cx++)
+          {
+            GArray **cell =
+              journal->pick_cells + cy * COGL_JOURNAL_PICK_GRID_SIZE + cx;
+
+            if (*cell == NULL)
+              *cell = g_array_new (FALSE, FALSE, sizeof (int));
+
+            g_array_append_val (*cell, i);
+          }
+    }
+
+  journal->pick_n_indexed_entries = journal->entries->len;
+}
+
+typedef enum
+{
+  PICK_RESULT_MISS,
+  PICK_RESULT_HIT,
+  PICK_RESULT_UNKNOWN
+} PickResult;
+
+static PickResult
+try_read_pixel_from_entry (CoglJournal *journal,
+                           CoglJournalEntry *entry,
+                           const float *poly,
+                           int x,
+                           int y,
+                           CoglBitmap *bitmap,
+                           CoglBool *found_intersection)
+{
+  CoglContext *ctx = journal->framebuffer->context;
+  uint8_t *color = (uint8_t *)&g_array_index (journal->vertices, float,
+                                            entry->array_offset);
+  float *vertices = (float *)color + 1;
+  uint8_t *pixel;
+  CoglError *ignore_error;
+
+  if (!_cogl_util_point_in_screen_poly (x, y, (void *) poly,
+                                        sizeof (float) * 4, 4))
+    return PICK_RESULT_MISS;
+
+  if (entry->clip_stack)
+    {
+      CoglBool hit;
+
+      if (!try_checking_point_hits_entry_after_clipping (journal->framebuffer,
+                                                         entry,
+                                                         vertices,
+                                                         x, y, &hit))
+        return PICK_RESULT_UNKNOWN; /* hit couldn't be determined */
+
+      if (!hit)
+        return PICK_RESULT_MISS;
+    }
+
+  *found_intersection = TRUE;
+
+  /* If we find that the rectangle the point of interest
+   * intersects has any state more complex than a constant opaque
+   * color then we bail out. */
+  if (!_cogl_pipeline_equal (ctx->opaque_color_pipeline, entry->pipeline,
+                             (COGL_PIPELINE_STATE_ALL &
+                              ~COGL_PIPELINE_STATE_COLOR),
+                             COGL_PIPELINE_LAYER_STATE_ALL,
+                             0))
+    return PICK_RESULT_UNKNOWN;
+
+
+  /* we currently only care about cases where the premultiplied or
+   * unpremultipled colors are equivalent... */
+  if (color[3] != 0xff)
+    return PICK_RESULT_UNKNOWN;
+
+  pixel = _cogl_bitmap_map (bitmap,
+                            COGL_BUFFER_ACCESS_WRITE,
+                            COGL_BUFFER_MAP_HINT_DISCARD,
+                            &ignore_error);
+  if (pixel == NULL)
+    {
+      cogl_error_free (ignore_error);
+      return PICK_RESULT_UNKNOWN;
+    }
+
+  pixel[0] = color[0];
+  pixel[1] = color[1];
+  pixel[2] = color[2];
+  pixel[3] = color[3];
+
+  _cogl_bitmap_unmap (bitmap);
+
+  return PICK_RESULT_HIT;
+}
+
 CoglBool
 _cogl_journal_try_read_pixel (CoglJournal *journal,
                               int x,
@@ -1735,29 +2301,17 @@ _cogl_journal_try_read_pixel (CoglJournal *journal,
                               CoglBitmap *bitmap,
                               CoglBool *found_intersection)
 {
-  CoglContext *ctx;
+  CoglFramebuffer *framebuffer = journal->framebuffer;
   CoglPixelFormat format;
+  PickResult result;
   int i;
 
-  /* XXX: this number has been plucked out of thin air, but the idea
-   * is that if so many pixels are being read from the same un-changed
-   * journal than we expect that it will be more efficient to fail
-   * here so we end up flushing and rendering the journal so that
-   * further reads can directly read from the framebuffer. There will
-   * be a bit more lag to flush the render but if there are going to
-   * continue being lots of arbitrary single pixel reads they will end
-   * up faster in the end. */
-  if (journal->fast_read_pixel_count > 50)
-    return FALSE;
-
   format = cogl_bitmap_get_format (bitmap);
 
   if (format != COGL_PIXEL_FORMAT_RGBA_8888_PRE &&
       format != COGL_PIXEL_FORMAT_RGBA_8888)
     return FALSE;
 
-  ctx = _cogl_bitmap_get_context (bitmap);
-
   *found_intersection = FALSE;
 
   /* NB: The most recently added journal entry is the last entry, and
@@ -1767,76 +2321,75 @@ _cogl_journal_try_read_pixel (CoglJournal *journal,
    * entries and so our fast read-pixel just needs to walk backwards
    * through the journal entries trying to intersect each entry with
    * the given point of interest. */
-  for (i = journal->entries->len - 1; i >= 0; i--)
+
+  /* For large journals the entries are indexed in a screen-space
+   * grid so only the entries overlapping the cell containing the
+   * point need to be checked. The screen polygons are also only
+   * calculated once so repeated reads from the same journal stay
+   * cheap. */
+  if (journal->entries->len >= COGL_JOURNAL_PICK_INDEX_THRESHOLD &&
+      x >= 0 && x < cogl_framebuffer_get_width (framebuffer) &&
+      y >= 0 && y < cogl_framebuffer_get_height (framebuffer))
     {
-      CoglJournalEntry *entry =
-        &g_array_index (journal->entries, CoglJournalEntry, i);
-      uint8_t *color = (uint8_t *)&g_array_index (journal->vertices, float,
-                                                entry->array_offset);
-      float *vertices = (float *)color + 1;
-      float poly[16];
-      CoglFramebuffer *framebuffer = journal->framebuffer;
-      uint8_t *pixel;
-      CoglError *ignore_error;
+      GArray *cell;
 
-      entry_to_screen_polygon (framebuffer, entry, vertices, poly);
+      _cogl_journal_update_pick_index (journal);
 
-      if (!_cogl_util_point_in_screen_poly (x, y, poly, sizeof (float) * 4, 4))
-        continue;
+      cell = journal->pick_cells[pick_grid_cell (y, framebuffer->height) *
+                                 COGL_JOURNAL_PICK_GRID_SIZE +
+                                 pick_grid_cell (x, framebuffer->width)];
 
-      if (entry->clip_stack)
+      for (i = cell ? (int) cell->len - 1 : -1; i >= 0; i--)
         {
-          CoglBool hit;
-
-          if (!try_checking_point_hits_entry_after_clipping (framebuffer,
-                                                             entry,
-                                                             vertices,
-                                                             x, y, &hit))
-            return FALSE; /* hit couldn't be determined */
-
-          if (!hit)
-            continue;
+          int entry_index = g_array_index (cell, int, i);
+          CoglJournalEntry *entry =
+            &g_array_index (journal->entries, CoglJournalEntry, entry_index);
+          const float *poly = &g_array_index (journal->pick_polygons, float,
+                                              entry_index * 16);
+
+          result = try_read_pixel_from_entry (journal, entry, poly,
+                                              x, y, bitmap,
+                                              found_intersection);
+          if (result == PICK_RESULT_HIT)
+            break;
+          if (result == PICK_RESULT_UNKNOWN)
+            return FALSE;
         }
 
-      *found_intersection = TRUE;
-
-      /* If we find that the rectangle the point of interest
-       * intersects has any state more complex than a constant opaque
-       * color then we bail out. */
-      if (!_cogl_pipeline_equal (ctx->opaque_color_pipeline, entry->pipeline,
-                                 (COGL_PIPELINE_STATE_ALL &
-                                  ~COGL_PIPELINE_STATE_COLOR),
-                                 COGL_PIPELINE_LAYER_STATE_ALL,
-                                 0))
-        return FALSE;
-
-
-      /* we currently only care about cases where the premultiplied or
-       * unpremultipled colors are equivalent... */
-      if (color[3] != 0xff)
-        return FALSE;
+      return TRUE;
+    }
 
-      pixel = _cogl_bitmap_map (bitmap,
-                                COGL_BUFFER_ACCESS_WRITE,
-                                COGL_BUFFER_MAP_HINT_DISCARD,
-                                &ignore_error);
-      if (pixel == NULL)
-        {
-          cogl_error_free (ignore_error);
-          return FALSE;
-        }
+  /* XXX: this number has been plucked out of thin air, but the idea
+   * is that if so many pixels are being read from the same un-changed
+   * journal than we expect that it will be more efficient to fail
+   * here so we end up flushing and rendering the journal so that
+   * further reads can directly read from the framebuffer. There will
+   * be a bit more lag to flush the render but if there are going to
+   * continue being lots of arbitrary single pixel reads they will end
+   * up faster in the end. This doesn't apply to reads using the pick
+   * index because they don't have to reproject every entry. */
+  if (journal->fast_read_pixel_count > 50)
+    return FALSE;
 
-      pixel[0] = color[0];
-      pixel[1] = color[1];
-      pixel[2] = color[2];
-      pixel[3] = color[3];
+  for (i = journal->entries->len - 1; i >= 0; i--)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+      float *vertices = &g_array_index (journal->vertices, float,
+                                        entry->array_offset + 1);
+      float poly[16];
 
-      _cogl_bitmap_unmap (bitmap);
+      entry_to_screen_polygon (framebuffer, entry, vertices, poly);
 
-      goto success;
+      result = try_read_pixel_from_entry (journal, entry, poly,
+                                          x, y, bitmap,
+                                          found_intersection);
+      if (result == PICK_RESULT_HIT)
+        break;
+      if (result == PICK_RESULT_UNKNOWN)
+        return FALSE;
     }
 
-success:
   journal->fast_read_pixel_count++;
   return TRUE;
 }
@@ -0,0 +1,93 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_MEMORY_STATS_PRIVATE_H
+#define __COGL_MEMORY_STATS_PRIVATE_H
+
+#include "cogl-memory-stats.h"
+#include "cogl-closure-list-private.h"
+
+typedef enum
+{
+  COGL_MEMORY_TYPE_TEXTURE,
+  COGL_MEMORY_TYPE_ATLAS,
+  COGL_MEMORY_TYPE_SLICED_TEXTURE,
+  COGL_MEMORY_TYPE_FRAMEBUFFER,
+  COGL_MEMORY_TYPE_BUFFER,
+
+  COGL_N_MEMORY_TYPES
+} CoglMemoryType;
+
+typedef struct _CoglMemoryAccounting
+{
+  size_t usage[COGL_N_MEMORY_TYPES];
+  int n_programs;
+
+  /* 0 if there is no budget */
+  size_t budget;
+
+  CoglList pressure_closures;
+  /* Idle closure used to invoke the pressure callbacks outside of
+   * the allocation that went over the budget */
+  CoglClosure *pressure_idle;
+} CoglMemoryAccounting;
+
+void
+_cogl_memory_accounting_init (CoglContext *context);
+
+void
+_cogl_memory_accounting_destroy (CoglContext *context);
+
+/*
+ * _cogl_memory_add:
+ * @context: A #CoglContext
+ * @type: The category to add the memory to
+ * @size: The number of bytes that were allocated
+ *
+ * Records an allocation. If this puts the context over its budget
+ * then the memory pressure callbacks will be invoked the next time
+ * the renderer is dispatched.
+ */
+void
+_cogl_memory_add (CoglContext *context,
+                  CoglMemoryType type,
+                  size_t size);
+
+void
+_cogl_memory_remove (CoglContext *context,
+                     CoglMemoryType type,
+                     size_t size);
+
+void
+_cogl_memory_add_program (CoglContext *context);
+
+void
+_cogl_memory_remove_program (CoglContext *context);
+
+#endif /* __COGL_MEMORY_STATS_PRIVATE_H */
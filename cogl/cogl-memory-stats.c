@@ -0,0 +1,319 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "cogl-memory-stats-private.h"
+#include "cogl-context-private.h"
+#include "cogl-poll-private.h"
+#include "cogl-pipeline-cache.h"
+
+#include <test-fixtures/test-unit.h>
+
+void
+_cogl_memory_accounting_init (CoglContext *context)
+{
+  CoglMemoryAccounting *memory = &context->memory;
+
+  memset (memory->usage, 0, sizeof (memory->usage));
+  memory->n_programs = 0;
+  memory->budget = 0;
+  memory->pressure_idle = NULL;
+  _cogl_list_init (&memory->pressure_closures);
+}
+
+void
+_cogl_memory_accounting_destroy (CoglContext *context)
+{
+  CoglMemoryAccounting *memory = &context->memory;
+
+  if (memory->pressure_idle)
+    {
+      _cogl_closure_disconnect (memory->pressure_idle);
+      memory->pressure_idle = NULL;
+    }
+
+  _cogl_closure_list_disconnect_all (&memory->pressure_closures);
+}
+
+static size_t
+get_total (CoglMemoryAccounting *memory)
+{
+  size_t total = 0;
+  int i;
+
+  for (i = 0; i < COGL_N_MEMORY_TYPES; i++)
+    total += memory->usage[i];
+
+  return total;
+}
+
+static CoglBool
+is_over_budget (CoglMemoryAccounting *memory)
+{
+  return memory->budget && get_total (memory) > memory->budget;
+}
+
+void
+cogl_context_get_memory_stats (CoglContext *context,
+                               CoglMemoryStats *stats)
+{
+  CoglMemoryAccounting *memory = &context->memory;
+
+  stats->texture_bytes = memory->usage[COGL_MEMORY_TYPE_TEXTURE];
+  stats->atlas_bytes = memory->usage[COGL_MEMORY_TYPE_ATLAS];
+  stats->sliced_texture_bytes =
+    memory->usage[COGL_MEMORY_TYPE_SLICED_TEXTURE];
+  stats->framebuffer_bytes = memory->usage[COGL_MEMORY_TYPE_FRAMEBUFFER];
+  stats->buffer_bytes = memory->usage[COGL_MEMORY_TYPE_BUFFER];
+  stats->n_programs = memory->n_programs;
+  stats->total_bytes = get_total (memory);
+  stats->budget = memory->budget;
+}
+
+static void
+dispatch_memory_pressure_cb (void *user_data)
+{
+  CoglContext *context = user_data;
+  CoglMemoryAccounting *memory = &context->memory;
+  CoglMemoryStats stats;
+  CoglClosure *closure, *tmp;
+
+  _cogl_closure_disconnect (memory->pressure_idle);
+  memory->pressure_idle = NULL;
+
+  if (!is_over_budget (memory))
+    return;
+
+  /* Unused pipeline templates hold on to linked programs which can
+   * always be regenerated so they are dropped before asking the
+   * application to free anything */
+  _cogl_pipeline_cache_prune (context->pipeline_cache);
+
+  _cogl_list_for_each_safe (closure, tmp, &memory->pressure_closures, link)
+    {
+      CoglMemoryPressureCallback callback = closure->function;
+
+      if (!is_over_budget (memory))
+        break;
+
+      cogl_context_get_memory_stats (context, &stats);
+      callback (context, &stats, closure->user_data);
+    }
+}
+
+static void
+check_budget (CoglContext *context)
+{
+  CoglMemoryAccounting *memory = &context->memory;
+
+  if (memory->pressure_idle || !is_over_budget (memory))
+    return;
+
+  /* The context may still be being constructed */
+  if (context->display == NULL)
+    return;
+
+  memory->pressure_idle =
+    _cogl_poll_renderer_add_idle (context->display->renderer,
+                                  dispatch_memory_pressure_cb,
+                                  context,
+                                  NULL);
+}
+
+void
+cogl_context_set_memory_budget (CoglContext *context,
+                                size_t budget)
+{
+  context->memory.budget = budget;
+
+  check_budget (context);
+}
+
+size_t
+cogl_context_get_memory_budget (CoglContext *context)
+{
+  return context->memory.budget;
+}
+
+CoglMemoryPressureClosure *
+cogl_context_add_memory_pressure_callback (CoglContext *context,
+                                           CoglMemoryPressureCallback callback,
+                                           void *user_data,
+                                           CoglUserDataDestroyCallback destroy)
+{
+  return _cogl_closure_list_add (&context->memory.pressure_closures,
+                                 callback,
+                                 user_data,
+                                 destroy);
+}
+
+void
+cogl_context_remove_memory_pressure_callback (CoglContext *context,
+                                              CoglMemoryPressureClosure *closure)
+{
+  _COGL_RETURN_IF_FAIL (closure);
+
+  _cogl_closure_disconnect (closure);
+}
+
+void
+_cogl_memory_add (CoglContext *context,
+                  CoglMemoryType type,
+                  size_t size)
+{
+  if (size == 0)
+    return;
+
+  context->memory.usage[type] += size;
+
+  check_budget (context);
+}
+
+void
+_cogl_memory_remove (CoglContext *context,
+                     CoglMemoryType type,
+                     size_t size)
+{
+  CoglMemoryAccounting *memory = &context->memory;
+
+  _COGL_RETURN_IF_FAIL (memory->usage[type] >= size);
+
+  memory->usage[type] -= size;
+}
+
+void
+_cogl_memory_add_program (CoglContext *context)
+{
+  context->memory.n_programs++;
+}
+
+void
+_cogl_memory_remove_program (CoglContext *context)
+{
+  context->memory.n_programs--;
+}
+
+typedef struct
+{
+  int n_calls;
+  size_t last_total;
+  /* Number of bytes the callback should release */
+  size_t release;
+} CheckMemoryState;
+
+static void
+check_memory_pressure_cb (CoglContext *context,
+                          const CoglMemoryStats *stats,
+                          void *user_data)
+{
+  CheckMemoryState *state = user_data;
+
+  state->n_calls++;
+  state->last_total = stats->total_bytes;
+
+  _cogl_memory_remove (context, COGL_MEMORY_TYPE_BUFFER, state->release);
+}
+
+static void
+dispatch_renderer (CoglContext *context)
+{
+  CoglRenderer *renderer = cogl_context_get_renderer (context);
+  CoglPollFD *poll_fds;
+  int n_poll_fds;
+  int64_t timeout;
+
+  cogl_poll_renderer_get_info (renderer, &poll_fds, &n_poll_fds, &timeout);
+  cogl_poll_renderer_dispatch (renderer, poll_fds, n_poll_fds);
+}
+
+UNIT_TEST (check_memory_budget,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  CheckMemoryState first = { 0, 0, 600 }, second = { 0, 0, 0 };
+  CoglMemoryPressureClosure *first_closure, *second_closure;
+  CoglMemoryStats base, stats;
+
+  cogl_context_get_memory_stats (test_ctx, &base);
+
+  cogl_context_set_memory_budget (test_ctx, base.total_bytes + 1000);
+  g_assert_cmpint (cogl_context_get_memory_budget (test_ctx),
+                   ==,
+                   base.total_bytes + 1000);
+
+  /* The most recently added callback is called first */
+  second_closure =
+    cogl_context_add_memory_pressure_callback (test_ctx,
+                                               check_memory_pressure_cb,
+                                               &second,
+                                               NULL);
+  first_closure =
+    cogl_context_add_memory_pressure_callback (test_ctx,
+                                               check_memory_pressure_cb,
+                                               &first,
+                                               NULL);
+
+  /* Staying under the budget doesn't invoke anything */
+  _cogl_memory_add (test_ctx, COGL_MEMORY_TYPE_BUFFER, 800);
+  cogl_context_get_memory_stats (test_ctx, &stats);
+  g_assert_cmpint (stats.buffer_bytes, ==, base.buffer_bytes + 800);
+  g_assert_cmpint (stats.total_bytes, ==, base.total_bytes + 800);
+  dispatch_renderer (test_ctx);
+  g_assert_cmpint (first.n_calls, ==, 0);
+
+  /* Going over it only invokes the callbacks once dispatched. The
+   * first callback frees enough memory so the second one is skipped */
+  _cogl_memory_add (test_ctx, COGL_MEMORY_TYPE_BUFFER, 400);
+  _cogl_memory_add (test_ctx, COGL_MEMORY_TYPE_BUFFER, 100);
+  g_assert_cmpint (first.n_calls, ==, 0);
+  dispatch_renderer (test_ctx);
+  g_assert_cmpint (first.n_calls, ==, 1);
+  g_assert_cmpint (first.last_total, ==, base.total_bytes + 1300);
+  g_assert_cmpint (second.n_calls, ==, 0);
+
+  /* If the first callback doesn't free enough the second one is
+   * called too */
+  first.release = 0;
+  second.release = 700;
+  _cogl_memory_add (test_ctx, COGL_MEMORY_TYPE_BUFFER, 500);
+  dispatch_renderer (test_ctx);
+  g_assert_cmpint (first.n_calls, ==, 2);
+  g_assert_cmpint (second.n_calls, ==, 1);
+
+  cogl_context_get_memory_stats (test_ctx, &stats);
+  g_assert_cmpint (stats.total_bytes, ==, base.total_bytes + 500);
+
+  cogl_context_remove_memory_pressure_callback (test_ctx, first_closure);
+  cogl_context_remove_memory_pressure_callback (test_ctx, second_closure);
+  _cogl_memory_remove (test_ctx, COGL_MEMORY_TYPE_BUFFER, 500);
+  cogl_context_set_memory_budget (test_ctx, 0);
+}
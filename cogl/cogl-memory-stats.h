@@ -0,0 +1,229 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_MEMORY_STATS_H__
+#define __COGL_MEMORY_STATS_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-object.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-memory-stats
+ * @short_description: Functions for tracking the GPU memory used by
+ *   a context
+ *
+ * Cogl keeps an estimate of how much memory is held by the GPU
+ * resources that it allocates for a #CoglContext. The size of a
+ * texture is calculated from its internal format and the size of
+ * each mipmap level that has been allocated so it doesn't include any
+ * padding or alignment that the driver adds. Textures created from
+ * foreign GL objects are not counted because their memory is owned
+ * by someone else.
+ *
+ * An application can set a memory budget with
+ * cogl_context_set_memory_budget(). Whenever the total goes over the
+ * budget Cogl first drops any unused entries from its internal
+ * caches and then notifies the callbacks registered with
+ * cogl_context_add_memory_pressure_callback() so that application
+ * level caches such as glyph caches can be trimmed. The callbacks are
+ * invoked from cogl_poll_renderer_dispatch() rather than from the
+ * allocation that pushed the total over the budget so it is safe for
+ * them to destroy any Cogl object.
+ */
+
+/**
+ * CoglMemoryStats:
+ * @texture_bytes: The memory used by textures that aren't counted in
+ *   any of the other categories
+ * @atlas_bytes: The memory used by the textures backing the shared
+ *   texture atlases
+ * @sliced_texture_bytes: The memory used by the slices of
+ *   #CoglTexture2DSliced textures
+ * @framebuffer_bytes: The memory used by the depth and stencil
+ *   buffers of offscreen framebuffers
+ * @buffer_bytes: The memory used by attribute, index and pixel
+ *   buffers
+ * @n_programs: The number of GLSL programs that have been linked.
+ *   The driver doesn't report how much memory these use so only the
+ *   number is tracked
+ * @total_bytes: The sum of all of the byte counts above
+ * @budget: The budget set with cogl_context_set_memory_budget() or 0
+ *
+ * A snapshot of the memory held by a #CoglContext, filled in by
+ * cogl_context_get_memory_stats().
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef struct _CoglMemoryStats
+{
+  size_t texture_bytes;
+  size_t atlas_bytes;
+  size_t sliced_texture_bytes;
+  size_t framebuffer_bytes;
+  size_t buffer_bytes;
+  int n_programs;
+
+  size_t total_bytes;
+  size_t budget;
+} CoglMemoryStats;
+
+/**
+ * cogl_context_get_memory_stats:
+ * @context: A #CoglContext
+ * @stats: (out): A #CoglMemoryStats to fill in
+ *
+ * Retrieves an estimate of the memory currently held by @context
+ * broken down by the type of resource.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_context_get_memory_stats (CoglContext *context,
+                               CoglMemoryStats *stats);
+
+/**
+ * cogl_context_set_memory_budget:
+ * @context: A #CoglContext
+ * @budget: The number of bytes that the context should try to stay
+ *   under or 0 to disable the budget
+ *
+ * Sets a limit on the total memory reported by
+ * cogl_context_get_memory_stats(). Cogl never refuses an allocation
+ * because of the budget. Instead, going over it causes the memory
+ * pressure callbacks to be invoked so that caches can be shrunk.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_context_set_memory_budget (CoglContext *context,
+                                size_t budget);
+
+/**
+ * cogl_context_get_memory_budget:
+ * @context: A #CoglContext
+ *
+ * Return value: The budget set with cogl_context_set_memory_budget()
+ *   or 0 if there is no budget
+ * Since: 2.0
+ * Stability: unstable
+ */
+size_t
+cogl_context_get_memory_budget (CoglContext *context);
+
+/**
+ * CoglMemoryPressureCallback:
+ * @context: The #CoglContext that is over its budget
+ * @stats: The current memory statistics of @context
+ * @user_data: The private data passed to
+ *   cogl_context_add_memory_pressure_callback()
+ *
+ * The callback prototype used with
+ * cogl_context_add_memory_pressure_callback(). The callback should
+ * release whatever resources it can afford to recreate later. The
+ * difference between @stats->total_bytes and @stats->budget gives
+ * the amount that would need to be freed to get back under the
+ * budget.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef void (* CoglMemoryPressureCallback) (CoglContext *context,
+                                             const CoglMemoryStats *stats,
+                                             void *user_data);
+
+/**
+ * CoglMemoryPressureClosure:
+ *
+ * An opaque type that tracks a #CoglMemoryPressureCallback and
+ * associated user data. A #CoglMemoryPressureClosure pointer will be
+ * returned from cogl_context_add_memory_pressure_callback() and it
+ * allows you to remove a callback later using
+ * cogl_context_remove_memory_pressure_callback().
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef struct _CoglClosure CoglMemoryPressureClosure;
+
+/**
+ * cogl_context_add_memory_pressure_callback:
+ * @context: A #CoglContext
+ * @callback: (scope notified): A callback function to call when the
+ *   context goes over its memory budget
+ * @user_data: (closure): Private data to be passed to @callback
+ * @destroy: (allow-none): An optional callback to destroy @user_data
+ *   when the @callback is removed or @context is freed
+ *
+ * Installs a @callback function that will be called whenever the
+ * memory held by @context goes over the budget set with
+ * cogl_context_set_memory_budget(). The most recently added callback
+ * is called first and the remaining ones are skipped once the total
+ * is back under the budget.
+ *
+ * Return value: a #CoglMemoryPressureClosure pointer that can be used
+ *   to remove the callback using
+ *   cogl_context_remove_memory_pressure_callback().
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglMemoryPressureClosure *
+cogl_context_add_memory_pressure_callback (CoglContext *context,
+                                           CoglMemoryPressureCallback callback,
+                                           void *user_data,
+                                           CoglUserDataDestroyCallback destroy);
+
+/**
+ * cogl_context_remove_memory_pressure_callback:
+ * @context: A #CoglContext
+ * @closure: A #CoglMemoryPressureClosure returned from
+ *   cogl_context_add_memory_pressure_callback()
+ *
+ * Removes a callback that was previously added with
+ * cogl_context_add_memory_pressure_callback().
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_context_remove_memory_pressure_callback (CoglContext *context,
+                                              CoglMemoryPressureClosure *closure);
+
+COGL_END_DECLS
+
+#endif /* __COGL_MEMORY_STATS_H__ */
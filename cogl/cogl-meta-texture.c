@@ -562,6 +562,7 @@ cogl_meta_texture_foreach_in_region (CoglMetaTexture *meta_texture,
   if (texture->vtable->foreach_sub_texture_in_region)
     {
       ForeachData data;
+      float slice_region[4] = { 0, 0, 1, 1 };
 
       data.meta_region_coords[0] = tx_1;
       data.meta_region_coords[1] = ty_1;
@@ -601,8 +602,25 @@ cogl_meta_texture_foreach_in_region (CoglMetaTexture *meta_texture,
        * that we can batch geometry.
        */
 
+      /* If the region doesn't need repeating then only the slices that
+       * it covers need to be iterated. This avoids visiting every
+       * slice of a large texture to draw a small part of it and
+       * matters for textures such as CoglTextureVirtual that only
+       * load the slices that are visited. */
+      if (MIN (tx_1, tx_2) >= 0 && MAX (tx_1, tx_2) <= width &&
+          MIN (ty_1, ty_2) >= 0 && MAX (ty_1, ty_2) <= height)
+        {
+          slice_region[0] = MIN (tx_1, tx_2) / width;
+          slice_region[1] = MIN (ty_1, ty_2) / height;
+          slice_region[2] = MAX (tx_1, tx_2) / width;
+          slice_region[3] = MAX (ty_1, ty_2) / height;
+        }
+
       texture->vtable->foreach_sub_texture_in_region (texture,
-                                                      0, 0, 1, 1,
+                                                      slice_region[0],
+                                                      slice_region[1],
+                                                      slice_region[2],
+                                                      slice_region[3],
                                                       create_grid_and_repeat_cb,
                                                       &data);
     }
@@ -0,0 +1,126 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_MIPMAP_CHAIN_PRIVATE_H
+#define __COGL_MIPMAP_CHAIN_PRIVATE_H
+
+#include "cogl-types.h"
+#include "cogl-texture-2d.h"
+
+typedef struct _CoglMipmapChainLevel
+{
+  int width;
+  int height;
+  /* Four bytes per pixel, tightly packed */
+  uint8_t *data;
+} CoglMipmapChainLevel;
+
+/* A copy of every level of a texture in CPU memory. This is used to
+ * generate the mipmaps with a better filter than the driver would
+ * use and so that a change to part of the first level only requires
+ * updating the corresponding part of the other levels */
+typedef struct _CoglMipmapChain
+{
+  CoglTexture2DMipmapFilter filter;
+  /* Whether the colour components are sRGB encoded and so must be
+   * converted to linear values before filtering */
+  CoglBool srgb;
+  /* Whether the colour components are premultiplied. This only
+   * affects the clamping of filters with negative lobes */
+  CoglBool premultiplied;
+
+  int n_levels;
+  CoglMipmapChainLevel *levels;
+
+  /* Part of the first level that has been modified since the other
+   * levels were last generated. It is empty if x1 >= x2 */
+  int dirty_x1, dirty_y1;
+  int dirty_x2, dirty_y2;
+} CoglMipmapChain;
+
+/* Called for each rectangle of a level that was regenerated */
+typedef void (* CoglMipmapChainUpdateCallback) (int level,
+                                                int x,
+                                                int y,
+                                                int width,
+                                                int height,
+                                                const uint8_t *data,
+                                                int rowstride,
+                                                void *user_data);
+
+CoglMipmapChain *
+_cogl_mipmap_chain_new (int width,
+                        int height,
+                        CoglTexture2DMipmapFilter filter,
+                        CoglBool srgb,
+                        CoglBool premultiplied);
+
+void
+_cogl_mipmap_chain_free (CoglMipmapChain *chain);
+
+/*
+ * _cogl_mipmap_chain_set_region:
+ * @chain: A #CoglMipmapChain
+ * @x: The left edge of the region in the first level
+ * @y: The top edge of the region in the first level
+ * @width: The width of the region
+ * @height: The height of the region
+ * @data: Four bytes per pixel data in the same format as the chain
+ * @rowstride: The rowstride of @data
+ *
+ * Copies the data into the first level and adds the region to the
+ * dirty area so that it will be propagated to the other levels by the
+ * next call to _cogl_mipmap_chain_update().
+ */
+void
+_cogl_mipmap_chain_set_region (CoglMipmapChain *chain,
+                               int x,
+                               int y,
+                               int width,
+                               int height,
+                               const uint8_t *data,
+                               int rowstride);
+
+/*
+ * _cogl_mipmap_chain_update:
+ * @chain: A #CoglMipmapChain
+ * @callback: A function to call for each regenerated rectangle
+ * @user_data: Data to pass to @callback
+ *
+ * Regenerates the parts of the levels that are affected by the dirty
+ * area of the first level and then clears the dirty area. The
+ * callback is called with the new contents of each level in order
+ * from the largest to the smallest.
+ */
+void
+_cogl_mipmap_chain_update (CoglMipmapChain *chain,
+                           CoglMipmapChainUpdateCallback callback,
+                           void *user_data);
+
+#endif /* __COGL_MIPMAP_CHAIN_PRIVATE_H */
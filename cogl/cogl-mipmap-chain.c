@@ -0,0 +1,693 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <test-fixtures/test-unit.h>
+
+#include "cogl-util.h"
+#include "cogl-mipmap-chain-private.h"
+
+/* The box filter can average four pixels at once using SSE2 */
+#if defined(__SSE2__) && defined(__GNUC__)
+#define COGL_USE_MIPMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+/* The Lanczos filter reads this many pixels either side of the two
+ * pixels that are centred on the destination pixel */
+#define LANCZOS_SUPPORT 3
+#define LANCZOS_N_TAPS ((LANCZOS_SUPPORT + 1) * 2)
+
+/* Maps an 8-bit sRGB value to a 16-bit linear value */
+static uint16_t srgb_to_linear_table[256];
+/* Maps a 12-bit linear value to an 8-bit sRGB value */
+static uint8_t linear_to_srgb_table[4096];
+/* Weights of a Lanczos filter with a = 2 scaled to halve the size */
+static float lanczos_weights[LANCZOS_N_TAPS];
+static CoglBool tables_initialized = FALSE;
+
+static float
+sinc (float x)
+{
+  if (x == 0.0f)
+    return 1.0f;
+
+  x *= G_PI;
+
+  return sinf (x) / x;
+}
+
+static void
+init_tables (void)
+{
+  float total = 0.0f;
+  int i;
+
+  if (tables_initialized)
+    return;
+
+  for (i = 0; i < 256; i++)
+    {
+      float value = i / 255.0f;
+
+      if (value <= 0.04045f)
+        value /= 12.92f;
+      else
+        value = powf ((value + 0.055f) / 1.055f, 2.4f);
+
+      srgb_to_linear_table[i] = value * 65535.0f + 0.5f;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (linear_to_srgb_table); i++)
+    {
+      float value = i / 4095.0f;
+
+      if (value <= 0.0031308f)
+        value *= 12.92f;
+      else
+        value = 1.055f * powf (value, 1.0f / 2.4f) - 0.055f;
+
+      linear_to_srgb_table[i] = value * 255.0f + 0.5f;
+    }
+
+  /* The taps are centred between the two source pixels that cover
+   * the destination pixel */
+  for (i = 0; i < LANCZOS_N_TAPS; i++)
+    {
+      float t = (i - (LANCZOS_N_TAPS - 1) / 2.0f) / 2.0f;
+
+      lanczos_weights[i] = sinc (t) * sinc (t / 2.0f);
+      total += lanczos_weights[i];
+    }
+
+  for (i = 0; i < LANCZOS_N_TAPS; i++)
+    lanczos_weights[i] /= total;
+
+  tables_initialized = TRUE;
+}
+
+CoglMipmapChain *
+_cogl_mipmap_chain_new (int width,
+                        int height,
+                        CoglTexture2DMipmapFilter filter,
+                        CoglBool srgb,
+                        CoglBool premultiplied)
+{
+  CoglMipmapChain *chain = g_slice_new (CoglMipmapChain);
+  int n_levels, level;
+
+  init_tables ();
+
+  for (n_levels = 1; (width >> n_levels) | (height >> n_levels); n_levels++)
+    ;
+
+  chain->filter = filter;
+  chain->srgb = srgb;
+  chain->premultiplied = premultiplied;
+  chain->n_levels = n_levels;
+  chain->levels = g_new (CoglMipmapChainLevel, n_levels);
+
+  for (level = 0; level < n_levels; level++)
+    {
+      CoglMipmapChainLevel *chain_level = chain->levels + level;
+
+      chain_level->width = MAX (width >> level, 1);
+      chain_level->height = MAX (height >> level, 1);
+      chain_level->data = g_malloc0 (chain_level->width *
+                                     chain_level->height * 4);
+    }
+
+  chain->dirty_x1 = chain->dirty_y1 = 0;
+  chain->dirty_x2 = chain->dirty_y2 = 0;
+
+  return chain;
+}
+
+void
+_cogl_mipmap_chain_free (CoglMipmapChain *chain)
+{
+  int level;
+
+  for (level = 0; level < chain->n_levels; level++)
+    g_free (chain->levels[level].data);
+
+  g_free (chain->levels);
+
+  g_slice_free (CoglMipmapChain, chain);
+}
+
+void
+_cogl_mipmap_chain_set_region (CoglMipmapChain *chain,
+                               int x,
+                               int y,
+                               int width,
+                               int height,
+                               const uint8_t *data,
+                               int rowstride)
+{
+  CoglMipmapChainLevel *level = chain->levels;
+  int row;
+
+  _COGL_RETURN_IF_FAIL (x >= 0 && y >= 0 &&
+                        x + width <= level->width &&
+                        y + height <= level->height);
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  for (row = 0; row < height; row++)
+    memcpy (level->data + ((y + row) * level->width + x) * 4,
+            data + row * rowstride,
+            width * 4);
+
+  if (chain->dirty_x1 >= chain->dirty_x2)
+    {
+      chain->dirty_x1 = x;
+      chain->dirty_y1 = y;
+      chain->dirty_x2 = x + width;
+      chain->dirty_y2 = y + height;
+    }
+  else
+    {
+      chain->dirty_x1 = MIN (chain->dirty_x1, x);
+      chain->dirty_y1 = MIN (chain->dirty_y1, y);
+      chain->dirty_x2 = MAX (chain->dirty_x2, x + width);
+      chain->dirty_y2 = MAX (chain->dirty_y2, y + height);
+    }
+}
+
+/* Averages 2x2 blocks from two rows. @next is the offset to the
+ * second pixel of each pair which is zero if the source is only one
+ * pixel wide */
+static void
+box_filter_span (const uint8_t *row0,
+                 const uint8_t *row1,
+                 uint8_t *dst,
+                 int n_pixels,
+                 int next)
+{
+#ifdef COGL_USE_MIPMAP_SSE2
+  if (next == 4)
+    {
+      const __m128i zero = _mm_setzero_si128 ();
+      const __m128i two = _mm_set1_epi16 (2);
+
+      /* Process two destination pixels at a time. The components are
+       * unpacked to 16 bits so that the sums can't overflow */
+      while (n_pixels >= 2)
+        {
+          __m128i a = _mm_loadu_si128 ((const __m128i *) row0);
+          __m128i b = _mm_loadu_si128 ((const __m128i *) row1);
+          __m128i left = _mm_add_epi16 (_mm_unpacklo_epi8 (a, zero),
+                                        _mm_unpacklo_epi8 (b, zero));
+          __m128i right = _mm_add_epi16 (_mm_unpackhi_epi8 (a, zero),
+                                         _mm_unpackhi_epi8 (b, zero));
+          __m128i sum = _mm_add_epi16 (_mm_unpacklo_epi64 (left, right),
+                                       _mm_unpackhi_epi64 (left, right));
+
+          sum = _mm_srli_epi16 (_mm_add_epi16 (sum, two), 2);
+          _mm_storel_epi64 ((__m128i *) dst, _mm_packus_epi16 (sum, sum));
+
+          row0 += 16;
+          row1 += 16;
+          dst += 8;
+          n_pixels -= 2;
+        }
+    }
+#endif /* COGL_USE_MIPMAP_SSE2 */
+
+  while (n_pixels-- > 0)
+    {
+      int i;
+
+      for (i = 0; i < 4; i++)
+        dst[i] = (row0[i] + row0[i + next] + row1[i] + row1[i + next] + 2) >> 2;
+
+      row0 += 8;
+      row1 += 8;
+      dst += 4;
+    }
+}
+
+static void
+box_filter_span_srgb (const uint8_t *row0,
+                      const uint8_t *row1,
+                      uint8_t *dst,
+                      int n_pixels,
+                      int next)
+{
+  while (n_pixels-- > 0)
+    {
+      int i;
+
+      for (i = 0; i < 3; i++)
+        {
+          int sum = (srgb_to_linear_table[row0[i]] +
+                     srgb_to_linear_table[row0[i + next]] +
+                     srgb_to_linear_table[row1[i]] +
+                     srgb_to_linear_table[row1[i + next]] +
+                     2) >> 2;
+
+          dst[i] = linear_to_srgb_table[sum >> 4];
+        }
+
+      dst[3] = (row0[3] + row0[3 + next] + row1[3] + row1[3 + next] + 2) >> 2;
+
+      row0 += 8;
+      row1 += 8;
+      dst += 4;
+    }
+}
+
+static void
+downsample_box (CoglMipmapChain *chain,
+                const CoglMipmapChainLevel *src,
+                CoglMipmapChainLevel *dst,
+                int x1, int y1,
+                int x2, int y2)
+{
+  int next = src->width >= 2 ? 4 : 0;
+  int y;
+
+  for (y = y1; y < y2; y++)
+    {
+      int sy0 = MIN (y * 2, src->height - 1);
+      int sy1 = MIN (y * 2 + 1, src->height - 1);
+      const uint8_t *row0 = src->data + (sy0 * src->width + x1 * 2) * 4;
+      const uint8_t *row1 = src->data + (sy1 * src->width + x1 * 2) * 4;
+      uint8_t *out = dst->data + (y * dst->width + x1) * 4;
+
+      if (chain->srgb)
+        box_filter_span_srgb (row0, row1, out, x2 - x1, next);
+      else
+        box_filter_span (row0, row1, out, x2 - x1, next);
+    }
+}
+
+static float
+unpack_component (const CoglMipmapChain *chain,
+                  const uint8_t *pixel,
+                  int component)
+{
+  if (chain->srgb && component < 3)
+    return srgb_to_linear_table[pixel[component]] / 65535.0f;
+  else
+    return pixel[component] / 255.0f;
+}
+
+static uint8_t
+pack_component (const CoglMipmapChain *chain,
+                float value,
+                int component)
+{
+  value = CLAMP (value, 0.0f, 1.0f);
+
+  if (chain->srgb && component < 3)
+    return linear_to_srgb_table[(int) (value * 4095.0f + 0.5f)];
+  else
+    return value * 255.0f + 0.5f;
+}
+
+static void
+downsample_lanczos (CoglMipmapChain *chain,
+                    const CoglMipmapChainLevel *src,
+                    CoglMipmapChainLevel *dst,
+                    int x1, int y1,
+                    int x2, int y2)
+{
+  int first_row = MAX (y1 * 2 - LANCZOS_SUPPORT, 0);
+  int last_row = MIN ((y2 - 1) * 2 + 1 + LANCZOS_SUPPORT, src->height - 1);
+  int width = x2 - x1;
+  float *rows;
+  int x, y, i, c;
+
+  /* First filter horizontally into a temporary buffer containing all
+   * of the source rows that the vertical pass needs */
+  rows = g_new (float, (last_row - first_row + 1) * width * 4);
+
+  for (y = first_row; y <= last_row; y++)
+    {
+      const uint8_t *src_row = src->data + y * src->width * 4;
+      float *row = rows + (y - first_row) * width * 4;
+
+      for (x = x1; x < x2; x++)
+        {
+          float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+          for (i = 0; i < LANCZOS_N_TAPS; i++)
+            {
+              int sx = CLAMP (x * 2 - LANCZOS_SUPPORT + i, 0, src->width - 1);
+              const uint8_t *pixel = src_row + sx * 4;
+
+              for (c = 0; c < 4; c++)
+                sum[c] += lanczos_weights[i] * unpack_component (chain,
+                                                                 pixel,
+                                                                 c);
+            }
+
+          memcpy (row + (x - x1) * 4, sum, sizeof (sum));
+        }
+    }
+
+  for (y = y1; y < y2; y++)
+    {
+      uint8_t *out = dst->data + (y * dst->width + x1) * 4;
+
+      for (x = 0; x < width; x++)
+        {
+          float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+          for (i = 0; i < LANCZOS_N_TAPS; i++)
+            {
+              int sy = CLAMP (y * 2 - LANCZOS_SUPPORT + i, 0, src->height - 1);
+              const float *pixel = rows + ((sy - first_row) * width + x) * 4;
+
+              for (c = 0; c < 4; c++)
+                sum[c] += lanczos_weights[i] * pixel[c];
+            }
+
+          for (c = 0; c < 4; c++)
+            out[c] = pack_component (chain, sum[c], c);
+
+          /* The negative lobes can make a colour component bigger
+           * than the alpha which isn't valid for premultiplied data */
+          if (chain->premultiplied)
+            for (c = 0; c < 3; c++)
+              out[c] = MIN (out[c], out[3]);
+
+          out += 4;
+        }
+    }
+
+  g_free (rows);
+}
+
+void
+_cogl_mipmap_chain_update (CoglMipmapChain *chain,
+                           CoglMipmapChainUpdateCallback callback,
+                           void *user_data)
+{
+  int support = (chain->filter == COGL_TEXTURE_2D_MIPMAP_FILTER_LANCZOS ?
+                 LANCZOS_SUPPORT + 1 : 0);
+  int x1 = chain->dirty_x1, y1 = chain->dirty_y1;
+  int x2 = chain->dirty_x2, y2 = chain->dirty_y2;
+  int level;
+
+  if (x1 >= x2 || y1 >= y2)
+    return;
+
+  for (level = 1; level < chain->n_levels; level++)
+    {
+      const CoglMipmapChainLevel *src = chain->levels + level - 1;
+      CoglMipmapChainLevel *dst = chain->levels + level;
+
+      /* Grow the dirty rectangle to cover all of the destination
+       * pixels whose filter reads from it */
+      x1 = MAX (x1 - support, 0) / 2;
+      y1 = MAX (y1 - support, 0) / 2;
+      x2 = MIN ((x2 + support + 1) / 2, dst->width);
+      y2 = MIN ((y2 + support + 1) / 2, dst->height);
+
+      /* If the source level is an odd size then the last row or
+       * column isn't used so the change might not affect anything */
+      if (x1 >= x2 || y1 >= y2)
+        break;
+
+      if (chain->filter == COGL_TEXTURE_2D_MIPMAP_FILTER_LANCZOS)
+        downsample_lanczos (chain, src, dst, x1, y1, x2, y2);
+      else
+        downsample_box (chain, src, dst, x1, y1, x2, y2);
+
+      callback (level,
+                x1, y1,
+                x2 - x1, y2 - y1,
+                dst->data + (y1 * dst->width + x1) * 4,
+                dst->width * 4,
+                user_data);
+    }
+
+  chain->dirty_x1 = chain->dirty_y1 = 0;
+  chain->dirty_x2 = chain->dirty_y2 = 0;
+}
+
+typedef struct
+{
+  int n_updates;
+  int rects[16][5];
+} CheckMipmapChainState;
+
+static void
+check_mipmap_chain_update_cb (int level,
+                              int x,
+                              int y,
+                              int width,
+                              int height,
+                              const uint8_t *data,
+                              int rowstride,
+                              void *user_data)
+{
+  CheckMipmapChainState *state = user_data;
+  int *rect = state->rects[state->n_updates++];
+
+  rect[0] = level;
+  rect[1] = x;
+  rect[2] = y;
+  rect[3] = width;
+  rect[4] = height;
+}
+
+static void
+check_mipmap_chain_rect (CheckMipmapChainState *state,
+                         int update,
+                         int level,
+                         int x, int y,
+                         int width, int height)
+{
+  const int *rect = state->rects[update];
+
+  g_assert_cmpint (rect[0], ==, level);
+  g_assert_cmpint (rect[1], ==, x);
+  g_assert_cmpint (rect[2], ==, y);
+  g_assert_cmpint (rect[3], ==, width);
+  g_assert_cmpint (rect[4], ==, height);
+}
+
+static CoglMipmapChain *
+make_test_chain (int width,
+                 int height,
+                 CoglTexture2DMipmapFilter filter,
+                 const uint8_t *data)
+{
+  CoglMipmapChain *chain = _cogl_mipmap_chain_new (width, height,
+                                                   filter,
+                                                   FALSE, /* srgb */
+                                                   TRUE /* premultiplied */);
+  CheckMipmapChainState state = { 0 };
+
+  _cogl_mipmap_chain_set_region (chain,
+                                 0, 0,
+                                 width, height,
+                                 data,
+                                 width * 4);
+  _cogl_mipmap_chain_update (chain, check_mipmap_chain_update_cb, &state);
+
+  return chain;
+}
+
+static void
+check_chains_equal (CoglMipmapChain *a,
+                    CoglMipmapChain *b)
+{
+  int level;
+
+  g_assert_cmpint (a->n_levels, ==, b->n_levels);
+
+  for (level = 0; level < a->n_levels; level++)
+    g_assert (!memcmp (a->levels[level].data,
+                       b->levels[level].data,
+                       a->levels[level].width * a->levels[level].height * 4));
+}
+
+UNIT_TEST (check_mipmap_chain_box_filter,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  uint8_t data[5 * 3 * 4];
+  CoglMipmapChain *chain;
+  const uint8_t *level1;
+  int i, x;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i * 17;
+
+  /* A 5x3 image has levels of 2x1 and 1x1. The last column and row
+   * of the first level are ignored */
+  chain = make_test_chain (5, 3, COGL_TEXTURE_2D_MIPMAP_FILTER_BOX, data);
+
+  g_assert_cmpint (chain->n_levels, ==, 3);
+  g_assert_cmpint (chain->levels[1].width, ==, 2);
+  g_assert_cmpint (chain->levels[1].height, ==, 1);
+
+  level1 = chain->levels[1].data;
+
+  for (x = 0; x < 2; x++)
+    for (i = 0; i < 4; i++)
+      {
+        const uint8_t *p = data + x * 2 * 4 + i;
+        int expected = (p[0] + p[4] + p[5 * 4] + p[5 * 4 + 4] + 2) / 4;
+
+        g_assert_cmpint (level1[x * 4 + i], ==, expected);
+      }
+
+  /* The 1x1 level averages the two pixels of the 2x1 level with
+   * themselves because the source is only one pixel high */
+  for (i = 0; i < 4; i++)
+    g_assert_cmpint (chain->levels[2].data[i],
+                     ==,
+                     (level1[i] * 2 + level1[i + 4] * 2 + 2) / 4);
+
+  _cogl_mipmap_chain_free (chain);
+}
+
+UNIT_TEST (check_mipmap_chain_incremental_update,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  CoglTexture2DMipmapFilter filters[] =
+    {
+      COGL_TEXTURE_2D_MIPMAP_FILTER_BOX,
+      COGL_TEXTURE_2D_MIPMAP_FILTER_LANCZOS
+    };
+  uint8_t *data = g_malloc (64 * 64 * 4);
+  uint8_t patch[4 * 4 * 4];
+  int filter, i, y;
+
+  for (i = 0; i < 64 * 64 * 4; i++)
+    data[i] = (i * 7919) >> 3;
+  for (i = 0; i < sizeof (patch); i++)
+    patch[i] = (i * 104729) >> 5;
+
+  for (filter = 0; filter < G_N_ELEMENTS (filters); filter++)
+    {
+      CheckMipmapChainState state = { 0 };
+      CoglMipmapChain *chain, *full_chain;
+
+      chain = make_test_chain (64, 64, filters[filter], data);
+
+      /* Update a 4x4 square at 8,8 */
+      _cogl_mipmap_chain_set_region (chain, 8, 8, 4, 4, patch, 4 * 4);
+      for (y = 0; y < 4; y++)
+        memcpy (data + ((8 + y) * 64 + 8) * 4, patch + y * 4 * 4, 4 * 4);
+
+      _cogl_mipmap_chain_update (chain, check_mipmap_chain_update_cb, &state);
+
+      g_assert_cmpint (state.n_updates, ==, 6);
+
+      if (filters[filter] == COGL_TEXTURE_2D_MIPMAP_FILTER_BOX)
+        {
+          /* Only the pixels covering the square should be updated */
+          check_mipmap_chain_rect (&state, 0, 1, 4, 4, 2, 2);
+          check_mipmap_chain_rect (&state, 1, 2, 2, 2, 1, 1);
+          check_mipmap_chain_rect (&state, 2, 3, 1, 1, 1, 1);
+          check_mipmap_chain_rect (&state, 5, 6, 0, 0, 1, 1);
+        }
+      else
+        {
+          /* The Lanczos filter spreads the change further */
+          check_mipmap_chain_rect (&state, 0, 1, 2, 2, 6, 6);
+          check_mipmap_chain_rect (&state, 5, 6, 0, 0, 1, 1);
+        }
+
+      /* Nothing is dirty after updating */
+      state.n_updates = 0;
+      _cogl_mipmap_chain_update (chain, check_mipmap_chain_update_cb, &state);
+      g_assert_cmpint (state.n_updates, ==, 0);
+
+      /* The result should be the same as generating all of the levels
+       * from scratch */
+      full_chain = make_test_chain (64, 64, filters[filter], data);
+      check_chains_equal (chain, full_chain);
+
+      _cogl_mipmap_chain_free (full_chain);
+      _cogl_mipmap_chain_free (chain);
+    }
+
+  g_free (data);
+}
+
+UNIT_TEST (check_mipmap_chain_filters,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  uint8_t data[16 * 16 * 4];
+  CheckMipmapChainState state = { 0 };
+  CoglMipmapChain *chain;
+  int level, i;
+
+  /* Averaging black and white in linear space gives a lighter grey
+   * than averaging the sRGB values */
+  chain = _cogl_mipmap_chain_new (2, 2,
+                                  COGL_TEXTURE_2D_MIPMAP_FILTER_BOX,
+                                  TRUE, /* srgb */
+                                  TRUE /* premultiplied */);
+  for (i = 0; i < 2 * 2 * 4; i++)
+    data[i] = (i & 4) ? 255 : 0;
+  for (i = 0; i < 2 * 2; i++)
+    data[i * 4 + 3] = 255;
+  _cogl_mipmap_chain_set_region (chain, 0, 0, 2, 2, data, 2 * 4);
+  _cogl_mipmap_chain_update (chain, check_mipmap_chain_update_cb, &state);
+
+  for (i = 0; i < 3; i++)
+    g_assert_cmpint (abs (chain->levels[1].data[i] - 188), <=, 1);
+  g_assert_cmpint (chain->levels[1].data[3], ==, 255);
+
+  _cogl_mipmap_chain_free (chain);
+
+  /* The Lanczos weights add up to one so a flat image stays flat */
+  for (i = 0; i < 16 * 16; i++)
+    {
+      data[i * 4 + 0] = 10;
+      data[i * 4 + 1] = 100;
+      data[i * 4 + 2] = 200;
+      data[i * 4 + 3] = 200;
+    }
+  chain = make_test_chain (16, 16, COGL_TEXTURE_2D_MIPMAP_FILTER_LANCZOS, data);
+
+  for (level = 1; level < chain->n_levels; level++)
+    g_assert (!memcmp (chain->levels[level].data, data, 4));
+
+  _cogl_mipmap_chain_free (chain);
+}
@@ -252,9 +252,16 @@ cogl_onscreen_swap_buffers_with_damage (CoglOnscreen *onscreen,
 
   _cogl_framebuffer_flush_journal (framebuffer);
 
+  cogl_framebuffer_get_frame_stats (framebuffer, &info->frame_stats);
+  cogl_framebuffer_reset_frame_stats (framebuffer);
+
   winsys = _cogl_framebuffer_get_winsys (framebuffer);
   winsys->onscreen_swap_buffers_with_damage (onscreen,
                                              rectangles, n_rectangles);
+
+  /* The stencil contents are undefined after a swap so any clip
+   * silhouettes cached there can't be reused for the next frame */
+  _cogl_framebuffer_invalidate_stencil_clip_cache (framebuffer);
   cogl_framebuffer_discard_buffers (framebuffer,
                                     COGL_BUFFER_BIT_COLOR |
                                     COGL_BUFFER_BIT_DEPTH |
@@ -301,6 +308,9 @@ cogl_onscreen_swap_region (CoglOnscreen *onscreen,
 
   _cogl_framebuffer_flush_journal (framebuffer);
 
+  cogl_framebuffer_get_frame_stats (framebuffer, &info->frame_stats);
+  cogl_framebuffer_reset_frame_stats (framebuffer);
+
   winsys = _cogl_framebuffer_get_winsys (framebuffer);
 
   /* This should only be called if the winsys advertises
@@ -311,6 +321,10 @@ cogl_onscreen_swap_region (CoglOnscreen *onscreen,
                                 rectangles,
                                 n_rectangles);
 
+  /* The stencil contents are undefined after a swap so any clip
+   * silhouettes cached there can't be reused for the next frame */
+  _cogl_framebuffer_invalidate_stencil_clip_cache (framebuffer);
+
   cogl_framebuffer_discard_buffers (framebuffer,
                                     COGL_BUFFER_BIT_COLOR |
                                     COGL_BUFFER_BIT_DEPTH |
@@ -94,6 +94,14 @@ _cogl_pipeline_cache_free (CoglPipelineCache *cache)
   g_free (cache);
 }
 
+void
+_cogl_pipeline_cache_prune (CoglPipelineCache *cache)
+{
+  _cogl_pipeline_hash_table_prune (&cache->fragment_hash);
+  _cogl_pipeline_hash_table_prune (&cache->vertex_hash);
+  _cogl_pipeline_hash_table_prune (&cache->combined_hash);
+}
+
 CoglPipelineCacheEntry *
 _cogl_pipeline_cache_get_fragment_template (CoglPipelineCache *cache,
                                             CoglPipeline *key_pipeline)
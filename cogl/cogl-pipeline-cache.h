@@ -50,6 +50,14 @@ _cogl_pipeline_cache_new (void);
 void
 _cogl_pipeline_cache_free (CoglPipelineCache *cache);
 
+/*
+ * Removes all of the template pipelines that aren't used by any
+ * pipeline. The generated programs are owned by the templates so
+ * this releases them too.
+ */
+void
+_cogl_pipeline_cache_prune (CoglPipelineCache *cache);
+
 /*
  * Gets a pipeline from the cache that has the same state as
  * @key_pipeline for the state in
@@ -175,6 +175,25 @@ prune_old_pipelines (CoglPipelineHashTable *hash)
   g_list_free (entries.head);
 }
 
+void
+_cogl_pipeline_hash_table_prune (CoglPipelineHashTable *hash)
+{
+  GQueue entries;
+  GList *l;
+
+  g_queue_init (&entries);
+  g_hash_table_foreach (hash->table,
+                        collect_prunable_entries_cb,
+                        &entries);
+
+  for (l = entries.head; l; l = l->next)
+    g_hash_table_remove (hash->table, l->data);
+
+  hash->expected_min_size = MAX (g_hash_table_size (hash->table), 8);
+
+  g_list_free (entries.head);
+}
+
 CoglPipelineCacheEntry *
 _cogl_pipeline_hash_table_get (CoglPipelineHashTable *hash,
                                CoglPipeline *key_pipeline)
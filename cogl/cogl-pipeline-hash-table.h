@@ -66,6 +66,14 @@ _cogl_pipeline_hash_table_init (CoglPipelineHashTable *hash,
 void
 _cogl_pipeline_hash_table_destroy (CoglPipelineHashTable *hash);
 
+/*
+ * Removes all of the pipelines that are not currently in use. This
+ * is used to free the associated programs when the context is under
+ * memory pressure
+ */
+void
+_cogl_pipeline_hash_table_prune (CoglPipelineHashTable *hash);
+
 /*
  * Gets a pipeline from the hash that has the same state as
  * @key_pipeline according to the limited state bits passed to
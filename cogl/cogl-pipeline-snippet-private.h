@@ -85,6 +85,9 @@ typedef struct
   GString *source_buf;
 } CoglPipelineSnippetData;
 
+GHashTable *
+_cogl_pipeline_snippet_code_cache_new (void);
+
 void
 _cogl_pipeline_snippet_generate_code (const CoglPipelineSnippetData *data);
 
@@ -40,8 +40,206 @@
 #include "cogl-types.h"
 #include "cogl-pipeline-snippet-private.h"
 #include "cogl-snippet-private.h"
+#include "cogl-context-private.h"
+#include "cogl-debug.h"
 #include "cogl-util.h"
 
+/* The maximum number of generated snippet functions to keep. The
+   cache is just emptied when it gets this big */
+#define COGL_SNIPPET_CODE_CACHE_SIZE 256
+
+/* Code generated for a snippet list is cached using the snippets that
+   are used for the hook and all of the names that the code is
+   generated with. The key holds a reference on the snippets so that
+   the pointers can't be reused by different snippets */
+typedef struct
+{
+  unsigned int hash;
+  CoglSnippetHook hook;
+  int n_snippets;
+  CoglSnippet **snippets;
+  char *names;
+} CoglSnippetCodeKey;
+
+static unsigned int
+snippet_code_key_hash (const void *key)
+{
+  const CoglSnippetCodeKey *code_key = key;
+
+  return code_key->hash;
+}
+
+static gboolean
+snippet_code_key_equal (const void *a,
+                        const void *b)
+{
+  const CoglSnippetCodeKey *key_a = a;
+  const CoglSnippetCodeKey *key_b = b;
+
+  return (key_a->hash == key_b->hash &&
+          key_a->hook == key_b->hook &&
+          key_a->n_snippets == key_b->n_snippets &&
+          !memcmp (key_a->snippets,
+                   key_b->snippets,
+                   sizeof (CoglSnippet *) * key_a->n_snippets) &&
+          !strcmp (key_a->names, key_b->names));
+}
+
+static void
+snippet_code_key_free (void *key)
+{
+  CoglSnippetCodeKey *code_key = key;
+  int i;
+
+  for (i = 0; i < code_key->n_snippets; i++)
+    cogl_object_unref (code_key->snippets[i]);
+
+  g_free (code_key->snippets);
+  g_free (code_key->names);
+  g_slice_free (CoglSnippetCodeKey, code_key);
+}
+
+GHashTable *
+_cogl_pipeline_snippet_code_cache_new (void)
+{
+  return g_hash_table_new_full (snippet_code_key_hash,
+                                snippet_code_key_equal,
+                                snippet_code_key_free,
+                                g_free);
+}
+
+static void
+init_snippet_code_key (CoglSnippetCodeKey *key,
+                       const CoglPipelineSnippetData *data,
+                       CoglSnippet **snippets,
+                       int n_snippets)
+{
+  unsigned int hash = 0;
+  int i;
+
+  key->names = g_strdup_printf ("%s %s %s %s %s %i %s %s",
+                                data->chain_function,
+                                data->final_name,
+                                data->function_prefix,
+                                data->return_type ?
+                                data->return_type : "",
+                                data->return_variable ?
+                                data->return_variable : "",
+                                data->return_variable_is_argument,
+                                data->arguments ?
+                                data->arguments : "",
+                                data->argument_declarations ?
+                                data->argument_declarations : "");
+
+  for (i = 0; i < n_snippets; i++)
+    hash = _cogl_util_one_at_a_time_hash (hash,
+                                          snippets + i,
+                                          sizeof (CoglSnippet *));
+  hash = _cogl_util_one_at_a_time_hash (hash,
+                                        &data->hook,
+                                        sizeof (data->hook));
+  hash = _cogl_util_one_at_a_time_hash (hash,
+                                        key->names,
+                                        strlen (key->names));
+
+  key->hash = _cogl_util_one_at_a_time_mix (hash);
+  key->hook = data->hook;
+  key->n_snippets = n_snippets;
+  key->snippets = snippets;
+}
+
+static void
+generate_snippet_functions (const CoglPipelineSnippetData *data,
+                            CoglSnippet **snippets,
+                            int n_snippets)
+{
+  CoglSnippet *snippet;
+  int snippet_num;
+
+  for (snippet_num = 0; snippet_num < n_snippets; snippet_num++)
+    {
+      const char *source;
+
+      snippet = snippets[snippet_num];
+
+      if ((source = cogl_snippet_get_declarations (snippet)))
+        g_string_append (data->source_buf, source);
+
+      g_string_append_printf (data->source_buf,
+                              "\n"
+                              "%s\n",
+                              data->return_type ?
+                              data->return_type :
+                              "void");
+
+      if (snippet_num + 1 < n_snippets)
+        g_string_append_printf (data->source_buf,
+                                "%s_%i",
+                                data->function_prefix,
+                                snippet_num);
+      else
+        g_string_append (data->source_buf, data->final_name);
+
+      g_string_append (data->source_buf, " (");
+
+      if (data->argument_declarations)
+        g_string_append (data->source_buf, data->argument_declarations);
+
+      g_string_append (data->source_buf,
+                       ")\n"
+                       "{\n");
+
+      if (data->return_type && !data->return_variable_is_argument)
+        g_string_append_printf (data->source_buf,
+                                "  %s %s;\n"
+                                "\n",
+                                data->return_type,
+                                data->return_variable);
+
+      if ((source = cogl_snippet_get_pre (snippet)))
+        g_string_append (data->source_buf, source);
+
+      /* Chain on to the next function, or bypass it if there is
+         a replace string */
+      if ((source = cogl_snippet_get_replace (snippet)))
+        g_string_append (data->source_buf, source);
+      else
+        {
+          g_string_append (data->source_buf, "  ");
+
+          if (data->return_type)
+            g_string_append_printf (data->source_buf,
+                                    "%s = ",
+                                    data->return_variable);
+
+          if (snippet_num > 0)
+            g_string_append_printf (data->source_buf,
+                                    "%s_%i",
+                                    data->function_prefix,
+                                    snippet_num - 1);
+          else
+            g_string_append (data->source_buf, data->chain_function);
+
+          g_string_append (data->source_buf, " (");
+
+          if (data->arguments)
+            g_string_append (data->source_buf, data->arguments);
+
+          g_string_append (data->source_buf, ");\n");
+        }
+
+      if ((source = cogl_snippet_get_post (snippet)))
+        g_string_append (data->source_buf, source);
+
+      if (data->return_type)
+        g_string_append_printf (data->source_buf,
+                                "  return %s;\n",
+                                data->return_variable);
+
+      g_string_append (data->source_buf, "}\n");
+    }
+}
+
 /* Helper functions that are used by both GLSL pipeline backends */
 
 void
@@ -49,9 +247,15 @@ _cogl_pipeline_snippet_generate_code (const CoglPipelineSnippetData *data)
 {
   GList *first_snippet, *l;
   CoglSnippet *snippet;
+  CoglSnippet **snippets;
+  CoglSnippetCodeKey key, *new_key;
+  const char *code;
+  int start_len;
   int snippet_num = 0;
   int n_snippets = 0;
 
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
   first_snippet = data->snippets->entries;
 
   /* First count the number of snippets so we can easily tell when
@@ -109,92 +313,51 @@ _cogl_pipeline_snippet_generate_code (const CoglPipelineSnippetData *data)
       return;
     }
 
+  /* Only the snippets that are actually used for this hook affect
+     the generated code */
+  snippets = g_new (CoglSnippet *, n_snippets);
+
   for (l = first_snippet; snippet_num < n_snippets; l = l->next)
     {
       snippet = l->data;
 
       if (snippet->hook == data->hook)
-        {
-          const char *source;
-
-          if ((source = cogl_snippet_get_declarations (snippet)))
-            g_string_append (data->source_buf, source);
-
-          g_string_append_printf (data->source_buf,
-                                  "\n"
-                                  "%s\n",
-                                  data->return_type ?
-                                  data->return_type :
-                                  "void");
-
-          if (snippet_num + 1 < n_snippets)
-            g_string_append_printf (data->source_buf,
-                                    "%s_%i",
-                                    data->function_prefix,
-                                    snippet_num);
-          else
-            g_string_append (data->source_buf, data->final_name);
-
-          g_string_append (data->source_buf, " (");
-
-          if (data->argument_declarations)
-            g_string_append (data->source_buf, data->argument_declarations);
-
-          g_string_append (data->source_buf,
-                           ")\n"
-                           "{\n");
-
-          if (data->return_type && !data->return_variable_is_argument)
-            g_string_append_printf (data->source_buf,
-                                    "  %s %s;\n"
-                                    "\n",
-                                    data->return_type,
-                                    data->return_variable);
-
-          if ((source = cogl_snippet_get_pre (snippet)))
-            g_string_append (data->source_buf, source);
-
-          /* Chain on to the next function, or bypass it if there is
-             a replace string */
-          if ((source = cogl_snippet_get_replace (snippet)))
-            g_string_append (data->source_buf, source);
-          else
-            {
-              g_string_append (data->source_buf, "  ");
+        snippets[snippet_num++] = snippet;
+    }
 
-              if (data->return_type)
-                g_string_append_printf (data->source_buf,
-                                        "%s = ",
-                                        data->return_variable);
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES)))
+    {
+      generate_snippet_functions (data, snippets, n_snippets);
+      g_free (snippets);
+      return;
+    }
 
-              if (snippet_num > 0)
-                g_string_append_printf (data->source_buf,
-                                        "%s_%i",
-                                        data->function_prefix,
-                                        snippet_num - 1);
-              else
-                g_string_append (data->source_buf, data->chain_function);
+  init_snippet_code_key (&key, data, snippets, n_snippets);
 
-              g_string_append (data->source_buf, " (");
+  code = g_hash_table_lookup (ctx->snippet_code_cache, &key);
 
-              if (data->arguments)
-                g_string_append (data->source_buf, data->arguments);
+  if (code)
+    {
+      g_string_append (data->source_buf, code);
+      g_free (key.names);
+      g_free (snippets);
+      return;
+    }
 
-              g_string_append (data->source_buf, ");\n");
-            }
+  start_len = data->source_buf->len;
+  generate_snippet_functions (data, snippets, n_snippets);
 
-          if ((source = cogl_snippet_get_post (snippet)))
-            g_string_append (data->source_buf, source);
+  if (g_hash_table_size (ctx->snippet_code_cache) >=
+      COGL_SNIPPET_CODE_CACHE_SIZE)
+    g_hash_table_remove_all (ctx->snippet_code_cache);
 
-          if (data->return_type)
-            g_string_append_printf (data->source_buf,
-                                    "  return %s;\n",
-                                    data->return_variable);
+  for (snippet_num = 0; snippet_num < n_snippets; snippet_num++)
+    cogl_object_ref (snippets[snippet_num]);
 
-          g_string_append (data->source_buf, "}\n");
-          snippet_num++;
-        }
-    }
+  new_key = g_slice_dup (CoglSnippetCodeKey, &key);
+  g_hash_table_insert (ctx->snippet_code_cache,
+                       new_key,
+                       g_strdup (data->source_buf->str + start_len));
 }
 
 void
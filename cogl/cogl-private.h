@@ -64,11 +64,19 @@ typedef enum
   COGL_PRIVATE_FEATURE_TEXTURE_MAX_LEVEL,
   COGL_PRIVATE_FEATURE_ARBFP,
   COGL_PRIVATE_FEATURE_OES_EGL_SYNC,
+  COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_S3TC,
+  COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC1,
+  COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC2,
+  COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ASTC,
   /* If this is set then the winsys is responsible for queueing dirty
    * events. Otherwise a dirty event will be queued when the onscreen
    * is first allocated or when it is shown or resized */
   COGL_PRIVATE_FEATURE_DIRTY_EVENTS,
   COGL_PRIVATE_FEATURE_ENABLE_PROGRAM_POINT_SIZE,
+  /* The journal can combine quads that only differ by the texture of
+   * their single layer into one draw by binding several textures at
+   * once. ctx->max_batched_textures gives the number of textures */
+  COGL_PRIVATE_FEATURE_TEXTURE_BATCHING,
   /* These features let us avoid conditioning code based on the exact
    * driver being used and instead check for broad opengl feature
    * sets that can be shared by several GL apis */
@@ -45,12 +45,58 @@ extern UProfContext *_cogl_uprof_context;
 #define COGL_TIMER_START     UPROF_TIMER_START
 #define COGL_TIMER_STOP      UPROF_TIMER_STOP
 
+#define COGL_GPU_TIMER_START(A,B) G_STMT_START{ (void)0; }G_STMT_END
+#define COGL_GPU_TIMER_STOP(A,B) G_STMT_START{ (void)0; }G_STMT_END
+
 void
 _cogl_uprof_init (void);
 
 void
 _cogl_profile_trace_message (const char *format, ...);
 
+#elif defined (COGL_ENABLE_TRACING)
+
+#include "cogl-trace-private.h"
+
+/* The parent, description and private data of the timers are only
+ * used by UProf. The trace viewer works out the nesting from the
+ * order of the begin and end events */
+#define COGL_STATIC_TIMER(VAR, PARENT, NAME, DESCRIPTION, PRIV) \
+  static CoglTraceSite VAR = COGL_TRACE_SITE_INIT (NAME)
+#define COGL_STATIC_COUNTER(VAR, NAME, DESCRIPTION, PRIV) \
+  static CoglTraceSite VAR = COGL_TRACE_SITE_INIT (NAME)
+
+#define COGL_COUNTER_INC(CONTEXT, COUNTER) G_STMT_START{ \
+    if (G_UNLIKELY (_cogl_trace_enabled))               \
+      _cogl_trace_counter (&(COUNTER), 1);              \
+  }G_STMT_END
+#define COGL_COUNTER_DEC(CONTEXT, COUNTER) G_STMT_START{ \
+    if (G_UNLIKELY (_cogl_trace_enabled))               \
+      _cogl_trace_counter (&(COUNTER), -1);             \
+  }G_STMT_END
+#define COGL_TIMER_START(CONTEXT, TIMER) G_STMT_START{ \
+    if (G_UNLIKELY (_cogl_trace_enabled))             \
+      _cogl_trace_begin (&(TIMER));                   \
+  }G_STMT_END
+#define COGL_TIMER_STOP(CONTEXT, TIMER) G_STMT_START{  \
+    if (G_UNLIKELY (_cogl_trace_enabled))             \
+      _cogl_trace_end (&(TIMER));                     \
+  }G_STMT_END
+
+/* These record the time that the GPU spends executing the commands
+ * between the start and the stop in a separate track of the trace.
+ * Unlike the other macros the first argument is a CoglContext */
+#define COGL_GPU_TIMER_START(CONTEXT, TIMER) G_STMT_START{ \
+    if (G_UNLIKELY (_cogl_trace_enabled))                 \
+      _cogl_trace_gpu_begin ((CONTEXT), &(TIMER));        \
+  }G_STMT_END
+#define COGL_GPU_TIMER_STOP(CONTEXT, TIMER) G_STMT_START{  \
+    if (G_UNLIKELY (_cogl_trace_enabled))                 \
+      _cogl_trace_gpu_end ((CONTEXT), &(TIMER));          \
+  }G_STMT_END
+
+#define _cogl_profile_trace_message g_message
+
 #else
 
 #define COGL_STATIC_TIMER(A,B,C,D,E) extern void _cogl_dummy_decl (void)
@@ -59,6 +105,8 @@ _cogl_profile_trace_message (const char *format, ...);
 #define COGL_COUNTER_DEC(A,B) G_STMT_START{ (void)0; }G_STMT_END
 #define COGL_TIMER_START(A,B) G_STMT_START{ (void)0; }G_STMT_END
 #define COGL_TIMER_STOP(A,B) G_STMT_START{ (void)0; }G_STMT_END
+#define COGL_GPU_TIMER_START(A,B) G_STMT_START{ (void)0; }G_STMT_END
+#define COGL_GPU_TIMER_STOP(A,B) G_STMT_START{ (void)0; }G_STMT_END
 
 #define _cogl_profile_trace_message g_message
 
@@ -0,0 +1,60 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_READ_PIXELS_ASYNC_PRIVATE_H__
+#define __COGL_READ_PIXELS_ASYNC_PRIVATE_H__
+
+#include "cogl-read-pixels-async.h"
+#include "cogl-fence.h"
+#include "cogl-list.h"
+#include "cogl-closure-list-private.h"
+
+struct _CoglReadPixelsClosure
+{
+  CoglList link;
+  CoglFramebuffer *framebuffer;
+
+  CoglBitmap *bitmap;
+  /* Whether the rows were read upside-down and need to be flipped
+     before the data is passed to the callback */
+  CoglBool needs_flip;
+
+  /* Only one of these is set depending on whether fences are
+     supported. If neither is set the closure is being dispatched */
+  CoglFenceClosure *fence;
+  CoglClosure *idle;
+
+  CoglReadPixelsCallback callback;
+  void *user_data;
+};
+
+void
+_cogl_read_pixels_cancel_for_framebuffer (CoglFramebuffer *framebuffer);
+
+#endif /* __COGL_READ_PIXELS_ASYNC_PRIVATE_H__ */
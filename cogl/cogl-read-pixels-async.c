@@ -0,0 +1,229 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "cogl-read-pixels-async.h"
+#include "cogl-read-pixels-async-private.h"
+#include "cogl-context-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-bitmap-private.h"
+#include "cogl-poll-private.h"
+#include "cogl-private.h"
+#include "cogl-error-private.h"
+#include "cogl-offscreen.h"
+
+static void
+_cogl_read_pixels_closure_free (CoglReadPixelsClosure *closure)
+{
+  cogl_object_unref (closure->bitmap);
+  g_slice_free (CoglReadPixelsClosure, closure);
+}
+
+static void
+flip_rows (uint8_t *data,
+           int rowstride,
+           int row_length,
+           int height)
+{
+  uint8_t *tmp_row = g_malloc (row_length);
+  uint8_t *top = data;
+  uint8_t *bottom = data + (height - 1) * rowstride;
+
+  while (top < bottom)
+    {
+      memcpy (tmp_row, top, row_length);
+      memcpy (top, bottom, row_length);
+      memcpy (bottom, tmp_row, row_length);
+
+      top += rowstride;
+      bottom -= rowstride;
+    }
+
+  g_free (tmp_row);
+}
+
+static void
+_cogl_read_pixels_dispatch (CoglReadPixelsClosure *closure)
+{
+  CoglBitmap *bitmap = closure->bitmap;
+  CoglBufferAccess access = COGL_BUFFER_ACCESS_READ;
+  CoglError *ignore_error = NULL;
+  uint8_t *data;
+
+  /* Unlink the closure before invoking the callback so that it
+     doesn't get freed again if the callback destroys the
+     framebuffer */
+  _cogl_list_remove (&closure->link);
+
+  if (closure->needs_flip)
+    access |= COGL_BUFFER_ACCESS_WRITE;
+
+  data = _cogl_bitmap_map (bitmap, access, 0, &ignore_error);
+
+  if (data == NULL)
+    cogl_error_free (ignore_error);
+  else if (closure->needs_flip)
+    {
+      CoglPixelFormat format = cogl_bitmap_get_format (bitmap);
+
+      flip_rows (data,
+                 cogl_bitmap_get_rowstride (bitmap),
+                 (cogl_bitmap_get_width (bitmap) *
+                  _cogl_pixel_format_get_bytes_per_pixel (format)),
+                 cogl_bitmap_get_height (bitmap));
+    }
+
+  closure->callback (closure->framebuffer,
+                     bitmap,
+                     data,
+                     closure->user_data);
+
+  if (data)
+    _cogl_bitmap_unmap (bitmap);
+
+  _cogl_read_pixels_closure_free (closure);
+}
+
+static void
+_cogl_read_pixels_fence_cb (CoglFence *fence,
+                            void *user_data)
+{
+  CoglReadPixelsClosure *closure = user_data;
+
+  /* The fence closure is freed by the fence code once we return */
+  closure->fence = NULL;
+
+  _cogl_read_pixels_dispatch (closure);
+}
+
+static void
+_cogl_read_pixels_idle_cb (void *user_data)
+{
+  CoglReadPixelsClosure *closure = user_data;
+
+  _cogl_closure_disconnect (closure->idle);
+  closure->idle = NULL;
+
+  _cogl_read_pixels_dispatch (closure);
+}
+
+CoglReadPixelsClosure *
+cogl_framebuffer_read_pixels_async (CoglFramebuffer *framebuffer,
+                                    int x,
+                                    int y,
+                                    CoglReadPixelsFlags source,
+                                    CoglBitmap *bitmap,
+                                    CoglReadPixelsCallback callback,
+                                    void *user_data,
+                                    CoglError **error)
+{
+  CoglContext *ctx = framebuffer->context;
+  CoglReadPixelsClosure *closure;
+  CoglBool needs_flip = FALSE;
+
+  _COGL_RETURN_VAL_IF_FAIL (source & COGL_READ_PIXELS_COLOR_BUFFER, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_bitmap (bitmap), NULL);
+  _COGL_RETURN_VAL_IF_FAIL (callback != NULL, NULL);
+
+  /* If the driver would have to flip the rows of an onscreen
+     framebuffer on the CPU then it would need to map the bitmap
+     straight away. Instead we read the rows upside-down and flip them
+     when the data is mapped for the callback */
+  if (!cogl_is_offscreen (framebuffer) &&
+      (source & COGL_READ_PIXELS_NO_FLIP) == 0 &&
+      !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_MESA_PACK_INVERT))
+    {
+      needs_flip = TRUE;
+      source |= COGL_READ_PIXELS_NO_FLIP;
+    }
+
+  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                 x, y,
+                                                 source,
+                                                 bitmap,
+                                                 error))
+    return NULL;
+
+  closure = g_slice_new0 (CoglReadPixelsClosure);
+  closure->framebuffer = framebuffer;
+  closure->bitmap = cogl_object_ref (bitmap);
+  closure->needs_flip = needs_flip;
+  closure->callback = callback;
+  closure->user_data = user_data;
+
+  /* The read has been submitted to the GPU so a fence added now will
+     signal once the data is in the bitmap */
+  closure->fence =
+    cogl_framebuffer_add_fence_callback (framebuffer,
+                                         _cogl_read_pixels_fence_cb,
+                                         closure);
+
+  /* Without fences the data is already available because the driver
+     had to wait for it but we still defer the callback so that it is
+     always invoked from the main loop */
+  if (closure->fence == NULL)
+    closure->idle = _cogl_poll_renderer_add_idle (ctx->display->renderer,
+                                                  _cogl_read_pixels_idle_cb,
+                                                  closure,
+                                                  NULL);
+
+  _cogl_list_insert (framebuffer->pending_read_pixels.prev, &closure->link);
+
+  return closure;
+}
+
+void
+cogl_framebuffer_cancel_read_pixels_callback (CoglFramebuffer *framebuffer,
+                                              CoglReadPixelsClosure *closure)
+{
+  _COGL_RETURN_IF_FAIL (closure->framebuffer == framebuffer);
+
+  if (closure->fence)
+    cogl_framebuffer_cancel_fence_callback (framebuffer, closure->fence);
+  else if (closure->idle)
+    _cogl_closure_disconnect (closure->idle);
+
+  _cogl_list_remove (&closure->link);
+  _cogl_read_pixels_closure_free (closure);
+}
+
+void
+_cogl_read_pixels_cancel_for_framebuffer (CoglFramebuffer *framebuffer)
+{
+  CoglReadPixelsClosure *closure, *tmp;
+
+  _cogl_list_for_each_safe (closure, tmp,
+                            &framebuffer->pending_read_pixels, link)
+    cogl_framebuffer_cancel_read_pixels_callback (framebuffer, closure);
+}
@@ -0,0 +1,161 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_READ_PIXELS_ASYNC_H__
+#define __COGL_READ_PIXELS_ASYNC_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-framebuffer.h>
+#include <cogl/cogl-bitmap.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-read-pixels-async
+ * @short_description: Functions for reading back framebuffer contents
+ *   without stalling
+ *
+ * cogl_framebuffer_read_pixels_into_bitmap() has to wait for the GPU
+ * to finish rendering before it can return the pixel data. The
+ * functions in this section instead start a read into a #CoglBitmap
+ * and notify the application with a callback once the GPU has
+ * written the data.
+ *
+ * The read can only be queued without blocking if the bitmap is
+ * backed by a #CoglPixelBuffer (see cogl_bitmap_new_with_size()) and
+ * its format matches the framebuffer's format so that no conversion
+ * is needed. Otherwise the data is read synchronously but the
+ * callback is still deferred.
+ *
+ * A typical way to stream the contents of a framebuffer back to the
+ * CPU is to keep a ring of two or three bitmaps and start a read into
+ * the next bitmap of the ring every frame. The callbacks are invoked
+ * in the same order that the reads were started so the application
+ * only has to wait for a bitmap if it wraps around to one whose read
+ * is still pending.
+ */
+
+/**
+ * CoglReadPixelsClosure:
+ *
+ * An opaque type representing a pending asynchronous read started
+ * with cogl_framebuffer_read_pixels_async().
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+typedef struct _CoglReadPixelsClosure CoglReadPixelsClosure;
+
+/**
+ * CoglReadPixelsCallback:
+ * @framebuffer: The #CoglFramebuffer that was read from
+ * @bitmap: The #CoglBitmap that the data was read into
+ * @data: A pointer to the mapped data of the bitmap or %NULL if the
+ *   bitmap could not be mapped
+ * @user_data: The private data passed to
+ *   cogl_framebuffer_read_pixels_async()
+ *
+ * The callback prototype used with
+ * cogl_framebuffer_read_pixels_async(). The data pointer is laid out
+ * according to the format and rowstride of @bitmap and is only valid
+ * until the callback returns.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+typedef void (* CoglReadPixelsCallback) (CoglFramebuffer *framebuffer,
+                                         CoglBitmap *bitmap,
+                                         const uint8_t *data,
+                                         void *user_data);
+
+/**
+ * cogl_framebuffer_read_pixels_async:
+ * @framebuffer: A #CoglFramebuffer
+ * @x: The x position to read from
+ * @y: The y position to read from
+ * @source: Identifies which auxillary buffer you want to read
+ *          (only COGL_READ_PIXELS_COLOR_BUFFER supported currently)
+ * @bitmap: The bitmap to store the results in.
+ * @callback: (scope notified): A #CoglReadPixelsCallback to call once
+ *   the data is available
+ * @user_data: (closure): Private data that will be passed to the
+ *   callback
+ * @error: A #CoglError to return an exception on failure
+ *
+ * Starts reading a region of the framebuffer into @bitmap in the same
+ * way as cogl_framebuffer_read_pixels_into_bitmap() but without
+ * waiting for the GPU. The region read has the same width and height
+ * as @bitmap. Once the data has been written @callback is called from
+ * cogl_poll_renderer_dispatch(). A reference is taken on @bitmap until
+ * then and the application must not modify it before the callback is
+ * invoked.
+ *
+ * Return value: A #CoglReadPixelsClosure that can be passed to
+ *   cogl_framebuffer_cancel_read_pixels_callback() or %NULL if the
+ *   read could not be started, in which case @error is set and
+ *   @callback will never be called. The closure is freed
+ *   automatically after the callback has been invoked.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglReadPixelsClosure *
+cogl_framebuffer_read_pixels_async (CoglFramebuffer *framebuffer,
+                                    int x,
+                                    int y,
+                                    CoglReadPixelsFlags source,
+                                    CoglBitmap *bitmap,
+                                    CoglReadPixelsCallback callback,
+                                    void *user_data,
+                                    CoglError **error);
+
+/**
+ * cogl_framebuffer_cancel_read_pixels_callback:
+ * @framebuffer: The #CoglFramebuffer the read was started on
+ * @closure: The #CoglReadPixelsClosure returned from
+ *           cogl_framebuffer_read_pixels_async()
+ *
+ * Cancels a pending read started with
+ * cogl_framebuffer_read_pixels_async(); the callback will not be
+ * called and the reference on the bitmap is released. The contents of
+ * the bitmap are undefined afterwards.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_framebuffer_cancel_read_pixels_callback (CoglFramebuffer *framebuffer,
+                                              CoglReadPixelsClosure *closure);
+
+COGL_END_DECLS
+
+#endif /* __COGL_READ_PIXELS_ASYNC_H__ */
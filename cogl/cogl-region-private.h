@@ -0,0 +1,121 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_REGION_PRIVATE_H
+#define __COGL_REGION_PRIVATE_H
+
+#include <glib.h>
+
+#include "cogl-types.h"
+
+/*
+ * CoglRegion is a set of pixels described by a list of integer
+ * rectangles which never overlap each other. It is used to track
+ * damage so it is optimised for the case where there are only a few
+ * rectangles. The operations test the extents of the region first so
+ * disjoint regions are rejected without looking at the rectangles.
+ */
+
+typedef struct _CoglRegionBox
+{
+  int x1, y1;
+  int x2, y2;
+} CoglRegionBox;
+
+typedef struct _CoglRegion
+{
+  /* Bounding box of all of the rectangles. This is only valid when
+   * there is at least one rectangle */
+  CoglRegionBox extents;
+  GArray *boxes;
+} CoglRegion;
+
+void
+_cogl_region_init (CoglRegion *region);
+
+void
+_cogl_region_destroy (CoglRegion *region);
+
+void
+_cogl_region_clear (CoglRegion *region);
+
+void
+_cogl_region_copy (CoglRegion *dst,
+                   const CoglRegion *src);
+
+static inline CoglBool
+_cogl_region_is_empty (const CoglRegion *region)
+{
+  return region->boxes->len == 0;
+}
+
+static inline int
+_cogl_region_get_n_boxes (const CoglRegion *region)
+{
+  return region->boxes->len;
+}
+
+static inline const CoglRegionBox *
+_cogl_region_get_boxes (const CoglRegion *region)
+{
+  return (const CoglRegionBox *) region->boxes->data;
+}
+
+/* Adds the rectangle (x, y, width, height) to the region. Empty
+ * rectangles are ignored */
+void
+_cogl_region_union_rectangle (CoglRegion *region,
+                              int x,
+                              int y,
+                              int width,
+                              int height);
+
+void
+_cogl_region_union (CoglRegion *region,
+                    const CoglRegion *other);
+
+void
+_cogl_region_intersect_rectangle (CoglRegion *region,
+                                  int x,
+                                  int y,
+                                  int width,
+                                  int height);
+
+void
+_cogl_region_intersect (CoglRegion *region,
+                        const CoglRegion *other);
+
+/* Replaces the rectangles with their bounding box if there are more
+ * than @max_boxes of them. The resulting region is a superset of the
+ * original which is good enough when tracking damage */
+void
+_cogl_region_simplify (CoglRegion *region,
+                       int max_boxes);
+
+#endif /* __COGL_REGION_PRIVATE_H */
@@ -0,0 +1,544 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <string.h>
+
+#include <test-fixtures/test-unit.h>
+
+#include "cogl-region-private.h"
+#include "cogl-util.h"
+
+void
+_cogl_region_init (CoglRegion *region)
+{
+  region->boxes = g_array_new (FALSE, FALSE, sizeof (CoglRegionBox));
+}
+
+void
+_cogl_region_destroy (CoglRegion *region)
+{
+  g_array_free (region->boxes, TRUE);
+}
+
+void
+_cogl_region_clear (CoglRegion *region)
+{
+  g_array_set_size (region->boxes, 0);
+}
+
+void
+_cogl_region_copy (CoglRegion *dst,
+                   const CoglRegion *src)
+{
+  g_array_set_size (dst->boxes, src->boxes->len);
+  memcpy (dst->boxes->data,
+          src->boxes->data,
+          src->boxes->len * sizeof (CoglRegionBox));
+  dst->extents = src->extents;
+}
+
+static inline CoglBool
+box_is_empty (const CoglRegionBox *box)
+{
+  return box->x1 >= box->x2 || box->y1 >= box->y2;
+}
+
+static inline CoglBool
+boxes_overlap (const CoglRegionBox *a,
+               const CoglRegionBox *b)
+{
+  return (a->x1 < b->x2 && b->x1 < a->x2 &&
+          a->y1 < b->y2 && b->y1 < a->y2);
+}
+
+static inline CoglBool
+box_contains (const CoglRegionBox *outer,
+              const CoglRegionBox *inner)
+{
+  return (outer->x1 <= inner->x1 && outer->x2 >= inner->x2 &&
+          outer->y1 <= inner->y1 && outer->y2 >= inner->y2);
+}
+
+static void
+update_extents (CoglRegion *region)
+{
+  const CoglRegionBox *boxes = _cogl_region_get_boxes (region);
+  int i;
+
+  if (region->boxes->len == 0)
+    return;
+
+  region->extents = boxes[0];
+
+  for (i = 1; i < region->boxes->len; i++)
+    {
+      region->extents.x1 = MIN (region->extents.x1, boxes[i].x1);
+      region->extents.y1 = MIN (region->extents.y1, boxes[i].y1);
+      region->extents.x2 = MAX (region->extents.x2, boxes[i].x2);
+      region->extents.y2 = MAX (region->extents.y2, boxes[i].y2);
+    }
+}
+
+static void
+append_box (CoglRegion *region,
+            const CoglRegionBox *box)
+{
+  if (region->boxes->len == 0)
+    region->extents = *box;
+  else
+    {
+      region->extents.x1 = MIN (region->extents.x1, box->x1);
+      region->extents.y1 = MIN (region->extents.y1, box->y1);
+      region->extents.x2 = MAX (region->extents.x2, box->x2);
+      region->extents.y2 = MAX (region->extents.y2, box->y2);
+    }
+
+  g_array_append_val (region->boxes, *box);
+}
+
+/* Adds the parts of @box that aren't covered by any of the existing
+ * boxes from @first_box up to @n_boxes. Whenever the box overlaps an
+ * existing box it is split into up to four pieces around it which
+ * can only overlap the boxes after it. The pieces of one split never
+ * overlap each other so they can be appended independently */
+static void
+add_uncovered_parts (CoglRegion *region,
+                     const CoglRegionBox *box,
+                     int first_box,
+                     int n_boxes)
+{
+  int i;
+
+  for (i = first_box; i < n_boxes; i++)
+    {
+      const CoglRegionBox *other =
+        &g_array_index (region->boxes, CoglRegionBox, i);
+      CoglRegionBox piece;
+      int band_y1, band_y2;
+
+      if (!boxes_overlap (box, other))
+        continue;
+
+      if (box_contains (other, box))
+        return;
+
+      band_y1 = MAX (box->y1, other->y1);
+      band_y2 = MIN (box->y2, other->y2);
+
+      /* Copy the other box because appending pieces may reallocate
+       * the array */
+      {
+        CoglRegionBox split = *other;
+
+        if (box->y1 < split.y1)
+          {
+            piece.x1 = box->x1;
+            piece.y1 = box->y1;
+            piece.x2 = box->x2;
+            piece.y2 = split.y1;
+            add_uncovered_parts (region, &piece, i + 1, n_boxes);
+          }
+        if (box->y2 > split.y2)
+          {
+            piece.x1 = box->x1;
+            piece.y1 = split.y2;
+            piece.x2 = box->x2;
+            piece.y2 = box->y2;
+            add_uncovered_parts (region, &piece, i + 1, n_boxes);
+          }
+        if (box->x1 < split.x1)
+          {
+            piece.x1 = box->x1;
+            piece.y1 = band_y1;
+            piece.x2 = split.x1;
+            piece.y2 = band_y2;
+            add_uncovered_parts (region, &piece, i + 1, n_boxes);
+          }
+        if (box->x2 > split.x2)
+          {
+            piece.x1 = split.x2;
+            piece.y1 = band_y1;
+            piece.x2 = box->x2;
+            piece.y2 = band_y2;
+            add_uncovered_parts (region, &piece, i + 1, n_boxes);
+          }
+      }
+
+      return;
+    }
+
+  append_box (region, box);
+}
+
+static void
+union_box (CoglRegion *region,
+           const CoglRegionBox *box)
+{
+  CoglRegionBox *boxes;
+  int i, n_boxes;
+
+  if (box_is_empty (box))
+    return;
+
+  if (region->boxes->len == 0 || !boxes_overlap (&region->extents, box))
+    {
+      append_box (region, box);
+      return;
+    }
+
+  if (box_contains (box, &region->extents))
+    {
+      g_array_set_size (region->boxes, 1);
+      g_array_index (region->boxes, CoglRegionBox, 0) = *box;
+      region->extents = *box;
+      return;
+    }
+
+  /* Remove any boxes that are completely covered by the new box so
+   * that it doesn't get split around them needlessly */
+  boxes = (CoglRegionBox *) region->boxes->data;
+  for (i = 0, n_boxes = 0; i < region->boxes->len; i++)
+    if (!box_contains (box, boxes + i))
+      boxes[n_boxes++] = boxes[i];
+  g_array_set_size (region->boxes, n_boxes);
+
+  add_uncovered_parts (region, box, 0, n_boxes);
+}
+
+void
+_cogl_region_union_rectangle (CoglRegion *region,
+                              int x,
+                              int y,
+                              int width,
+                              int height)
+{
+  CoglRegionBox box;
+
+  box.x1 = x;
+  box.y1 = y;
+  box.x2 = x + width;
+  box.y2 = y + height;
+
+  union_box (region, &box);
+}
+
+void
+_cogl_region_union (CoglRegion *region,
+                    const CoglRegion *other)
+{
+  const CoglRegionBox *boxes = _cogl_region_get_boxes (other);
+  int i;
+
+  if (other == region)
+    return;
+
+  for (i = 0; i < other->boxes->len; i++)
+    union_box (region, boxes + i);
+}
+
+void
+_cogl_region_intersect_rectangle (CoglRegion *region,
+                                  int x,
+                                  int y,
+                                  int width,
+                                  int height)
+{
+  CoglRegionBox *boxes = (CoglRegionBox *) region->boxes->data;
+  CoglRegionBox clip;
+  int i, n_boxes;
+
+  clip.x1 = x;
+  clip.y1 = y;
+  clip.x2 = x + width;
+  clip.y2 = y + height;
+
+  if (region->boxes->len == 0)
+    return;
+
+  if (!boxes_overlap (&region->extents, &clip))
+    {
+      _cogl_region_clear (region);
+      return;
+    }
+
+  if (box_contains (&clip, &region->extents))
+    return;
+
+  for (i = 0, n_boxes = 0; i < region->boxes->len; i++)
+    {
+      CoglRegionBox box;
+
+      box.x1 = MAX (boxes[i].x1, clip.x1);
+      box.y1 = MAX (boxes[i].y1, clip.y1);
+      box.x2 = MIN (boxes[i].x2, clip.x2);
+      box.y2 = MIN (boxes[i].y2, clip.y2);
+
+      if (!box_is_empty (&box))
+        boxes[n_boxes++] = box;
+    }
+
+  g_array_set_size (region->boxes, n_boxes);
+  update_extents (region);
+}
+
+void
+_cogl_region_intersect (CoglRegion *region,
+                        const CoglRegion *other)
+{
+  const CoglRegionBox *other_boxes = _cogl_region_get_boxes (other);
+  GArray *result;
+  int i, j;
+
+  if (other == region || region->boxes->len == 0)
+    return;
+
+  if (other->boxes->len == 0 ||
+      !boxes_overlap (&region->extents, &other->extents))
+    {
+      _cogl_region_clear (region);
+      return;
+    }
+
+  if (other->boxes->len == 1)
+    {
+      _cogl_region_intersect_rectangle (region,
+                                        other_boxes[0].x1,
+                                        other_boxes[0].y1,
+                                        other_boxes[0].x2 - other_boxes[0].x1,
+                                        other_boxes[0].y2 - other_boxes[0].y1);
+      return;
+    }
+
+  /* Both sets of boxes are disjoint so the intersections of each pair
+   * are also disjoint */
+  result = g_array_new (FALSE, FALSE, sizeof (CoglRegionBox));
+
+  for (i = 0; i < region->boxes->len; i++)
+    {
+      const CoglRegionBox *a = &g_array_index (region->boxes, CoglRegionBox, i);
+
+      if (!boxes_overlap (a, &other->extents))
+        continue;
+
+      for (j = 0; j < other->boxes->len; j++)
+        {
+          const CoglRegionBox *b = other_boxes + j;
+          CoglRegionBox box;
+
+          box.x1 = MAX (a->x1, b->x1);
+          box.y1 = MAX (a->y1, b->y1);
+          box.x2 = MIN (a->x2, b->x2);
+          box.y2 = MIN (a->y2, b->y2);
+
+          if (!box_is_empty (&box))
+            g_array_append_val (result, box);
+        }
+    }
+
+  g_array_free (region->boxes, TRUE);
+  region->boxes = result;
+  update_extents (region);
+}
+
+void
+_cogl_region_simplify (CoglRegion *region,
+                       int max_boxes)
+{
+  if (region->boxes->len <= max_boxes)
+    return;
+
+  g_array_set_size (region->boxes, 1);
+  g_array_index (region->boxes, CoglRegionBox, 0) = region->extents;
+}
+
+static int
+count_pixels (const CoglRegion *region)
+{
+  const CoglRegionBox *boxes = _cogl_region_get_boxes (region);
+  int i, n_pixels = 0;
+
+  for (i = 0; i < region->boxes->len; i++)
+    n_pixels += (boxes[i].x2 - boxes[i].x1) * (boxes[i].y2 - boxes[i].y1);
+
+  return n_pixels;
+}
+
+static CoglBool
+region_contains_point (const CoglRegion *region,
+                       int x,
+                       int y)
+{
+  const CoglRegionBox *boxes = _cogl_region_get_boxes (region);
+  int i;
+
+  for (i = 0; i < region->boxes->len; i++)
+    if (x >= boxes[i].x1 && x < boxes[i].x2 &&
+        y >= boxes[i].y1 && y < boxes[i].y2)
+      return TRUE;
+
+  return FALSE;
+}
+
+static void
+verify_region (const CoglRegion *region,
+               const uint8_t *mask,
+               int size)
+{
+  const CoglRegionBox *boxes = _cogl_region_get_boxes (region);
+  int n_pixels = 0;
+  int x, y, i;
+
+  /* The boxes must not overlap so the total area must match the
+   * number of pixels in the mask */
+  for (y = 0; y < size; y++)
+    for (x = 0; x < size; x++)
+      {
+        g_assert_cmpint (region_contains_point (region, x, y),
+                         ==,
+                         mask[y * size + x]);
+        n_pixels += mask[y * size + x];
+      }
+
+  g_assert_cmpint (count_pixels (region), ==, n_pixels);
+
+  for (i = 0; i < region->boxes->len; i++)
+    g_assert (box_contains (&region->extents, boxes + i));
+}
+
+static void
+set_mask_rectangle (uint8_t *mask,
+                    int size,
+                    int x, int y, int width, int height,
+                    uint8_t value)
+{
+  int i, j;
+
+  for (j = y; j < y + height; j++)
+    for (i = x; i < x + width; i++)
+      mask[j * size + i] = value;
+}
+
+UNIT_TEST (check_region_operations,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+#define MASK_SIZE 32
+  static const int rects[][4] =
+    {
+      { 4, 4, 8, 8 },
+      { 8, 8, 8, 8 },
+      { 0, 10, 32, 2 },
+      { 6, 0, 2, 32 },
+      { 5, 5, 2, 2 },
+      { 20, 20, 10, 10 },
+      { 2, 2, 26, 26 }
+    };
+  uint8_t mask[MASK_SIZE * MASK_SIZE];
+  uint8_t other_mask[MASK_SIZE * MASK_SIZE];
+  CoglRegion region, other;
+  int i, j;
+
+  _cogl_region_init (&region);
+  _cogl_region_init (&other);
+
+  memset (mask, 0, sizeof (mask));
+
+  /* Add overlapping rectangles one at a time */
+  for (i = 0; i < G_N_ELEMENTS (rects); i++)
+    {
+      _cogl_region_union_rectangle (&region,
+                                    rects[i][0], rects[i][1],
+                                    rects[i][2], rects[i][3]);
+      set_mask_rectangle (mask, MASK_SIZE,
+                          rects[i][0], rects[i][1],
+                          rects[i][2], rects[i][3],
+                          1);
+      verify_region (&region, mask, MASK_SIZE);
+    }
+
+  /* Empty rectangles are ignored */
+  _cogl_region_union_rectangle (&region, 30, 0, 0, 10);
+  verify_region (&region, mask, MASK_SIZE);
+
+  /* Intersect with a rectangle */
+  _cogl_region_intersect_rectangle (&region, 0, 0, 16, 31);
+  for (j = 0; j < MASK_SIZE; j++)
+    for (i = 0; i < MASK_SIZE; i++)
+      if (i >= 16 || j >= 31)
+        mask[j * MASK_SIZE + i] = 0;
+  verify_region (&region, mask, MASK_SIZE);
+
+  /* Intersect with a region made of two separate rectangles */
+  memset (other_mask, 0, sizeof (other_mask));
+  _cogl_region_union_rectangle (&other, 1, 1, 6, 6);
+  set_mask_rectangle (other_mask, MASK_SIZE, 1, 1, 6, 6, 1);
+  _cogl_region_union_rectangle (&other, 10, 3, 20, 20);
+  set_mask_rectangle (other_mask, MASK_SIZE, 10, 3, 20, 20, 1);
+  verify_region (&other, other_mask, MASK_SIZE);
+
+  _cogl_region_intersect (&region, &other);
+  for (i = 0; i < MASK_SIZE * MASK_SIZE; i++)
+    mask[i] &= other_mask[i];
+  verify_region (&region, mask, MASK_SIZE);
+
+  /* Union of the two regions */
+  _cogl_region_union (&region, &other);
+  for (i = 0; i < MASK_SIZE * MASK_SIZE; i++)
+    mask[i] |= other_mask[i];
+  verify_region (&region, mask, MASK_SIZE);
+
+  /* Disjoint regions intersect to nothing */
+  _cogl_region_clear (&other);
+  _cogl_region_union_rectangle (&other, 31, 31, 1, 1);
+  _cogl_region_intersect (&region, &other);
+  g_assert (_cogl_region_is_empty (&region));
+
+  /* Simplifying replaces the boxes with the extents */
+  _cogl_region_union_rectangle (&region, 0, 0, 2, 2);
+  _cogl_region_union_rectangle (&region, 4, 4, 2, 2);
+  _cogl_region_simplify (&region, 1);
+  g_assert_cmpint (_cogl_region_get_n_boxes (&region), ==, 1);
+  memset (mask, 0, sizeof (mask));
+  set_mask_rectangle (mask, MASK_SIZE, 0, 0, 6, 6, 1);
+  verify_region (&region, mask, MASK_SIZE);
+
+  /* A rectangle covering the whole region replaces all of the boxes */
+  _cogl_region_union_rectangle (&region, 8, 8, 2, 2);
+  _cogl_region_union_rectangle (&region, 0, 0, 10, 10);
+  g_assert_cmpint (_cogl_region_get_n_boxes (&region), ==, 1);
+
+  _cogl_region_destroy (&other);
+  _cogl_region_destroy (&region);
+#undef MASK_SIZE
+}
@@ -0,0 +1,101 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_STATIC_BATCH_PRIVATE_H
+#define __COGL_STATIC_BATCH_PRIVATE_H
+
+#include <glib.h>
+
+#include "cogl-static-batch.h"
+#include "cogl-object-private.h"
+#include "cogl-attribute-buffer.h"
+#include "cogl-attribute.h"
+
+typedef struct _CoglStaticBatchDraw
+{
+  /* A copy of the pipeline of the first rectangle in the group. The
+   * batch owns a reference. When the group is baked this has the
+   * wrap mode overrides applied after the batch is drawn for the
+   * first time */
+  CoglPipeline *pipeline;
+
+  int n_rectangles;
+
+  /* Whether the vertices of the group are in the attribute
+   * buffer. Otherwise the rectangles are drawn through the journal
+   * with the coordinates in fallback_data */
+  CoglBool baked;
+
+  /* For baked groups. Each vertex is 2 floats for the position, 4
+   * bytes for the color and 2 floats per layer for the texture
+   * coordinates */
+  int n_layers;
+  /* Mask of the layers whose automatic wrap modes have to be changed
+   * to repeat because the texture coordinates go outside [0,1] */
+  uint32_t repeat_layers;
+  /* Offset in floats of the first vertex in the vertex data */
+  int first_vertex_float;
+  CoglAttribute **attributes;
+  int n_attributes;
+
+  /* For groups that aren't baked */
+  int fallback_data_index;
+  CoglBool textured;
+  int first_rect;
+} CoglStaticBatchDraw;
+
+struct _CoglStaticBatch
+{
+  CoglObject _parent;
+
+  CoglContext *context;
+
+  /* Array of CoglStaticBatchDraws */
+  GArray *draws;
+
+  /* Array of floats for the baked vertices. This is freed once it
+   * has been uploaded to the attribute buffer */
+  GArray *vertices;
+  CoglAttributeBuffer *attribute_buffer;
+  /* The largest number of rectangles in a baked group */
+  int max_baked_rectangles;
+
+  /* Array of floats for the coordinates of the rectangles that can't
+   * be baked and an array of CoglMultiTexturedRects pointing into it
+   * which is built when the batch is first drawn */
+  GArray *fallback_data;
+  GArray *fallback_rects;
+  int n_fallback_rects;
+
+  /* Set once the batch has been drawn. After that it can't be
+   * modified */
+  CoglBool sealed;
+};
+
+#endif /* __COGL_STATIC_BATCH_PRIVATE_H */
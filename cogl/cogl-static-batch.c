@@ -0,0 +1,580 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "cogl-context-private.h"
+#include "cogl-static-batch-private.h"
+#include "cogl-pipeline-private.h"
+#include "cogl-pipeline-state-private.h"
+#include "cogl-texture-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-primitives-private.h"
+#include "cogl-indices.h"
+
+/* The rectangle indices are at most 16-bit so a baked group can't
+ * have more vertices than that */
+#define MAX_BAKED_RECTANGLES (65536 / 4)
+
+/* Each baked vertex is 2 floats for the position, 1 float's worth of
+ * bytes for the color and 2 floats per layer */
+#define GET_VERTEX_STRIDE_FOR_N_LAYERS(N_LAYERS) (3 + (N_LAYERS) * 2)
+
+static void _cogl_static_batch_free (CoglStaticBatch *batch);
+
+COGL_OBJECT_DEFINE (StaticBatch, static_batch);
+
+CoglStaticBatch *
+cogl_static_batch_new (CoglContext *context)
+{
+  CoglStaticBatch *batch = g_slice_new0 (CoglStaticBatch);
+
+  batch->context = context;
+  batch->draws = g_array_new (FALSE, FALSE, sizeof (CoglStaticBatchDraw));
+  batch->vertices = g_array_new (FALSE, FALSE, sizeof (float));
+  batch->fallback_data = g_array_new (FALSE, FALSE, sizeof (float));
+  batch->fallback_rects = g_array_new (FALSE, FALSE,
+                                       sizeof (CoglMultiTexturedRect));
+
+  return _cogl_static_batch_object_new (batch);
+}
+
+static void
+_cogl_static_batch_free (CoglStaticBatch *batch)
+{
+  int i, j;
+
+  for (i = 0; i < batch->draws->len; i++)
+    {
+      CoglStaticBatchDraw *draw =
+        &g_array_index (batch->draws, CoglStaticBatchDraw, i);
+
+      cogl_object_unref (draw->pipeline);
+
+      for (j = 0; j < draw->n_attributes; j++)
+        cogl_object_unref (draw->attributes[j]);
+      g_free (draw->attributes);
+    }
+
+  g_array_free (batch->draws, TRUE);
+
+  if (batch->vertices)
+    g_array_free (batch->vertices, TRUE);
+  if (batch->attribute_buffer)
+    cogl_object_unref (batch->attribute_buffer);
+
+  g_array_free (batch->fallback_data, TRUE);
+  g_array_free (batch->fallback_rects, TRUE);
+
+  g_slice_free (CoglStaticBatch, batch);
+}
+
+static CoglStaticBatchDraw *
+get_last_draw (CoglStaticBatch *batch)
+{
+  if (batch->draws->len == 0)
+    return NULL;
+
+  return &g_array_index (batch->draws,
+                         CoglStaticBatchDraw,
+                         batch->draws->len - 1);
+}
+
+static CoglStaticBatchDraw *
+add_draw (CoglStaticBatch *batch,
+          CoglPipeline *pipeline,
+          CoglBool baked)
+{
+  CoglStaticBatchDraw *draw;
+
+  g_array_set_size (batch->draws, batch->draws->len + 1);
+  draw = get_last_draw (batch);
+
+  memset (draw, 0, sizeof (CoglStaticBatchDraw));
+  /* Take a copy so that later changes to the pipeline don't affect
+   * the batch */
+  draw->pipeline = cogl_pipeline_copy (pipeline);
+  draw->baked = baked;
+
+  return draw;
+}
+
+static CoglBool
+check_layer_cb (CoglPipeline *pipeline,
+                int layer_index,
+                void *user_data)
+{
+  CoglBool *can_bake = user_data;
+  CoglTexture *texture =
+    cogl_pipeline_get_layer_texture (pipeline, layer_index);
+
+  /* NULL textures are handled by _cogl_pipeline_flush_gl_state */
+  if (texture == NULL)
+    return TRUE;
+
+  /* Baked rectangles are drawn like any other primitive which
+   * migrates textures out of the atlas. That needs to happen before
+   * the texture coordinates are transformed so that they still
+   * match the texture when it is drawn */
+  _cogl_texture_ensure_non_quad_rendering (texture);
+
+  if (cogl_texture_is_sliced (texture) ||
+      !_cogl_texture_can_hardware_repeat (texture))
+    {
+      *can_bake = FALSE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+typedef struct
+{
+  /* The coordinates given for the first layer or NULL */
+  const float *user_tex_coords;
+  /* 4 floats per layer */
+  float *tex_coords;
+  int i;
+  uint32_t repeat_layers;
+} TransformTexCoordsState;
+
+static CoglBool
+transform_tex_coords_cb (CoglPipeline *pipeline,
+                         int layer_index,
+                         void *user_data)
+{
+  TransformTexCoordsState *state = user_data;
+  float *tex_coords = state->tex_coords + state->i * 4;
+  CoglTexture *texture;
+
+  if (state->i == 0 && state->user_tex_coords)
+    memcpy (tex_coords, state->user_tex_coords, sizeof (float) * 4);
+  else
+    {
+      tex_coords[0] = 0.0f;
+      tex_coords[1] = 0.0f;
+      tex_coords[2] = 1.0f;
+      tex_coords[3] = 1.0f;
+    }
+
+  texture = cogl_pipeline_get_layer_texture (pipeline, layer_index);
+
+  /* Like the journal, an automatic wrap mode becomes repeat if the
+   * coordinates need repeating. The rectangles that need this are
+   * put in a separate group */
+  if (texture &&
+      _cogl_texture_transform_quad_coords_to_gl (texture, tex_coords) ==
+      COGL_TRANSFORM_HARDWARE_REPEAT &&
+      state->i < 32 &&
+      (cogl_pipeline_get_layer_wrap_mode_s (pipeline, layer_index) ==
+       COGL_PIPELINE_WRAP_MODE_AUTOMATIC ||
+       cogl_pipeline_get_layer_wrap_mode_t (pipeline, layer_index) ==
+       COGL_PIPELINE_WRAP_MODE_AUTOMATIC))
+    state->repeat_layers |= 1 << state->i;
+
+  state->i++;
+
+  return TRUE;
+}
+
+static void
+add_baked_rectangle (CoglStaticBatch *batch,
+                     CoglStaticBatchDraw *draw,
+                     const float *position,
+                     const uint8_t *color,
+                     const float *tex_coords)
+{
+  /* The corners are in the same order as the journal uses so that
+   * the rectangle indices make two triangles out of them. Each pair
+   * is the index of the x and y coordinate in the rectangle */
+  static const int corners[4][2] = { { 0, 1 }, { 0, 3 }, { 2, 3 }, { 2, 1 } };
+  int stride = GET_VERTEX_STRIDE_FOR_N_LAYERS (draw->n_layers);
+  int first_float = batch->vertices->len;
+  float *v;
+  int i, j;
+
+  g_array_set_size (batch->vertices, first_float + stride * 4);
+  v = &g_array_index (batch->vertices, float, first_float);
+
+  for (i = 0; i < 4; i++, v += stride)
+    {
+      v[0] = position[corners[i][0]];
+      v[1] = position[corners[i][1]];
+      memcpy (v + 2, color, 4);
+
+      for (j = 0; j < draw->n_layers; j++)
+        {
+          v[3 + j * 2] = tex_coords[j * 4 + corners[i][0]];
+          v[4 + j * 2] = tex_coords[j * 4 + corners[i][1]];
+        }
+    }
+
+  draw->n_rectangles++;
+}
+
+static void
+add_fallback_rectangles (CoglStaticBatch *batch,
+                         CoglPipeline *pipeline,
+                         const float *coordinates,
+                         unsigned int n_rectangles,
+                         CoglBool textured)
+{
+  CoglStaticBatchDraw *draw = get_last_draw (batch);
+
+  if (draw == NULL ||
+      draw->baked ||
+      draw->textured != textured ||
+      !_cogl_pipeline_equal (draw->pipeline,
+                             pipeline,
+                             COGL_PIPELINE_STATE_ALL,
+                             COGL_PIPELINE_LAYER_STATE_ALL,
+                             0))
+    {
+      draw = add_draw (batch, pipeline, FALSE);
+      draw->fallback_data_index = batch->fallback_data->len;
+      draw->textured = textured;
+      draw->first_rect = batch->n_fallback_rects;
+    }
+
+  g_array_append_vals (batch->fallback_data,
+                       coordinates,
+                       n_rectangles * (textured ? 8 : 4));
+  draw->n_rectangles += n_rectangles;
+  batch->n_fallback_rects += n_rectangles;
+}
+
+static void
+add_rectangles (CoglStaticBatch *batch,
+                CoglPipeline *pipeline,
+                const float *coordinates,
+                unsigned int n_rectangles,
+                CoglBool textured)
+{
+  int coords_stride = textured ? 8 : 4;
+  CoglBool can_bake = TRUE;
+  CoglStaticBatchDraw *draw;
+  TransformTexCoordsState state;
+  uint8_t color[4];
+  int n_layers;
+  int i;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_static_batch (batch));
+  _COGL_RETURN_IF_FAIL (cogl_is_pipeline (pipeline));
+  _COGL_RETURN_IF_FAIL (!batch->sealed);
+
+  if (n_rectangles == 0)
+    return;
+
+  cogl_pipeline_foreach_layer (pipeline, check_layer_cb, &can_bake);
+
+  if (!can_bake)
+    {
+      add_fallback_rectangles (batch,
+                               pipeline,
+                               coordinates,
+                               n_rectangles,
+                               textured);
+      return;
+    }
+
+  n_layers = cogl_pipeline_get_n_layers (pipeline);
+  state.user_tex_coords = NULL;
+  state.tex_coords = g_alloca (sizeof (float) * 4 * MAX (n_layers, 1));
+
+  /* The color is stored in the vertices so rectangles whose
+   * pipelines only differ by color can be drawn together */
+  _cogl_pipeline_get_colorubv (pipeline, color);
+
+  /* Only compare the pipeline with the last group once because all
+   * of the rectangles use the same one */
+  draw = get_last_draw (batch);
+  if (draw &&
+      (!draw->baked ||
+       !_cogl_pipeline_equal (draw->pipeline,
+                              pipeline,
+                              COGL_PIPELINE_STATE_ALL &
+                              ~COGL_PIPELINE_STATE_COLOR,
+                              COGL_PIPELINE_LAYER_STATE_ALL,
+                              0)))
+    draw = NULL;
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      const float *coords = coordinates + i * coords_stride;
+
+      if (textured)
+        state.user_tex_coords = coords + 4;
+      state.i = 0;
+      state.repeat_layers = 0;
+      cogl_pipeline_foreach_layer (pipeline, transform_tex_coords_cb, &state);
+
+      if (draw == NULL ||
+          draw->repeat_layers != state.repeat_layers ||
+          draw->n_rectangles >= MAX_BAKED_RECTANGLES)
+        {
+          draw = add_draw (batch, pipeline, TRUE);
+          draw->n_layers = n_layers;
+          draw->repeat_layers = state.repeat_layers;
+          draw->first_vertex_float = batch->vertices->len;
+        }
+
+      add_baked_rectangle (batch, draw, coords, color, state.tex_coords);
+
+      batch->max_baked_rectangles = MAX (batch->max_baked_rectangles,
+                                         draw->n_rectangles);
+    }
+}
+
+void
+cogl_static_batch_add_rectangles (CoglStaticBatch *batch,
+                                  CoglPipeline *pipeline,
+                                  const float *coordinates,
+                                  unsigned int n_rectangles)
+{
+  add_rectangles (batch, pipeline, coordinates, n_rectangles, FALSE);
+}
+
+void
+cogl_static_batch_add_textured_rectangles (CoglStaticBatch *batch,
+                                           CoglPipeline *pipeline,
+                                           const float *coordinates,
+                                           unsigned int n_rectangles)
+{
+  add_rectangles (batch, pipeline, coordinates, n_rectangles, TRUE);
+}
+
+int
+cogl_static_batch_get_n_batches (CoglStaticBatch *batch)
+{
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_static_batch (batch), 0);
+
+  return batch->draws->len;
+}
+
+typedef struct
+{
+  CoglStaticBatch *batch;
+  CoglStaticBatchDraw *draw;
+  int i;
+} BakeLayerState;
+
+static CoglBool
+bake_layer_cb (CoglPipeline *pipeline,
+               int layer_index,
+               void *user_data)
+{
+  BakeLayerState *state = user_data;
+  CoglStaticBatchDraw *draw = state->draw;
+  size_t stride =
+    GET_VERTEX_STRIDE_FOR_N_LAYERS (draw->n_layers) * sizeof (float);
+  char *name;
+
+  if (state->i < 32 && (draw->repeat_layers & (1 << state->i)))
+    {
+      if (cogl_pipeline_get_layer_wrap_mode_s (pipeline, layer_index) ==
+          COGL_PIPELINE_WRAP_MODE_AUTOMATIC)
+        cogl_pipeline_set_layer_wrap_mode_s (pipeline,
+                                             layer_index,
+                                             COGL_PIPELINE_WRAP_MODE_REPEAT);
+      if (cogl_pipeline_get_layer_wrap_mode_t (pipeline, layer_index) ==
+          COGL_PIPELINE_WRAP_MODE_AUTOMATIC)
+        cogl_pipeline_set_layer_wrap_mode_t (pipeline,
+                                             layer_index,
+                                             COGL_PIPELINE_WRAP_MODE_REPEAT);
+    }
+
+  name = g_strdup_printf ("cogl_tex_coord%d_in", layer_index);
+  draw->attributes[2 + state->i] =
+    cogl_attribute_new (state->batch->attribute_buffer,
+                        name,
+                        stride,
+                        (draw->first_vertex_float + 3 + state->i * 2) *
+                        sizeof (float),
+                        2,
+                        COGL_ATTRIBUTE_TYPE_FLOAT);
+  g_free (name);
+
+  state->i++;
+
+  return TRUE;
+}
+
+static void
+bake_draw (CoglStaticBatch *batch,
+           CoglStaticBatchDraw *draw)
+{
+  size_t stride =
+    GET_VERTEX_STRIDE_FOR_N_LAYERS (draw->n_layers) * sizeof (float);
+  size_t offset = draw->first_vertex_float * sizeof (float);
+  BakeLayerState state;
+
+  draw->n_attributes = 2 + draw->n_layers;
+  draw->attributes = g_new (CoglAttribute *, draw->n_attributes);
+
+  draw->attributes[0] = cogl_attribute_new (batch->attribute_buffer,
+                                            "cogl_position_in",
+                                            stride,
+                                            offset,
+                                            2,
+                                            COGL_ATTRIBUTE_TYPE_FLOAT);
+  draw->attributes[1] =
+    cogl_attribute_new (batch->attribute_buffer,
+                        "cogl_color_in",
+                        stride,
+                        offset + sizeof (float) * 2,
+                        4,
+                        COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE);
+
+  state.batch = batch;
+  state.draw = draw;
+  state.i = 0;
+  cogl_pipeline_foreach_layer (draw->pipeline, bake_layer_cb, &state);
+}
+
+static void
+seal (CoglStaticBatch *batch)
+{
+  CoglMultiTexturedRect *rects;
+  const float *fallback_data;
+  int i, j;
+
+  if (batch->vertices->len > 0)
+    {
+      batch->attribute_buffer =
+        cogl_attribute_buffer_new (batch->context,
+                                   batch->vertices->len * sizeof (float),
+                                   batch->vertices->data);
+      cogl_buffer_set_update_hint (COGL_BUFFER (batch->attribute_buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STATIC);
+    }
+
+  g_array_set_size (batch->fallback_rects, batch->n_fallback_rects);
+  rects = (CoglMultiTexturedRect *) batch->fallback_rects->data;
+  fallback_data = (const float *) batch->fallback_data->data;
+
+  for (i = 0; i < batch->draws->len; i++)
+    {
+      CoglStaticBatchDraw *draw =
+        &g_array_index (batch->draws, CoglStaticBatchDraw, i);
+      int stride = draw->textured ? 8 : 4;
+
+      if (draw->baked)
+        {
+          bake_draw (batch, draw);
+          continue;
+        }
+
+      for (j = 0; j < draw->n_rectangles; j++)
+        {
+          CoglMultiTexturedRect *rect = rects + draw->first_rect + j;
+          const float *coords =
+            fallback_data + draw->fallback_data_index + j * stride;
+
+          rect->position = coords;
+
+          if (draw->textured)
+            {
+              rect->tex_coords = coords + 4;
+              rect->tex_coords_len = 4;
+            }
+          else
+            {
+              rect->tex_coords = NULL;
+              rect->tex_coords_len = 0;
+            }
+        }
+    }
+
+  /* The batch can't be modified any more so the vertices aren't
+   * needed now that they have been uploaded */
+  g_array_free (batch->vertices, TRUE);
+  batch->vertices = NULL;
+
+  batch->sealed = TRUE;
+}
+
+void
+cogl_static_batch_draw (CoglStaticBatch *batch,
+                        CoglFramebuffer *framebuffer,
+                        const CoglMatrix *transform)
+{
+  CoglIndices *indices = NULL;
+  int i;
+
+  _COGL_RETURN_IF_FAIL (cogl_is_static_batch (batch));
+  _COGL_RETURN_IF_FAIL (cogl_is_framebuffer (framebuffer));
+
+  if (!batch->sealed)
+    seal (batch);
+
+  if (batch->draws->len == 0)
+    return;
+
+  if (transform)
+    {
+      cogl_framebuffer_push_matrix (framebuffer);
+      cogl_framebuffer_transform (framebuffer, transform);
+    }
+
+  if (batch->max_baked_rectangles > 0)
+    indices = cogl_get_rectangle_indices (batch->context,
+                                          batch->max_baked_rectangles);
+
+  for (i = 0; i < batch->draws->len; i++)
+    {
+      CoglStaticBatchDraw *draw =
+        &g_array_index (batch->draws, CoglStaticBatchDraw, i);
+
+      if (draw->baked)
+        _cogl_framebuffer_draw_indexed_attributes (framebuffer,
+                                                   draw->pipeline,
+                                                   COGL_VERTICES_MODE_TRIANGLES,
+                                                   0, /* first_vertex */
+                                                   draw->n_rectangles * 6,
+                                                   indices,
+                                                   draw->attributes,
+                                                   draw->n_attributes,
+                                                   0 /* flags */);
+      else
+        _cogl_framebuffer_draw_multitextured_rectangles (
+                                  framebuffer,
+                                  draw->pipeline,
+                                  &g_array_index (batch->fallback_rects,
+                                                  CoglMultiTexturedRect,
+                                                  draw->first_rect),
+                                  draw->n_rectangles);
+    }
+
+  if (transform)
+    cogl_framebuffer_pop_matrix (framebuffer);
+}
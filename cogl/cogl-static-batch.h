@@ -0,0 +1,187 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_STATIC_BATCH_H__
+#define __COGL_STATIC_BATCH_H__
+
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-framebuffer.h>
+#include <cogl/cogl-pipeline.h>
+#include <cogl/cogl-matrix.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-static-batch
+ * @short_description: Functions for drawing static rectangles
+ *   without batching them again every frame
+ *
+ * Rectangles drawn with cogl_framebuffer_draw_rectangles() go
+ * through the journal where their vertices are transformed, batched
+ * by pipeline and uploaded to the GPU again every time they are
+ * drawn. For content that doesn't change between frames, such as
+ * the chrome of a user interface, that work is wasted.
+ *
+ * A #CoglStaticBatch is given a list of rectangles once. The first
+ * time it is drawn their vertices are uploaded to a single
+ * #CoglAttributeBuffer and consecutive rectangles whose pipelines
+ * only differ by color are grouped into one draw call. Drawing the
+ * batch again only submits those draw calls.
+ *
+ * The rectangles are transformed by the modelview matrix of the
+ * framebuffer at the time the batch is drawn. The batch takes a copy
+ * of each pipeline as it is added so changing the pipeline
+ * afterwards doesn't affect the batch. The batch can't be modified
+ * once it has been drawn.
+ *
+ * Rectangles that can't be drawn from a single vertex buffer, for
+ * example because they use a sliced texture, are still supported
+ * but they are drawn through the journal as usual.
+ */
+
+typedef struct _CoglStaticBatch CoglStaticBatch;
+#define COGL_STATIC_BATCH(X) ((CoglStaticBatch *)(X))
+
+/**
+ * cogl_static_batch_new:
+ * @context: A #CoglContext
+ *
+ * Creates a new empty static batch.
+ *
+ * Return value: (transfer full): A newly allocated #CoglStaticBatch
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglStaticBatch *
+cogl_static_batch_new (CoglContext *context);
+
+/**
+ * cogl_is_static_batch:
+ * @object: A #CoglObject pointer
+ *
+ * Gets whether the given object references a #CoglStaticBatch.
+ *
+ * Return value: %TRUE if the object references a #CoglStaticBatch
+ *   and %FALSE otherwise.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_is_static_batch (void *object);
+
+/**
+ * cogl_static_batch_add_rectangles:
+ * @batch: A #CoglStaticBatch
+ * @pipeline: A #CoglPipeline state object
+ * @coordinates: (array length=n_rectangles) (element-type float): an
+ *   array of coordinates containing groups of 4 float values:
+ *   [x_1, y_1, x_2, y_2] that are interpreted as two position
+ *   coordinates; one for the top left of the rectangle (x1, y1), and
+ *   one for the bottom right of the rectangle (x2, y2).
+ * @n_rectangles: number of rectangles defined in @coordinates.
+ *
+ * Adds rectangles to the batch that will be drawn as if by
+ * cogl_framebuffer_draw_rectangles(). This can't be called after the
+ * batch has been drawn.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_static_batch_add_rectangles (CoglStaticBatch *batch,
+                                  CoglPipeline *pipeline,
+                                  const float *coordinates,
+                                  unsigned int n_rectangles);
+
+/**
+ * cogl_static_batch_add_textured_rectangles:
+ * @batch: A #CoglStaticBatch
+ * @pipeline: A #CoglPipeline state object
+ * @coordinates: (array) (element-type float): an array containing
+ *   groups of 8 float values: [x_1, y_1, x_2, y_2, s_1, t_1, s_2, t_2]
+ *   that have the same meaning as the arguments for
+ *   cogl_framebuffer_draw_textured_rectangle().
+ * @n_rectangles: number of rectangles defined in @coordinates.
+ *
+ * Adds textured rectangles to the batch that will be drawn as if by
+ * cogl_framebuffer_draw_textured_rectangles(). This can't be called
+ * after the batch has been drawn.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_static_batch_add_textured_rectangles (CoglStaticBatch *batch,
+                                           CoglPipeline *pipeline,
+                                           const float *coordinates,
+                                           unsigned int n_rectangles);
+
+/**
+ * cogl_static_batch_get_n_batches:
+ * @batch: A #CoglStaticBatch
+ *
+ * Gets the number of groups that the rectangles have been split
+ * into. Each group that could be baked into the vertex buffer is
+ * drawn with a single draw call.
+ *
+ * Return value: The number of groups of rectangles
+ * Since: 2.0
+ * Stability: Unstable
+ */
+int
+cogl_static_batch_get_n_batches (CoglStaticBatch *batch);
+
+/**
+ * cogl_static_batch_draw:
+ * @batch: A #CoglStaticBatch
+ * @framebuffer: The #CoglFramebuffer to draw to
+ * @transform: (allow-none): An extra transform to apply or %NULL
+ *
+ * Draws all of the rectangles in @batch to @framebuffer. If
+ * @transform is not %NULL then it is multiplied with the current
+ * modelview matrix of the framebuffer while the batch is drawn. The
+ * modelview matrix of @framebuffer is left unchanged.
+ *
+ * Since: 2.0
+ * Stability: Unstable
+ */
+void
+cogl_static_batch_draw (CoglStaticBatch *batch,
+                        CoglFramebuffer *framebuffer,
+                        const CoglMatrix *transform);
+
+COGL_END_DECLS
+
+#endif /* __COGL_STATIC_BATCH_H__ */
@@ -35,6 +35,7 @@
 #include "cogl-pipeline-private.h"
 #include "cogl-texture-private.h"
 #include "cogl-texture-2d.h"
+#include "cogl-mipmap-chain-private.h"
 
 #ifdef COGL_HAS_EGL_SUPPORT
 #include "cogl-egl-defines.h"
@@ -52,6 +53,12 @@ struct _CoglTexture2D
   CoglBool mipmaps_dirty;
   CoglBool is_foreign;
 
+  CoglTexture2DMipmapFilter mipmap_filter;
+  CoglBool mipmap_srgb;
+  /* A copy of the mipmap levels in system memory. This is only used
+   * if the mipmaps are generated on the CPU */
+  CoglMipmapChain *mipmap_chain;
+
   /* TODO: factor out these OpenGL specific members into some form
    * of driver private state. */
 
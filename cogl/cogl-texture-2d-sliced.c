@@ -891,6 +891,8 @@ allocate_slices (CoglTexture2DSliced *tex_2ds,
                                            x_span->size, y_span->size));
 
           _cogl_texture_copy_internal_format (tex, slice);
+          _cogl_texture_set_memory_type (slice,
+                                         COGL_MEMORY_TYPE_SLICED_TEXTURE);
 
           g_array_append_val (tex_2ds->slice_textures, slice);
           if (!cogl_texture_allocate (slice, error))
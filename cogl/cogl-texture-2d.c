@@ -47,6 +47,8 @@
 #include "cogl-pipeline-opengl-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-error-private.h"
+#include "cogl-compressed-image-private.h"
+#include "cogl-debug.h"
 #ifdef COGL_HAS_EGL_SUPPORT
 #include "cogl-winsys-egl-private.h"
 #endif
@@ -78,6 +80,9 @@ _cogl_texture_2d_free (CoglTexture2D *tex_2d)
 
   ctx->driver_vtable->texture_2d_free (tex_2d);
 
+  if (tex_2d->mipmap_chain)
+    _cogl_mipmap_chain_free (tex_2d->mipmap_chain);
+
   /* Chain up */
   _cogl_texture_free (COGL_TEXTURE (tex_2d));
 }
@@ -109,6 +114,10 @@ _cogl_texture_2d_create_base (CoglContext *ctx,
 
   tex_2d->is_foreign = FALSE;
 
+  tex_2d->mipmap_filter = COGL_TEXTURE_2D_MIPMAP_FILTER_DRIVER;
+  tex_2d->mipmap_srgb = FALSE;
+  tex_2d->mipmap_chain = NULL;
+
   ctx->driver_vtable->texture_2d_init (tex_2d);
 
   return _cogl_texture_2d_object_new (tex_2d);
@@ -130,13 +139,216 @@ cogl_texture_2d_new_with_size (CoglContext *ctx,
                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE, loader);
 }
 
+static CoglPixelFormat
+get_mipmap_chain_format (CoglTexture2D *tex_2d)
+{
+  return (tex_2d->mipmap_chain->premultiplied ?
+          COGL_PIXEL_FORMAT_RGBA_8888_PRE :
+          COGL_PIXEL_FORMAT_RGBA_8888);
+}
+
+static void
+drop_mipmap_chain (CoglTexture2D *tex_2d)
+{
+  if (tex_2d->mipmap_chain == NULL)
+    return;
+
+  COGL_NOTE (PERFORMANCE,
+             "Falling back to driver generated mipmaps because the "
+             "CPU copy of the texture is no longer valid");
+
+  _cogl_mipmap_chain_free (tex_2d->mipmap_chain);
+  tex_2d->mipmap_chain = NULL;
+}
+
+static void
+upload_mipmap_level_cb (int level,
+                        int x,
+                        int y,
+                        int width,
+                        int height,
+                        const uint8_t *data,
+                        int rowstride,
+                        void *user_data)
+{
+  CoglTexture2D *tex_2d = user_data;
+  CoglContext *ctx = COGL_TEXTURE (tex_2d)->context;
+  CoglError *ignore_error = NULL;
+  CoglBitmap *bmp;
+
+  bmp = cogl_bitmap_new_for_data (ctx,
+                                  width, height,
+                                  get_mipmap_chain_format (tex_2d),
+                                  rowstride,
+                                  (uint8_t *) data);
+
+  if (!ctx->driver_vtable->texture_2d_copy_from_bitmap (tex_2d,
+                                                        0, 0, /* src_x/y */
+                                                        width, height,
+                                                        bmp,
+                                                        x, y,
+                                                        level,
+                                                        &ignore_error))
+    {
+      g_warning ("Failed to upload mipmap level %i: %s",
+                 level, ignore_error->message);
+      cogl_error_free (ignore_error);
+    }
+
+  cogl_object_unref (bmp);
+}
+
+/* Copies part of a bitmap into the first level of the mipmap chain.
+ * If the bitmap can't be read then the chain is dropped */
+static void
+update_mipmap_chain_from_bitmap (CoglTexture2D *tex_2d,
+                                 CoglBitmap *bmp,
+                                 int src_x,
+                                 int src_y,
+                                 int width,
+                                 int height,
+                                 int dst_x,
+                                 int dst_y)
+{
+  CoglError *ignore_error = NULL;
+  CoglBitmap *converted;
+  uint8_t *data;
+
+  converted = _cogl_bitmap_convert (bmp,
+                                    get_mipmap_chain_format (tex_2d),
+                                    &ignore_error);
+  if (converted == NULL)
+    {
+      cogl_error_free (ignore_error);
+      drop_mipmap_chain (tex_2d);
+      return;
+    }
+
+  data = _cogl_bitmap_map (converted,
+                           COGL_BUFFER_ACCESS_READ,
+                           0, /* hints */
+                           &ignore_error);
+  if (data == NULL)
+    {
+      cogl_error_free (ignore_error);
+      cogl_object_unref (converted);
+      drop_mipmap_chain (tex_2d);
+      return;
+    }
+
+  _cogl_mipmap_chain_set_region (tex_2d->mipmap_chain,
+                                 dst_x, dst_y,
+                                 width, height,
+                                 data +
+                                 src_y * cogl_bitmap_get_rowstride (converted) +
+                                 src_x * 4,
+                                 cogl_bitmap_get_rowstride (converted));
+
+  _cogl_bitmap_unmap (converted);
+  cogl_object_unref (converted);
+}
+
+static void
+init_mipmap_chain (CoglTexture2D *tex_2d,
+                   CoglBitmap *bmp)
+{
+  CoglTexture *tex = COGL_TEXTURE (tex_2d);
+
+  tex_2d->mipmap_chain =
+    _cogl_mipmap_chain_new (tex->width,
+                            tex->height,
+                            tex_2d->mipmap_filter,
+                            tex_2d->mipmap_srgb,
+                            !!(tex_2d->internal_format & COGL_PREMULT_BIT));
+
+  if (bmp)
+    {
+      update_mipmap_chain_from_bitmap (tex_2d,
+                                       bmp,
+                                       0, 0, /* src_x/y */
+                                       tex->width, tex->height,
+                                       0, 0 /* dst_x/y */);
+
+      /* Generate the mipmaps straight away so that a static image
+       * never needs to be touched again */
+      if (tex_2d->mipmap_chain)
+        {
+          _cogl_mipmap_chain_update (tex_2d->mipmap_chain,
+                                     upload_mipmap_level_cb,
+                                     tex_2d);
+          tex_2d->mipmaps_dirty = FALSE;
+        }
+    }
+  else
+    {
+      /* The contents are undefined but every level still needs to be
+       * uploaded at least once */
+      tex_2d->mipmap_chain->dirty_x1 = 0;
+      tex_2d->mipmap_chain->dirty_y1 = 0;
+      tex_2d->mipmap_chain->dirty_x2 = tex->width;
+      tex_2d->mipmap_chain->dirty_y2 = tex->height;
+    }
+}
+
 static CoglBool
 _cogl_texture_2d_allocate (CoglTexture *tex,
                            CoglError **error)
 {
   CoglContext *ctx = tex->context;
+  CoglTexture2D *tex_2d = COGL_TEXTURE_2D (tex);
+  CoglBitmap *bmp = NULL;
+  CoglBool ret;
+
+  /* The loader is freed once the texture is allocated so the bitmap
+   * needs to be kept to initialize the mipmap chain */
+  if (tex_2d->mipmap_filter != COGL_TEXTURE_2D_MIPMAP_FILTER_DRIVER &&
+      tex->loader->src_type == COGL_TEXTURE_SOURCE_TYPE_BITMAP)
+    bmp = cogl_object_ref (tex->loader->src.bitmap.bitmap);
+
+  ret = ctx->driver_vtable->texture_2d_allocate (tex, error);
+
+  if (ret &&
+      tex_2d->mipmap_filter != COGL_TEXTURE_2D_MIPMAP_FILTER_DRIVER &&
+      tex_2d->auto_mipmap &&
+      !tex_2d->is_foreign)
+    init_mipmap_chain (tex_2d, bmp);
+
+  if (bmp)
+    cogl_object_unref (bmp);
 
-  return ctx->driver_vtable->texture_2d_allocate (tex, error);
+  return ret;
+}
+
+void
+cogl_texture_2d_set_mipmap_filter (CoglTexture2D *texture,
+                                   CoglTexture2DMipmapFilter filter)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_texture_2d (texture));
+  _COGL_RETURN_IF_FAIL (!COGL_TEXTURE (texture)->allocated);
+
+  texture->mipmap_filter = filter;
+}
+
+CoglTexture2DMipmapFilter
+cogl_texture_2d_get_mipmap_filter (CoglTexture2D *texture)
+{
+  return texture->mipmap_filter;
+}
+
+void
+cogl_texture_2d_set_mipmap_srgb (CoglTexture2D *texture,
+                                 CoglBool srgb)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_texture_2d (texture));
+  _COGL_RETURN_IF_FAIL (!COGL_TEXTURE (texture)->allocated);
+
+  texture->mipmap_srgb = !!srgb;
+}
+
+CoglBool
+cogl_texture_2d_get_mipmap_srgb (CoglTexture2D *texture)
+{
+  return texture->mipmap_srgb;
 }
 
 static CoglTexture2D *
@@ -188,6 +400,199 @@ cogl_texture_2d_new_from_file (CoglContext *ctx,
   return tex_2d;
 }
 
+static CoglBool
+can_upload_compressed_image (CoglContext *ctx,
+                             const CoglCompressedImage *image)
+{
+  switch (image->format)
+    {
+    case COGL_COMPRESSED_FORMAT_RGB_DXT1:
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT1:
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT3:
+    case COGL_COMPRESSED_FORMAT_RGBA_DXT5:
+      return _cogl_has_private_feature
+        (ctx, COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_S3TC);
+    case COGL_COMPRESSED_FORMAT_RGB_ETC1:
+      /* ETC1 is a subset of ETC2 */
+      return (_cogl_has_private_feature
+              (ctx, COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC1) ||
+              _cogl_has_private_feature
+              (ctx, COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC2));
+    case COGL_COMPRESSED_FORMAT_RGB_ETC2:
+    case COGL_COMPRESSED_FORMAT_RGBA_ETC2_EAC:
+      return _cogl_has_private_feature
+        (ctx, COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC2);
+    case COGL_COMPRESSED_FORMAT_RGBA_ASTC:
+      return _cogl_has_private_feature
+        (ctx, COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ASTC);
+    }
+
+  g_return_val_if_reached (FALSE);
+}
+
+static CoglTexture2D *
+new_from_decompressed_image (CoglContext *ctx,
+                             const CoglCompressedImage *image,
+                             CoglError **error)
+{
+  int rowstride = image->width * 4;
+  CoglTexture2D *tex_2d;
+  CoglTexture *tex;
+  CoglBitmap *bmp;
+  uint8_t *data;
+  int level;
+
+  if (!_cogl_compressed_image_can_decompress (image))
+    {
+      _cogl_set_error (error,
+                       COGL_TEXTURE_ERROR,
+                       COGL_TEXTURE_ERROR_FORMAT,
+                       "The compressed texture format is not supported "
+                       "by the GPU and can not be decoded on the CPU");
+      return NULL;
+    }
+
+  COGL_NOTE (PERFORMANCE,
+             "Decoding a %ix%i compressed texture on the CPU because the "
+             "GPU doesn't support its format",
+             image->width, image->height);
+
+  /* The first level is the largest so the buffer can be reused for
+   * all of them */
+  data = g_malloc (rowstride * image->height);
+
+  _cogl_compressed_image_decompress_level (image, 0, rowstride, data);
+  bmp = cogl_bitmap_new_for_data (ctx,
+                                  image->width, image->height,
+                                  COGL_PIXEL_FORMAT_RGBA_8888,
+                                  rowstride,
+                                  data);
+  tex_2d = _cogl_texture_2d_new_from_bitmap (bmp,
+                                             TRUE); /* can convert in-place */
+  cogl_object_unref (bmp);
+
+  tex = COGL_TEXTURE (tex_2d);
+
+  /* Match the texture that the GPU would have created if it
+   * supported the format */
+  cogl_texture_set_premultiplied (tex, FALSE);
+  if (!_cogl_compressed_format_has_alpha (image->format))
+    cogl_texture_set_components (tex, COGL_TEXTURE_COMPONENTS_RGB);
+
+  if (!cogl_texture_allocate (tex, error))
+    goto error;
+
+  for (level = 1; level < image->n_levels; level++)
+    {
+      const CoglCompressedImageLevel *image_level = image->levels + level;
+
+      _cogl_compressed_image_decompress_level (image, level,
+                                               image_level->width * 4,
+                                               data);
+
+      if (!cogl_texture_set_region (tex,
+                                    image_level->width,
+                                    image_level->height,
+                                    COGL_PIXEL_FORMAT_RGBA_8888,
+                                    image_level->width * 4,
+                                    data,
+                                    0, 0, /* dst_x/y */
+                                    level,
+                                    error))
+        goto error;
+    }
+
+  /* If the container has a complete mipmap chain then there's no
+   * need to regenerate it */
+  if (image->n_levels == _cogl_texture_get_n_levels (tex))
+    {
+      tex_2d->auto_mipmap = FALSE;
+      tex_2d->mipmaps_dirty = FALSE;
+    }
+
+  g_free (data);
+
+  return tex_2d;
+
+ error:
+  cogl_object_unref (tex_2d);
+  g_free (data);
+  return NULL;
+}
+
+static CoglTexture2D *
+new_from_compressed_image (CoglContext *ctx,
+                           const CoglCompressedImage *image,
+                           CoglError **error)
+{
+  CoglTextureLoader *loader;
+  CoglTexture2D *tex_2d;
+  CoglPixelFormat internal_format;
+
+  if (!can_upload_compressed_image (ctx, image))
+    return new_from_decompressed_image (ctx, image, error);
+
+  internal_format = (_cogl_compressed_format_has_alpha (image->format) ?
+                     COGL_PIXEL_FORMAT_RGBA_8888 :
+                     COGL_PIXEL_FORMAT_RGB_888);
+
+  loader = _cogl_texture_create_loader ();
+  loader->src_type = COGL_TEXTURE_SOURCE_TYPE_COMPRESSED;
+  loader->src.compressed.image = image;
+
+  tex_2d = _cogl_texture_2d_create_base (ctx,
+                                         image->width,
+                                         image->height,
+                                         internal_format,
+                                         loader);
+
+  /* The image isn't kept after this function returns so the texture
+   * has to be allocated immediately */
+  if (!cogl_texture_allocate (COGL_TEXTURE (tex_2d), error))
+    {
+      cogl_object_unref (tex_2d);
+      return NULL;
+    }
+
+  return tex_2d;
+}
+
+CoglTexture2D *
+cogl_texture_2d_new_from_compressed_file (CoglContext *ctx,
+                                          const char *filename,
+                                          CoglError **error)
+{
+  CoglCompressedImage image;
+  CoglTexture2D *tex_2d;
+
+  _COGL_RETURN_VAL_IF_FAIL (error == NULL || *error == NULL, NULL);
+
+  if (!_cogl_compressed_image_load_file (&image, filename, error))
+    return NULL;
+
+  tex_2d = new_from_compressed_image (ctx, &image, error);
+
+  _cogl_compressed_image_destroy (&image);
+
+  return tex_2d;
+}
+
+CoglTexture2D *
+cogl_texture_2d_new_from_compressed_data (CoglContext *ctx,
+                                          const uint8_t *data,
+                                          size_t size,
+                                          CoglError **error)
+{
+  CoglCompressedImage image;
+
+  _COGL_RETURN_VAL_IF_FAIL (data != NULL, NULL);
+
+  if (!_cogl_compressed_image_parse (&image, data, size, error))
+    return NULL;
+
+  return new_from_compressed_image (ctx, &image, error);
+}
+
 CoglTexture2D *
 cogl_texture_2d_new_from_data (CoglContext *ctx,
                                int width,
@@ -452,6 +857,9 @@ _cogl_texture_2d_externally_modified (CoglTexture *texture)
   if (!cogl_is_texture_2d (texture))
     return;
 
+  /* The CPU copy of the texture can't be updated */
+  drop_mipmap_chain (COGL_TEXTURE_2D (texture));
+
   COGL_TEXTURE_2D (texture)->mipmaps_dirty = TRUE;
 }
 
@@ -482,6 +890,9 @@ _cogl_texture_2d_copy_from_framebuffer (CoglTexture2D *tex_2d,
                                                         dst_y,
                                                         level);
 
+  if (level == 0)
+    drop_mipmap_chain (tex_2d);
+
   tex_2d->mipmaps_dirty = TRUE;
 }
 
@@ -572,7 +983,14 @@ _cogl_texture_2d_pre_paint (CoglTexture *tex, CoglTexturePrePaintFlags flags)
     {
       CoglContext *ctx = tex->context;
 
-      ctx->driver_vtable->texture_2d_generate_mipmap (tex_2d);
+      /* Only the parts of the levels that were affected by calls to
+       * set_region need to be regenerated */
+      if (tex_2d->mipmap_chain)
+        _cogl_mipmap_chain_update (tex_2d->mipmap_chain,
+                                   upload_mipmap_level_cb,
+                                   tex_2d);
+      else
+        ctx->driver_vtable->texture_2d_generate_mipmap (tex_2d);
 
       tex_2d->mipmaps_dirty = FALSE;
     }
@@ -613,6 +1031,13 @@ _cogl_texture_2d_set_region (CoglTexture *tex,
       return FALSE;
     }
 
+  if (tex_2d->mipmap_chain && level == 0)
+    update_mipmap_chain_from_bitmap (tex_2d,
+                                     bmp,
+                                     src_x, src_y,
+                                     width, height,
+                                     dst_x, dst_y);
+
   tex_2d->mipmaps_dirty = TRUE;
 
   return TRUE;
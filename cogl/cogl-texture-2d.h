@@ -189,6 +189,61 @@ cogl_texture_2d_new_from_data (CoglContext *ctx,
                                const uint8_t *data,
                                CoglError **error);
 
+/**
+ * cogl_texture_2d_new_from_compressed_file:
+ * @ctx: A #CoglContext
+ * @filename: the file to load
+ * @error: A #CoglError to catch exceptional errors or %NULL
+ *
+ * Creates a #CoglTexture2D from a KTX or DDS container of compressed
+ * image data. KTX files may contain DXT1, DXT3, DXT5, ETC1, ETC2,
+ * ETC2 with EAC alpha or ASTC data and DDS files may contain DXT1,
+ * DXT3 or DXT5 data. Only 2D images are supported. Any mipmap levels
+ * in the container are uploaded too.
+ *
+ * The file is mapped into memory and the compressed data is uploaded
+ * directly to the GPU if it supports the format. Otherwise the image
+ * is decoded on the CPU and uploaded as uncompressed pixels. ASTC data
+ * can only be used if the GPU supports it.
+ *
+ * The texture is allocated immediately. Its contents are not
+ * premultiplied.
+ *
+ * Return value: (transfer full): A newly created #CoglTexture2D or
+ *               %NULL on failure and @error will be updated.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglTexture2D *
+cogl_texture_2d_new_from_compressed_file (CoglContext *ctx,
+                                          const char *filename,
+                                          CoglError **error);
+
+/**
+ * cogl_texture_2d_new_from_compressed_data:
+ * @ctx: A #CoglContext
+ * @data: the contents of a KTX or DDS container
+ * @size: the size of @data in bytes
+ * @error: A #CoglError to catch exceptional errors or %NULL
+ *
+ * Creates a #CoglTexture2D from a KTX or DDS container that is already
+ * in memory. This behaves the same as
+ * cogl_texture_2d_new_from_compressed_file() and @data does not need
+ * to remain valid once this function returns.
+ *
+ * Return value: (transfer full): A newly created #CoglTexture2D or
+ *               %NULL on failure and @error will be updated.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglTexture2D *
+cogl_texture_2d_new_from_compressed_data (CoglContext *ctx,
+                                          const uint8_t *data,
+                                          size_t size,
+                                          CoglError **error);
+
 /**
  * cogl_texture_2d_new_from_bitmap:
  * @bitmap: A #CoglBitmap
@@ -220,6 +275,101 @@ cogl_texture_2d_new_from_data (CoglContext *ctx,
 CoglTexture2D *
 cogl_texture_2d_new_from_bitmap (CoglBitmap *bitmap);
 
+/**
+ * CoglTexture2DMipmapFilter:
+ * @COGL_TEXTURE_2D_MIPMAP_FILTER_DRIVER: The mipmaps are generated by
+ *   the GPU driver. The quality of the filter depends on the driver.
+ * @COGL_TEXTURE_2D_MIPMAP_FILTER_BOX: Each pixel is the average of the
+ *   four pixels that it covers in the level above.
+ * @COGL_TEXTURE_2D_MIPMAP_FILTER_LANCZOS: A Lanczos filter is used to
+ *   generate each level. This keeps more detail than the box filter
+ *   but is slower.
+ *
+ * The filters that can be used to generate the mipmaps of a
+ * #CoglTexture2D. See cogl_texture_2d_set_mipmap_filter().
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef enum
+{
+  COGL_TEXTURE_2D_MIPMAP_FILTER_DRIVER,
+  COGL_TEXTURE_2D_MIPMAP_FILTER_BOX,
+  COGL_TEXTURE_2D_MIPMAP_FILTER_LANCZOS
+} CoglTexture2DMipmapFilter;
+
+/**
+ * cogl_texture_2d_set_mipmap_filter:
+ * @texture: A #CoglTexture2D
+ * @filter: The filter to use
+ *
+ * Sets the filter used to generate the mipmap levels of the texture.
+ * By default the GPU driver generates them. If any other filter is
+ * used then the mipmaps are generated on the CPU when the texture is
+ * allocated and Cogl keeps a copy of every level in system memory.
+ * After that, when cogl_texture_set_region() modifies part of the
+ * texture, only the corresponding parts of the other levels are
+ * regenerated instead of the whole chain.
+ *
+ * This is most useful for static images or large textures where only
+ * small regions change. If the texture is modified by the GPU, for
+ * example by rendering to it, then Cogl falls back to letting the
+ * driver generate the mipmaps.
+ *
+ * This can only be called before the texture is allocated.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_texture_2d_set_mipmap_filter (CoglTexture2D *texture,
+                                   CoglTexture2DMipmapFilter filter);
+
+/**
+ * cogl_texture_2d_get_mipmap_filter:
+ * @texture: A #CoglTexture2D
+ *
+ * Return value: The filter set with cogl_texture_2d_set_mipmap_filter()
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglTexture2DMipmapFilter
+cogl_texture_2d_get_mipmap_filter (CoglTexture2D *texture);
+
+/**
+ * cogl_texture_2d_set_mipmap_srgb:
+ * @texture: A #CoglTexture2D
+ * @srgb: Whether the colour components are sRGB encoded
+ *
+ * Sets whether the CPU mipmap filters should treat the colour
+ * components of the texture as sRGB encoded values. If so, they are
+ * converted to linear values before filtering and back again
+ * afterwards. This avoids the mipmaps of images with high contrast
+ * detail becoming darker. The default is %FALSE. This has no effect
+ * if the mipmap filter is %COGL_TEXTURE_2D_MIPMAP_FILTER_DRIVER.
+ *
+ * This can only be called before the texture is allocated.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_texture_2d_set_mipmap_srgb (CoglTexture2D *texture,
+                                 CoglBool srgb);
+
+/**
+ * cogl_texture_2d_get_mipmap_srgb:
+ * @texture: A #CoglTexture2D
+ *
+ * Return value: The value set with cogl_texture_2d_set_mipmap_srgb()
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglBool
+cogl_texture_2d_get_mipmap_srgb (CoglTexture2D *texture);
+
 COGL_END_DECLS
 
 #endif /* __COGL_TEXTURE_2D_H */
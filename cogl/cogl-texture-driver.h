@@ -47,12 +47,14 @@ struct _CoglTextureDriver
 
   /*
    * This sets up the glPixelStore state for an upload to a destination with
-   * the same size, and with no offset.
+   * the same size, and with no offset. It returns the number of GL calls
+   * that were made so that callers sharing the state between several
+   * uploads can tell how many calls they saved.
    */
   /* NB: GLES can't upload a sub region of pixel data from a larger source
    * buffer which is why this interface is limited. The GL driver has a more
    * flexible version of this function that is uses internally */
-  void
+  int
   (* prep_gl_for_pixels_upload) (CoglContext *ctx,
                                  int pixels_rowstride,
                                  int pixels_bpp);
@@ -86,6 +88,32 @@ struct _CoglTextureDriver
                               GLuint source_gl_type,
                               CoglError **error);
 
+  /*
+   * This uploads a sub-region of a single GL texture handle from a
+   * pixel buffer that the caller has already bound with
+   * _cogl_buffer_gl_bind() for the PIXEL_UNPACK target. @bound_data is
+   * the pointer returned by that (NULL for a real buffer object) and
+   * @offset is the byte offset of the first pixel in the buffer.
+   *
+   * Unlike upload_subregion_to_gl this doesn't touch the glPixelStore
+   * state. The caller sets it up with prep_gl_for_pixels_upload so that
+   * it can be shared between uploads with the same layout.
+   */
+  CoglBool
+  (* upload_subregion_from_buffer) (CoglContext *ctx,
+                                    CoglTexture *texture,
+                                    int dst_x,
+                                    int dst_y,
+                                    int width,
+                                    int height,
+                                    int level,
+                                    uint8_t *bound_data,
+                                    size_t offset,
+                                    int bpp,
+                                    GLuint source_gl_format,
+                                    GLuint source_gl_type,
+                                    CoglError **error);
+
   /*
    * Replaces the contents of the GL texture with the entire bitmap. On
    * GL this just directly calls glTexImage2D, but under GLES it needs
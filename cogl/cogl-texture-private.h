@@ -37,6 +37,8 @@
 #include "cogl-spans.h"
 #include "cogl-meta-texture.h"
 #include "cogl-framebuffer.h"
+#include "cogl-compressed-image-private.h"
+#include "cogl-memory-stats-private.h"
 
 #ifdef COGL_HAS_EGL_SUPPORT
 #include "cogl-egl-defines.h"
@@ -152,7 +154,8 @@ typedef enum _CoglTextureSoureType {
   COGL_TEXTURE_SOURCE_TYPE_SIZED = 1,
   COGL_TEXTURE_SOURCE_TYPE_BITMAP,
   COGL_TEXTURE_SOURCE_TYPE_EGL_IMAGE,
-  COGL_TEXTURE_SOURCE_TYPE_GL_FOREIGN
+  COGL_TEXTURE_SOURCE_TYPE_GL_FOREIGN,
+  COGL_TEXTURE_SOURCE_TYPE_COMPRESSED
 } CoglTextureSourceType;
 
 typedef struct _CoglTextureLoader
@@ -184,6 +187,11 @@ typedef struct _CoglTextureLoader
       unsigned int gl_handle;
       CoglPixelFormat format;
     } gl_foreign;
+    struct {
+      /* This is owned by whoever created the loader and only needs
+       * to stay valid until the texture is allocated */
+      const CoglCompressedImage *image;
+    } compressed;
   } src;
 } CoglTextureLoader;
 
@@ -204,6 +212,11 @@ struct _CoglTexture
   CoglTextureComponents components;
   unsigned int premultiplied:1;
 
+  /* The number of bytes that have been added to the context's memory
+   * accounting for this texture and the category they were added to */
+  size_t memory_size;
+  CoglMemoryType memory_type;
+
   const CoglTextureVtable *vtable;
 };
 
@@ -373,6 +386,33 @@ _cogl_texture_set_allocated (CoglTexture *texture,
 CoglPixelFormat
 _cogl_texture_get_format (CoglTexture *texture);
 
+/*
+ * Recalculates the memory used by a primitive texture from its
+ * internal format and the number of mipmap levels that have been
+ * allocated. This is called automatically when the texture is
+ * allocated and whenever texture::max_level grows.
+ */
+void
+_cogl_texture_update_memory_size (CoglTexture *texture);
+
+/*
+ * Overrides the calculated memory size. This can be used for formats
+ * where the size can't be derived from the bytes per pixel such as
+ * compressed textures.
+ */
+void
+_cogl_texture_set_memory_size (CoglTexture *texture,
+                               size_t size);
+
+/*
+ * Moves the memory of the texture to a different category. This is
+ * used by meta textures such as atlases so that the memory of the
+ * textures they own is reported separately.
+ */
+void
+_cogl_texture_set_memory_type (CoglTexture *texture,
+                               CoglMemoryType type);
+
 CoglTextureLoader *
 _cogl_texture_create_loader (void);
 
@@ -0,0 +1,95 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_TEXTURE_UPLOAD_BATCH_PRIVATE_H
+#define __COGL_TEXTURE_UPLOAD_BATCH_PRIVATE_H
+
+#include <glib.h>
+
+#include "cogl-texture-upload-batch.h"
+#include "cogl-object-private.h"
+#include "cogl-pixel-buffer.h"
+
+typedef struct _CoglTextureUploadRegion
+{
+  CoglTexture *texture;
+  int level;
+  int dst_x, dst_y;
+  int width, height;
+
+  /* Format and layout of the data in the staging chunk */
+  CoglPixelFormat format;
+  int rowstride;
+  int chunk;
+  size_t offset;
+
+  /* The order the region was added in so that the upload order for
+   * a texture is kept when sorting */
+  int sequence;
+} CoglTextureUploadRegion;
+
+/* A pixel buffer that region data is written to directly as the
+ * regions are added. A new, larger chunk is started when the current
+ * one is full because the data can't be read back out of a write-only
+ * mapping to move it into a bigger buffer */
+typedef struct _CoglTextureUploadChunk
+{
+  CoglPixelBuffer *buffer;
+  size_t size;
+  size_t used;
+
+  /* Either the mapped buffer or, if it couldn't be mapped, a malloc'd
+   * copy that is given to cogl_buffer_set_data() when flushing. This
+   * is NULL until the first region is added after a flush */
+  uint8_t *data;
+  CoglBool mapped;
+} CoglTextureUploadChunk;
+
+struct _CoglTextureUploadBatch
+{
+  CoglObject _parent;
+
+  CoglContext *context;
+
+  /* Array of CoglTextureUploadRegions */
+  GArray *regions;
+  int n_added_regions;
+
+  /* Array of CoglTextureUploadChunks. Only the last chunk is kept
+   * after a flush so that it can be reused */
+  GArray *chunks;
+
+  /* Statistics about the last flush */
+  int n_flushed_regions;
+  int n_flushed_uploads;
+  size_t n_flushed_bytes;
+  int n_flushed_gl_calls_saved;
+};
+
+#endif /* __COGL_TEXTURE_UPLOAD_BATCH_PRIVATE_H */
@@ -0,0 +1,644 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "cogl-context-private.h"
+#include "cogl-texture-upload-batch-private.h"
+#include "cogl-texture-private.h"
+#include "cogl-texture-2d-private.h"
+#include "cogl-texture-driver.h"
+#include "cogl-bitmap-private.h"
+#include "cogl-buffer-private.h"
+#include "cogl-buffer-gl-private.h"
+#include "cogl-error-private.h"
+#include "cogl-profile.h"
+
+static void _cogl_texture_upload_batch_free (CoglTextureUploadBatch *batch);
+
+COGL_OBJECT_DEFINE (TextureUploadBatch, texture_upload_batch);
+
+/* Offsets and rowstrides in the staging chunks are aligned to this
+ * so that GL can read the rows using only GL_UNPACK_ALIGNMENT */
+#define STAGING_ALIGNMENT 4
+
+#define ALIGN_STAGING(x) \
+  (((x) + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1))
+
+#define MIN_CHUNK_SIZE 4096
+
+CoglTextureUploadBatch *
+cogl_texture_upload_batch_new (CoglContext *context)
+{
+  CoglTextureUploadBatch *batch = g_slice_new0 (CoglTextureUploadBatch);
+
+  batch->context = context;
+  batch->regions = g_array_new (FALSE, FALSE,
+                                sizeof (CoglTextureUploadRegion));
+  batch->chunks = g_array_new (FALSE, FALSE,
+                               sizeof (CoglTextureUploadChunk));
+
+  return _cogl_texture_upload_batch_object_new (batch);
+}
+
+static void
+release_chunk_data (CoglTextureUploadChunk *chunk)
+{
+  if (chunk->mapped)
+    cogl_buffer_unmap (COGL_BUFFER (chunk->buffer));
+  else
+    g_free (chunk->data);
+
+  chunk->data = NULL;
+  chunk->mapped = FALSE;
+  chunk->used = 0;
+}
+
+static void
+clear_regions (CoglTextureUploadBatch *batch)
+{
+  int i;
+
+  for (i = 0; i < batch->regions->len; i++)
+    {
+      CoglTextureUploadRegion *region =
+        &g_array_index (batch->regions, CoglTextureUploadRegion, i);
+      cogl_object_unref (region->texture);
+    }
+
+  g_array_set_size (batch->regions, 0);
+  batch->n_added_regions = 0;
+
+  /* Only keep the last chunk because it is the largest */
+  for (i = 0; i < batch->chunks->len; i++)
+    {
+      CoglTextureUploadChunk *chunk =
+        &g_array_index (batch->chunks, CoglTextureUploadChunk, i);
+
+      release_chunk_data (chunk);
+
+      if (i < batch->chunks->len - 1)
+        cogl_object_unref (chunk->buffer);
+      else if (i > 0)
+        g_array_index (batch->chunks, CoglTextureUploadChunk, 0) = *chunk;
+    }
+
+  if (batch->chunks->len > 1)
+    g_array_set_size (batch->chunks, 1);
+}
+
+static void
+_cogl_texture_upload_batch_free (CoglTextureUploadBatch *batch)
+{
+  clear_regions (batch);
+
+  if (batch->chunks->len > 0)
+    cogl_object_unref (g_array_index (batch->chunks,
+                                      CoglTextureUploadChunk,
+                                      0).buffer);
+
+  g_array_free (batch->regions, TRUE);
+  g_array_free (batch->chunks, TRUE);
+
+  g_slice_free (CoglTextureUploadBatch, batch);
+}
+
+static CoglTextureUploadChunk *
+get_last_chunk (CoglTextureUploadBatch *batch)
+{
+  if (batch->chunks->len == 0)
+    return NULL;
+
+  return &g_array_index (batch->chunks,
+                         CoglTextureUploadChunk,
+                         batch->chunks->len - 1);
+}
+
+static CoglTextureUploadChunk *
+start_chunk (CoglTextureUploadBatch *batch,
+             size_t min_size,
+             CoglError **error)
+{
+  CoglTextureUploadChunk *last = get_last_chunk (batch);
+  CoglTextureUploadChunk chunk;
+
+  chunk.size = last ? last->size * 2 : MIN_CHUNK_SIZE;
+  while (chunk.size < min_size)
+    chunk.size *= 2;
+
+  chunk.buffer = cogl_pixel_buffer_new (batch->context,
+                                        chunk.size,
+                                        NULL, /* data */
+                                        error);
+  if (chunk.buffer == NULL)
+    return NULL;
+
+  cogl_buffer_set_update_hint (COGL_BUFFER (chunk.buffer),
+                               COGL_BUFFER_UPDATE_HINT_STREAM);
+
+  chunk.used = 0;
+  chunk.data = NULL;
+  chunk.mapped = FALSE;
+
+  g_array_append_val (batch->chunks, chunk);
+
+  return get_last_chunk (batch);
+}
+
+static void
+ensure_chunk_data (CoglTextureUploadChunk *chunk)
+{
+  CoglError *ignore_error = NULL;
+
+  if (chunk->data)
+    return;
+
+  /* Discarding the old contents lets the driver give us fresh storage
+   * instead of waiting for uploads from the previous flush */
+  chunk->data = cogl_buffer_map (COGL_BUFFER (chunk->buffer),
+                                 COGL_BUFFER_ACCESS_WRITE,
+                                 COGL_BUFFER_MAP_HINT_DISCARD,
+                                 &ignore_error);
+  if (chunk->data)
+    chunk->mapped = TRUE;
+  else
+    {
+      cogl_error_free (ignore_error);
+      chunk->data = g_malloc (chunk->size);
+    }
+}
+
+/* Checks whether a new region can be appended to the last region in
+ * the batch. This is the case when it continues the last region
+ * directly below it in the same texture. The data for the last region
+ * is always at the end of the last chunk so the rows for the new
+ * region can just be added after it if there is room */
+static CoglTextureUploadRegion *
+find_region_to_extend (CoglTextureUploadBatch *batch,
+                       CoglTexture *texture,
+                       int level,
+                       CoglPixelFormat format,
+                       int dst_x,
+                       int dst_y,
+                       int width,
+                       size_t size)
+{
+  CoglTextureUploadRegion *last;
+  CoglTextureUploadChunk *chunk;
+
+  if (batch->regions->len == 0)
+    return NULL;
+
+  last = &g_array_index (batch->regions,
+                         CoglTextureUploadRegion,
+                         batch->regions->len - 1);
+  chunk = get_last_chunk (batch);
+
+  if (last->texture == texture &&
+      last->level == level &&
+      last->format == format &&
+      last->dst_x == dst_x &&
+      last->width == width &&
+      last->dst_y + last->height == dst_y &&
+      chunk->used + size <= chunk->size)
+    return last;
+  else
+    return NULL;
+}
+
+CoglBool
+cogl_texture_upload_batch_add_region (CoglTextureUploadBatch *batch,
+                                      CoglTexture *texture,
+                                      int width,
+                                      int height,
+                                      CoglPixelFormat format,
+                                      int rowstride,
+                                      const uint8_t *data,
+                                      int dst_x,
+                                      int dst_y,
+                                      int level,
+                                      CoglError **error)
+{
+  CoglContext *ctx = batch->context;
+  CoglTextureUploadRegion *region;
+  CoglTextureUploadChunk *chunk;
+  CoglPixelFormat upload_format;
+  int upload_bpp;
+  int upload_rowstride;
+  size_t size;
+  size_t offset;
+  uint8_t *dst;
+
+  COGL_STATIC_COUNTER (texture_upload_batch_region_counter,
+                       "Texture upload batch region counter",
+                       "Increments for each region added to a "
+                       "texture upload batch",
+                       0 /* no application private data */);
+
+  _COGL_RETURN_VAL_IF_FAIL (cogl_is_texture (texture), FALSE);
+  _COGL_RETURN_VAL_IF_FAIL (format != COGL_PIXEL_FORMAT_ANY, FALSE);
+  _COGL_RETURN_VAL_IF_FAIL (width > 0, FALSE);
+  _COGL_RETURN_VAL_IF_FAIL (height > 0, FALSE);
+
+  if (rowstride == 0)
+    rowstride = _cogl_pixel_format_get_bytes_per_pixel (format) * width;
+
+  if (!cogl_texture_allocate (texture, error))
+    return FALSE;
+
+  /* Convert the data now to the format that set_region would convert
+   * it to so that the flush doesn't need to map the pixel buffer
+   * again to convert it */
+  upload_format =
+    _cogl_bitmap_get_upload_format (ctx,
+                                    format,
+                                    _cogl_texture_get_format (texture));
+  upload_bpp = _cogl_pixel_format_get_bytes_per_pixel (upload_format);
+  upload_rowstride = ALIGN_STAGING (width * upload_bpp);
+  size = (size_t) upload_rowstride * height;
+
+  region = find_region_to_extend (batch,
+                                  texture,
+                                  level,
+                                  upload_format,
+                                  dst_x, dst_y,
+                                  width,
+                                  size);
+
+  chunk = get_last_chunk (batch);
+
+  if (region)
+    offset = chunk->used;
+  else if (chunk && ALIGN_STAGING (chunk->used) + size <= chunk->size)
+    offset = ALIGN_STAGING (chunk->used);
+  else
+    {
+      chunk = start_chunk (batch, size, error);
+      if (chunk == NULL)
+        return FALSE;
+      offset = 0;
+    }
+
+  ensure_chunk_data (chunk);
+  dst = chunk->data + offset;
+
+  if (upload_format == format)
+    {
+      int y;
+
+      for (y = 0; y < height; y++)
+        memcpy (dst + y * upload_rowstride,
+                data + y * rowstride,
+                width * upload_bpp);
+    }
+  else
+    {
+      CoglBitmap *src_bmp = cogl_bitmap_new_for_data (ctx,
+                                                      width, height,
+                                                      format,
+                                                      rowstride,
+                                                      (uint8_t *) data);
+      CoglBitmap *dst_bmp = cogl_bitmap_new_for_data (ctx,
+                                                      width, height,
+                                                      upload_format,
+                                                      upload_rowstride,
+                                                      dst);
+      CoglBool ret = _cogl_bitmap_convert_into_bitmap (src_bmp,
+                                                       dst_bmp,
+                                                       error);
+
+      cogl_object_unref (dst_bmp);
+      cogl_object_unref (src_bmp);
+
+      if (!ret)
+        return FALSE;
+    }
+
+  chunk->used = offset + size;
+
+  if (region)
+    region->height += height;
+  else
+    {
+      CoglTextureUploadRegion new_region;
+
+      new_region.texture = cogl_object_ref (texture);
+      new_region.level = level;
+      new_region.dst_x = dst_x;
+      new_region.dst_y = dst_y;
+      new_region.width = width;
+      new_region.height = height;
+      new_region.format = upload_format;
+      new_region.rowstride = upload_rowstride;
+      new_region.chunk = batch->chunks->len - 1;
+      new_region.offset = offset;
+      new_region.sequence = batch->regions->len;
+
+      g_array_append_val (batch->regions, new_region);
+    }
+
+  batch->n_added_regions++;
+
+  COGL_COUNTER_INC (_cogl_uprof_context, texture_upload_batch_region_counter);
+
+  return TRUE;
+}
+
+/* Chunks are filled in the order the regions are added so sorting by
+ * chunk first still keeps the upload order for each texture */
+static int
+compare_regions (const void *a,
+                 const void *b)
+{
+  const CoglTextureUploadRegion *region_a = a;
+  const CoglTextureUploadRegion *region_b = b;
+
+  if (region_a->chunk != region_b->chunk)
+    return region_a->chunk - region_b->chunk;
+
+  if (region_a->texture != region_b->texture)
+    return region_a->texture < region_b->texture ? -1 : 1;
+
+  return region_a->sequence - region_b->sequence;
+}
+
+static CoglBool
+finish_chunk (CoglTextureUploadChunk *chunk,
+              CoglError **error)
+{
+  CoglBool ret = TRUE;
+
+  if (chunk->data && !chunk->mapped)
+    ret = cogl_buffer_set_data (COGL_BUFFER (chunk->buffer),
+                                0, /* offset */
+                                chunk->data,
+                                chunk->used,
+                                error);
+
+  release_chunk_data (chunk);
+
+  return ret;
+}
+
+/* Regions of plain 2D textures can be uploaded straight from the
+ * bound pixel buffer. Anything else goes through set_region, as does
+ * a texture that keeps a copy of some of its data on the CPU */
+static CoglBool
+can_upload_from_buffer (CoglContext *ctx,
+                        CoglTextureUploadRegion *region)
+{
+  CoglTexture2D *tex_2d;
+
+  if (ctx->texture_driver == NULL ||
+      !cogl_is_texture_2d (region->texture))
+    return FALSE;
+
+  tex_2d = COGL_TEXTURE_2D (region->texture);
+
+  if (tex_2d->mipmap_chain)
+    return FALSE;
+
+  /* set_region keeps a copy of the first pixel for the
+   * glGenerateMipmap fallback */
+  if (region->dst_x == 0 && region->dst_y == 0 &&
+      !cogl_has_feature (ctx, COGL_FEATURE_ID_OFFSCREEN))
+    return FALSE;
+
+  return TRUE;
+}
+
+static CoglBool
+upload_region_from_bitmap (CoglTextureUploadRegion *region,
+                           CoglTextureUploadChunk *chunk,
+                           CoglError **error)
+{
+  CoglBitmap *bmp = cogl_bitmap_new_from_buffer (COGL_BUFFER (chunk->buffer),
+                                                 region->format,
+                                                 region->width,
+                                                 region->height,
+                                                 region->rowstride,
+                                                 region->offset);
+  CoglBool ret;
+
+  ret = cogl_texture_set_region_from_bitmap (region->texture,
+                                             0, 0, /* src_x/y */
+                                             region->width,
+                                             region->height,
+                                             bmp,
+                                             region->dst_x,
+                                             region->dst_y,
+                                             region->level,
+                                             error);
+
+  cogl_object_unref (bmp);
+
+  return ret;
+}
+
+CoglBool
+cogl_texture_upload_batch_flush (CoglTextureUploadBatch *batch,
+                                 CoglError **error)
+{
+  CoglContext *ctx = batch->context;
+  CoglTextureUploadChunk *bound_chunk = NULL;
+  uint8_t *bound_data = NULL;
+  CoglPixelFormat prepped_format = COGL_PIXEL_FORMAT_ANY;
+  int prepped_rowstride = 0;
+  int n_prep_calls = 0;
+  CoglBool ret = TRUE;
+  int i;
+
+  COGL_STATIC_COUNTER (texture_upload_batch_upload_counter,
+                       "Texture upload batch upload counter",
+                       "Increments for each upload issued when "
+                       "flushing a texture upload batch",
+                       0 /* no application private data */);
+
+  batch->n_flushed_regions = batch->n_added_regions;
+  batch->n_flushed_uploads = batch->regions->len;
+  batch->n_flushed_bytes = 0;
+  batch->n_flushed_gl_calls_saved = 0;
+
+  if (batch->regions->len == 0)
+    return TRUE;
+
+  for (i = 0; i < batch->chunks->len; i++)
+    {
+      CoglTextureUploadChunk *chunk =
+        &g_array_index (batch->chunks, CoglTextureUploadChunk, i);
+
+      batch->n_flushed_bytes += chunk->used;
+
+      if (!finish_chunk (chunk, error))
+        {
+          clear_regions (batch);
+          return FALSE;
+        }
+    }
+
+  /* Group the uploads by texture so that each texture is only bound
+   * once in the common case */
+  g_array_sort (batch->regions, compare_regions);
+
+  for (i = 0; i < batch->regions->len; i++)
+    {
+      CoglTextureUploadRegion *region =
+        &g_array_index (batch->regions, CoglTextureUploadRegion, i);
+      CoglTextureUploadChunk *chunk =
+        &g_array_index (batch->chunks, CoglTextureUploadChunk, region->chunk);
+      int bpp = _cogl_pixel_format_get_bytes_per_pixel (region->format);
+      GLenum gl_format;
+      GLenum gl_type;
+
+      if (!can_upload_from_buffer (ctx, region))
+        {
+          /* set_region binds the buffer and sets up the pixel store
+           * state itself */
+          if (bound_chunk)
+            {
+              _cogl_buffer_gl_unbind (COGL_BUFFER (bound_chunk->buffer));
+              bound_chunk = NULL;
+            }
+          prepped_format = COGL_PIXEL_FORMAT_ANY;
+
+          ret = upload_region_from_bitmap (region, chunk, error);
+        }
+      else
+        {
+          /* Each of these would have been done again for every
+           * region by set_region so count the GL calls that are
+           * skipped by sharing them */
+          if (bound_chunk != chunk)
+            {
+              CoglError *internal_error = NULL;
+
+              if (bound_chunk)
+                _cogl_buffer_gl_unbind (COGL_BUFFER (bound_chunk->buffer));
+
+              bound_data =
+                _cogl_buffer_gl_bind (COGL_BUFFER (chunk->buffer),
+                                      COGL_BUFFER_BIND_TARGET_PIXEL_UNPACK,
+                                      &internal_error);
+
+              /* NB: _cogl_buffer_gl_bind() may return NULL in
+               * non-error conditions */
+              if (internal_error)
+                {
+                  _cogl_propagate_error (error, internal_error);
+                  bound_chunk = NULL;
+                  ret = FALSE;
+                  break;
+                }
+
+              bound_chunk = chunk;
+            }
+          else if (COGL_BUFFER (chunk->buffer)->flags &
+                   COGL_BUFFER_FLAG_BUFFER_OBJECT)
+            /* glBindBuffer to bind and unbind */
+            batch->n_flushed_gl_calls_saved += 2;
+
+          if (region->format != prepped_format ||
+              region->rowstride != prepped_rowstride)
+            {
+              const CoglTextureDriver *driver = ctx->texture_driver;
+
+              n_prep_calls =
+                driver->prep_gl_for_pixels_upload (ctx,
+                                                   region->rowstride,
+                                                   bpp);
+              prepped_format = region->format;
+              prepped_rowstride = region->rowstride;
+            }
+          else
+            batch->n_flushed_gl_calls_saved += n_prep_calls;
+
+          ctx->driver_vtable->pixel_format_to_gl (ctx,
+                                                  region->format,
+                                                  NULL, /* internal format */
+                                                  &gl_format,
+                                                  &gl_type);
+
+          ret = ctx->texture_driver->upload_subregion_from_buffer
+            (ctx,
+             region->texture,
+             region->dst_x, region->dst_y,
+             region->width, region->height,
+             region->level,
+             bound_data,
+             region->offset,
+             bpp,
+             gl_format,
+             gl_type,
+             error);
+
+          _cogl_texture_2d_externally_modified (region->texture);
+        }
+
+      COGL_COUNTER_INC (_cogl_uprof_context,
+                        texture_upload_batch_upload_counter);
+
+      if (!ret)
+        break;
+    }
+
+  if (bound_chunk)
+    _cogl_buffer_gl_unbind (COGL_BUFFER (bound_chunk->buffer));
+
+  clear_regions (batch);
+
+  return ret;
+}
+
+int
+cogl_texture_upload_batch_get_n_regions (CoglTextureUploadBatch *batch)
+{
+  return batch->n_flushed_regions;
+}
+
+int
+cogl_texture_upload_batch_get_n_uploads (CoglTextureUploadBatch *batch)
+{
+  return batch->n_flushed_uploads;
+}
+
+size_t
+cogl_texture_upload_batch_get_n_bytes (CoglTextureUploadBatch *batch)
+{
+  return batch->n_flushed_bytes;
+}
+
+int
+cogl_texture_upload_batch_get_n_gl_calls_saved (CoglTextureUploadBatch *batch)
+{
+  return batch->n_flushed_gl_calls_saved;
+}
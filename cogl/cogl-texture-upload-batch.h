@@ -0,0 +1,221 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_TEXTURE_UPLOAD_BATCH_H__
+#define __COGL_TEXTURE_UPLOAD_BATCH_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-texture.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-texture-upload-batch
+ * @short_description: Functions for uploading many texture regions
+ *   at once
+ *
+ * Each call to cogl_texture_set_region() wraps the data in a bitmap,
+ * converts it to a format suitable for the texture and issues a
+ * separate upload to the GPU. When lots of small regions are updated
+ * every frame, for example glyphs or map tiles, this overhead can
+ * dominate.
+ *
+ * A #CoglTextureUploadBatch instead writes the data for each region
+ * straight into a mapped #CoglPixelBuffer as the regions are added,
+ * converting the format if needed. When the batch is flushed the
+ * regions are uploaded from that buffer, grouped by texture. The
+ * buffer is only bound once and the pixel store state is only set up
+ * again when the layout of the data changes. Regions that continue the
+ * previous region of the same texture directly below it are merged
+ * into a single upload.
+ */
+
+typedef struct _CoglTextureUploadBatch CoglTextureUploadBatch;
+#define COGL_TEXTURE_UPLOAD_BATCH(X) ((CoglTextureUploadBatch *)(X))
+
+/**
+ * cogl_texture_upload_batch_new:
+ * @context: A #CoglContext
+ *
+ * Creates a new empty batch of texture uploads.
+ *
+ * Return value: (transfer full): A newly allocated
+ *   #CoglTextureUploadBatch
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglTextureUploadBatch *
+cogl_texture_upload_batch_new (CoglContext *context);
+
+/**
+ * cogl_is_texture_upload_batch:
+ * @object: A #CoglObject pointer
+ *
+ * Gets whether the given object references a #CoglTextureUploadBatch.
+ *
+ * Return value: %TRUE if the object references a
+ *   #CoglTextureUploadBatch and %FALSE otherwise.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_is_texture_upload_batch (void *object);
+
+/**
+ * cogl_texture_upload_batch_add_region:
+ * @batch: A #CoglTextureUploadBatch
+ * @texture: The #CoglTexture to update
+ * @width: width of the region in pixels
+ * @height: height of the region in pixels
+ * @format: the #CoglPixelFormat of @data
+ * @rowstride: the rowstride of @data or 0 to derive it from @width
+ *   and @format
+ * @data: the actual pixel data
+ * @dst_x: x position of the region in the texture
+ * @dst_y: y position of the region in the texture
+ * @level: The mipmap level to update
+ * @error: A #CoglError to return exceptional errors
+ *
+ * Adds a region to the batch with the same semantics as
+ * cogl_texture_set_region(). The data is copied immediately so it
+ * can be freed as soon as this function returns, but the texture
+ * won't be updated until cogl_texture_upload_batch_flush() is
+ * called. The batch keeps a reference on @texture until then.
+ *
+ * Regions for the same texture are uploaded in the order they were
+ * added so later regions will overwrite earlier ones where they
+ * overlap.
+ *
+ * Return value: %TRUE if the region was added or %FALSE if the
+ *   texture could not be allocated or the data could not be
+ *   converted.
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_texture_upload_batch_add_region (CoglTextureUploadBatch *batch,
+                                      CoglTexture *texture,
+                                      int width,
+                                      int height,
+                                      CoglPixelFormat format,
+                                      int rowstride,
+                                      const uint8_t *data,
+                                      int dst_x,
+                                      int dst_y,
+                                      int level,
+                                      CoglError **error);
+
+/**
+ * cogl_texture_upload_batch_flush:
+ * @batch: A #CoglTextureUploadBatch
+ * @error: A #CoglError to return exceptional errors
+ *
+ * Uploads all of the regions added since the last flush to their
+ * textures. The batch is left empty afterwards even if an error
+ * occurs.
+ *
+ * Return value: %TRUE if all of the regions were uploaded
+ * Since: 2.0
+ * Stability: Unstable
+ */
+CoglBool
+cogl_texture_upload_batch_flush (CoglTextureUploadBatch *batch,
+                                 CoglError **error);
+
+/**
+ * cogl_texture_upload_batch_get_n_regions:
+ * @batch: A #CoglTextureUploadBatch
+ *
+ * Gets the number of regions that were added before the last call
+ * to cogl_texture_upload_batch_flush(). Compared with
+ * cogl_texture_upload_batch_get_n_uploads() this tells how many
+ * upload calls were saved by merging regions.
+ *
+ * Return value: The number of regions in the last flush
+ * Since: 2.0
+ * Stability: Unstable
+ */
+int
+cogl_texture_upload_batch_get_n_regions (CoglTextureUploadBatch *batch);
+
+/**
+ * cogl_texture_upload_batch_get_n_uploads:
+ * @batch: A #CoglTextureUploadBatch
+ *
+ * Gets the number of texture uploads that were issued by the last
+ * call to cogl_texture_upload_batch_flush().
+ *
+ * Return value: The number of uploads in the last flush
+ * Since: 2.0
+ * Stability: Unstable
+ */
+int
+cogl_texture_upload_batch_get_n_uploads (CoglTextureUploadBatch *batch);
+
+/**
+ * cogl_texture_upload_batch_get_n_bytes:
+ * @batch: A #CoglTextureUploadBatch
+ *
+ * Gets the size of the staging data that was transferred by the last
+ * call to cogl_texture_upload_batch_flush().
+ *
+ * Return value: The number of bytes in the last flush
+ * Since: 2.0
+ * Stability: Unstable
+ */
+size_t
+cogl_texture_upload_batch_get_n_bytes (CoglTextureUploadBatch *batch);
+
+/**
+ * cogl_texture_upload_batch_get_n_gl_calls_saved:
+ * @batch: A #CoglTextureUploadBatch
+ *
+ * Gets the number of GL calls that the last call to
+ * cogl_texture_upload_batch_flush() avoided by binding the pixel
+ * buffer and setting up the pixel store state once for several
+ * uploads instead of once per upload. Uploads that were avoided
+ * entirely by merging regions are not included; compare
+ * cogl_texture_upload_batch_get_n_regions() with
+ * cogl_texture_upload_batch_get_n_uploads() for those.
+ *
+ * Return value: The number of GL calls saved by the last flush
+ * Since: 2.0
+ * Stability: Unstable
+ */
+int
+cogl_texture_upload_batch_get_n_gl_calls_saved (CoglTextureUploadBatch *batch);
+
+COGL_END_DECLS
+
+#endif /* __COGL_TEXTURE_UPLOAD_BATCH_H__ */
@@ -0,0 +1,92 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_TEXTURE_VIRTUAL_PRIVATE_H
+#define __COGL_TEXTURE_VIRTUAL_PRIVATE_H
+
+#include "cogl-texture-private.h"
+#include "cogl-texture-virtual.h"
+#include "cogl-list.h"
+
+typedef struct _CoglTextureVirtualTile
+{
+  /* The texture containing the tile or NULL if it isn't loaded */
+  CoglTexture *texture;
+  size_t size;
+  /* Link in the list of loaded tiles */
+  CoglList link;
+  /* The value of use_serial when the tile was last drawn */
+  unsigned int last_used;
+  /* Set when the load callback has been called for the tile but
+     returned FALSE */
+  CoglBool requested;
+} CoglTextureVirtualTile;
+
+typedef struct _CoglTextureVirtualLevel
+{
+  int width;
+  int height;
+  int n_tiles_x;
+  int n_tiles_y;
+  CoglTextureVirtualTile *tiles;
+} CoglTextureVirtualLevel;
+
+struct _CoglTextureVirtual
+{
+  CoglTexture _parent;
+
+  CoglPixelFormat internal_format;
+  int tile_size;
+
+  int n_levels;
+  CoglTextureVirtualLevel *levels;
+  int detail_level;
+
+  CoglTextureVirtualLoadCallback load_callback;
+  void *user_data;
+  CoglUserDataDestroyCallback destroy;
+
+  /* The source image for textures created with
+     cogl_texture_virtual_new_from_data() */
+  const uint8_t *source_data;
+  int source_rowstride;
+
+  /* A buffer big enough for one tile to load tiles into */
+  uint8_t *scratch;
+
+  /* The loaded tiles with the most recently used first */
+  CoglList lru;
+  size_t memory_budget;
+  size_t memory_used;
+  /* Incremented every time the texture is drawn so that tiles used
+     by the current draw aren't evicted */
+  unsigned int use_serial;
+};
+
+#endif /* __COGL_TEXTURE_VIRTUAL_PRIVATE_H */
@@ -0,0 +1,931 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <math.h>
+
+#include <test-fixtures/test-unit.h>
+
+#include "cogl-util.h"
+#include "cogl-texture-private.h"
+#include "cogl-texture-virtual-private.h"
+#include "cogl-texture-virtual.h"
+#include "cogl-texture-2d.h"
+#include "cogl-texture-gl-private.h"
+#include "cogl-context-private.h"
+#include "cogl-meta-texture.h"
+#include "cogl-error-private.h"
+#include "cogl-private.h"
+#include "cogl-profile.h"
+
+#define COGL_TEXTURE_VIRTUAL_DEFAULT_BUDGET (64 * 1024 * 1024)
+
+static void _cogl_texture_virtual_free (CoglTextureVirtual *tex_virtual);
+
+COGL_TEXTURE_DEFINE (TextureVirtual, texture_virtual);
+
+static const CoglTextureVtable cogl_texture_virtual_vtable;
+
+static void
+_cogl_texture_virtual_unload_tile (CoglTextureVirtual *tex_virtual,
+                                   CoglTextureVirtualTile *tile)
+{
+  /* Any journal entries using the tile hold their own reference to
+     the texture so it's safe to drop ours straight away */
+  cogl_object_unref (tile->texture);
+  tile->texture = NULL;
+  tex_virtual->memory_used -= tile->size;
+  _cogl_list_remove (&tile->link);
+}
+
+static void
+_cogl_texture_virtual_evict (CoglTextureVirtual *tex_virtual,
+                             size_t needed)
+{
+  CoglTextureVirtualLevel *last_level =
+    tex_virtual->levels + tex_virtual->n_levels - 1;
+  CoglTextureVirtualTile *tile, *tmp;
+
+  COGL_STATIC_COUNTER (texture_virtual_evict_counter,
+                       "Virtual texture tile evictions",
+                       "Increments each time a tile of a virtual texture "
+                       "is released to stay within its memory budget",
+                       0 /* no application private data */);
+
+  _cogl_list_for_each_reverse_safe (tile, tmp, &tex_virtual->lru, link)
+    {
+      if (tex_virtual->memory_used + needed <= tex_virtual->memory_budget)
+        break;
+
+      /* The tiles used by the current draw and the single tile of
+         the lowest level of detail are always kept */
+      if (tile->last_used == tex_virtual->use_serial ||
+          tile == last_level->tiles)
+        continue;
+
+      _cogl_texture_virtual_unload_tile (tex_virtual, tile);
+
+      COGL_COUNTER_INC (_cogl_uprof_context, texture_virtual_evict_counter);
+    }
+}
+
+static void
+_cogl_texture_virtual_get_tile_size (CoglTextureVirtual *tex_virtual,
+                                     int level_num,
+                                     int tile_x,
+                                     int tile_y,
+                                     int *width,
+                                     int *height)
+{
+  CoglTextureVirtualLevel *level = tex_virtual->levels + level_num;
+  int tile_size = tex_virtual->tile_size;
+
+  *width = MIN (tile_size, level->width - tile_x * tile_size);
+  *height = MIN (tile_size, level->height - tile_y * tile_size);
+}
+
+static CoglTexture *
+_cogl_texture_virtual_load_tile (CoglTextureVirtual *tex_virtual,
+                                 CoglTextureVirtualTile *tile,
+                                 int width,
+                                 int height,
+                                 int rowstride,
+                                 const uint8_t *data,
+                                 CoglError **error)
+{
+  CoglContext *ctx = COGL_TEXTURE (tex_virtual)->context;
+  CoglPixelFormat format = tex_virtual->internal_format;
+  int bpp = _cogl_pixel_format_get_bytes_per_pixel (format);
+  size_t size = (size_t) width * height * bpp;
+  CoglTexture2D *tile_tex;
+
+  COGL_STATIC_COUNTER (texture_virtual_load_counter,
+                       "Virtual texture tile loads",
+                       "Increments each time a tile of a virtual texture "
+                       "is uploaded",
+                       0 /* no application private data */);
+
+  _cogl_texture_virtual_evict (tex_virtual, size);
+
+  tile_tex = cogl_texture_2d_new_from_data (ctx,
+                                            width, height,
+                                            format,
+                                            rowstride,
+                                            data,
+                                            error);
+  if (tile_tex == NULL)
+    return NULL;
+
+  if (tile->texture)
+    _cogl_texture_virtual_unload_tile (tex_virtual, tile);
+
+  tile->texture = COGL_TEXTURE (tile_tex);
+  tile->size = size;
+  tile->requested = FALSE;
+  tile->last_used = tex_virtual->use_serial;
+  _cogl_list_insert (&tex_virtual->lru, &tile->link);
+  tex_virtual->memory_used += size;
+
+  COGL_COUNTER_INC (_cogl_uprof_context, texture_virtual_load_counter);
+
+  return tile->texture;
+}
+
+/* Fills the scratch buffer with a tile of a lower level of detail by
+ * point-sampling the source image */
+static void
+_cogl_texture_virtual_sample_source (CoglTextureVirtual *tex_virtual,
+                                     int level_num,
+                                     int tile_x,
+                                     int tile_y,
+                                     int width,
+                                     int height,
+                                     int rowstride)
+{
+  CoglTexture *tex = COGL_TEXTURE (tex_virtual);
+  CoglTextureVirtualLevel *level = tex_virtual->levels + level_num;
+  int bpp = _cogl_pixel_format_get_bytes_per_pixel (tex_virtual->internal_format);
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      int64_t level_y = tile_y * tex_virtual->tile_size + y;
+      int src_y = (level_y * 2 + 1) * tex->height / (level->height * 2);
+      const uint8_t *src_row =
+        tex_virtual->source_data + src_y * tex_virtual->source_rowstride;
+      uint8_t *dst = tex_virtual->scratch + y * rowstride;
+
+      for (x = 0; x < width; x++)
+        {
+          int64_t level_x = tile_x * tex_virtual->tile_size + x;
+          int src_x = (level_x * 2 + 1) * tex->width / (level->width * 2);
+
+          memcpy (dst, src_row + src_x * bpp, bpp);
+          dst += bpp;
+        }
+    }
+}
+
+static CoglTexture *
+_cogl_texture_virtual_get_tile (CoglTextureVirtual *tex_virtual,
+                                int level_num,
+                                int tile_x,
+                                int tile_y)
+{
+  CoglTextureVirtualLevel *level = tex_virtual->levels + level_num;
+  CoglTextureVirtualTile *tile =
+    level->tiles + tile_y * level->n_tiles_x + tile_x;
+  int bpp = _cogl_pixel_format_get_bytes_per_pixel (tex_virtual->internal_format);
+  CoglTexture *tile_tex;
+  CoglError *ignore_error = NULL;
+  int width, height, rowstride;
+
+  if (tile->texture)
+    {
+      /* Move the tile to the front of the LRU list */
+      _cogl_list_remove (&tile->link);
+      _cogl_list_insert (&tex_virtual->lru, &tile->link);
+      tile->last_used = tex_virtual->use_serial;
+
+      return tile->texture;
+    }
+
+  if (tile->requested)
+    return NULL;
+
+  _cogl_texture_virtual_get_tile_size (tex_virtual,
+                                       level_num, tile_x, tile_y,
+                                       &width, &height);
+  rowstride = width * bpp;
+
+  if (tex_virtual->source_data)
+    {
+      if (level_num == 0)
+        {
+          /* The full size tiles can be uploaded straight from the
+             source */
+          const uint8_t *data =
+            tex_virtual->source_data +
+            (size_t) tile_y * tex_virtual->tile_size *
+            tex_virtual->source_rowstride +
+            (size_t) tile_x * tex_virtual->tile_size * bpp;
+
+          tile_tex = _cogl_texture_virtual_load_tile (tex_virtual, tile,
+                                                      width, height,
+                                                      tex_virtual->source_rowstride,
+                                                      data,
+                                                      &ignore_error);
+          goto done;
+        }
+
+      _cogl_texture_virtual_sample_source (tex_virtual,
+                                           level_num, tile_x, tile_y,
+                                           width, height,
+                                           rowstride);
+    }
+  else if (!tex_virtual->load_callback (tex_virtual,
+                                        level_num, tile_x, tile_y,
+                                        width, height,
+                                        rowstride,
+                                        tex_virtual->scratch,
+                                        tex_virtual->user_data))
+    {
+      tile->requested = TRUE;
+      return NULL;
+    }
+
+  tile_tex = _cogl_texture_virtual_load_tile (tex_virtual, tile,
+                                              width, height,
+                                              rowstride,
+                                              tex_virtual->scratch,
+                                              &ignore_error);
+
+ done:
+  if (tile_tex == NULL)
+    {
+      /* Don't keep trying to load a tile that can't be created */
+      g_warning ("Failed to load virtual texture tile: %s",
+                 ignore_error->message);
+      cogl_error_free (ignore_error);
+      tile->requested = TRUE;
+    }
+
+  return tile_tex;
+}
+
+static CoglTexture *
+_cogl_texture_virtual_get_lowest_detail_tile (CoglTextureVirtual *tex_virtual)
+{
+  /* The last level is a single tile covering the whole texture */
+  return _cogl_texture_virtual_get_tile (tex_virtual,
+                                         tex_virtual->n_levels - 1,
+                                         0, 0);
+}
+
+static void
+_cogl_texture_virtual_foreach_tile (CoglTextureVirtual *tex_virtual,
+                                    int level_num,
+                                    float s_1,
+                                    float t_1,
+                                    float s_2,
+                                    float t_2,
+                                    CoglMetaTextureCallback callback,
+                                    void *user_data)
+{
+  CoglTextureVirtualLevel *level = tex_virtual->levels + level_num;
+  /* The size of a tile in normalized texture coordinates */
+  float tile_s = tex_virtual->tile_size / (float) level->width;
+  float tile_t = tex_virtual->tile_size / (float) level->height;
+  int first_x, first_y, last_x, last_y;
+  int x, y;
+
+  first_x = CLAMP ((int) floorf (s_1 / tile_s), 0, level->n_tiles_x - 1);
+  first_y = CLAMP ((int) floorf (t_1 / tile_t), 0, level->n_tiles_y - 1);
+  last_x = CLAMP ((int) ceilf (s_2 / tile_s) - 1,
+                  first_x, level->n_tiles_x - 1);
+  last_y = CLAMP ((int) ceilf (t_2 / tile_t) - 1,
+                  first_y, level->n_tiles_y - 1);
+
+  for (y = first_y; y <= last_y; y++)
+    for (x = first_x; x <= last_x; x++)
+      {
+        float tile_coords[4] = {
+          x * tile_s,
+          y * tile_t,
+          MIN ((x + 1) * tile_s, 1.0f),
+          MIN ((y + 1) * tile_t, 1.0f)
+        };
+        float meta_coords[4] = {
+          MAX (s_1, tile_coords[0]),
+          MAX (t_1, tile_coords[1]),
+          MIN (s_2, tile_coords[2]),
+          MIN (t_2, tile_coords[3])
+        };
+        CoglTexture *tile_tex =
+          _cogl_texture_virtual_get_tile (tex_virtual, level_num, x, y);
+
+        if (tile_tex)
+          {
+            float tile_width = tile_coords[2] - tile_coords[0];
+            float tile_height = tile_coords[3] - tile_coords[1];
+            float slice_coords[4] = {
+              (meta_coords[0] - tile_coords[0]) / tile_width,
+              (meta_coords[1] - tile_coords[1]) / tile_height,
+              (meta_coords[2] - tile_coords[0]) / tile_width,
+              (meta_coords[3] - tile_coords[1]) / tile_height
+            };
+
+            callback (tile_tex, slice_coords, meta_coords, user_data);
+          }
+        else if (level_num + 1 < tex_virtual->n_levels)
+          {
+            /* Fill in the missing tile with a lower level of detail */
+            _cogl_texture_virtual_foreach_tile (tex_virtual,
+                                                level_num + 1,
+                                                meta_coords[0],
+                                                meta_coords[1],
+                                                meta_coords[2],
+                                                meta_coords[3],
+                                                callback,
+                                                user_data);
+          }
+      }
+}
+
+static void
+_cogl_texture_virtual_foreach_sub_texture_in_region (
+                                       CoglTexture *tex,
+                                       float virtual_tx_1,
+                                       float virtual_ty_1,
+                                       float virtual_tx_2,
+                                       float virtual_ty_2,
+                                       CoglMetaTextureCallback callback,
+                                       void *user_data)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+
+  tex_virtual->use_serial++;
+
+  _cogl_texture_virtual_foreach_tile (tex_virtual,
+                                      tex_virtual->detail_level,
+                                      MIN (virtual_tx_1, virtual_tx_2),
+                                      MIN (virtual_ty_1, virtual_ty_2),
+                                      MAX (virtual_tx_1, virtual_tx_2),
+                                      MAX (virtual_ty_1, virtual_ty_2),
+                                      callback,
+                                      user_data);
+}
+
+static void
+_cogl_texture_virtual_free (CoglTextureVirtual *tex_virtual)
+{
+  CoglTextureVirtualTile *tile, *tmp;
+  int i;
+
+  _cogl_list_for_each_safe (tile, tmp, &tex_virtual->lru, link)
+    _cogl_texture_virtual_unload_tile (tex_virtual, tile);
+
+  for (i = 0; i < tex_virtual->n_levels; i++)
+    g_free (tex_virtual->levels[i].tiles);
+  g_free (tex_virtual->levels);
+
+  g_free (tex_virtual->scratch);
+
+  if (tex_virtual->destroy)
+    tex_virtual->destroy (tex_virtual->user_data);
+
+  /* Chain up */
+  _cogl_texture_free (COGL_TEXTURE (tex_virtual));
+}
+
+static CoglTextureVirtual *
+_cogl_texture_virtual_create_base (CoglContext *ctx,
+                                   int width,
+                                   int height,
+                                   int tile_size,
+                                   CoglPixelFormat format)
+{
+  CoglTextureVirtual *tex_virtual = g_new0 (CoglTextureVirtual, 1);
+  int bpp = _cogl_pixel_format_get_bytes_per_pixel (format);
+  int level_width = width, level_height = height;
+  int i;
+
+  _cogl_texture_init (COGL_TEXTURE (tex_virtual), ctx, width, height,
+                      format,
+                      NULL, /* no loader */
+                      &cogl_texture_virtual_vtable);
+
+  tex_virtual->internal_format = format;
+  tex_virtual->tile_size = tile_size;
+
+  /* Halve the size until the whole image fits in one tile */
+  tex_virtual->n_levels = 1;
+  while (level_width > tile_size || level_height > tile_size)
+    {
+      level_width = MAX (1, level_width >> 1);
+      level_height = MAX (1, level_height >> 1);
+      tex_virtual->n_levels++;
+    }
+
+  tex_virtual->levels = g_new (CoglTextureVirtualLevel, tex_virtual->n_levels);
+
+  for (i = 0; i < tex_virtual->n_levels; i++)
+    {
+      CoglTextureVirtualLevel *level = tex_virtual->levels + i;
+
+      level->width = MAX (1, width >> i);
+      level->height = MAX (1, height >> i);
+      level->n_tiles_x = (level->width + tile_size - 1) / tile_size;
+      level->n_tiles_y = (level->height + tile_size - 1) / tile_size;
+      level->tiles = g_new0 (CoglTextureVirtualTile,
+                             level->n_tiles_x * level->n_tiles_y);
+    }
+
+  tex_virtual->scratch = g_malloc ((size_t) tile_size * tile_size * bpp);
+
+  _cogl_list_init (&tex_virtual->lru);
+  tex_virtual->memory_budget = COGL_TEXTURE_VIRTUAL_DEFAULT_BUDGET;
+
+  return tex_virtual;
+}
+
+CoglTextureVirtual *
+cogl_texture_virtual_new (CoglContext *ctx,
+                          int width,
+                          int height,
+                          int tile_size,
+                          CoglPixelFormat format,
+                          CoglTextureVirtualLoadCallback callback,
+                          void *user_data,
+                          CoglUserDataDestroyCallback destroy)
+{
+  CoglTextureVirtual *tex_virtual;
+
+  _COGL_RETURN_VAL_IF_FAIL (width > 0 && height > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (tile_size > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (format != COGL_PIXEL_FORMAT_ANY, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (callback != NULL, NULL);
+
+  tex_virtual = _cogl_texture_virtual_create_base (ctx,
+                                                   width, height,
+                                                   tile_size,
+                                                   format);
+
+  tex_virtual->load_callback = callback;
+  tex_virtual->user_data = user_data;
+  tex_virtual->destroy = destroy;
+
+  return _cogl_texture_virtual_object_new (tex_virtual);
+}
+
+CoglTextureVirtual *
+cogl_texture_virtual_new_from_data (CoglContext *ctx,
+                                    int width,
+                                    int height,
+                                    int tile_size,
+                                    CoglPixelFormat format,
+                                    int rowstride,
+                                    const uint8_t *data)
+{
+  CoglTextureVirtual *tex_virtual;
+
+  _COGL_RETURN_VAL_IF_FAIL (width > 0 && height > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (tile_size > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (format != COGL_PIXEL_FORMAT_ANY, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (data != NULL, NULL);
+
+  if (rowstride == 0)
+    rowstride = width * _cogl_pixel_format_get_bytes_per_pixel (format);
+
+  tex_virtual = _cogl_texture_virtual_create_base (ctx,
+                                                   width, height,
+                                                   tile_size,
+                                                   format);
+
+  tex_virtual->source_data = data;
+  tex_virtual->source_rowstride = rowstride;
+
+  return _cogl_texture_virtual_object_new (tex_virtual);
+}
+
+int
+cogl_texture_virtual_get_n_levels (CoglTextureVirtual *texture)
+{
+  return texture->n_levels;
+}
+
+int
+cogl_texture_virtual_get_tile_size (CoglTextureVirtual *texture)
+{
+  return texture->tile_size;
+}
+
+void
+cogl_texture_virtual_set_detail_level (CoglTextureVirtual *texture,
+                                       int level)
+{
+  texture->detail_level = CLAMP (level, 0, texture->n_levels - 1);
+}
+
+int
+cogl_texture_virtual_get_detail_level (CoglTextureVirtual *texture)
+{
+  return texture->detail_level;
+}
+
+CoglBool
+cogl_texture_virtual_set_tile_data (CoglTextureVirtual *texture,
+                                    int level,
+                                    int tile_x,
+                                    int tile_y,
+                                    int rowstride,
+                                    const uint8_t *data,
+                                    CoglError **error)
+{
+  CoglTextureVirtualLevel *level_data;
+  int width, height;
+
+  _COGL_RETURN_VAL_IF_FAIL (level >= 0 && level < texture->n_levels, FALSE);
+
+  level_data = texture->levels + level;
+
+  _COGL_RETURN_VAL_IF_FAIL (tile_x >= 0 && tile_x < level_data->n_tiles_x,
+                            FALSE);
+  _COGL_RETURN_VAL_IF_FAIL (tile_y >= 0 && tile_y < level_data->n_tiles_y,
+                            FALSE);
+
+  _cogl_texture_virtual_get_tile_size (texture,
+                                       level, tile_x, tile_y,
+                                       &width, &height);
+
+  if (rowstride == 0)
+    rowstride =
+      width * _cogl_pixel_format_get_bytes_per_pixel (texture->internal_format);
+
+  return _cogl_texture_virtual_load_tile (texture,
+                                          level_data->tiles +
+                                          tile_y * level_data->n_tiles_x +
+                                          tile_x,
+                                          width, height,
+                                          rowstride,
+                                          data,
+                                          error) != NULL;
+}
+
+void
+cogl_texture_virtual_set_memory_budget (CoglTextureVirtual *texture,
+                                        size_t budget)
+{
+  texture->memory_budget = budget;
+
+  _cogl_texture_virtual_evict (texture, 0);
+}
+
+size_t
+cogl_texture_virtual_get_memory_budget (CoglTextureVirtual *texture)
+{
+  return texture->memory_budget;
+}
+
+size_t
+cogl_texture_virtual_get_memory_used (CoglTextureVirtual *texture)
+{
+  return texture->memory_used;
+}
+
+static CoglBool
+_cogl_texture_virtual_allocate (CoglTexture *tex,
+                                CoglError **error)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+
+  /* The tiles are allocated lazily when they are drawn */
+  _cogl_texture_set_allocated (tex,
+                               tex_virtual->internal_format,
+                               tex->width, tex->height);
+
+  return TRUE;
+}
+
+static CoglBool
+_cogl_texture_virtual_set_region (CoglTexture *tex,
+                                  int src_x,
+                                  int src_y,
+                                  int dst_x,
+                                  int dst_y,
+                                  int dst_width,
+                                  int dst_height,
+                                  int level,
+                                  CoglBitmap *bmp,
+                                  CoglError **error)
+{
+  /* The data of a tile that isn't loaded would be lost so the
+     contents can only be changed a tile at a time */
+  _cogl_set_error (error,
+                   COGL_SYSTEM_ERROR,
+                   COGL_SYSTEM_ERROR_UNSUPPORTED,
+                   "Virtual textures can only be updated with "
+                   "cogl_texture_virtual_set_tile_data()");
+  return FALSE;
+}
+
+static CoglBool
+_cogl_texture_virtual_is_sliced (CoglTexture *tex)
+{
+  return TRUE;
+}
+
+static CoglBool
+_cogl_texture_virtual_can_hardware_repeat (CoglTexture *tex)
+{
+  return FALSE;
+}
+
+/* Drawing that doesn't go through the meta texture interface uses
+ * the tile of the lowest level of detail because it covers the whole
+ * texture with the same texture coordinates */
+
+static void
+_cogl_texture_virtual_transform_coords_to_gl (CoglTexture *tex,
+                                              float *s,
+                                              float *t)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTexture *tile_tex =
+    _cogl_texture_virtual_get_lowest_detail_tile (tex_virtual);
+
+  if (tile_tex)
+    _cogl_texture_transform_coords_to_gl (tile_tex, s, t);
+}
+
+static CoglTransformResult
+_cogl_texture_virtual_transform_quad_coords_to_gl (CoglTexture *tex,
+                                                   float *coords)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTexture *tile_tex =
+    _cogl_texture_virtual_get_lowest_detail_tile (tex_virtual);
+
+  if (tile_tex == NULL)
+    return COGL_TRANSFORM_SOFTWARE_REPEAT;
+
+  return _cogl_texture_transform_quad_coords_to_gl (tile_tex, coords);
+}
+
+static CoglBool
+_cogl_texture_virtual_get_gl_texture (CoglTexture *tex,
+                                      GLuint *out_gl_handle,
+                                      GLenum *out_gl_target)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTexture *tile_tex =
+    _cogl_texture_virtual_get_lowest_detail_tile (tex_virtual);
+
+  if (tile_tex == NULL)
+    return FALSE;
+
+  return cogl_texture_get_gl_texture (tile_tex, out_gl_handle, out_gl_target);
+}
+
+static void
+_cogl_texture_virtual_gl_flush_legacy_texobj_filters (CoglTexture *tex,
+                                                      GLenum min_filter,
+                                                      GLenum mag_filter)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTexture *tile_tex =
+    _cogl_texture_virtual_get_lowest_detail_tile (tex_virtual);
+
+  if (tile_tex)
+    _cogl_texture_gl_flush_legacy_texobj_filters (tile_tex,
+                                                  min_filter, mag_filter);
+}
+
+static void
+_cogl_texture_virtual_pre_paint (CoglTexture *tex,
+                                 CoglTexturePrePaintFlags flags)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTextureVirtualTile *tile;
+
+  /* Pass the pre-paint on to every loaded tile */
+  _cogl_list_for_each (tile, &tex_virtual->lru, link)
+    _cogl_texture_pre_paint (tile->texture, flags);
+}
+
+static void
+_cogl_texture_virtual_ensure_non_quad_rendering (CoglTexture *tex)
+{
+}
+
+static void
+_cogl_texture_virtual_gl_flush_legacy_texobj_wrap_modes (CoglTexture *tex,
+                                                         GLenum wrap_mode_s,
+                                                         GLenum wrap_mode_t,
+                                                         GLenum wrap_mode_p)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTexture *tile_tex =
+    _cogl_texture_virtual_get_lowest_detail_tile (tex_virtual);
+
+  if (tile_tex)
+    _cogl_texture_gl_flush_legacy_texobj_wrap_modes (tile_tex,
+                                                     wrap_mode_s,
+                                                     wrap_mode_t,
+                                                     wrap_mode_p);
+}
+
+static CoglPixelFormat
+_cogl_texture_virtual_get_format (CoglTexture *tex)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+
+  return tex_virtual->internal_format;
+}
+
+static GLenum
+_cogl_texture_virtual_get_gl_format (CoglTexture *tex)
+{
+  CoglTextureVirtual *tex_virtual = COGL_TEXTURE_VIRTUAL (tex);
+  CoglTexture *tile_tex =
+    _cogl_texture_virtual_get_lowest_detail_tile (tex_virtual);
+
+  _COGL_RETURN_VAL_IF_FAIL (tile_tex != NULL, 0);
+
+  return _cogl_texture_gl_get_format (tile_tex);
+}
+
+static CoglTextureType
+_cogl_texture_virtual_get_type (CoglTexture *tex)
+{
+  return COGL_TEXTURE_TYPE_2D;
+}
+
+static const CoglTextureVtable
+cogl_texture_virtual_vtable =
+  {
+    FALSE, /* not primitive */
+    _cogl_texture_virtual_allocate,
+    _cogl_texture_virtual_set_region,
+    NULL, /* get_data */
+    _cogl_texture_virtual_foreach_sub_texture_in_region,
+    _cogl_texture_virtual_is_sliced,
+    _cogl_texture_virtual_can_hardware_repeat,
+    _cogl_texture_virtual_transform_coords_to_gl,
+    _cogl_texture_virtual_transform_quad_coords_to_gl,
+    _cogl_texture_virtual_get_gl_texture,
+    _cogl_texture_virtual_gl_flush_legacy_texobj_filters,
+    _cogl_texture_virtual_pre_paint,
+    _cogl_texture_virtual_ensure_non_quad_rendering,
+    _cogl_texture_virtual_gl_flush_legacy_texobj_wrap_modes,
+    _cogl_texture_virtual_get_format,
+    _cogl_texture_virtual_get_gl_format,
+    _cogl_texture_virtual_get_type,
+    NULL, /* is_foreign */
+    NULL /* set_auto_mipmap */
+  };
+
+typedef struct
+{
+  CoglTextureVirtual *tex_virtual;
+  int n_loads;
+  float covered_area;
+  int n_fallback_tiles;
+} CheckVirtualTextureState;
+
+static CoglBool
+check_virtual_texture_load_cb (CoglTextureVirtual *texture,
+                               int level,
+                               int tile_x,
+                               int tile_y,
+                               int width,
+                               int height,
+                               int rowstride,
+                               uint8_t *data,
+                               void *user_data)
+{
+  CheckVirtualTextureState *state = user_data;
+  int y;
+
+  /* Pretend that one of the full size tiles is still loading */
+  if (level == 0 && tile_x == 1 && tile_y == 1)
+    return FALSE;
+
+  for (y = 0; y < height; y++)
+    memset (data + y * rowstride, level, width * 4);
+
+  state->n_loads++;
+
+  return TRUE;
+}
+
+static void
+check_virtual_texture_foreach_cb (CoglTexture *slice_texture,
+                                  const float *slice_coords,
+                                  const float *meta_coords,
+                                  void *user_data)
+{
+  CheckVirtualTextureState *state = user_data;
+
+  state->covered_area += ((meta_coords[2] - meta_coords[0]) *
+                          (meta_coords[3] - meta_coords[1]));
+
+  g_assert_cmpfloat (slice_coords[0], >=, 0.0f);
+  g_assert_cmpfloat (slice_coords[2], <=, 1.0f);
+
+  if (slice_texture == state->tex_virtual->levels[1].tiles[0].texture)
+    state->n_fallback_tiles++;
+}
+
+UNIT_TEST (check_virtual_texture_streaming,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  CheckVirtualTextureState state = { 0 };
+  CoglTextureVirtual *tex_virtual;
+
+  /* The levels are 128x100, 64x50 and 32x25 */
+  tex_virtual = cogl_texture_virtual_new (test_ctx,
+                                          128, 100,
+                                          32,
+                                          COGL_PIXEL_FORMAT_RGBA_8888,
+                                          check_virtual_texture_load_cb,
+                                          &state,
+                                          NULL);
+
+  state.tex_virtual = tex_virtual;
+
+  g_assert_cmpint (cogl_texture_virtual_get_n_levels (tex_virtual), ==, 3);
+  g_assert_cmpint (tex_virtual->levels[2].n_tiles_x, ==, 1);
+  g_assert_cmpint (tex_virtual->levels[2].n_tiles_y, ==, 1);
+
+  /* Iterating the top left quarter should only load the 2x2 tiles
+   * that it covers. The missing tile is replaced with part of a level
+   * 1 tile */
+  cogl_meta_texture_foreach_in_region (COGL_META_TEXTURE (tex_virtual),
+                                       0.0f, 0.0f, 0.5f, 0.5f,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       check_virtual_texture_foreach_cb,
+                                       &state);
+
+  g_assert_cmpint (state.n_loads, ==, 4);
+  g_assert_cmpint (state.n_fallback_tiles, ==, 1);
+  g_assert_cmpfloat (fabsf (state.covered_area - 0.25f), <, 0.0001f);
+  g_assert_cmpint (cogl_texture_virtual_get_memory_used (tex_virtual),
+                   ==,
+                   4 * 32 * 32 * 4);
+
+  /* Drawing the same region again shouldn't load anything */
+  state.covered_area = 0.0f;
+  cogl_meta_texture_foreach_in_region (COGL_META_TEXTURE (tex_virtual),
+                                       0.0f, 0.0f, 0.5f, 0.5f,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       check_virtual_texture_foreach_cb,
+                                       &state);
+  g_assert_cmpint (state.n_loads, ==, 4);
+
+  /* Supplying the missing tile replaces the fallback */
+  state.n_fallback_tiles = 0;
+  g_assert (cogl_texture_virtual_set_tile_data (tex_virtual,
+                                                0, 1, 1,
+                                                0,
+                                                tex_virtual->scratch,
+                                                NULL));
+  cogl_meta_texture_foreach_in_region (COGL_META_TEXTURE (tex_virtual),
+                                       0.0f, 0.0f, 0.5f, 0.5f,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       check_virtual_texture_foreach_cb,
+                                       &state);
+  g_assert_cmpint (state.n_fallback_tiles, ==, 0);
+
+  /* With a budget of four tiles, drawing the bottom right quarter
+   * has to evict all of the tiles that were loaded before. It needs
+   * six tiles, the last two of which are only 4 pixels high, so it
+   * temporarily goes over the budget */
+  cogl_texture_virtual_set_memory_budget (tex_virtual, 4 * 32 * 32 * 4);
+  cogl_meta_texture_foreach_in_region (COGL_META_TEXTURE (tex_virtual),
+                                       0.5f, 0.5f, 1.0f, 1.0f,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                       check_virtual_texture_foreach_cb,
+                                       &state);
+  g_assert_cmpint (state.n_loads, ==, 10);
+  g_assert_cmpint (cogl_texture_virtual_get_memory_used (tex_virtual),
+                   ==,
+                   4 * 32 * 32 * 4 + 2 * 32 * 4 * 4);
+
+  cogl_object_unref (tex_virtual);
+}
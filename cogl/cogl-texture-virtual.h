@@ -0,0 +1,314 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_TEXTURE_VIRTUAL_H
+#define __COGL_TEXTURE_VIRTUAL_H
+
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-object.h>
+#include <cogl/cogl-types.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-texture-virtual
+ * @short_description: Functions for creating and manipulating
+ *                     textures that are streamed in on demand
+ *
+ * A #CoglTextureVirtual represents an image that is too big to keep
+ * in GPU memory all at once, such as a gigapixel map or photograph.
+ * The image is divided into square tiles at a number of levels of
+ * detail, each level being half the size of the previous one, down
+ * to a level that fits in a single tile. Tiles are only loaded when
+ * they are drawn and the least recently used tiles are released when
+ * the memory used by the texture exceeds a budget.
+ *
+ * The tiles are loaded either from a callback or directly from a
+ * block of memory which can be a memory-mapped file. When a tile
+ * can't be loaded yet the area it covers is drawn with the tiles of
+ * a lower level of detail instead.
+ *
+ * A #CoglTextureVirtual implements the #CoglMetaTexture interface so
+ * it can be drawn with cogl_framebuffer_draw_rectangle() and related
+ * functions in the same way as a #CoglTexture2DSliced. Only the tiles
+ * within the region being drawn are visited.
+ */
+
+#define COGL_TEXTURE_VIRTUAL(X) ((CoglTextureVirtual *)X)
+typedef struct _CoglTextureVirtual CoglTextureVirtual;
+
+/**
+ * CoglTextureVirtualLoadCallback:
+ * @texture: The #CoglTextureVirtual that needs the tile
+ * @level: The level of detail of the tile where 0 is the full size
+ *         image
+ * @tile_x: The column of the tile within the level
+ * @tile_y: The row of the tile within the level
+ * @width: The width of the tile in pixels
+ * @height: The height of the tile in pixels
+ * @rowstride: The number of bytes between the rows of @data
+ * @data: A buffer to write the tile's pixels to in the format of the
+ *        texture
+ * @user_data: The private data passed to cogl_texture_virtual_new()
+ *
+ * The callback used to load the contents of a tile of a
+ * #CoglTextureVirtual. The tiles are @width by @height pixels which is
+ * the tile size except for the tiles on the right and bottom edges.
+ * Level n is scaled to the texture size shifted right by n bits,
+ * with a minimum of 1 pixel.
+ *
+ * If the data isn't available straight away the callback can return
+ * %FALSE. The tile won't be requested again so the application
+ * should supply the data later with cogl_texture_virtual_set_tile_data().
+ * In the meantime a lower level of detail is drawn instead.
+ *
+ * Return value: %TRUE if @data was filled or %FALSE otherwise
+ * Since: 2.0
+ * Stability: unstable
+ */
+typedef CoglBool (* CoglTextureVirtualLoadCallback) (CoglTextureVirtual *texture,
+                                                     int level,
+                                                     int tile_x,
+                                                     int tile_y,
+                                                     int width,
+                                                     int height,
+                                                     int rowstride,
+                                                     uint8_t *data,
+                                                     void *user_data);
+
+/**
+ * cogl_texture_virtual_new:
+ * @ctx: A #CoglContext
+ * @width: The width of the full size image
+ * @height: The height of the full size image
+ * @tile_size: The width and height of each tile
+ * @format: The format of the pixels
+ * @callback: (scope notified): A #CoglTextureVirtualLoadCallback used
+ *            to load the tiles
+ * @user_data: (closure): Private data passed to @callback
+ * @destroy: (allow-none): A function to destroy @user_data when the
+ *           texture is freed
+ *
+ * Creates a #CoglTextureVirtual whose tiles are loaded on demand with
+ * @callback. The tile size should be a size that the hardware can
+ * handle as a #CoglTexture2D. Typical values are 256 or 512.
+ *
+ * Return value: (transfer full): A new #CoglTextureVirtual
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglTextureVirtual *
+cogl_texture_virtual_new (CoglContext *ctx,
+                          int width,
+                          int height,
+                          int tile_size,
+                          CoglPixelFormat format,
+                          CoglTextureVirtualLoadCallback callback,
+                          void *user_data,
+                          CoglUserDataDestroyCallback destroy);
+
+/**
+ * cogl_texture_virtual_new_from_data:
+ * @ctx: A #CoglContext
+ * @width: The width of the image
+ * @height: The height of the image
+ * @tile_size: The width and height of each tile
+ * @format: The format of the pixels in @data
+ * @rowstride: The number of bytes between the rows of @data
+ * @data: The pixels of the full size image
+ *
+ * Creates a #CoglTextureVirtual whose tiles are copied from @data when
+ * they are needed. The data is not copied up front so it must remain
+ * valid until the texture is destroyed. This is intended to be used
+ * with a memory-mapped file so that only the pages of the file that
+ * are drawn are read.
+ *
+ * The lower levels of detail are generated by point-sampling the
+ * full size image.
+ *
+ * Return value: (transfer full): A new #CoglTextureVirtual
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglTextureVirtual *
+cogl_texture_virtual_new_from_data (CoglContext *ctx,
+                                    int width,
+                                    int height,
+                                    int tile_size,
+                                    CoglPixelFormat format,
+                                    int rowstride,
+                                    const uint8_t *data);
+
+/**
+ * cogl_texture_virtual_get_n_levels:
+ * @texture: A #CoglTextureVirtual
+ *
+ * Return value: the number of levels of detail in @texture. The last
+ *   level always fits in a single tile.
+ * Since: 2.0
+ * Stability: unstable
+ */
+int
+cogl_texture_virtual_get_n_levels (CoglTextureVirtual *texture);
+
+/**
+ * cogl_texture_virtual_get_tile_size:
+ * @texture: A #CoglTextureVirtual
+ *
+ * Return value: the width and height of the tiles of @texture
+ * Since: 2.0
+ * Stability: unstable
+ */
+int
+cogl_texture_virtual_get_tile_size (CoglTextureVirtual *texture);
+
+/**
+ * cogl_texture_virtual_set_detail_level:
+ * @texture: A #CoglTextureVirtual
+ * @level: The level of detail to draw with
+ *
+ * Sets the level of detail whose tiles are used when the texture is
+ * drawn. Level 0 is the full size image. The application should
+ * choose the level according to how much the texture is scaled down
+ * on screen so that tiles with more detail than can be seen are not
+ * loaded. The level is clamped to the number of levels.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_texture_virtual_set_detail_level (CoglTextureVirtual *texture,
+                                       int level);
+
+/**
+ * cogl_texture_virtual_get_detail_level:
+ * @texture: A #CoglTextureVirtual
+ *
+ * Return value: the level of detail set with
+ *   cogl_texture_virtual_set_detail_level()
+ * Since: 2.0
+ * Stability: unstable
+ */
+int
+cogl_texture_virtual_get_detail_level (CoglTextureVirtual *texture);
+
+/**
+ * cogl_texture_virtual_set_tile_data:
+ * @texture: A #CoglTextureVirtual
+ * @level: The level of detail of the tile
+ * @tile_x: The column of the tile within the level
+ * @tile_y: The row of the tile within the level
+ * @rowstride: The number of bytes between the rows of @data
+ * @data: The pixels of the tile in the format of the texture
+ * @error: A #CoglError to return exceptional errors or %NULL
+ *
+ * Replaces the contents of a tile. This can be used to supply a tile
+ * that was loaded asynchronously after the
+ * #CoglTextureVirtualLoadCallback returned %FALSE for it. The data
+ * must have the full size of the tile as described for the
+ * #CoglTextureVirtualLoadCallback.
+ *
+ * Return value: %TRUE if the tile was updated or %FALSE otherwise
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglBool
+cogl_texture_virtual_set_tile_data (CoglTextureVirtual *texture,
+                                    int level,
+                                    int tile_x,
+                                    int tile_y,
+                                    int rowstride,
+                                    const uint8_t *data,
+                                    CoglError **error);
+
+/**
+ * cogl_texture_virtual_set_memory_budget:
+ * @texture: A #CoglTextureVirtual
+ * @budget: The maximum number of bytes of tile data to keep
+ *
+ * Sets the amount of memory that the tiles of @texture may use. When
+ * loading a tile would exceed the budget the least recently drawn
+ * tiles are released first. Tiles that are needed to draw the
+ * current rectangle and the tile of the lowest level of detail are
+ * never released so the budget may be exceeded temporarily. The
+ * default budget is 64MiB.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_texture_virtual_set_memory_budget (CoglTextureVirtual *texture,
+                                        size_t budget);
+
+/**
+ * cogl_texture_virtual_get_memory_budget:
+ * @texture: A #CoglTextureVirtual
+ *
+ * Return value: the budget set with
+ *   cogl_texture_virtual_set_memory_budget()
+ * Since: 2.0
+ * Stability: unstable
+ */
+size_t
+cogl_texture_virtual_get_memory_budget (CoglTextureVirtual *texture);
+
+/**
+ * cogl_texture_virtual_get_memory_used:
+ * @texture: A #CoglTextureVirtual
+ *
+ * Return value: the number of bytes used by the tiles of @texture
+ *   that are currently loaded
+ * Since: 2.0
+ * Stability: unstable
+ */
+size_t
+cogl_texture_virtual_get_memory_used (CoglTextureVirtual *texture);
+
+/**
+ * cogl_is_texture_virtual:
+ * @object: A #CoglObject
+ *
+ * Checks whether @object is a #CoglTextureVirtual.
+ *
+ * Return value: %TRUE if the passed @object represents a
+ *               #CoglTextureVirtual and %FALSE otherwise.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglBool
+cogl_is_texture_virtual (void *object);
+
+COGL_END_DECLS
+
+#endif /* __COGL_TEXTURE_VIRTUAL_H */
@@ -61,6 +61,7 @@
 #include "cogl-sub-texture.h"
 #include "cogl-primitive-texture.h"
 #include "cogl-error-private.h"
+#include "cogl-profile.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -123,6 +124,8 @@ _cogl_texture_init (CoglTexture *texture,
   texture->allocated = FALSE;
   texture->vtable = vtable;
   texture->framebuffers = NULL;
+  texture->memory_size = 0;
+  texture->memory_type = COGL_MEMORY_TYPE_TEXTURE;
 
   texture->loader = loader;
 
@@ -155,6 +158,7 @@ _cogl_texture_free_loader (CoglTexture *texture)
         case COGL_TEXTURE_SOURCE_TYPE_SIZED:
         case COGL_TEXTURE_SOURCE_TYPE_EGL_IMAGE:
         case COGL_TEXTURE_SOURCE_TYPE_GL_FOREIGN:
+        case COGL_TEXTURE_SOURCE_TYPE_COMPRESSED:
           break;
         case COGL_TEXTURE_SOURCE_TYPE_BITMAP:
           cogl_object_unref (loader->src.bitmap.bitmap);
@@ -176,6 +180,8 @@ _cogl_texture_free (CoglTexture *texture)
 {
   _cogl_texture_free_loader (texture);
 
+  _cogl_texture_set_memory_size (texture, 0);
+
   g_free (texture);
 }
 
@@ -368,6 +374,14 @@ cogl_texture_set_region_from_bitmap (CoglTexture *texture,
                                      int level,
                                      CoglError **error)
 {
+  CoglBool ret;
+
+  COGL_STATIC_TIMER (texture_upload_timer,
+                     "Mainloop", /* parent */
+                     "Texture Upload",
+                     "The time spent uploading data to textures",
+                     0 /* no application private data */);
+
   _COGL_RETURN_VAL_IF_FAIL ((cogl_bitmap_get_width (bmp) - src_x)
                             >= width, FALSE);
   _COGL_RETURN_VAL_IF_FAIL ((cogl_bitmap_get_height (bmp) - src_y)
@@ -386,13 +400,19 @@ cogl_texture_set_region_from_bitmap (CoglTexture *texture,
      always stored in an RGBA texture even if the texture format is
      advertised as RGB. */
 
-  return texture->vtable->set_region (texture,
-                                      src_x, src_y,
-                                      dst_x, dst_y,
-                                      width, height,
-                                      level,
-                                      bmp,
-                                      error);
+  COGL_TIMER_START (_cogl_uprof_context, texture_upload_timer);
+
+  ret = texture->vtable->set_region (texture,
+                                     src_x, src_y,
+                                     dst_x, dst_y,
+                                     width, height,
+                                     level,
+                                     bmp,
+                                     error);
+
+  COGL_TIMER_STOP (_cogl_uprof_context, texture_upload_timer);
+
+  return ret;
 }
 
 CoglBool
@@ -1282,6 +1302,65 @@ _cogl_texture_set_allocated (CoglTexture *texture,
   texture->allocated = TRUE;
 
   _cogl_texture_free_loader (texture);
+
+  _cogl_texture_update_memory_size (texture);
+}
+
+void
+_cogl_texture_set_memory_size (CoglTexture *texture,
+                               size_t size)
+{
+  CoglContext *ctx = texture->context;
+
+  _cogl_memory_remove (ctx, texture->memory_type, texture->memory_size);
+  texture->memory_size = size;
+  _cogl_memory_add (ctx, texture->memory_type, texture->memory_size);
+}
+
+void
+_cogl_texture_update_memory_size (CoglTexture *texture)
+{
+  CoglPixelFormat format;
+  int bpp;
+  size_t size = 0;
+  int level;
+
+  /* Meta textures are made of primitive textures which are already
+   * counted and the memory of foreign textures isn't owned by Cogl */
+  if (!texture->vtable->is_primitive ||
+      !texture->allocated ||
+      _cogl_texture_is_foreign (texture))
+    {
+      _cogl_texture_set_memory_size (texture, 0);
+      return;
+    }
+
+  format = texture->vtable->get_format (texture);
+  bpp = _cogl_pixel_format_get_bytes_per_pixel (format);
+  if (bpp == 0)
+    bpp = 4;
+
+  for (level = 0; level <= texture->max_level; level++)
+    {
+      int width, height, depth;
+
+      _cogl_texture_get_level_size (texture, level, &width, &height, &depth);
+
+      size += (size_t) width * height * MAX (depth, 1) * bpp;
+    }
+
+  _cogl_texture_set_memory_size (texture, size);
+}
+
+void
+_cogl_texture_set_memory_type (CoglTexture *texture,
+                               CoglMemoryType type)
+{
+  CoglContext *ctx = texture->context;
+
+  _cogl_memory_remove (ctx, texture->memory_type, texture->memory_size);
+  texture->memory_type = type;
+  _cogl_memory_add (ctx, texture->memory_type, texture->memory_size);
 }
 
 CoglBool
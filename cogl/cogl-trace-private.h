@@ -0,0 +1,109 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef __COGL_TRACE_PRIVATE_H
+#define __COGL_TRACE_PRIVATE_H
+
+#include <glib.h>
+
+#include "cogl-types.h"
+
+/* A trace site is the static data for one of the COGL_STATIC_TIMER or
+ * COGL_STATIC_COUNTER declarations. Events in the trace buffers only
+ * store a pointer to the site so that recording an event doesn't
+ * need to copy any strings */
+typedef struct _CoglTraceSite
+{
+  const char *name;
+  /* Current value of a counter site. This is only updated while
+   * tracing is enabled */
+  volatile int count;
+} CoglTraceSite;
+
+#define COGL_TRACE_SITE_INIT(NAME) { (NAME), 0 }
+
+/* Whether events are currently being recorded. The macros in
+ * cogl-profile.h check this before calling into any of the functions
+ * below so that the instrumentation only costs a single branch while
+ * tracing is disabled */
+extern CoglBool _cogl_trace_enabled;
+
+void
+_cogl_trace_init (void);
+
+void
+_cogl_trace_begin (CoglTraceSite *site);
+
+void
+_cogl_trace_end (CoglTraceSite *site);
+
+void
+_cogl_trace_counter (CoglTraceSite *site,
+                     int delta);
+
+#ifdef COGL_COMPILATION
+
+#include "cogl-context.h"
+
+/* GPU spans are recorded with GL timestamp queries. The queries are
+ * read back without stalling the next time a span is started so the
+ * events appear in the trace a few frames late */
+typedef struct _CoglTraceGpuState
+{
+  /* CoglTraceGpuSpans that have been ended but whose results haven't
+   * been read yet. The oldest span is at the head */
+  GQueue pending_spans;
+  /* Spans that have been started but not ended yet. The innermost
+   * span is first */
+  GSList *open_spans;
+  /* The trace generation that the open spans were started in. Spans
+   * left open when tracing stopped are dropped once this changes */
+  int open_spans_generation;
+  /* Query objects that can be reused */
+  GArray *free_queries;
+  /* Value to add to a GPU timestamp to convert it to the clock used
+   * for the CPU events */
+  int64_t clock_offset;
+  CoglBool clock_offset_valid;
+} CoglTraceGpuState;
+
+void
+_cogl_trace_gpu_begin (CoglContext *context,
+                       CoglTraceSite *site);
+
+void
+_cogl_trace_gpu_end (CoglContext *context,
+                     CoglTraceSite *site);
+
+void
+_cogl_trace_gpu_destroy (CoglContext *context);
+
+#endif /* COGL_COMPILATION */
+
+#endif /* __COGL_TRACE_PRIVATE_H */
@@ -0,0 +1,726 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2013 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "config.h"
+
+#include "cogl-trace.h"
+#include "cogl-trace-private.h"
+#include "cogl-context-private.h"
+#include "cogl-error-private.h"
+
+#ifdef COGL_ENABLE_TRACING
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include <test-fixtures/test-unit.h>
+
+/* The number of events kept for each thread. This must be a power of
+ * two */
+#define COGL_TRACE_BUFFER_SIZE 65536
+
+typedef enum
+{
+  COGL_TRACE_EVENT_BEGIN,
+  COGL_TRACE_EVENT_END,
+  COGL_TRACE_EVENT_COUNTER,
+  /* A span with a known duration. These are used for the GPU spans
+   * because they are only read back once both ends are known */
+  COGL_TRACE_EVENT_COMPLETE
+} CoglTraceEventType;
+
+typedef struct
+{
+  const CoglTraceSite *site;
+  int64_t timestamp;
+  /* The value of a counter or the duration of a complete span */
+  int64_t value;
+  CoglTraceEventType type;
+} CoglTraceEvent;
+
+typedef struct _CoglTraceBuffer CoglTraceBuffer;
+
+struct _CoglTraceBuffer
+{
+  CoglTraceBuffer *next;
+
+  int tid;
+  /* The name to show for the track or NULL to use the default */
+  const char *name;
+
+  /* The value of trace_generation when the first event was added.
+   * The buffer is emptied the next time an event is added after
+   * cogl_trace_start() has been called so that only the thread that
+   * owns the buffer ever modifies it */
+  int generation;
+  /* The total number of events added. The position in the ring is
+   * this modulo the buffer size */
+  unsigned int n_events;
+  CoglTraceEvent events[COGL_TRACE_BUFFER_SIZE];
+};
+
+CoglBool _cogl_trace_enabled;
+
+/* The buffers are never freed so that the writer can walk this list
+ * without taking a lock while other threads are adding to it */
+static CoglTraceBuffer *volatile trace_buffers;
+static volatile int trace_generation;
+static volatile int next_tid = 1;
+static int64_t trace_start_time;
+static char *trace_exit_filename;
+
+static __thread CoglTraceBuffer *thread_buffer;
+
+#ifdef GL_ARB_timer_query
+/* All GPU spans are put in a single track. This is only touched by
+ * the thread that owns the context */
+static CoglTraceBuffer *gpu_buffer;
+#endif
+
+static int64_t
+get_time (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * G_GINT64_CONSTANT (1000000000) + ts.tv_nsec;
+}
+
+static CoglTraceBuffer *
+create_buffer (const char *name)
+{
+  /* The events aren't cleared because they are only read up to
+   * n_events */
+  CoglTraceBuffer *buffer = g_malloc (sizeof (CoglTraceBuffer));
+
+  buffer->tid = g_atomic_int_add (&next_tid, 1);
+  buffer->name = name;
+  buffer->generation = g_atomic_int_get (&trace_generation);
+  buffer->n_events = 0;
+
+  do
+    buffer->next = g_atomic_pointer_get (&trace_buffers);
+  while (!g_atomic_pointer_compare_and_exchange (&trace_buffers,
+                                                 buffer->next,
+                                                 buffer));
+
+  return buffer;
+}
+
+static void
+add_event (CoglTraceBuffer *buffer,
+           CoglTraceEventType type,
+           const CoglTraceSite *site,
+           int64_t timestamp,
+           int64_t value)
+{
+  int generation = g_atomic_int_get (&trace_generation);
+  CoglTraceEvent *event;
+
+  if (G_UNLIKELY (buffer->generation != generation))
+    {
+      buffer->generation = generation;
+      buffer->n_events = 0;
+    }
+
+  event = buffer->events + (buffer->n_events & (COGL_TRACE_BUFFER_SIZE - 1));
+  event->site = site;
+  event->timestamp = timestamp;
+  event->value = value;
+  event->type = type;
+
+  buffer->n_events++;
+}
+
+static CoglTraceBuffer *
+get_thread_buffer (void)
+{
+  if (G_UNLIKELY (thread_buffer == NULL))
+    thread_buffer = create_buffer (NULL);
+
+  return thread_buffer;
+}
+
+void
+_cogl_trace_begin (CoglTraceSite *site)
+{
+  add_event (get_thread_buffer (),
+             COGL_TRACE_EVENT_BEGIN,
+             site,
+             get_time (),
+             0);
+}
+
+void
+_cogl_trace_end (CoglTraceSite *site)
+{
+  add_event (get_thread_buffer (),
+             COGL_TRACE_EVENT_END,
+             site,
+             get_time (),
+             0);
+}
+
+void
+_cogl_trace_counter (CoglTraceSite *site,
+                     int delta)
+{
+  int value = g_atomic_int_add (&site->count, delta) + delta;
+
+  add_event (get_thread_buffer (),
+             COGL_TRACE_EVENT_COUNTER,
+             site,
+             get_time (),
+             value);
+}
+
+#ifdef GL_ARB_timer_query
+
+typedef struct
+{
+  const CoglTraceSite *site;
+  GLuint queries[2];
+} CoglTraceGpuSpan;
+
+static GLuint
+get_query (CoglContext *ctx)
+{
+  GArray *free_queries = ctx->trace_gpu.free_queries;
+  GLuint query;
+
+  if (free_queries && free_queries->len > 0)
+    {
+      query = g_array_index (free_queries, GLuint, free_queries->len - 1);
+      g_array_set_size (free_queries, free_queries->len - 1);
+    }
+  else
+    ctx->glGenQueries (1, &query);
+
+  return query;
+}
+
+static void
+free_span (CoglContext *ctx,
+           CoglTraceGpuSpan *span)
+{
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+  int i;
+
+  if (state->free_queries == NULL)
+    state->free_queries = g_array_new (FALSE, FALSE, sizeof (GLuint));
+
+  for (i = 0; i < G_N_ELEMENTS (span->queries); i++)
+    if (span->queries[i])
+      g_array_append_val (state->free_queries, span->queries[i]);
+
+  g_slice_free (CoglTraceGpuSpan, span);
+}
+
+static void
+free_open_spans (CoglContext *ctx)
+{
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+  GSList *l;
+
+  for (l = state->open_spans; l; l = l->next)
+    free_span (ctx, l->data);
+  g_slist_free (state->open_spans);
+  state->open_spans = NULL;
+}
+
+/* The end of a span that was open when tracing was stopped is never
+ * seen so any spans from a previous trace are dropped before
+ * starting or ending a span */
+static void
+check_open_spans_generation (CoglContext *ctx)
+{
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+  int generation = g_atomic_int_get (&trace_generation);
+
+  if (state->open_spans_generation != generation)
+    {
+      free_open_spans (ctx);
+      state->open_spans_generation = generation;
+    }
+}
+
+static void
+collect_gpu_spans (CoglContext *ctx,
+                   CoglBool wait)
+{
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+  CoglTraceGpuSpan *span;
+
+  while ((span = g_queue_peek_head (&state->pending_spans)))
+    {
+      GLuint64 start, end;
+
+      /* The queries complete in order so if the oldest span isn't
+       * finished then none of the others will be either */
+      if (!wait)
+        {
+          GLint available;
+
+          ctx->glGetQueryObjectiv (span->queries[1],
+                                   GL_QUERY_RESULT_AVAILABLE,
+                                   &available);
+          if (!available)
+            break;
+        }
+
+      ctx->glGetQueryObjectui64v (span->queries[0], GL_QUERY_RESULT, &start);
+      ctx->glGetQueryObjectui64v (span->queries[1], GL_QUERY_RESULT, &end);
+
+      if (gpu_buffer == NULL)
+        gpu_buffer = create_buffer ("GPU");
+
+      add_event (gpu_buffer,
+                 COGL_TRACE_EVENT_COMPLETE,
+                 span->site,
+                 (int64_t) start + state->clock_offset,
+                 end - start);
+
+      g_queue_pop_head (&state->pending_spans);
+      free_span (ctx, span);
+    }
+}
+
+#endif /* GL_ARB_timer_query */
+
+void
+_cogl_trace_gpu_begin (CoglContext *ctx,
+                       CoglTraceSite *site)
+{
+#ifdef GL_ARB_timer_query
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+  CoglTraceGpuSpan *span;
+
+  if (ctx->glQueryCounter == NULL)
+    return;
+
+  collect_gpu_spans (ctx, FALSE);
+  check_open_spans_generation (ctx);
+
+  /* The GL timestamps use an unspecified clock so an offset is
+   * measured once to line them up with the CPU events. This doesn't
+   * account for drift between the two clocks */
+  if (!state->clock_offset_valid)
+    {
+      GLint64 gpu_time;
+
+      ctx->glGetInteger64v (GL_TIMESTAMP, &gpu_time);
+      state->clock_offset = get_time () - gpu_time;
+      state->clock_offset_valid = TRUE;
+    }
+
+  span = g_slice_new (CoglTraceGpuSpan);
+  span->site = site;
+  span->queries[0] = get_query (ctx);
+  span->queries[1] = 0;
+  ctx->glQueryCounter (span->queries[0], GL_TIMESTAMP);
+
+  state->open_spans = g_slist_prepend (state->open_spans, span);
+#endif /* GL_ARB_timer_query */
+}
+
+void
+_cogl_trace_gpu_end (CoglContext *ctx,
+                     CoglTraceSite *site)
+{
+#ifdef GL_ARB_timer_query
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+  CoglTraceGpuSpan *span;
+
+  check_open_spans_generation (ctx);
+
+  /* This can happen if tracing was started in the middle of a span
+   * or if the driver doesn't support timestamp queries */
+  if (state->open_spans == NULL)
+    return;
+
+  span = state->open_spans->data;
+  state->open_spans = g_slist_delete_link (state->open_spans,
+                                           state->open_spans);
+
+  if (span->site != site)
+    {
+      g_warning ("GPU trace span \"%s\" was ended while \"%s\" "
+                 "was still open",
+                 site->name,
+                 span->site->name);
+      free_span (ctx, span);
+      return;
+    }
+
+  span->queries[1] = get_query (ctx);
+  ctx->glQueryCounter (span->queries[1], GL_TIMESTAMP);
+
+  g_queue_push_tail (&state->pending_spans, span);
+#endif /* GL_ARB_timer_query */
+}
+
+void
+_cogl_trace_gpu_destroy (CoglContext *ctx)
+{
+#ifdef GL_ARB_timer_query
+  CoglTraceGpuState *state = &ctx->trace_gpu;
+
+  if (ctx->glQueryCounter == NULL)
+    return;
+
+  /* Spans that are still pending can be read back while the context
+   * is still alive so they aren't lost from the trace */
+  collect_gpu_spans (ctx, TRUE);
+
+  free_open_spans (ctx);
+
+  if (state->free_queries)
+    {
+      ctx->glDeleteQueries (state->free_queries->len,
+                            (GLuint *) state->free_queries->data);
+      g_array_free (state->free_queries, TRUE);
+      state->free_queries = NULL;
+    }
+#endif /* GL_ARB_timer_query */
+}
+
+static void
+write_string (FILE *file,
+              const char *str)
+{
+  const char *p;
+
+  fputc ('"', file);
+
+  for (p = str; *p; p++)
+    {
+      /* The names are all static strings from the Cogl source so
+       * they don't need full escaping but this keeps the JSON valid
+       * if one ever contains a quote */
+      if (*p == '"' || *p == '\\')
+        fputc ('\\', file);
+      if ((unsigned char) *p >= ' ')
+        fputc (*p, file);
+    }
+
+  fputc ('"', file);
+}
+
+static void
+write_microseconds (FILE *file,
+                    int64_t nanoseconds)
+{
+  /* This is written by hand instead of using %f so that the decimal
+   * separator doesn't depend on the locale */
+  if (nanoseconds < 0)
+    {
+      fputc ('-', file);
+      nanoseconds = -nanoseconds;
+    }
+
+  fprintf (file, "%" G_GINT64_FORMAT ".%03d",
+           nanoseconds / 1000,
+           (int) (nanoseconds % 1000));
+}
+
+static void
+write_buffer (FILE *file,
+              CoglTraceBuffer *buffer,
+              CoglBool *first)
+{
+  unsigned int n_events = buffer->n_events;
+  unsigned int start = 0;
+  unsigned int depth = 0;
+  unsigned int i;
+
+  if (buffer->generation != g_atomic_int_get (&trace_generation) ||
+      n_events == 0)
+    return;
+
+  if (n_events > COGL_TRACE_BUFFER_SIZE)
+    start = n_events - COGL_TRACE_BUFFER_SIZE;
+
+  if (buffer->name)
+    {
+      fprintf (file,
+               "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+               "\"pid\":1,\"tid\":%i,\"args\":{\"name\":",
+               *first ? "" : ",",
+               buffer->tid);
+      write_string (file, buffer->name);
+      fputs ("}}", file);
+      *first = FALSE;
+    }
+
+  for (i = start; i < n_events; i++)
+    {
+      const CoglTraceEvent *event =
+        buffer->events + (i & (COGL_TRACE_BUFFER_SIZE - 1));
+      char phase;
+
+      switch (event->type)
+        {
+        case COGL_TRACE_EVENT_BEGIN:
+          phase = 'B';
+          depth++;
+          break;
+
+        case COGL_TRACE_EVENT_END:
+          /* Skip the ends of spans whose beginning has been
+           * overwritten in the ring */
+          if (depth == 0)
+            continue;
+          phase = 'E';
+          depth--;
+          break;
+
+        case COGL_TRACE_EVENT_COUNTER:
+          phase = 'C';
+          break;
+
+        case COGL_TRACE_EVENT_COMPLETE:
+          phase = 'X';
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+
+      fprintf (file, "%s\n{\"name\":", *first ? "" : ",");
+      write_string (file, event->site->name);
+      fprintf (file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%i,\"ts\":",
+               phase, buffer->tid);
+      write_microseconds (file, event->timestamp - trace_start_time);
+
+      if (event->type == COGL_TRACE_EVENT_COMPLETE)
+        {
+          fputs (",\"dur\":", file);
+          write_microseconds (file, event->value);
+        }
+      else if (event->type == COGL_TRACE_EVENT_COUNTER)
+        fprintf (file, ",\"args\":{\"value\":%" G_GINT64_FORMAT "}",
+                 event->value);
+
+      fputc ('}', file);
+      *first = FALSE;
+    }
+}
+
+static void
+write_exit_trace (void)
+{
+  CoglError *error = NULL;
+
+  if (!cogl_trace_write_json (trace_exit_filename, &error))
+    {
+      g_warning ("Failed to write the Cogl trace: %s", error->message);
+      cogl_error_free (error);
+    }
+}
+
+void
+_cogl_trace_init (void)
+{
+  const char *filename = g_getenv ("COGL_TRACE");
+
+  if (filename == NULL || *filename == '\0')
+    return;
+
+  trace_exit_filename = g_strdup (filename);
+  atexit (write_exit_trace);
+
+  cogl_trace_start ();
+}
+
+#endif /* COGL_ENABLE_TRACING */
+
+void
+cogl_trace_start (void)
+{
+#ifdef COGL_ENABLE_TRACING
+  trace_start_time = get_time ();
+  g_atomic_int_inc (&trace_generation);
+  _cogl_trace_enabled = TRUE;
+#endif
+}
+
+void
+cogl_trace_stop (void)
+{
+#ifdef COGL_ENABLE_TRACING
+  _cogl_trace_enabled = FALSE;
+#endif
+}
+
+CoglBool
+cogl_trace_write_json (const char *filename,
+                       CoglError **error)
+{
+#ifdef COGL_ENABLE_TRACING
+  CoglTraceBuffer *buffer;
+  CoglBool first = TRUE;
+  FILE *file;
+
+  file = fopen (filename, "w");
+  if (file == NULL)
+    {
+      _cogl_set_error (error,
+                       COGL_SYSTEM_ERROR,
+                       COGL_SYSTEM_ERROR_UNSUPPORTED,
+                       "Failed to open %s: %s",
+                       filename,
+                       g_strerror (errno));
+      return FALSE;
+    }
+
+  fputs ("{\"traceEvents\":[", file);
+
+  for (buffer = g_atomic_pointer_get (&trace_buffers);
+       buffer;
+       buffer = buffer->next)
+    write_buffer (file, buffer, &first);
+
+  fputs ("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+
+  if (fclose (file) != 0)
+    {
+      _cogl_set_error (error,
+                       COGL_SYSTEM_ERROR,
+                       COGL_SYSTEM_ERROR_UNSUPPORTED,
+                       "Failed to write %s: %s",
+                       filename,
+                       g_strerror (errno));
+      return FALSE;
+    }
+
+  return TRUE;
+#else
+  _cogl_set_error_literal (error,
+                           COGL_SYSTEM_ERROR,
+                           COGL_SYSTEM_ERROR_UNSUPPORTED,
+                           "Cogl was built without tracing support");
+  return FALSE;
+#endif
+}
+
+#ifdef COGL_ENABLE_TRACING
+
+static int
+count_matches (const char *haystack,
+               const char *needle)
+{
+  int count = 0;
+
+  while ((haystack = strstr (haystack, needle)))
+    {
+      count++;
+      haystack += strlen (needle);
+    }
+
+  return count;
+}
+
+static char *
+write_trace_to_string (void)
+{
+  char *filename = g_build_filename (g_get_tmp_dir (),
+                                     "cogl-unit-test-trace.json",
+                                     NULL);
+  CoglError *error = NULL;
+  char *contents;
+
+  if (!cogl_trace_write_json (filename, &error))
+    g_error ("Failed to write trace: %s", error->message);
+
+  g_assert (g_file_get_contents (filename, &contents, NULL, NULL));
+
+  remove (filename);
+  g_free (filename);
+
+  return contents;
+}
+
+UNIT_TEST (check_trace_events,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  static CoglTraceSite timer = COGL_TRACE_SITE_INIT ("Test \"timer\"");
+  static CoglTraceSite counter = COGL_TRACE_SITE_INIT ("Test counter");
+  char *json;
+  int i;
+
+  cogl_trace_start ();
+
+  _cogl_trace_counter (&counter, 1);
+  _cogl_trace_begin (&timer);
+  _cogl_trace_counter (&counter, 1);
+  _cogl_trace_end (&timer);
+
+  cogl_trace_stop ();
+
+  json = write_trace_to_string ();
+  g_assert (g_str_has_prefix (json, "{\"traceEvents\":["));
+  g_assert_cmpint (count_matches (json, "\"Test \\\"timer\\\"\""), ==, 2);
+  g_assert_cmpint (count_matches (json, "\"ph\":\"B\""), ==, 1);
+  g_assert_cmpint (count_matches (json, "\"ph\":\"E\""), ==, 1);
+  g_assert_cmpint (count_matches (json, "\"value\":1}"), ==, 1);
+  g_assert_cmpint (count_matches (json, "\"value\":2}"), ==, 1);
+  g_free (json);
+
+  /* Restarting discards the old events. Adding one event more than
+   * fits in the ring means that the first event in the output would
+   * be the end of a span whose beginning has been lost so it should
+   * be skipped */
+  cogl_trace_start ();
+
+  for (i = 0; i < COGL_TRACE_BUFFER_SIZE / 2; i++)
+    {
+      _cogl_trace_begin (&timer);
+      _cogl_trace_end (&timer);
+    }
+  _cogl_trace_begin (&timer);
+
+  cogl_trace_stop ();
+
+  json = write_trace_to_string ();
+  g_assert_cmpint (count_matches (json, "\"ph\":\"B\""),
+                   ==,
+                   COGL_TRACE_BUFFER_SIZE / 2);
+  g_assert_cmpint (count_matches (json, "\"ph\":\"E\""),
+                   ==,
+                   COGL_TRACE_BUFFER_SIZE / 2 - 1);
+  g_assert_cmpint (count_matches (json, "\"value\":"), ==, 0);
+  g_free (json);
+}
+
+#endif /* COGL_ENABLE_TRACING */
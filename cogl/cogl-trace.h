@@ -0,0 +1,110 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(COGL_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_TRACE_H__
+#define __COGL_TRACE_H__
+
+#include <cogl/cogl-types.h>
+#include <cogl/cogl-error.h>
+
+COGL_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-trace
+ * @short_description: Functions for recording a timeline of Cogl's
+ *   internal work
+ *
+ * If Cogl is configured with --enable-tracing then the timers and
+ * counters placed around its internal work, such as flushing the
+ * journal or flushing a pipeline, can record timestamped events. Each
+ * thread writes to its own fixed size ring buffer so only the most
+ * recent events are kept. Where the driver supports timestamp queries
+ * the time that the GPU spends executing each journal flush is
+ * recorded in a separate track.
+ *
+ * The events are written in the JSON trace event format which can be
+ * loaded into chrome://tracing or the Perfetto UI. Recording can be
+ * started at initialization time by setting the COGL_TRACE
+ * environment variable to the name of a file. In that case the trace
+ * is written to the file when the application exits.
+ */
+
+/**
+ * cogl_trace_start:
+ *
+ * Starts recording events. Any events that were already recorded are
+ * discarded. This does nothing if Cogl was built without tracing
+ * support.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_trace_start (void);
+
+/**
+ * cogl_trace_stop:
+ *
+ * Stops recording events. The events recorded so far are kept until
+ * the next call to cogl_trace_start() so they can still be written
+ * with cogl_trace_write_json().
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_trace_stop (void);
+
+/**
+ * cogl_trace_write_json:
+ * @filename: The name of the file to write
+ * @error: A #CoglError to return exceptional errors or %NULL
+ *
+ * Writes all of the events currently held in the trace buffers to
+ * @filename. Events from other threads that are recorded while the
+ * file is being written may be missing from the output so it is best
+ * to stop tracing first with cogl_trace_stop().
+ *
+ * Return value: %TRUE if the file was written or %FALSE otherwise.
+ *   If Cogl was built without tracing support this always fails with
+ *   %COGL_SYSTEM_ERROR_UNSUPPORTED.
+ * Since: 2.0
+ * Stability: unstable
+ */
+CoglBool
+cogl_trace_write_json (const char *filename,
+                       CoglError **error);
+
+COGL_END_DECLS
+
+#endif /* __COGL_TRACE_H__ */
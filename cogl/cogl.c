@@ -179,6 +179,9 @@ _cogl_init (void)
 
       _cogl_config_read ();
       _cogl_debug_check_environment ();
+#ifdef COGL_ENABLE_TRACING
+      _cogl_trace_init ();
+#endif
       initialized = TRUE;
     }
 }
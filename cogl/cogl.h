@@ -75,9 +75,11 @@
 #include <cogl/cogl-texture-3d.h>
 #include <cogl/cogl-texture-2d-sliced.h>
 #include <cogl/cogl-sub-texture.h>
+#include <cogl/cogl-texture-virtual.h>
 #include <cogl/cogl-atlas-texture.h>
 #include <cogl/cogl-meta-texture.h>
 #include <cogl/cogl-primitive-texture.h>
+#include <cogl/cogl-texture-upload-batch.h>
 #include <cogl/cogl-index-buffer.h>
 #include <cogl/cogl-attribute-buffer.h>
 #include <cogl/cogl-indices.h>
@@ -91,8 +93,15 @@
 #include <cogl/cogl-framebuffer.h>
 #include <cogl/cogl-onscreen.h>
 #include <cogl/cogl-frame-info.h>
+#include <cogl/cogl-damage-tracker.h>
 #include <cogl/cogl-poll.h>
 #include <cogl/cogl-fence.h>
+#include <cogl/cogl-read-pixels-async.h>
+#include <cogl/cogl-memory-stats.h>
+#include <cogl/cogl-trace.h>
+#include <cogl/cogl-frame-stats.h>
+#include <cogl/cogl-command-buffer.h>
+#include <cogl/cogl-static-batch.h>
 #if defined (COGL_HAS_EGL_PLATFORM_KMS_SUPPORT)
 #include <cogl/cogl-kms-renderer.h>
 #include <cogl/cogl-kms-display.h>
@@ -135,6 +135,15 @@ convert_bind_target_to_gl_target (CoglBufferBindTarget target)
     }
 }
 
+/* Whether data written to a buffer bound to target is counted in the
+ * vertex_bytes_uploaded frame stat */
+static CoglBool
+is_vertex_data_target (CoglBufferBindTarget target)
+{
+  return (target == COGL_BUFFER_BIND_TARGET_ATTRIBUTE_BUFFER ||
+          target == COGL_BUFFER_BIND_TARGET_INDEX_BUFFER);
+}
+
 static CoglBool
 recreate_store (CoglBuffer *buffer,
                 CoglError **error)
@@ -332,7 +341,15 @@ _cogl_buffer_gl_map_range (CoglBuffer *buffer,
     }
 
   if (data)
-    buffer->flags |= COGL_BUFFER_FLAG_MAPPED;
+    {
+      buffer->flags |= COGL_BUFFER_FLAG_MAPPED;
+
+      /* We can't tell how much of the range will actually be written
+       * so the whole range is counted */
+      if ((access & COGL_BUFFER_ACCESS_WRITE) &&
+          is_vertex_data_target (target))
+        ctx->vertex_bytes_uploaded += size;
+    }
 
   _cogl_buffer_gl_unbind (buffer);
 
@@ -391,6 +408,8 @@ _cogl_buffer_gl_set_data (CoglBuffer *buffer,
 
   if (_cogl_gl_util_catch_out_of_memory (ctx, error))
     status = FALSE;
+  else if (is_vertex_data_target (target))
+    ctx->vertex_bytes_uploaded += size;
 
   _cogl_buffer_gl_unbind (buffer);
 
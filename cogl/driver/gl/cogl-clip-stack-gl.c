@@ -43,6 +43,8 @@
 #include "cogl-clip-stack-gl-private.h"
 #include "cogl-primitive-private.h"
 
+#include <string.h>
+
 #ifndef GL_CLIP_PLANE0
 #define GL_CLIP_PLANE0 0x3000
 #define GL_CLIP_PLANE1 0x3001
@@ -201,6 +203,61 @@ set_clip_planes (CoglFramebuffer *framebuffer,
     }
 }
 
+/* The stencil buffer is used as a cache of clip silhouettes. Bit 0 is
+ * used as scratch space while intersecting the entries of a clip
+ * stack and each of the remaining bits holds the final silhouette of
+ * one clip stack. That way switching back to a clip stack that was
+ * recently flushed only needs a change to the stencil function. */
+#define STENCIL_SCRATCH_BIT 0x1
+
+static void
+set_stencil_clip_func (CoglContext *ctx,
+                       GLuint slot_bit)
+{
+  GE( ctx, glStencilMask (~(GLuint) 0) );
+  GE( ctx, glStencilFunc (GL_EQUAL, slot_bit, slot_bit) );
+  GE( ctx, glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP) );
+}
+
+static void
+clear_stencil_bits (CoglContext *ctx,
+                    GLuint bits)
+{
+  /* This will be clipped to the scissor which is the bounding box of
+     all of the clip entries so there's no need to clear the whole
+     buffer */
+  GE( ctx, glStencilMask (bits) );
+  GE( ctx, glClearStencil (0) );
+  GE( ctx, glClear (GL_STENCIL_BUFFER_BIT) );
+}
+
+/* Removes the slot bit from every pixel that doesn't have the scratch
+   bit set so that the slot holds the intersection of the two */
+static void
+intersect_stencil_scratch (CoglFramebuffer *framebuffer,
+                           GLuint slot_bit)
+{
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  CoglColorMask old_color_mask = ctx->current_gl_color_mask;
+  CoglBool old_depth_mask = ctx->depth_writing_enabled_cache;
+
+  _cogl_gl_state_set_color_mask (ctx, COGL_COLOR_MASK_NONE);
+  _cogl_gl_state_set_depth_mask (ctx, FALSE);
+
+  GE( ctx, glStencilMask (slot_bit) );
+  GE( ctx, glStencilFunc (GL_EQUAL, 0, STENCIL_SCRATCH_BIT) );
+  GE( ctx, glStencilOp (GL_KEEP, GL_ZERO, GL_ZERO) );
+
+  _cogl_context_set_current_projection_entry (ctx, &ctx->identity_entry);
+  _cogl_context_set_current_modelview_entry (ctx, &ctx->identity_entry);
+
+  _cogl_rectangle_immediate (framebuffer, ctx->stencil_pipeline,
+                             -1.0, -1.0, 1.0, 1.0);
+
+  _cogl_gl_state_set_depth_mask (ctx, old_depth_mask);
+  _cogl_gl_state_set_color_mask (ctx, old_color_mask);
+}
+
 static void
 add_stencil_clip_rectangle (CoglFramebuffer *framebuffer,
                             CoglMatrixEntry *modelview_entry,
@@ -208,11 +265,13 @@ add_stencil_clip_rectangle (CoglFramebuffer *framebuffer,
                             float y_1,
                             float x_2,
                             float y_2,
+                            GLuint slot_bit,
                             CoglBool first)
 {
   CoglMatrixStack *projection_stack =
     _cogl_framebuffer_get_projection_stack (framebuffer);
   CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  GLuint target_bit = first ? slot_bit : STENCIL_SCRATCH_BIT;
 
   /* NB: This can be called while flushing the journal so we need
    * to be very conservative with what state we change.
@@ -222,48 +281,24 @@ add_stencil_clip_rectangle (CoglFramebuffer *framebuffer,
                                               projection_stack->last_entry);
   _cogl_context_set_current_modelview_entry (ctx, modelview_entry);
 
-  if (first)
-    {
-      GE( ctx, glEnable (GL_STENCIL_TEST) );
+  GE( ctx, glEnable (GL_STENCIL_TEST) );
 
-      /* Initially disallow everything */
-      GE( ctx, glClearStencil (0) );
-      GE( ctx, glClear (GL_STENCIL_BUFFER_BIT) );
+  /* Initially disallow everything */
+  clear_stencil_bits (ctx, target_bit);
 
-      /* Punch out a hole to allow the rectangle */
-      GE( ctx, glStencilFunc (GL_NEVER, 0x1, 0x1) );
-      GE( ctx, glStencilOp (GL_REPLACE, GL_REPLACE, GL_REPLACE) );
+  /* Punch out a hole to allow the rectangle */
+  GE( ctx, glStencilFunc (GL_NEVER, target_bit, target_bit) );
+  GE( ctx, glStencilOp (GL_REPLACE, GL_REPLACE, GL_REPLACE) );
 
-      _cogl_rectangle_immediate (framebuffer,
-                                 ctx->stencil_pipeline,
-                                 x_1, y_1, x_2, y_2);
-    }
-  else
-    {
-      /* Add one to every pixel of the stencil buffer in the
-	 rectangle */
-      GE( ctx, glStencilFunc (GL_NEVER, 0x1, 0x3) );
-      GE( ctx, glStencilOp (GL_INCR, GL_INCR, GL_INCR) );
-      _cogl_rectangle_immediate (framebuffer,
-                                 ctx->stencil_pipeline,
-                                 x_1, y_1, x_2, y_2);
-
-      /* Subtract one from all pixels in the stencil buffer so that
-	 only pixels where both the original stencil buffer and the
-	 rectangle are set will be valid */
-      GE( ctx, glStencilOp (GL_DECR, GL_DECR, GL_DECR) );
-
-      _cogl_context_set_current_projection_entry (ctx, &ctx->identity_entry);
-      _cogl_context_set_current_modelview_entry (ctx, &ctx->identity_entry);
-
-      _cogl_rectangle_immediate (framebuffer,
-                                 ctx->stencil_pipeline,
-                                 -1.0, -1.0, 1.0, 1.0);
-    }
+  _cogl_rectangle_immediate (framebuffer,
+                             ctx->stencil_pipeline,
+                             x_1, y_1, x_2, y_2);
+
+  if (!first)
+    intersect_stencil_scratch (framebuffer, slot_bit);
 
   /* Restore the stencil mode */
-  GE( ctx, glStencilFunc (GL_EQUAL, 0x1, 0x1) );
-  GE( ctx, glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP) );
+  set_stencil_clip_func (ctx, slot_bit);
 }
 
 typedef void (*SilhouettePaintCallback) (CoglFramebuffer *framebuffer,
@@ -274,17 +309,16 @@ static void
 add_stencil_clip_silhouette (CoglFramebuffer *framebuffer,
                              SilhouettePaintCallback silhouette_callback,
                              CoglMatrixEntry *modelview_entry,
-                             float bounds_x1,
-                             float bounds_y1,
-                             float bounds_x2,
-                             float bounds_y2,
+                             GLuint slot_bit,
                              CoglBool merge,
-                             CoglBool need_clear,
                              void *user_data)
 {
   CoglMatrixStack *projection_stack =
     _cogl_framebuffer_get_projection_stack (framebuffer);
   CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  GLuint target_bit = merge ? STENCIL_SCRATCH_BIT : slot_bit;
+  CoglColorMask old_color_mask;
+  CoglBool old_depth_mask;
 
   /* NB: This can be called while flushing the journal so we need
    * to be very conservative with what state we change.
@@ -299,72 +333,28 @@ add_stencil_clip_silhouette (CoglFramebuffer *framebuffer,
 
   GE( ctx, glEnable (GL_STENCIL_TEST) );
 
-  GE( ctx, glColorMask (FALSE, FALSE, FALSE, FALSE) );
-  GE( ctx, glDepthMask (FALSE) );
+  old_color_mask = ctx->current_gl_color_mask;
+  old_depth_mask = ctx->depth_writing_enabled_cache;
+  _cogl_gl_state_set_color_mask (ctx, COGL_COLOR_MASK_NONE);
+  _cogl_gl_state_set_depth_mask (ctx, FALSE);
 
-  if (merge)
-    {
-      GE (ctx, glStencilMask (2));
-      GE (ctx, glStencilFunc (GL_LEQUAL, 0x2, 0x6));
-    }
-  else
-    {
-      /* If we're not using the stencil buffer for clipping then we
-         don't need to clear the whole stencil buffer, just the area
-         that will be drawn */
-      if (need_clear)
-        /* If this is being called from the clip stack code then it
-           will have set up a scissor for the minimum bounding box of
-           all of the clips. That box will likely mean that this
-           _cogl_clear won't need to clear the entire
-           buffer. _cogl_framebuffer_clear_without_flush4f is used instead
-           of cogl_clear because it won't try to flush the journal */
-        _cogl_framebuffer_clear_without_flush4f (framebuffer,
-                                                 COGL_BUFFER_BIT_STENCIL,
-                                                 0, 0, 0, 0);
-      else
-        {
-          /* Just clear the bounding box */
-          GE( ctx, glStencilMask (~(GLuint) 0) );
-          GE( ctx, glStencilOp (GL_ZERO, GL_ZERO, GL_ZERO) );
-          _cogl_rectangle_immediate (framebuffer,
-                                     ctx->stencil_pipeline,
-                                     bounds_x1, bounds_y1,
-                                     bounds_x2, bounds_y2);
-        }
-      GE (ctx, glStencilMask (1));
-      GE (ctx, glStencilFunc (GL_LEQUAL, 0x1, 0x3));
-    }
+  clear_stencil_bits (ctx, target_bit);
 
-  GE (ctx, glStencilOp (GL_INVERT, GL_INVERT, GL_INVERT));
+  /* Every time a pixel is covered by the silhouette its bit gets
+     inverted so that the pixels covered an odd number of times will
+     end up set */
+  GE( ctx, glStencilFunc (GL_NEVER, 0, 0) );
+  GE( ctx, glStencilOp (GL_INVERT, GL_INVERT, GL_INVERT) );
 
   silhouette_callback (framebuffer, ctx->stencil_pipeline, user_data);
 
-  if (merge)
-    {
-      /* Now we have the new stencil buffer in bit 1 and the old
-         stencil buffer in bit 0 so we need to intersect them */
-      GE (ctx, glStencilMask (3));
-      GE (ctx, glStencilFunc (GL_NEVER, 0x2, 0x3));
-      GE (ctx, glStencilOp (GL_DECR, GL_DECR, GL_DECR));
-      /* Decrement all of the bits twice so that only pixels where the
-         value is 3 will remain */
-
-      _cogl_context_set_current_projection_entry (ctx, &ctx->identity_entry);
-      _cogl_context_set_current_modelview_entry (ctx, &ctx->identity_entry);
-
-      _cogl_rectangle_immediate (framebuffer, ctx->stencil_pipeline,
-                                 -1.0, -1.0, 1.0, 1.0);
-      _cogl_rectangle_immediate (framebuffer, ctx->stencil_pipeline,
-                                 -1.0, -1.0, 1.0, 1.0);
-    }
+  _cogl_gl_state_set_depth_mask (ctx, old_depth_mask);
+  _cogl_gl_state_set_color_mask (ctx, old_color_mask);
 
-  GE (ctx, glStencilMask (~(GLuint) 0));
-  GE (ctx, glDepthMask (TRUE));
-  GE (ctx, glColorMask (TRUE, TRUE, TRUE, TRUE));
+  if (merge)
+    intersect_stencil_scratch (framebuffer, slot_bit);
 
-  GE (ctx, glStencilFunc (GL_EQUAL, 0x1, 0x1));
-  GE (ctx, glStencilOp (GL_KEEP, GL_KEEP, GL_KEEP));
+  set_stencil_clip_func (ctx, slot_bit);
 }
 
 static void
@@ -384,25 +374,237 @@ static void
 add_stencil_clip_primitive (CoglFramebuffer *framebuffer,
                             CoglMatrixEntry *modelview_entry,
                             CoglPrimitive *primitive,
-                            float bounds_x1,
-                            float bounds_y1,
-                            float bounds_x2,
-                            float bounds_y2,
-                            CoglBool merge,
-                            CoglBool need_clear)
+                            GLuint slot_bit,
+                            CoglBool merge)
 {
   add_stencil_clip_silhouette (framebuffer,
                                paint_primitive_silhouette,
                                modelview_entry,
-                               bounds_x1,
-                               bounds_y1,
-                               bounds_x2,
-                               bounds_y2,
+                               slot_bit,
                                merge,
-                               need_clear,
                                primitive);
 }
 
+static int
+get_n_stencil_clip_slots (CoglFramebuffer *framebuffer)
+{
+  int stencil_bits = _cogl_framebuffer_get_stencil_bits (framebuffer);
+
+  /* The cache needs the scratch bit plus at least one slot. Without
+     that the silhouette is drawn into the scratch bit and not cached */
+  if (stencil_bits < 2)
+    return 0;
+
+  return MIN (stencil_bits - 1, COGL_STENCIL_CLIP_CACHE_SIZE);
+}
+
+/* Returns whether another entry can be intersected with the
+   silhouette that is being drawn into the given bit */
+static CoglBool
+can_merge_stencil_clip (GLuint stencil_slot_bit)
+{
+  static CoglBool warning_seen = FALSE;
+
+  if (stencil_slot_bit != STENCIL_SCRATCH_BIT)
+    return TRUE;
+
+  if (!warning_seen)
+    g_warning ("Only one clip entry can use the stencil buffer because "
+               "the framebuffer has fewer than 2 stencil bits. The "
+               "remaining entries will be ignored");
+  warning_seen = TRUE;
+
+  return FALSE;
+}
+
+/* Looks for a slot in the stencil buffer that already contains the
+   silhouette for the given stack. Returns -1 if there isn't one */
+static int
+find_stencil_clip_slot (CoglFramebuffer *framebuffer,
+                        CoglClipStack *stack)
+{
+  CoglMatrixStack *projection_stack =
+    _cogl_framebuffer_get_projection_stack (framebuffer);
+  int i;
+
+  if (stack == NULL)
+    return -1;
+
+  for (i = 0; i < COGL_STENCIL_CLIP_CACHE_SIZE; i++)
+    {
+      CoglStencilClipCacheEntry *entry = framebuffer->stencil_clip_cache + i;
+
+      if (entry->stack == stack &&
+          entry->projection_entry == projection_stack->last_entry &&
+          entry->viewport_age == framebuffer->viewport_age)
+        {
+          entry->last_used = ++framebuffer->stencil_clip_cache_age;
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+/* Picks the least recently used slot and records that it will now
+   contain the silhouette for the given stack */
+static int
+replace_stencil_clip_slot (CoglFramebuffer *framebuffer,
+                           CoglClipStack *stack)
+{
+  CoglMatrixStack *projection_stack =
+    _cogl_framebuffer_get_projection_stack (framebuffer);
+  int n_slots = get_n_stencil_clip_slots (framebuffer);
+  CoglStencilClipCacheEntry *entry;
+  int best_slot = 0;
+  int i;
+
+  for (i = 0; i < n_slots; i++)
+    {
+      entry = framebuffer->stencil_clip_cache + i;
+
+      if (entry->stack == NULL)
+        {
+          best_slot = i;
+          break;
+        }
+
+      if (entry->last_used <
+          framebuffer->stencil_clip_cache[best_slot].last_used)
+        best_slot = i;
+    }
+
+  entry = framebuffer->stencil_clip_cache + best_slot;
+
+  if (entry->stack)
+    {
+      _cogl_clip_stack_unref (entry->stack);
+      cogl_matrix_entry_unref (entry->projection_entry);
+    }
+
+  entry->stack = _cogl_clip_stack_ref (stack);
+  entry->projection_entry =
+    cogl_matrix_entry_ref (projection_stack->last_entry);
+  entry->viewport_age = framebuffer->viewport_age;
+  entry->last_used = ++framebuffer->stencil_clip_cache_age;
+
+  return best_slot;
+}
+
+static CoglBool
+can_use_shader_clip (CoglContext *ctx)
+{
+  /* The clip test is generated by the GLSL fragend so we can only use
+     it if there is no fixed function or ARBfp backend that a pipeline
+     could end up using instead */
+  return (cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL) &&
+          !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_GL_FIXED) &&
+          !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_ARBFP) &&
+          !COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SHADER_CLIP));
+}
+
+/* Calculates a matrix that will map a GL window position (ie,
+ * gl_FragCoord) to a homogeneous position where the x and y
+ * components lie between 0 and the w component when the position is
+ * inside the given rectangle. The matrix is written as a column-major
+ * 3x3 matrix suitable for glUniformMatrix3fv */
+static void
+get_shader_clip_matrix (CoglFramebuffer *framebuffer,
+                        CoglMatrixEntry *modelview_entry,
+                        float x_1,
+                        float y_1,
+                        float x_2,
+                        float y_2,
+                        float *clip_matrix)
+{
+  CoglMatrixStack *projection_stack =
+    _cogl_framebuffer_get_projection_stack (framebuffer);
+  CoglMatrix projection_matrix;
+  CoglMatrix modelview_matrix;
+  CoglMatrix mvp;
+  float half_width = framebuffer->viewport_width / 2.0f;
+  float half_height = framebuffer->viewport_height / 2.0f;
+  float width = x_2 - x_1;
+  float height = y_2 - y_1;
+  /* Rows are the x, y and w components. Columns are the coefficients
+     of the position within the unit square of the rectangle */
+  float clip[3][3];
+  float window[3][3];
+  float det;
+  int i;
+
+  cogl_matrix_stack_get (projection_stack, &projection_matrix);
+  cogl_matrix_entry_get (modelview_entry, &modelview_matrix);
+  cogl_matrix_multiply (&mvp, &projection_matrix, &modelview_matrix);
+
+  /* Clip space position of (x_1 + u * width, y_1 + v * height, 0, 1) */
+  clip[0][0] = mvp.xx * width;
+  clip[0][1] = mvp.xy * height;
+  clip[0][2] = mvp.xx * x_1 + mvp.xy * y_1 + mvp.xw;
+  clip[1][0] = mvp.yx * width;
+  clip[1][1] = mvp.yy * height;
+  clip[1][2] = mvp.yx * x_1 + mvp.yy * y_1 + mvp.yw;
+  clip[2][0] = mvp.wx * width;
+  clip[2][1] = mvp.wy * height;
+  clip[2][2] = mvp.wx * x_1 + mvp.wy * y_1 + mvp.ww;
+
+  /* Apply the viewport transform without the perspective divide */
+  for (i = 0; i < 3; i++)
+    {
+      window[0][i] = (half_width * clip[0][i] +
+                      (framebuffer->viewport_x + half_width) * clip[2][i]);
+      window[1][i] = (-half_height * clip[1][i] +
+                      (framebuffer->viewport_y + half_height) * clip[2][i]);
+      window[2][i] = clip[2][i];
+
+      /* Cogl forces offscreen rendering to be upside down so only
+         onscreen framebuffers need converting to the bottom-left
+         origin of gl_FragCoord */
+      if (!cogl_is_offscreen (framebuffer))
+        window[1][i] = (cogl_framebuffer_get_height (framebuffer) *
+                        window[2][i] - window[1][i]);
+    }
+
+  det = (window[0][0] * (window[1][1] * window[2][2] -
+                         window[1][2] * window[2][1]) -
+         window[0][1] * (window[1][0] * window[2][2] -
+                         window[1][2] * window[2][0]) +
+         window[0][2] * (window[1][0] * window[2][1] -
+                         window[1][1] * window[2][0]));
+
+  if (det == 0.0f)
+    {
+      /* The rectangle is seen edge-on so nothing can pass. Map
+         everything to (-1, -1, 1) which is always outside */
+      memset (clip_matrix, 0, sizeof (float) * 9);
+      clip_matrix[6] = -1.0f;
+      clip_matrix[7] = -1.0f;
+      clip_matrix[8] = 1.0f;
+      return;
+    }
+
+  /* Invert using the adjugate. The matrix is stored column-major so
+     element (row, col) of the inverse goes at [col * 3 + row] */
+  clip_matrix[0] = (window[1][1] * window[2][2] -
+                    window[1][2] * window[2][1]) / det;
+  clip_matrix[3] = (window[0][2] * window[2][1] -
+                    window[0][1] * window[2][2]) / det;
+  clip_matrix[6] = (window[0][1] * window[1][2] -
+                    window[0][2] * window[1][1]) / det;
+  clip_matrix[1] = (window[1][2] * window[2][0] -
+                    window[1][0] * window[2][2]) / det;
+  clip_matrix[4] = (window[0][0] * window[2][2] -
+                    window[0][2] * window[2][0]) / det;
+  clip_matrix[7] = (window[0][2] * window[1][0] -
+                    window[0][0] * window[1][2]) / det;
+  clip_matrix[2] = (window[1][0] * window[2][1] -
+                    window[1][1] * window[2][0]) / det;
+  clip_matrix[5] = (window[0][1] * window[2][0] -
+                    window[0][0] * window[2][1]) / det;
+  clip_matrix[8] = (window[0][0] * window[1][1] -
+                    window[0][1] * window[1][0]) / det;
+}
+
 static void
 enable_clip_planes (CoglContext *ctx)
 {
@@ -421,19 +623,65 @@ disable_clip_planes (CoglContext *ctx)
   GE( ctx, glDisable (GL_CLIP_PLANE0) );
 }
 
+/* Called for the first clip entry that needs the stencil buffer.
+   Returns the stencil bit that will contain the silhouette */
+static GLuint
+begin_stencil_clip (CoglFramebuffer *framebuffer,
+                    CoglClipStack *stack,
+                    int *stencil_slot)
+{
+  CoglContext *ctx = framebuffer->context;
+
+  if (get_n_stencil_clip_slots (framebuffer) == 0)
+    {
+      COGL_NOTE (CLIPPING, "Not enough stencil bits to cache the clip");
+
+      /* find_stencil_clip_slot can't have found anything because no
+         slots are ever filled */
+      return STENCIL_SCRATCH_BIT;
+    }
+
+  if (*stencil_slot != -1)
+    {
+      COGL_NOTE (CLIPPING, "Reusing stencil clip from slot %i",
+                 *stencil_slot);
+      framebuffer->frame_stats.n_stencil_clip_cache_hits++;
+
+      GE( ctx, glEnable (GL_STENCIL_TEST) );
+      set_stencil_clip_func (ctx, 2 << *stencil_slot);
+    }
+  else
+    {
+      framebuffer->frame_stats.n_stencil_clip_cache_misses++;
+
+      *stencil_slot = replace_stencil_clip_slot (framebuffer, stack);
+    }
+
+  /* Bit 0 is the scratch bit so the slots start from bit 1 */
+  return 2 << *stencil_slot;
+}
+
 void
 _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                            CoglFramebuffer *framebuffer)
 {
   CoglContext *ctx = framebuffer->context;
   int has_clip_planes;
+  CoglBool has_shader_clip;
   CoglBool using_clip_planes = FALSE;
   CoglBool using_stencil_buffer = FALSE;
+  float shader_clip_matrices[COGL_MAX_SHADER_CLIP_RECTS * 9];
+  int n_shader_clip_rects = 0;
+  int stencil_slot;
+  CoglBool stencil_cached;
+  GLuint stencil_slot_bit = 0;
   int scissor_x0;
   int scissor_y0;
   int scissor_x1;
   int scissor_y1;
   CoglClipStack *entry;
+  CoglClipStack *cached_stack;
+  CoglClipStackPrimitive *transient_entry = NULL;
   int scissor_y_start;
 
   /* If we have already flushed this state then we don't need to do
@@ -451,6 +699,8 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
       _cogl_clip_stack_unref (ctx->current_clip_stack);
     }
 
+  framebuffer->frame_stats.n_clip_flushes++;
+
   ctx->current_clip_stack_valid = TRUE;
   ctx->current_clip_stack = _cogl_clip_stack_ref (stack);
 
@@ -461,6 +711,11 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
     disable_clip_planes (ctx);
   GE( ctx, glDisable (GL_STENCIL_TEST) );
 
+  /* Any shader clip rectangles are only set once the stencil buffer
+     has been set up so that they won't affect drawing the stencil */
+  ctx->n_shader_clip_rects = 0;
+  has_shader_clip = can_use_shader_clip (ctx);
+
   /* If the stack is empty then there's nothing else to do
    *
    * See comment below about ctx->needs_viewport_scissor_workaround
@@ -539,11 +794,32 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                       scissor_x1 - scissor_x0,
                       scissor_y1 - scissor_y0));
 
+  /* A transient entry is popped again after a single draw so its
+     silhouette would never be reused. Caching it would only evict the
+     silhouettes of longer lived stacks so instead the rest of the
+     stack is flushed as normal and the transient entry is added
+     afterwards using the scratch bit */
+  cached_stack = stack;
+  if (stack &&
+      stack->type == COGL_CLIP_STACK_PRIMITIVE &&
+      ((CoglClipStackPrimitive *) stack)->transient &&
+      get_n_stencil_clip_slots (framebuffer) > 0)
+    {
+      transient_entry = (CoglClipStackPrimitive *) stack;
+      cached_stack = stack->parent;
+    }
+
+  /* If the silhouette for this stack is still in the stencil buffer
+     from a previous flush then we don't need to draw any of the
+     stencil entries again */
+  stencil_slot = find_stencil_clip_slot (framebuffer, cached_stack);
+  stencil_cached = stencil_slot != -1;
+
   /* Add all of the entries. This will end up adding them in the
      reverse order that they were specified but as all of the clips
      are intersecting it should work out the same regardless of the
      order */
-  for (entry = stack; entry; entry = entry->parent)
+  for (entry = cached_stack; entry; entry = entry->parent)
     {
       switch (entry->type)
         {
@@ -552,17 +828,23 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
               CoglClipStackPrimitive *primitive_entry =
                 (CoglClipStackPrimitive *) entry;
 
-              COGL_NOTE (CLIPPING, "Adding stencil clip for primitive");
+              if (!using_stencil_buffer)
+                stencil_slot_bit = begin_stencil_clip (framebuffer,
+                                                       cached_stack,
+                                                       &stencil_slot);
 
-              add_stencil_clip_primitive (framebuffer,
-                                          primitive_entry->matrix_entry,
-                                          primitive_entry->primitive,
-                                          primitive_entry->bounds_x1,
-                                          primitive_entry->bounds_y1,
-                                          primitive_entry->bounds_x2,
-                                          primitive_entry->bounds_y2,
-                                          using_stencil_buffer,
-                                          TRUE);
+              if (!stencil_cached &&
+                  (!using_stencil_buffer ||
+                   can_merge_stencil_clip (stencil_slot_bit)))
+                {
+                  COGL_NOTE (CLIPPING, "Adding stencil clip for primitive");
+
+                  add_stencil_clip_primitive (framebuffer,
+                                              primitive_entry->matrix_entry,
+                                              primitive_entry->primitive,
+                                              stencil_slot_bit,
+                                              using_stencil_buffer);
+                }
 
               using_stencil_buffer = TRUE;
               break;
@@ -592,17 +874,45 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                       /* We can't use clip planes a second time */
                       has_clip_planes = FALSE;
                     }
+                  else if (has_shader_clip &&
+                           n_shader_clip_rects < COGL_MAX_SHADER_CLIP_RECTS)
+                    {
+                      COGL_NOTE (CLIPPING,
+                                 "Adding shader clip for rectangle");
+
+                      get_shader_clip_matrix (framebuffer,
+                                              rect->matrix_entry,
+                                              rect->x0,
+                                              rect->y0,
+                                              rect->x1,
+                                              rect->y1,
+                                              shader_clip_matrices +
+                                              n_shader_clip_rects * 9);
+                      n_shader_clip_rects++;
+                    }
                   else
                     {
-                      COGL_NOTE (CLIPPING, "Adding stencil clip for rectangle");
-
-                      add_stencil_clip_rectangle (framebuffer,
-                                                  rect->matrix_entry,
-                                                  rect->x0,
-                                                  rect->y0,
-                                                  rect->x1,
-                                                  rect->y1,
-                                                  !using_stencil_buffer);
+                      if (!using_stencil_buffer)
+                        stencil_slot_bit =
+                          begin_stencil_clip (framebuffer, cached_stack,
+                                              &stencil_slot);
+
+                      if (!stencil_cached &&
+                          (!using_stencil_buffer ||
+                           can_merge_stencil_clip (stencil_slot_bit)))
+                        {
+                          COGL_NOTE (CLIPPING,
+                                     "Adding stencil clip for rectangle");
+
+                          add_stencil_clip_rectangle (framebuffer,
+                                                      rect->matrix_entry,
+                                                      rect->x0,
+                                                      rect->y0,
+                                                      rect->x1,
+                                                      rect->y1,
+                                                      stencil_slot_bit,
+                                                      !using_stencil_buffer);
+                        }
                       using_stencil_buffer = TRUE;
                     }
                 }
@@ -616,8 +926,34 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
         }
     }
 
+  if (transient_entry)
+    {
+      COGL_NOTE (CLIPPING, "Adding transient stencil clip for primitive");
+
+      add_stencil_clip_primitive (framebuffer,
+                                  transient_entry->matrix_entry,
+                                  transient_entry->primitive,
+                                  STENCIL_SCRATCH_BIT,
+                                  FALSE);
+
+      /* Only pixels inside both the transient silhouette and the
+         silhouette of the rest of the stack (if any) can pass */
+      set_stencil_clip_func (ctx, STENCIL_SCRATCH_BIT | stencil_slot_bit);
+    }
+
   /* Enabling clip planes is delayed to now so that they won't affect
      setting up the stencil buffer */
   if (using_clip_planes)
     enable_clip_planes (ctx);
+
+  /* The shader clip rectangles will be picked up by the GLSL progend
+     when the next pipeline is flushed */
+  if (n_shader_clip_rects > 0)
+    {
+      memcpy (ctx->shader_clip_matrices,
+              shader_clip_matrices,
+              sizeof (float) * 9 * n_shader_clip_rects);
+      ctx->n_shader_clip_rects = n_shader_clip_rects;
+      ctx->shader_clip_age++;
+    }
 }
@@ -37,6 +37,7 @@
 #include "cogl-framebuffer-private.h"
 #include "cogl-framebuffer-gl-private.h"
 #include "cogl-buffer-gl-private.h"
+#include "cogl-pipeline-opengl-private.h"
 #include "cogl-error-private.h"
 #include "cogl-texture-gl-private.h"
 #include "cogl-texture-private.h"
@@ -517,10 +518,14 @@ try_creating_renderbuffers (CoglContext *ctx,
                             int width,
                             int height,
                             CoglOffscreenAllocateFlags flags,
-                            int n_samples)
+                            int n_samples,
+                            size_t *size_out)
 {
   GList *renderbuffers = NULL;
   GLuint gl_depth_stencil_handle;
+  size_t pixel_size = (size_t) width * height * MAX (n_samples, 1);
+
+  *size_out = 0;
 
   if (flags & COGL_OFFSCREEN_ALLOCATE_FLAG_DEPTH_STENCIL)
     {
@@ -581,6 +586,7 @@ try_creating_renderbuffers (CoglContext *ctx,
       renderbuffers =
         g_list_prepend (renderbuffers,
                         GUINT_TO_POINTER (gl_depth_stencil_handle));
+      *size_out += pixel_size * 4;
     }
 
   if (flags & COGL_OFFSCREEN_ALLOCATE_FLAG_DEPTH)
@@ -605,6 +611,7 @@ try_creating_renderbuffers (CoglContext *ctx,
                                           GL_RENDERBUFFER, gl_depth_handle));
       renderbuffers =
         g_list_prepend (renderbuffers, GUINT_TO_POINTER (gl_depth_handle));
+      *size_out += pixel_size * 2;
     }
 
   if (flags & COGL_OFFSCREEN_ALLOCATE_FLAG_STENCIL)
@@ -627,6 +634,7 @@ try_creating_renderbuffers (CoglContext *ctx,
                                           GL_RENDERBUFFER, gl_stencil_handle));
       renderbuffers =
         g_list_prepend (renderbuffers, GUINT_TO_POINTER (gl_stencil_handle));
+      *size_out += pixel_size;
     }
 
   return renderbuffers;
@@ -732,7 +740,8 @@ try_creating_fbo (CoglContext *ctx,
                                     texture_level_width,
                                     texture_level_height,
                                     flags,
-                                    n_samples);
+                                    n_samples,
+                                    &gl_framebuffer->renderbuffers_size);
     }
 
   /* Make sure it's complete */
@@ -744,6 +753,7 @@ try_creating_fbo (CoglContext *ctx,
 
       delete_renderbuffers (ctx, gl_framebuffer->renderbuffers);
       gl_framebuffer->renderbuffers = NULL;
+      gl_framebuffer->renderbuffers_size = 0;
 
       return FALSE;
     }
@@ -824,6 +834,8 @@ _cogl_offscreen_gl_allocate (CoglOffscreen *offscreen,
           return FALSE;
         }
 
+      _cogl_texture_set_memory_type (offscreen->depth_texture,
+                                     COGL_MEMORY_TYPE_FRAMEBUFFER);
       _cogl_texture_associate_framebuffer (offscreen->depth_texture, fb);
     }
 
@@ -937,6 +949,10 @@ _cogl_offscreen_gl_allocate (CoglOffscreen *offscreen,
        * GLES2 context later */
       offscreen->allocation_flags = flags;
 
+      _cogl_memory_add (ctx,
+                        COGL_MEMORY_TYPE_FRAMEBUFFER,
+                        gl_framebuffer->renderbuffers_size);
+
       return TRUE;
     }
   else
@@ -955,6 +971,10 @@ _cogl_offscreen_gl_free (CoglOffscreen *offscreen)
 
   delete_renderbuffers (ctx, offscreen->gl_framebuffer.renderbuffers);
 
+  _cogl_memory_remove (ctx,
+                       COGL_MEMORY_TYPE_FRAMEBUFFER,
+                       offscreen->gl_framebuffer.renderbuffers_size);
+
   GE (ctx, glDeleteFramebuffers (1, &offscreen->gl_framebuffer.fbo_handle));
 }
 
@@ -976,12 +996,7 @@ _cogl_framebuffer_gl_clear (CoglFramebuffer *framebuffer,
 
       if (ctx->current_gl_color_mask != framebuffer->color_mask)
         {
-          CoglColorMask color_mask = framebuffer->color_mask;
-          GE( ctx, glColorMask (!!(color_mask & COGL_COLOR_MASK_RED),
-                                !!(color_mask & COGL_COLOR_MASK_GREEN),
-                                !!(color_mask & COGL_COLOR_MASK_BLUE),
-                                !!(color_mask & COGL_COLOR_MASK_ALPHA)));
-          ctx->current_gl_color_mask = color_mask;
+          _cogl_gl_state_set_color_mask (ctx, framebuffer->color_mask);
           /* Make sure the ColorMask is updated when the next primitive is drawn */
           ctx->current_pipeline_changes_since_flush |=
             COGL_PIPELINE_STATE_LOGIC_OPS;
@@ -995,9 +1010,8 @@ _cogl_framebuffer_gl_clear (CoglFramebuffer *framebuffer,
 
       if (ctx->depth_writing_enabled_cache != framebuffer->depth_writing_enabled)
         {
-          GE( ctx, glDepthMask (framebuffer->depth_writing_enabled));
-
-          ctx->depth_writing_enabled_cache = framebuffer->depth_writing_enabled;
+          _cogl_gl_state_set_depth_mask (ctx,
+                                         framebuffer->depth_writing_enabled);
 
           /* Make sure the DepthMask is updated when the next primitive is drawn */
           ctx->current_pipeline_changes_since_flush |=
@@ -1169,6 +1183,8 @@ _cogl_framebuffer_gl_draw_attributes (CoglFramebuffer *framebuffer,
 
   GE (framebuffer->context,
       glDrawArrays ((GLenum)mode, first_vertex, n_vertices));
+
+  framebuffer->frame_stats.n_draw_calls++;
 }
 
 static size_t
@@ -1237,6 +1253,8 @@ _cogl_framebuffer_gl_draw_indexed_attributes (CoglFramebuffer *framebuffer,
                       indices_gl_type,
                       base + buffer_offset + index_size * first_vertex));
 
+  framebuffer->frame_stats.n_draw_calls++;
+
   _cogl_buffer_gl_unbind (buffer);
 }
 
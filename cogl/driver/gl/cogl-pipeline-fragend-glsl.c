@@ -90,7 +90,7 @@ typedef struct
 {
   int ref_count;
 
-  GLuint gl_shader;
+  CoglGLSLShaderCacheEntry *shader_entry;
   GString *header, *source;
   UnitState *unit_state;
 
@@ -103,7 +103,10 @@ typedef struct
   CoglPipelineCacheEntry *cache_entry;
 } CoglPipelineShaderState;
 
-static CoglUserDataKey shader_state_key;
+/* The generated shader depends on the number of rectangle clips that
+   are being evaluated in the shader so we keep a separate shader
+   state for each number */
+static CoglUserDataKey shader_state_keys[COGL_MAX_SHADER_CLIP_RECTS + 1];
 
 static void
 ensure_layer_generated (CoglPipeline *pipeline,
@@ -126,7 +129,11 @@ shader_state_new (int n_layers,
 static CoglPipelineShaderState *
 get_shader_state (CoglPipeline *pipeline)
 {
-  return cogl_object_get_user_data (COGL_OBJECT (pipeline), &shader_state_key);
+  _COGL_GET_CONTEXT (ctx, NULL);
+
+  return cogl_object_get_user_data (COGL_OBJECT (pipeline),
+                                    &shader_state_keys
+                                    [ctx->n_shader_clip_rects]);
 }
 
 static void
@@ -143,8 +150,8 @@ destroy_shader_state (void *user_data,
 
   if (--shader_state->ref_count == 0)
     {
-      if (shader_state->gl_shader)
-        GE( ctx, glDeleteShader (shader_state->gl_shader) );
+      if (shader_state->shader_entry)
+        _cogl_glsl_shader_cache_unref (ctx, shader_state->shader_entry);
 
       g_free (shader_state->unit_state);
 
@@ -155,6 +162,8 @@ destroy_shader_state (void *user_data,
 static void
 set_shader_state (CoglPipeline *pipeline, CoglPipelineShaderState *shader_state)
 {
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
   if (shader_state)
     {
       shader_state->ref_count++;
@@ -167,7 +176,7 @@ set_shader_state (CoglPipeline *pipeline, CoglPipelineShaderState *shader_state)
     }
 
   _cogl_object_set_user_data (COGL_OBJECT (pipeline),
-                              &shader_state_key,
+                              &shader_state_keys[ctx->n_shader_clip_rects],
                               shader_state,
                               destroy_shader_state);
 }
@@ -175,10 +184,13 @@ set_shader_state (CoglPipeline *pipeline, CoglPipelineShaderState *shader_state)
 static void
 dirty_shader_state (CoglPipeline *pipeline)
 {
-  cogl_object_set_user_data (COGL_OBJECT (pipeline),
-                             &shader_state_key,
-                             NULL,
-                             NULL);
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (shader_state_keys); i++)
+    cogl_object_set_user_data (COGL_OBJECT (pipeline),
+                               &shader_state_keys[i],
+                               NULL,
+                               NULL);
 }
 
 GLuint
@@ -186,8 +198,8 @@ _cogl_pipeline_fragend_glsl_get_shader (CoglPipeline *pipeline)
 {
   CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
 
-  if (shader_state)
-    return shader_state->gl_shader;
+  if (shader_state && shader_state->shader_entry)
+    return shader_state->shader_entry->gl_shader;
   else
     return 0;
 }
@@ -349,11 +361,11 @@ _cogl_pipeline_fragend_glsl_start (CoglPipeline *pipeline,
         set_shader_state (pipeline, shader_state);
     }
 
-  if (shader_state->gl_shader)
+  if (shader_state->shader_entry)
     return;
 
   /* If we make it here then we have a glsl_shader_state struct
-     without a gl_shader because this is the first time we've
+     without a shader because this is the first time we've
      encountered it. */
 
   /* We reuse two grow-only GStrings for code-gen. One string
@@ -502,11 +514,11 @@ add_arg (CoglPipelineShaderState *shader_state,
 
   g_string_append_c (shader_source, '(');
 
+  /* GLSL will expand a scalar to the size of the vector so there's
+     no need to construct a vector of ones */
   if (operand == COGL_PIPELINE_COMBINE_OP_ONE_MINUS_SRC_COLOR ||
       operand == COGL_PIPELINE_COMBINE_OP_ONE_MINUS_SRC_ALPHA)
-    g_string_append_printf (shader_source,
-                            "vec4(1.0, 1.0, 1.0, 1.0).%s - ",
-                            swizzle);
+    g_string_append (shader_source, "1.0 - ");
 
   /* If the operand is reading from the alpha then replace the swizzle
      with the same number of copies of the alpha */
@@ -694,9 +706,7 @@ append_masked_combine (CoglPipeline *pipeline,
       g_string_append (shader_source, " + ");
       add_arg (shader_state, pipeline, layer, previous_layer_index,
                src[1], op[1], swizzle);
-      g_string_append_printf (shader_source,
-                              " - vec4(0.5, 0.5, 0.5, 0.5).%s",
-                              swizzle);
+      g_string_append (shader_source, " - 0.5");
       break;
 
     case COGL_PIPELINE_COMBINE_FUNC_SUBTRACT:
@@ -708,17 +718,15 @@ append_masked_combine (CoglPipeline *pipeline,
       break;
 
     case COGL_PIPELINE_COMBINE_FUNC_INTERPOLATE:
-      add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[0], op[0], swizzle);
-      g_string_append (shader_source, " * ");
-      add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[2], op[2], swizzle);
-      g_string_append (shader_source, " + ");
+      /* arg0 * arg2 + arg1 * (1 - arg2) is exactly what mix() does
+         and it only needs to reference arg2 once */
+      g_string_append (shader_source, "mix (");
       add_arg (shader_state, pipeline, layer, previous_layer_index,
                src[1], op[1], swizzle);
-      g_string_append_printf (shader_source,
-                              " * (vec4(1.0, 1.0, 1.0, 1.0).%s - ",
-                              swizzle);
+      g_string_append (shader_source, ", ");
+      add_arg (shader_state, pipeline, layer, previous_layer_index,
+               src[0], op[0], swizzle);
+      g_string_append (shader_source, ", ");
       add_arg (shader_state, pipeline, layer, previous_layer_index,
                src[2], op[2], swizzle);
       g_string_append_c (shader_source, ')');
@@ -726,31 +734,66 @@ append_masked_combine (CoglPipeline *pipeline,
 
     case COGL_PIPELINE_COMBINE_FUNC_DOT3_RGB:
     case COGL_PIPELINE_COMBINE_FUNC_DOT3_RGBA:
-      g_string_append (shader_source, "vec4(4.0 * ((");
+      g_string_append (shader_source, "vec4 (4.0 * dot (");
       add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[0], op[0], "r");
-      g_string_append (shader_source, " - 0.5) * (");
+               src[0], op[0], "rgb");
+      g_string_append (shader_source, " - 0.5, ");
       add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[1], op[1], "r");
-      g_string_append (shader_source, " - 0.5) + (");
-      add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[0], op[0], "g");
-      g_string_append (shader_source, " - 0.5) * (");
-      add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[1], op[1], "g");
-      g_string_append (shader_source, " - 0.5) + (");
-      add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[0], op[0], "b");
-      g_string_append (shader_source, " - 0.5) * (");
-      add_arg (shader_state, pipeline, layer, previous_layer_index,
-               src[1], op[1], "b");
-      g_string_append_printf (shader_source, " - 0.5))).%s", swizzle);
+               src[1], op[1], "rgb");
+      g_string_append_printf (shader_source, " - 0.5)).%s", swizzle);
       break;
     }
 
   g_string_append_printf (shader_source, ";\n");
 }
 
+static CoglBool
+has_layer_snippets (CoglPipelineLayer *layer,
+                    CoglSnippetHook hook)
+{
+  GList *l;
+
+  for (l = get_layer_fragment_snippets (layer)->entries; l; l = l->next)
+    {
+      CoglSnippet *snippet = l->data;
+
+      if (snippet->hook == hook)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Returns whether the combine state just copies the result of the
+   previous layer. For example this happens with "RGBA = REPLACE
+   (PREVIOUS)". */
+static CoglBool
+is_passthrough_combine (CoglPipelineLayer *combine_authority)
+{
+  CoglPipelineLayerBigState *big_state = combine_authority->big_state;
+
+  if (big_state->texture_combine_rgb_func !=
+      COGL_PIPELINE_COMBINE_FUNC_REPLACE ||
+      big_state->texture_combine_alpha_func !=
+      COGL_PIPELINE_COMBINE_FUNC_REPLACE)
+    return FALSE;
+
+  if (big_state->texture_combine_rgb_src[0] !=
+      COGL_PIPELINE_COMBINE_SOURCE_PREVIOUS ||
+      big_state->texture_combine_alpha_src[0] !=
+      COGL_PIPELINE_COMBINE_SOURCE_PREVIOUS)
+    return FALSE;
+
+  /* For the alpha channel reading the alpha component is the same
+     as reading the color */
+  return (big_state->texture_combine_rgb_op[0] ==
+          COGL_PIPELINE_COMBINE_OP_SRC_COLOR &&
+          (big_state->texture_combine_alpha_op[0] ==
+           COGL_PIPELINE_COMBINE_OP_SRC_COLOR ||
+           big_state->texture_combine_alpha_op[0] ==
+           COGL_PIPELINE_COMBINE_OP_SRC_ALPHA));
+}
+
 static void
 ensure_layer_generated (CoglPipeline *pipeline,
                         int layer_index)
@@ -790,6 +833,32 @@ ensure_layer_generated (CoglPipeline *pipeline,
                           "vec4 cogl_layer%i;\n",
                           layer_index);
 
+  /* If the layer doesn't modify the previous layer and there are no
+     snippets to wrap it then we can just copy the value without
+     generating any functions. A chain of these layers then collapses
+     into a chain of assignments */
+  if (is_passthrough_combine (combine_authority) &&
+      !has_layer_snippets (layer, COGL_SNIPPET_HOOK_LAYER_FRAGMENT))
+    {
+      int previous_layer_index = layer_data->previous_layer_index;
+
+      if (previous_layer_index >= 0)
+        {
+          ensure_layer_generated (pipeline, previous_layer_index);
+          g_string_append_printf (shader_state->source,
+                                  "  cogl_layer%i = cogl_layer%i;\n",
+                                  layer_index,
+                                  previous_layer_index);
+        }
+      else
+        g_string_append_printf (shader_state->source,
+                                "  cogl_layer%i = cogl_color_in;\n",
+                                layer_index);
+
+      g_slice_free (LayerData, layer_data);
+      return;
+    }
+
   /* Skip the layer generation if there is a snippet that replaces the
      default layer code. This is important because generating this
      code may cause the code for other layers to be generated and
@@ -978,6 +1047,44 @@ add_alpha_test_snippet (CoglPipeline *pipeline,
 
 #endif /*  HAVE_COGL_GLES2 */
 
+/* Rectangle clips that couldn't be done with the scissor are tested
+   against a matrix which maps the window position to a homogeneous
+   position within the unit square of the rectangle. The test is done
+   in a wrapper around the main function so that it still applies if
+   a snippet replaces the rest of the fragment processing */
+static void
+add_shader_clip_main (CoglPipelineShaderState *shader_state,
+                      int n_clip_rects)
+{
+  int i;
+
+  g_string_append_printf (shader_state->header,
+                          "uniform mat3 _cogl_clip_matrix[%i];\n",
+                          n_clip_rects);
+
+  g_string_append (shader_state->source,
+                   "\n"
+                   "void\n"
+                   "main ()\n"
+                   "{\n"
+                   "  vec3 clip_pos;\n");
+
+  for (i = 0; i < n_clip_rects; i++)
+    g_string_append_printf (shader_state->source,
+                            "  clip_pos = _cogl_clip_matrix[%i] *\n"
+                            "    vec3 (gl_FragCoord.xy, 1.0);\n"
+                            "  if (any (lessThan (clip_pos.xy, "
+                            "vec2 (0.0))) ||\n"
+                            "      any (greaterThan (clip_pos.xy, "
+                            "clip_pos.zz)))\n"
+                            "    discard;\n",
+                            i);
+
+  g_string_append (shader_state->source,
+                   "  _cogl_clipped_main ();\n"
+                   "}\n");
+}
+
 static CoglBool
 _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
                                  unsigned long pipelines_difference)
@@ -990,16 +1097,14 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
-      GLuint shader;
       CoglPipelineSnippetData snippet_data;
 
-      COGL_STATIC_COUNTER (fragend_glsl_compile_counter,
-                           "glsl fragment compile counter",
-                           "Increments each time a new GLSL "
-                           "fragment shader is compiled",
+      COGL_STATIC_COUNTER (fragend_glsl_codegen_counter,
+                           "glsl fragment codegen counter",
+                           "Increments each time the source for a new "
+                           "GLSL fragment shader is generated",
                            0 /* no application private data */);
-      COGL_COUNTER_INC (_cogl_uprof_context, fragend_glsl_compile_counter);
+      COGL_COUNTER_INC (_cogl_uprof_context, fragend_glsl_codegen_counter);
 
       /* We only need to generate code to calculate the fragment value
          for the last layer. If the value of this layer depends on any
@@ -1043,40 +1148,29 @@ _cogl_pipeline_fragend_glsl_end (CoglPipeline *pipeline,
       snippet_data.snippets = get_fragment_snippets (pipeline);
       snippet_data.hook = COGL_SNIPPET_HOOK_FRAGMENT;
       snippet_data.chain_function = "cogl_generated_source";
-      snippet_data.final_name = "main";
+      snippet_data.final_name = (ctx->n_shader_clip_rects > 0 ?
+                                 "_cogl_clipped_main" :
+                                 "main");
       snippet_data.function_prefix = "cogl_fragment_hook";
       snippet_data.source_buf = shader_state->source;
       _cogl_pipeline_snippet_generate_code (&snippet_data);
 
-      GE_RET( shader, ctx, glCreateShader (GL_FRAGMENT_SHADER) );
+      if (ctx->n_shader_clip_rects > 0)
+        add_shader_clip_main (shader_state, ctx->n_shader_clip_rects);
 
       lengths[0] = shader_state->header->len;
       source_strings[0] = shader_state->header->str;
       lengths[1] = shader_state->source->len;
       source_strings[1] = shader_state->source->str;
 
-      _cogl_glsl_shader_set_source_with_boilerplate (ctx,
-                                                     shader, GL_FRAGMENT_SHADER,
-                                                     2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+      shader_state->shader_entry =
+        _cogl_glsl_shader_cache_get (ctx,
+                                     GL_FRAGMENT_SHADER,
+                                     2, /* count */
+                                     source_strings, lengths);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
-      shader_state->gl_shader = shader;
     }
 
   return TRUE;
@@ -35,6 +35,7 @@
 #define __COGL_PIPELINE_OPENGL_PRIVATE_H
 
 #include "cogl-pipeline-private.h"
+#include "cogl-context-private.h"
 #include "cogl-matrix-stack.h"
 
 /*
@@ -91,6 +92,10 @@ typedef struct _CoglTextureUnit
    */
   CoglBool           dirty_gl_texture;
 
+  /* The sampler object bound to this unit with glBindSampler or 0 if
+   * none has been bound yet */
+  GLuint             gl_sampler;
+
   /* A matrix stack giving us the means to associate a texture
    * transform matrix with the texture unit. */
   CoglMatrixStack   *matrix_stack;
@@ -147,6 +152,17 @@ _cogl_bind_gl_texture_transient (GLenum gl_target,
 void
 _cogl_delete_gl_texture (GLuint gl_texture);
 
+void
+_cogl_gl_state_cache_init (CoglGLStateCache *cache);
+
+void
+_cogl_gl_state_set_color_mask (CoglContext *ctx,
+                               CoglColorMask color_mask);
+
+void
+_cogl_gl_state_set_depth_mask (CoglContext *ctx,
+                               CoglBool depth_writing_enabled);
+
 void
 _cogl_pipeline_flush_gl_state (CoglContext *context,
                                CoglPipeline *pipeline,
@@ -34,6 +34,7 @@
 #include "config.h"
 
 #include "cogl-debug.h"
+#include "cogl-profile.h"
 #include "cogl-util-gl-private.h"
 #include "cogl-pipeline-opengl-private.h"
 #include "cogl-pipeline-private.h"
@@ -79,6 +80,7 @@ texture_unit_init (CoglContext *ctx,
   unit->gl_target = 0;
   unit->is_foreign = FALSE;
   unit->dirty_gl_texture = FALSE;
+  unit->gl_sampler = 0;
   unit->matrix_stack = cogl_matrix_stack_new (ctx);
 
   unit->layer = NULL;
@@ -265,6 +267,8 @@ set_glsl_program (GLuint gl_program)
           GE( ctx, glUseProgram (0) );
           ctx->current_gl_program = 0;
         }
+
+      _COGL_FRAME_STATS_INC (ctx, n_program_changes);
     }
 }
 
@@ -396,6 +400,261 @@ _cogl_use_vertex_program (GLuint gl_program, CoglPipelineProgramType type)
   ctx->current_vertex_program_type = type;
 }
 
+/* The initial values of the state tracked in CoglGLStateCache as
+ * defined by the GL spec */
+void
+_cogl_gl_state_cache_init (CoglGLStateCache *cache)
+{
+  cache->blend_src_factor_rgb = GL_ONE;
+  cache->blend_dst_factor_rgb = GL_ZERO;
+  cache->blend_src_factor_alpha = GL_ONE;
+  cache->blend_dst_factor_alpha = GL_ZERO;
+  cache->blend_equation_rgb = GL_FUNC_ADD;
+  cache->blend_equation_alpha = GL_FUNC_ADD;
+  cogl_color_init_from_4ub (&cache->blend_constant, 0, 0, 0, 0);
+
+  cache->alpha_func = GL_ALWAYS;
+  cache->alpha_func_reference = 0.0f;
+
+  cache->cull_face_enabled = FALSE;
+  cache->cull_face_mode = GL_BACK;
+  cache->front_face = GL_CCW;
+
+  cache->program_point_size_enabled = FALSE;
+
+  cache->n_calls_elided = 0;
+}
+
+static void
+gl_state_call_elided (CoglContext *ctx)
+{
+  COGL_STATIC_COUNTER (gl_state_elided_counter,
+                       "gl state calls elided counter",
+                       "Increments each time a GL state change is skipped "
+                       "because the state was already set",
+                       0 /* no application private data */);
+
+  COGL_COUNTER_INC (_cogl_uprof_context, gl_state_elided_counter);
+  ctx->gl_state_cache.n_calls_elided++;
+}
+
+/* The blend enable, depth test enable and depth mask state were
+ * already cached before CoglGLStateCache was added. These update
+ * functions are used for them directly so that n_calls_elided only
+ * counts the calls that would previously have reached GL. They
+ * return whether GL was called */
+static CoglBool
+gl_state_update_capability (CoglContext *ctx,
+                            GLenum capability,
+                            CoglBool *cache,
+                            CoglBool enabled)
+{
+  if (*cache == enabled)
+    return FALSE;
+
+  if (enabled)
+    GE (ctx, glEnable (capability));
+  else
+    GE (ctx, glDisable (capability));
+
+  *cache = enabled;
+
+  return TRUE;
+}
+
+static CoglBool
+gl_state_update_depth_mask (CoglContext *ctx,
+                            CoglBool depth_writing_enabled)
+{
+  if (ctx->depth_writing_enabled_cache == depth_writing_enabled)
+    return FALSE;
+
+  GE (ctx, glDepthMask (depth_writing_enabled ? GL_TRUE : GL_FALSE));
+  ctx->depth_writing_enabled_cache = depth_writing_enabled;
+
+  return TRUE;
+}
+
+static void
+gl_state_set_capability (CoglContext *ctx,
+                         GLenum capability,
+                         CoglBool *cache,
+                         CoglBool enabled)
+{
+  if (!gl_state_update_capability (ctx, capability, cache, enabled))
+    gl_state_call_elided (ctx);
+}
+
+void
+_cogl_gl_state_set_color_mask (CoglContext *ctx,
+                               CoglColorMask color_mask)
+{
+  if (ctx->current_gl_color_mask == color_mask)
+    {
+      gl_state_call_elided (ctx);
+      return;
+    }
+
+  GE (ctx, glColorMask (!!(color_mask & COGL_COLOR_MASK_RED),
+                        !!(color_mask & COGL_COLOR_MASK_GREEN),
+                        !!(color_mask & COGL_COLOR_MASK_BLUE),
+                        !!(color_mask & COGL_COLOR_MASK_ALPHA)));
+  ctx->current_gl_color_mask = color_mask;
+}
+
+void
+_cogl_gl_state_set_depth_mask (CoglContext *ctx,
+                               CoglBool depth_writing_enabled)
+{
+  if (!gl_state_update_depth_mask (ctx, depth_writing_enabled))
+    gl_state_call_elided (ctx);
+}
+
+static void
+gl_state_set_blend_func (CoglContext *ctx,
+                         GLenum src_factor_rgb,
+                         GLenum dst_factor_rgb,
+                         GLenum src_factor_alpha,
+                         GLenum dst_factor_alpha)
+{
+  CoglGLStateCache *cache = &ctx->gl_state_cache;
+
+  if (cache->blend_src_factor_rgb == src_factor_rgb &&
+      cache->blend_dst_factor_rgb == dst_factor_rgb &&
+      cache->blend_src_factor_alpha == src_factor_alpha &&
+      cache->blend_dst_factor_alpha == dst_factor_alpha)
+    {
+      gl_state_call_elided (ctx);
+      return;
+    }
+
+#if defined(HAVE_COGL_GLES2) || defined(HAVE_COGL_GL)
+  if (src_factor_rgb != src_factor_alpha ||
+      dst_factor_rgb != dst_factor_alpha)
+    GE (ctx, glBlendFuncSeparate (src_factor_rgb,
+                                  dst_factor_rgb,
+                                  src_factor_alpha,
+                                  dst_factor_alpha));
+  else
+#endif
+    GE (ctx, glBlendFunc (src_factor_rgb, dst_factor_rgb));
+
+  cache->blend_src_factor_rgb = src_factor_rgb;
+  cache->blend_dst_factor_rgb = dst_factor_rgb;
+  cache->blend_src_factor_alpha = src_factor_alpha;
+  cache->blend_dst_factor_alpha = dst_factor_alpha;
+}
+
+#if defined(HAVE_COGL_GLES2) || defined(HAVE_COGL_GL)
+
+static void
+gl_state_set_blend_equation (CoglContext *ctx,
+                             GLenum equation_rgb,
+                             GLenum equation_alpha)
+{
+  CoglGLStateCache *cache = &ctx->gl_state_cache;
+
+  if (cache->blend_equation_rgb == equation_rgb &&
+      cache->blend_equation_alpha == equation_alpha)
+    {
+      gl_state_call_elided (ctx);
+      return;
+    }
+
+  if (equation_rgb != equation_alpha)
+    GE (ctx, glBlendEquationSeparate (equation_rgb, equation_alpha));
+  else
+    GE (ctx, glBlendEquation (equation_rgb));
+
+  cache->blend_equation_rgb = equation_rgb;
+  cache->blend_equation_alpha = equation_alpha;
+}
+
+static void
+gl_state_set_blend_constant (CoglContext *ctx,
+                             const CoglColor *constant)
+{
+  CoglGLStateCache *cache = &ctx->gl_state_cache;
+
+  if (cogl_color_equal (&cache->blend_constant, constant))
+    {
+      gl_state_call_elided (ctx);
+      return;
+    }
+
+  GE (ctx, glBlendColor (cogl_color_get_red_float (constant),
+                         cogl_color_get_green_float (constant),
+                         cogl_color_get_blue_float (constant),
+                         cogl_color_get_alpha_float (constant)));
+
+  cache->blend_constant = *constant;
+}
+
+#endif
+
+#if defined (HAVE_COGL_GL) || defined (HAVE_COGL_GLES)
+
+static void
+gl_state_set_alpha_func (CoglContext *ctx,
+                         GLenum alpha_func,
+                         float reference)
+{
+  CoglGLStateCache *cache = &ctx->gl_state_cache;
+
+  if (cache->alpha_func == alpha_func &&
+      cache->alpha_func_reference == reference)
+    {
+      gl_state_call_elided (ctx);
+      return;
+    }
+
+  GE (ctx, glAlphaFunc (alpha_func, reference));
+
+  cache->alpha_func = alpha_func;
+  cache->alpha_func_reference = reference;
+}
+
+#endif
+
+static void
+gl_state_set_cull_face (CoglContext *ctx,
+                        GLenum mode,
+                        GLenum front_face)
+{
+  CoglGLStateCache *cache = &ctx->gl_state_cache;
+
+  if (cache->cull_face_mode == mode)
+    gl_state_call_elided (ctx);
+  else
+    {
+      GE (ctx, glCullFace (mode));
+      cache->cull_face_mode = mode;
+    }
+
+  if (cache->front_face == front_face)
+    gl_state_call_elided (ctx);
+  else
+    {
+      GE (ctx, glFrontFace (front_face));
+      cache->front_face = front_face;
+    }
+}
+
+static void
+gl_state_bind_sampler (CoglContext *ctx,
+                       CoglTextureUnit *unit,
+                       GLuint sampler)
+{
+  if (unit->gl_sampler == sampler)
+    {
+      gl_state_call_elided (ctx);
+      return;
+    }
+
+  GE (ctx, glBindSampler (unit->index, sampler));
+  unit->gl_sampler = sampler;
+}
+
 #if defined(HAVE_COGL_GLES2) || defined(HAVE_COGL_GL)
 
 static CoglBool
@@ -418,14 +677,10 @@ flush_depth_state (CoglContext *ctx,
   if (ctx->current_draw_buffer)
     depth_writing_enabled &= ctx->current_draw_buffer->depth_writing_enabled;
 
-  if (ctx->depth_test_enabled_cache != depth_state->test_enabled)
-    {
-      if (depth_state->test_enabled == TRUE)
-        GE (ctx, glEnable (GL_DEPTH_TEST));
-      else
-        GE (ctx, glDisable (GL_DEPTH_TEST));
-      ctx->depth_test_enabled_cache = depth_state->test_enabled;
-    }
+  gl_state_update_capability (ctx,
+                              GL_DEPTH_TEST,
+                              &ctx->depth_test_enabled_cache,
+                              depth_state->test_enabled);
 
   if (ctx->depth_test_function_cache != depth_state->test_function &&
       depth_state->test_enabled == TRUE)
@@ -434,12 +689,7 @@ flush_depth_state (CoglContext *ctx,
       ctx->depth_test_function_cache = depth_state->test_function;
     }
 
-  if (ctx->depth_writing_enabled_cache != depth_writing_enabled)
-    {
-      GE (ctx, glDepthMask (depth_writing_enabled ?
-                            GL_TRUE : GL_FALSE));
-      ctx->depth_writing_enabled_cache = depth_writing_enabled;
-    }
+  gl_state_update_depth_mask (ctx, depth_writing_enabled);
 
   if (ctx->driver != COGL_DRIVER_GLES1 &&
       (ctx->depth_range_near_cache != depth_state->range_near ||
@@ -489,6 +739,49 @@ UNIT_TEST (check_gl_blend_enable,
   g_assert_cmpint (test_ctx->gl_blend_enable_cache, ==, 0);
 }
 
+UNIT_TEST (check_gl_state_elision,
+           0 /* no requirements */,
+           0 /* no failure cases */)
+{
+  CoglPipeline *pipeline_a = cogl_pipeline_new (test_ctx);
+  CoglPipeline *pipeline_b = cogl_pipeline_new (test_ctx);
+  unsigned long n_calls_elided;
+
+  /* The two pipelines have the same blend state but they don't share
+   * an authority for it so the pipeline comparison will think that
+   * it has changed */
+  cogl_pipeline_set_blend (pipeline_a,
+                           "RGBA=ADD(SRC_COLOR, DST_COLOR)",
+                           NULL);
+  cogl_pipeline_set_blend (pipeline_b,
+                           "RGBA=ADD(SRC_COLOR, DST_COLOR)",
+                           NULL);
+
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline_a, 0, 0, 1, 1);
+  _cogl_framebuffer_flush_journal (test_fb);
+
+  g_assert_cmpint (test_ctx->gl_state_cache.blend_src_factor_rgb,
+                   ==,
+                   GL_ONE);
+  g_assert_cmpint (test_ctx->gl_state_cache.blend_dst_factor_rgb,
+                   ==,
+                   GL_ONE);
+
+  n_calls_elided = test_ctx->gl_state_cache.n_calls_elided;
+
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline_b, 0, 0, 1, 1);
+  _cogl_framebuffer_flush_journal (test_fb);
+
+  /* Flushing the second pipeline shouldn't have needed to change the
+   * blend function */
+  g_assert_cmpint (test_ctx->gl_state_cache.n_calls_elided,
+                   >,
+                   n_calls_elided);
+
+  cogl_object_unref (pipeline_a);
+  cogl_object_unref (pipeline_b);
+}
+
 static void
 _cogl_pipeline_flush_color_blend_alpha_depth_state (
                                             CoglPipeline *pipeline,
@@ -525,8 +818,11 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       /* GLES 1 only has glBlendFunc */
       if (ctx->driver == COGL_DRIVER_GLES1)
         {
-          GE (ctx, glBlendFunc (blend_state->blend_src_factor_rgb,
-                                blend_state->blend_dst_factor_rgb));
+          gl_state_set_blend_func (ctx,
+                                   blend_state->blend_src_factor_rgb,
+                                   blend_state->blend_dst_factor_rgb,
+                                   blend_state->blend_src_factor_rgb,
+                                   blend_state->blend_dst_factor_rgb);
         }
 #if defined(HAVE_COGL_GLES2) || defined(HAVE_COGL_GL)
       else
@@ -536,41 +832,29 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
                                           ->blend_src_factor_alpha) ||
               blend_factor_uses_constant (blend_state->blend_dst_factor_rgb) ||
               blend_factor_uses_constant (blend_state->blend_dst_factor_alpha))
-            {
-              float red =
-                cogl_color_get_red_float (&blend_state->blend_constant);
-              float green =
-                cogl_color_get_green_float (&blend_state->blend_constant);
-              float blue =
-                cogl_color_get_blue_float (&blend_state->blend_constant);
-              float alpha =
-                cogl_color_get_alpha_float (&blend_state->blend_constant);
+            gl_state_set_blend_constant (ctx, &blend_state->blend_constant);
 
-
-              GE (ctx, glBlendColor (red, green, blue, alpha));
-            }
-
-          if (ctx->glBlendEquationSeparate &&
-              blend_state->blend_equation_rgb !=
-              blend_state->blend_equation_alpha)
-            GE (ctx,
-                glBlendEquationSeparate (blend_state->blend_equation_rgb,
-                                         blend_state->blend_equation_alpha));
+          if (ctx->glBlendEquationSeparate)
+            gl_state_set_blend_equation (ctx,
+                                         blend_state->blend_equation_rgb,
+                                         blend_state->blend_equation_alpha);
           else
-            GE (ctx, glBlendEquation (blend_state->blend_equation_rgb));
-
-          if (ctx->glBlendFuncSeparate &&
-              (blend_state->blend_src_factor_rgb !=
-               blend_state->blend_src_factor_alpha ||
-               (blend_state->blend_dst_factor_rgb !=
-                blend_state->blend_dst_factor_alpha)))
-            GE (ctx, glBlendFuncSeparate (blend_state->blend_src_factor_rgb,
-                                          blend_state->blend_dst_factor_rgb,
-                                          blend_state->blend_src_factor_alpha,
-                                          blend_state->blend_dst_factor_alpha));
+            gl_state_set_blend_equation (ctx,
+                                         blend_state->blend_equation_rgb,
+                                         blend_state->blend_equation_rgb);
+
+          if (ctx->glBlendFuncSeparate)
+            gl_state_set_blend_func (ctx,
+                                     blend_state->blend_src_factor_rgb,
+                                     blend_state->blend_dst_factor_rgb,
+                                     blend_state->blend_src_factor_alpha,
+                                     blend_state->blend_dst_factor_alpha);
           else
-            GE (ctx, glBlendFunc (blend_state->blend_src_factor_rgb,
-                                  blend_state->blend_dst_factor_rgb));
+            gl_state_set_blend_func (ctx,
+                                     blend_state->blend_src_factor_rgb,
+                                     blend_state->blend_dst_factor_rgb,
+                                     blend_state->blend_src_factor_rgb,
+                                     blend_state->blend_dst_factor_rgb);
         }
 #endif
     }
@@ -591,8 +875,9 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
             &authority->big_state->alpha_state;
 
           /* NB: Currently the Cogl defines are compatible with the GL ones: */
-          GE (ctx, glAlphaFunc (alpha_state->alpha_func,
-                                alpha_state->alpha_func_reference));
+          gl_state_set_alpha_func (ctx,
+                                   alpha_state->alpha_func,
+                                   alpha_state->alpha_func_reference);
         }
     }
 
@@ -617,11 +902,7 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       if (ctx->current_draw_buffer)
         color_mask &= ctx->current_draw_buffer->color_mask;
 
-      GE (ctx, glColorMask (!!(color_mask & COGL_COLOR_MASK_RED),
-                            !!(color_mask & COGL_COLOR_MASK_GREEN),
-                            !!(color_mask & COGL_COLOR_MASK_BLUE),
-                            !!(color_mask & COGL_COLOR_MASK_ALPHA)));
-      ctx->current_gl_color_mask = color_mask;
+      _cogl_gl_state_set_color_mask (ctx, color_mask);
     }
 
   if (pipelines_difference & COGL_PIPELINE_STATE_CULL_FACE)
@@ -632,12 +913,19 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
         = &authority->big_state->cull_face_state;
 
       if (cull_face_state->mode == COGL_PIPELINE_CULL_FACE_MODE_NONE)
-        GE( ctx, glDisable (GL_CULL_FACE) );
+        gl_state_set_capability (ctx,
+                                 GL_CULL_FACE,
+                                 &ctx->gl_state_cache.cull_face_enabled,
+                                 FALSE);
       else
         {
           CoglBool invert_winding;
+          GLenum mode = GL_BACK, front_face = GL_CCW;
 
-          GE( ctx, glEnable (GL_CULL_FACE) );
+          gl_state_set_capability (ctx,
+                                   GL_CULL_FACE,
+                                   &ctx->gl_state_cache.cull_face_enabled,
+                                   TRUE);
 
           switch (cull_face_state->mode)
             {
@@ -645,15 +933,15 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
               g_assert_not_reached ();
 
             case COGL_PIPELINE_CULL_FACE_MODE_FRONT:
-              GE( ctx, glCullFace (GL_FRONT) );
+              mode = GL_FRONT;
               break;
 
             case COGL_PIPELINE_CULL_FACE_MODE_BACK:
-              GE( ctx, glCullFace (GL_BACK) );
+              mode = GL_BACK;
               break;
 
             case COGL_PIPELINE_CULL_FACE_MODE_BOTH:
-              GE( ctx, glCullFace (GL_FRONT_AND_BACK) );
+              mode = GL_FRONT_AND_BACK;
               break;
             }
 
@@ -665,13 +953,15 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
           switch (cull_face_state->front_winding)
             {
             case COGL_WINDING_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CCW : GL_CW) );
+              front_face = invert_winding ? GL_CCW : GL_CW;
               break;
 
             case COGL_WINDING_COUNTER_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CW : GL_CCW) );
+              front_face = invert_winding ? GL_CW : GL_CCW;
               break;
             }
+
+          gl_state_set_cull_face (ctx, mode, front_face);
         }
     }
 
@@ -683,23 +973,19 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       unsigned long state = COGL_PIPELINE_STATE_PER_VERTEX_POINT_SIZE;
       CoglPipeline *authority = _cogl_pipeline_get_authority (pipeline, state);
 
-      if (authority->big_state->per_vertex_point_size)
-        GE( ctx, glEnable (GL_PROGRAM_POINT_SIZE) );
-      else
-        GE( ctx, glDisable (GL_PROGRAM_POINT_SIZE) );
+      gl_state_set_capability (ctx,
+                               GL_PROGRAM_POINT_SIZE,
+                               &ctx->gl_state_cache.program_point_size_enabled,
+                               authority->big_state->per_vertex_point_size);
     }
 #endif
 
-  if (pipeline->real_blend_enable != ctx->gl_blend_enable_cache)
-    {
-      if (pipeline->real_blend_enable)
-        GE (ctx, glEnable (GL_BLEND));
-      else
-        GE (ctx, glDisable (GL_BLEND));
-      /* XXX: we shouldn't update any other blend state if blending
-       * is disabled! */
-      ctx->gl_blend_enable_cache = pipeline->real_blend_enable;
-    }
+  /* XXX: we shouldn't update any other blend state if blending
+   * is disabled! */
+  gl_state_update_capability (ctx,
+                              GL_BLEND,
+                              &ctx->gl_blend_enable_cache,
+                              pipeline->real_blend_enable);
 }
 
 static int
@@ -869,6 +1155,8 @@ flush_layers_common_gl_state_cb (CoglPipelineLayer *layer, void *user_data)
             GE (ctx, glBindTexture (gl_target, gl_texture));
           unit->gl_texture = gl_texture;
           unit->gl_target = gl_target;
+
+          _COGL_FRAME_STATS_INC (ctx, n_texture_changes);
         }
 
       unit->is_foreign = _cogl_texture_is_foreign (texture);
@@ -887,7 +1175,7 @@ flush_layers_common_gl_state_cb (CoglPipelineLayer *layer, void *user_data)
 
       sampler_state = _cogl_pipeline_layer_get_sampler_state (layer);
 
-      GE( ctx, glBindSampler (unit_index, sampler_state->sampler_object) );
+      gl_state_bind_sampler (ctx, unit, sampler_state->sampler_object);
     }
 
   /* FIXME: If using GLSL the progend we will use gl_PointCoord
@@ -1214,7 +1502,8 @@ _cogl_pipeline_flush_gl_state (CoglContext *ctx,
   if (current_pipeline == pipeline &&
       ctx->current_pipeline_age == pipeline->age &&
       ctx->current_pipeline_with_color_attrib == with_color_attrib &&
-      ctx->current_pipeline_unknown_color_alpha == unknown_color_alpha)
+      ctx->current_pipeline_unknown_color_alpha == unknown_color_alpha &&
+      ctx->current_pipeline_n_shader_clip_rects == ctx->n_shader_clip_rects)
     goto done;
   else
     {
@@ -1263,6 +1552,11 @@ _cogl_pipeline_flush_gl_state (CoglContext *ctx,
         }
     }
 
+  framebuffer->frame_stats.n_pipeline_flushes++;
+  if (pipelines_difference & (COGL_PIPELINE_STATE_BLEND |
+                              COGL_PIPELINE_STATE_REAL_BLEND_ENABLE))
+    framebuffer->frame_stats.n_blend_changes++;
+
   /* Get a layer_differences mask for each layer to be flushed */
   n_layers = cogl_pipeline_get_n_layers (pipeline);
   if (n_layers)
@@ -1403,6 +1697,7 @@ _cogl_pipeline_flush_gl_state (CoglContext *ctx,
   ctx->current_pipeline_with_color_attrib = with_color_attrib;
   ctx->current_pipeline_unknown_color_alpha = unknown_color_alpha;
   ctx->current_pipeline_age = pipeline->age;
+  ctx->current_pipeline_n_shader_clip_rects = ctx->n_shader_clip_rects;
 
 done:
 
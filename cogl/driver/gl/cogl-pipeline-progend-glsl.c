@@ -136,17 +136,29 @@ typedef struct
   GLint flip_uniform;
   int flushed_flip_state;
 
+  /* Uniform for the rectangle clips that are done in the fragment
+     shader and the context's clip age when it was last flushed */
+  GLint clip_matrix_uniform;
+  unsigned int flushed_clip_age;
+
   UnitState *unit_state;
 
   CoglPipelineCacheEntry *cache_entry;
 } CoglPipelineProgramState;
 
-static CoglUserDataKey program_state_key;
+/* The fragment shader depends on the number of rectangle clips that
+   are being evaluated in the shader so there is a separate program
+   for each number */
+static CoglUserDataKey program_state_keys[COGL_MAX_SHADER_CLIP_RECTS + 1];
 
 static CoglPipelineProgramState *
 get_program_state (CoglPipeline *pipeline)
 {
-  return cogl_object_get_user_data (COGL_OBJECT (pipeline), &program_state_key);
+  _COGL_GET_CONTEXT (ctx, NULL);
+
+  return cogl_object_get_user_data (COGL_OBJECT (pipeline),
+                                    &program_state_keys
+                                    [ctx->n_shader_clip_rects]);
 }
 
 #define UNIFORM_LOCATION_UNKNOWN -2
@@ -240,6 +252,7 @@ program_state_new (int n_layers,
   program_state->uniform_locations = NULL;
   program_state->attribute_locations = NULL;
   program_state->cache_entry = cache_entry;
+  program_state->clip_matrix_uniform = -1;
   _cogl_matrix_entry_cache_init (&program_state->modelview_cache);
   _cogl_matrix_entry_cache_init (&program_state->projection_cache);
 
@@ -273,7 +286,10 @@ destroy_program_state (void *user_data,
       _cogl_matrix_entry_cache_destroy (&program_state->modelview_cache);
 
       if (program_state->program)
-        GE( ctx, glDeleteProgram (program_state->program) );
+        {
+          GE( ctx, glDeleteProgram (program_state->program) );
+          _cogl_memory_remove_program (ctx);
+        }
 
       g_free (program_state->unit_state);
 
@@ -288,6 +304,8 @@ static void
 set_program_state (CoglPipeline *pipeline,
                   CoglPipelineProgramState *program_state)
 {
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
   if (program_state)
     {
       program_state->ref_count++;
@@ -300,7 +318,7 @@ set_program_state (CoglPipeline *pipeline,
     }
 
   _cogl_object_set_user_data (COGL_OBJECT (pipeline),
-                              &program_state_key,
+                              &program_state_keys[ctx->n_shader_clip_rects],
                               program_state,
                               destroy_program_state);
 }
@@ -308,10 +326,13 @@ set_program_state (CoglPipeline *pipeline,
 static void
 dirty_program_state (CoglPipeline *pipeline)
 {
-  cogl_object_set_user_data (COGL_OBJECT (pipeline),
-                             &program_state_key,
-                             NULL,
-                             NULL);
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (program_state_keys); i++)
+    cogl_object_set_user_data (COGL_OBJECT (pipeline),
+                               &program_state_keys[i],
+                               NULL,
+                               NULL);
 }
 
 static void
@@ -688,6 +709,7 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GLuint backend_shader;
 
       GE_RET( program_state->program, ctx, glCreateProgram () );
+      _cogl_memory_add_program (ctx);
 
       /* Attach any shaders from the GLSL backends */
       if ((backend_shader = _cogl_pipeline_fragend_glsl_get_shader (pipeline)))
@@ -726,6 +748,13 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE_RET (program_state->flip_uniform,
               ctx, glGetUniformLocation (gl_program, "_cogl_flip_vector"));
       program_state->flushed_flip_state = -1;
+
+      if (ctx->n_shader_clip_rects > 0)
+        GE_RET (program_state->clip_matrix_uniform,
+                ctx, glGetUniformLocation (gl_program, "_cogl_clip_matrix"));
+      else
+        program_state->clip_matrix_uniform = -1;
+      program_state->flushed_clip_age = ctx->shader_clip_age - 1;
     }
 
   state.unit = 0;
@@ -961,6 +990,16 @@ _cogl_pipeline_progend_glsl_pre_paint (CoglPipeline *pipeline,
                              needs_flip ? do_flip : dont_flip) );
       program_state->flushed_flip_state = needs_flip;
     }
+
+  if (program_state->clip_matrix_uniform != -1 &&
+      program_state->flushed_clip_age != ctx->shader_clip_age)
+    {
+      GE( ctx, glUniformMatrix3fv (program_state->clip_matrix_uniform,
+                                   ctx->n_shader_clip_rects,
+                                   FALSE, /* transpose */
+                                   ctx->shader_clip_matrices) );
+      program_state->flushed_clip_age = ctx->shader_clip_age;
+    }
 }
 
 static void
@@ -58,7 +58,7 @@ typedef struct
 {
   unsigned int ref_count;
 
-  GLuint gl_shader;
+  CoglGLSLShaderCacheEntry *shader_entry;
   GString *header, *source;
 
   CoglPipelineCacheEntry *cache_entry;
@@ -98,8 +98,8 @@ destroy_shader_state (void *user_data,
 
   if (--shader_state->ref_count == 0)
     {
-      if (shader_state->gl_shader)
-        GE( ctx, glDeleteShader (shader_state->gl_shader) );
+      if (shader_state->shader_entry)
+        _cogl_glsl_shader_cache_unref (ctx, shader_state->shader_entry);
 
       g_slice_free (CoglPipelineShaderState, shader_state);
     }
@@ -140,8 +140,8 @@ _cogl_pipeline_vertend_glsl_get_shader (CoglPipeline *pipeline)
 {
   CoglPipelineShaderState *shader_state = get_shader_state (pipeline);
 
-  if (shader_state)
-    return shader_state->gl_shader;
+  if (shader_state && shader_state->shader_entry)
+    return shader_state->shader_entry->gl_shader;
   else
     return 0;
 }
@@ -277,10 +277,10 @@ _cogl_pipeline_vertend_glsl_start (CoglPipeline *pipeline,
         set_shader_state (pipeline, shader_state);
     }
 
-  if (shader_state->gl_shader)
+  if (shader_state->shader_entry)
     return;
 
-  /* If we make it here then we have a shader_state struct without a gl_shader
+  /* If we make it here then we have a shader_state struct without a shader
      because this is the first time we've encountered it */
 
   /* We reuse two grow-only GStrings for code-gen. One string
@@ -399,19 +399,17 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
     {
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
-      GLuint shader;
       CoglPipelineSnippetData snippet_data;
       CoglPipelineSnippetList *vertex_snippets;
       CoglBool has_per_vertex_point_size =
         cogl_pipeline_get_per_vertex_point_size (pipeline);
 
-      COGL_STATIC_COUNTER (vertend_glsl_compile_counter,
-                           "glsl vertex compile counter",
-                           "Increments each time a new GLSL "
-                           "vertex shader is compiled",
+      COGL_STATIC_COUNTER (vertend_glsl_codegen_counter,
+                           "glsl vertex codegen counter",
+                           "Increments each time the source for a new "
+                           "GLSL vertex shader is generated",
                            0 /* no application private data */);
-      COGL_COUNTER_INC (_cogl_uprof_context, vertend_glsl_compile_counter);
+      COGL_COUNTER_INC (_cogl_uprof_context, vertend_glsl_codegen_counter);
 
       g_string_append (shader_state->header,
                        "void\n"
@@ -497,35 +495,19 @@ _cogl_pipeline_vertend_glsl_end (CoglPipeline *pipeline,
       g_string_append (shader_state->source,
                        "}\n");
 
-      GE_RET( shader, ctx, glCreateShader (GL_VERTEX_SHADER) );
-
       lengths[0] = shader_state->header->len;
       source_strings[0] = shader_state->header->str;
       lengths[1] = shader_state->source->len;
       source_strings[1] = shader_state->source->str;
 
-      _cogl_glsl_shader_set_source_with_boilerplate (ctx,
-                                                     shader, GL_VERTEX_SHADER,
-                                                     2, /* count */
-                                                     source_strings, lengths);
-
-      GE( ctx, glCompileShader (shader) );
-      GE( ctx, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status) );
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE( ctx, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len) );
-          shader_log = g_alloca (len);
-          GE( ctx, glGetShaderInfoLog (shader, len, &len, shader_log) );
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+      shader_state->shader_entry =
+        _cogl_glsl_shader_cache_get (ctx,
+                                     GL_VERTEX_SHADER,
+                                     2, /* count */
+                                     source_strings, lengths);
 
       shader_state->header = NULL;
       shader_state->source = NULL;
-      shader_state->gl_shader = shader;
     }
 
 #ifdef HAVE_COGL_GL
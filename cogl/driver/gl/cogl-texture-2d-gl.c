@@ -445,6 +445,111 @@ allocate_from_gl_foreign (CoglTexture2D *tex_2d,
   return TRUE;
 }
 
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8d64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+
+static CoglBool
+allocate_from_compressed (CoglTexture2D *tex_2d,
+                          CoglTextureLoader *loader,
+                          CoglError **error)
+{
+  CoglTexture *tex = COGL_TEXTURE (tex_2d);
+  CoglContext *ctx = tex->context;
+  const CoglCompressedImage *image = loader->src.compressed.image;
+  CoglPixelFormat internal_format;
+  GLenum gl_intformat;
+  GLenum gl_error;
+  GLuint gl_texture;
+  size_t compressed_size = 0;
+  int level;
+
+  internal_format = (_cogl_compressed_format_has_alpha (image->format) ?
+                     COGL_PIXEL_FORMAT_RGBA_8888 :
+                     COGL_PIXEL_FORMAT_RGB_888);
+
+  if (!_cogl_texture_2d_gl_can_create (ctx,
+                                       image->width,
+                                       image->height,
+                                       internal_format))
+    {
+      _cogl_set_error (error, COGL_TEXTURE_ERROR,
+                       COGL_TEXTURE_ERROR_SIZE,
+                       "Failed to create texture 2d due to size/format"
+                       " constraints");
+      return FALSE;
+    }
+
+  gl_intformat = _cogl_compressed_image_get_gl_internal_format (image);
+
+  /* ETC2 decoders can also decode ETC1 data */
+  if (gl_intformat == GL_ETC1_RGB8_OES &&
+      !_cogl_has_private_feature (ctx,
+                                  COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC1))
+    gl_intformat = GL_COMPRESSED_RGB8_ETC2;
+
+  gl_texture = ctx->texture_driver->gen (ctx, GL_TEXTURE_2D, internal_format);
+
+  _cogl_bind_gl_texture_transient (GL_TEXTURE_2D,
+                                   gl_texture,
+                                   tex_2d->is_foreign);
+
+  /* Clear any GL errors */
+  while ((gl_error = ctx->glGetError ()) != GL_NO_ERROR)
+    ;
+
+  /* The data is uploaded directly from the container so it never has
+   * to be copied or decoded on the CPU */
+  for (level = 0; level < image->n_levels; level++)
+    {
+      const CoglCompressedImageLevel *image_level = image->levels + level;
+
+      ctx->glCompressedTexImage2D (GL_TEXTURE_2D,
+                                   level,
+                                   gl_intformat,
+                                   image_level->width,
+                                   image_level->height,
+                                   0,
+                                   image_level->size,
+                                   image_level->data);
+
+      if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+        {
+          GE( ctx, glDeleteTextures (1, &gl_texture) );
+          return FALSE;
+        }
+
+      compressed_size += image_level->size;
+    }
+
+  ctx->texture_bytes_uploaded += compressed_size;
+
+  tex_2d->gl_texture = gl_texture;
+  tex_2d->gl_internal_format = gl_intformat;
+
+  tex_2d->internal_format = internal_format;
+
+  /* glGenerateMipmap can't be used with compressed formats so only
+   * the levels in the container are available */
+  _cogl_texture_2d_set_auto_mipmap (tex, FALSE);
+  tex_2d->mipmaps_dirty = FALSE;
+
+  _cogl_texture_set_allocated (tex,
+                               internal_format,
+                               image->width,
+                               image->height);
+
+  _cogl_texture_gl_maybe_update_max_level (tex, image->n_levels - 1);
+
+  /* The size can't be derived from the internal format */
+  _cogl_texture_set_memory_size (tex, compressed_size);
+
+  return TRUE;
+}
+
 CoglBool
 _cogl_texture_2d_gl_allocate (CoglTexture *tex,
                               CoglError **error)
@@ -468,6 +573,8 @@ _cogl_texture_2d_gl_allocate (CoglTexture *tex,
 #endif
     case COGL_TEXTURE_SOURCE_TYPE_GL_FOREIGN:
       return allocate_from_gl_foreign (tex_2d, loader, error);
+    case COGL_TEXTURE_SOURCE_TYPE_COMPRESSED:
+      return allocate_from_compressed (tex_2d, loader, error);
     }
 
   g_return_val_if_reached (FALSE);
@@ -108,28 +108,37 @@ void
 _cogl_texture_gl_maybe_update_max_level (CoglTexture *texture,
                                          int max_level)
 {
+  if (texture->max_level >= max_level)
+    return;
+
+  /* The level is tracked even when GL_TEXTURE_MAX_LEVEL can't be set
+   * so that the allocated levels are included in the memory
+   * accounting */
+  texture->max_level = max_level;
+
+  _cogl_texture_update_memory_size (texture);
+
   /* This isn't supported on GLES */
 #ifdef HAVE_COGL_GL
-  CoglContext *ctx = texture->context;
-
-  if (_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_TEXTURE_MAX_LEVEL) &&
-      texture->max_level < max_level)
-    {
-      CoglContext *ctx = texture->context;
-      GLuint gl_handle;
-      GLenum gl_target;
+  {
+    CoglContext *ctx = texture->context;
 
-      cogl_texture_get_gl_texture (texture, &gl_handle, &gl_target);
+    if (_cogl_has_private_feature (ctx,
+                                   COGL_PRIVATE_FEATURE_TEXTURE_MAX_LEVEL))
+      {
+        GLuint gl_handle;
+        GLenum gl_target;
 
-      texture->max_level = max_level;
+        cogl_texture_get_gl_texture (texture, &gl_handle, &gl_target);
 
-      _cogl_bind_gl_texture_transient (gl_target,
-                                       gl_handle,
-                                       _cogl_texture_is_foreign (texture));
+        _cogl_bind_gl_texture_transient (gl_target,
+                                         gl_handle,
+                                         _cogl_texture_is_foreign (texture));
 
-      GE( ctx, glTexParameteri (gl_target,
-                                GL_TEXTURE_MAX_LEVEL, texture->max_level));
-    }
+        GE( ctx, glTexParameteri (gl_target,
+                                  GL_TEXTURE_MAX_LEVEL, texture->max_level));
+      }
+  }
 #endif /* HAVE_COGL_GL */
 }
 
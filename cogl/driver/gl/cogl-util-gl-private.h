@@ -79,6 +79,15 @@ _cogl_gl_util_get_texture_target_string (CoglTextureType texture_type,
                                          const char **target_string_out,
                                          const char **swizzle_out);
 
+/* Works out how many textures the journal can bind at once to draw
+ * quads with different textures in a single batch and enables
+ * COGL_PRIVATE_FEATURE_TEXTURE_BATCHING in @private_features if it is
+ * worthwhile. This must be called after the GLSL feature has been
+ * determined. */
+void
+_cogl_gl_util_init_texture_batching (CoglContext *ctx,
+                                     unsigned long *private_features);
+
 /* Parses a GL version number stored in a string. @version_string must
  * point to the beginning of the version number (ie, it can't point to
  * the "OpenGL ES" part on GLES). The version number can be followed
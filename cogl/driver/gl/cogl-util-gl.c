@@ -38,6 +38,7 @@
 #include "cogl-context-private.h"
 #include "cogl-error-private.h"
 #include "cogl-util-gl-private.h"
+#include "cogl-journal-private.h"
 
 #ifdef COGL_GL_DEBUG
 /* GL error to string conversion */
@@ -147,6 +148,35 @@ _cogl_gl_util_get_texture_target_string (CoglTextureType texture_type,
     *swizzle_out = tex_coord_swizzle;
 }
 
+void
+_cogl_gl_util_init_texture_batching (CoglContext *ctx,
+                                     unsigned long *private_features)
+{
+#if defined (HAVE_COGL_GL) || defined (HAVE_COGL_GLES2)
+  GLint max_texture_units = 0, max_vertex_attribs = 0;
+  int n_textures;
+
+  /* The textures are selected in the fragment shader */
+  if (!COGL_FLAGS_GET (ctx->features, COGL_FEATURE_ID_GLSL))
+    return;
+
+  GE (ctx, glGetIntegerv (GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_units));
+  GE (ctx, glGetIntegerv (GL_MAX_VERTEX_ATTRIBS, &max_vertex_attribs));
+
+  /* Each batched texture gets a layer and each layer gets a texture
+   * coordinate attribute on top of the position and color */
+  n_textures = MIN (COGL_JOURNAL_MAX_BATCHED_TEXTURES, max_texture_units);
+  n_textures = MIN (n_textures, max_vertex_attribs - 2);
+
+  if (n_textures >= 2)
+    {
+      ctx->max_batched_textures = n_textures;
+      COGL_FLAGS_SET (private_features,
+                      COGL_PRIVATE_FEATURE_TEXTURE_BATCHING, TRUE);
+    }
+#endif
+}
+
 CoglBool
 _cogl_gl_util_parse_gl_version (const char *version_string,
                                 int *major_out,
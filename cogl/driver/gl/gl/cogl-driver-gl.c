@@ -502,6 +502,8 @@ _cogl_driver_update_features (CoglContext *ctx,
         }
     }
 
+  _cogl_gl_util_init_texture_batching (ctx, private_features);
+
   if ((COGL_CHECK_GL_VERSION (gl_major, gl_minor, 2, 0) ||
        _cogl_check_extension ("GL_ARB_point_sprite", gl_extensions)) &&
 
@@ -549,6 +551,25 @@ _cogl_driver_update_features (CoglContext *ctx,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_TEXTURE_SWIZZLE, TRUE);
 
+  if (_cogl_check_extension ("GL_EXT_texture_compression_s3tc", gl_extensions))
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_S3TC, TRUE);
+
+  if (_cogl_check_extension ("GL_OES_compressed_ETC1_RGB8_texture",
+                             gl_extensions))
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC1, TRUE);
+
+  if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 4, 3) ||
+      _cogl_check_extension ("GL_ARB_ES3_compatibility", gl_extensions))
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ETC2, TRUE);
+
+  if (_cogl_check_extension ("GL_KHR_texture_compression_astc_ldr",
+                             gl_extensions))
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_TEXTURE_COMPRESSION_ASTC, TRUE);
+
   /* The per-vertex point size is only available via GLSL with the
    * gl_PointSize builtin. This is only available in GL 2.0 (not the
    * GLSL extensions) */
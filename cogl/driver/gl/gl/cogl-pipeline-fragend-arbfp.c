@@ -50,6 +50,7 @@
 #include "cogl-texture-private.h"
 #include "cogl-blend-string.h"
 #include "cogl-journal-private.h"
+#include "cogl-framebuffer-private.h"
 #include "cogl-color-private.h"
 #include "cogl-profile.h"
 
@@ -868,6 +869,7 @@ _cogl_pipeline_fragend_arbfp_end (CoglPipeline *pipeline,
 
   GE (ctx, glBindProgram (GL_FRAGMENT_PROGRAM_ARB, gl_program));
   _cogl_use_fragment_program (0, COGL_PIPELINE_PROGRAM_TYPE_ARBFP);
+  _COGL_FRAME_STATS_INC (ctx, n_program_changes);
 
   state.unit = 0;
   state.shader_state = shader_state;
@@ -117,8 +117,8 @@ _cogl_texture_driver_gen (CoglContext *ctx,
 }
 
 /* OpenGL - unlike GLES - can upload a sub region of pixel data from a larger
- * source buffer */
-static void
+ * source buffer. Returns the number of GL calls made */
+static int
 prep_gl_for_pixels_upload_full (CoglContext *ctx,
                                 int pixels_rowstride,
                                 int image_height,
@@ -126,6 +126,8 @@ prep_gl_for_pixels_upload_full (CoglContext *ctx,
                                 int pixels_src_y,
                                 int pixels_bpp)
 {
+  int n_calls = 4;
+
   GE( ctx, glPixelStorei (GL_UNPACK_ROW_LENGTH,
                           pixels_rowstride / pixels_bpp) );
 
@@ -133,17 +135,25 @@ prep_gl_for_pixels_upload_full (CoglContext *ctx,
   GE( ctx, glPixelStorei (GL_UNPACK_SKIP_ROWS, pixels_src_y) );
 
   if (cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_3D))
-    GE( ctx, glPixelStorei (GL_UNPACK_IMAGE_HEIGHT, image_height) );
+    {
+      GE( ctx, glPixelStorei (GL_UNPACK_IMAGE_HEIGHT, image_height) );
+      n_calls++;
+    }
 
   _cogl_texture_gl_prep_alignment_for_pixels_upload (ctx, pixels_rowstride);
+
+  return n_calls;
 }
 
-static void
+static int
 _cogl_texture_driver_prep_gl_for_pixels_upload (CoglContext *ctx,
                                                 int pixels_rowstride,
                                                 int pixels_bpp)
 {
-  prep_gl_for_pixels_upload_full (ctx, pixels_rowstride, 0, 0, 0, pixels_bpp);
+  return prep_gl_for_pixels_upload_full (ctx,
+                                         pixels_rowstride,
+                                         0, 0, 0,
+                                         pixels_bpp);
 }
 
 /* OpenGL - unlike GLES - can download pixel data into a sub region of
@@ -294,12 +304,98 @@ _cogl_texture_driver_upload_subregion_to_gl (CoglContext *ctx,
 
   if (_cogl_gl_util_catch_out_of_memory (ctx, error))
     status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += (size_t) width * height * bpp;
 
   _cogl_bitmap_gl_unbind (source_bmp);
 
   return status;
 }
 
+static CoglBool
+_cogl_texture_driver_upload_subregion_from_buffer (CoglContext *ctx,
+                                                   CoglTexture *texture,
+                                                   int dst_x,
+                                                   int dst_y,
+                                                   int width,
+                                                   int height,
+                                                   int level,
+                                                   uint8_t *bound_data,
+                                                   size_t offset,
+                                                   int bpp,
+                                                   GLuint source_gl_format,
+                                                   GLuint source_gl_type,
+                                                   CoglError **error)
+{
+  GLenum gl_target;
+  GLuint gl_handle;
+  GLenum gl_error;
+  CoglBool status = TRUE;
+  int level_width;
+  int level_height;
+
+  cogl_texture_get_gl_texture (texture, &gl_handle, &gl_target);
+
+  _cogl_bind_gl_texture_transient (gl_target, gl_handle, FALSE);
+
+  /* Clear any GL errors */
+  while ((gl_error = ctx->glGetError ()) != GL_NO_ERROR)
+    ;
+
+  _cogl_texture_get_level_size (texture,
+                                level,
+                                &level_width,
+                                &level_height,
+                                NULL);
+
+  /* Mipmap levels are initialized with glTexImage2D for the same
+   * reasons as in _cogl_texture_driver_upload_subregion_to_gl() */
+  if (level_width == width && level_height == height)
+    {
+      ctx->glTexImage2D (gl_target,
+                         level,
+                         _cogl_texture_gl_get_format (texture),
+                         width,
+                         height,
+                         0,
+                         source_gl_format,
+                         source_gl_type,
+                         bound_data + offset);
+    }
+  else
+    {
+      if (texture->max_level < level)
+        {
+          ctx->glTexImage2D (gl_target,
+                             level,
+                             _cogl_texture_gl_get_format (texture),
+                             level_width,
+                             level_height,
+                             0,
+                             source_gl_format,
+                             source_gl_type,
+                             NULL);
+        }
+
+      ctx->glTexSubImage2D (gl_target,
+                            level,
+                            dst_x, dst_y,
+                            width, height,
+                            source_gl_format,
+                            source_gl_type,
+                            bound_data + offset);
+    }
+
+  if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+    status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += (size_t) width * height * bpp;
+
+  _cogl_texture_gl_maybe_update_max_level (texture, level);
+
+  return status;
+}
+
 static CoglBool
 _cogl_texture_driver_upload_to_gl (CoglContext *ctx,
                                    GLenum gl_target,
@@ -354,6 +450,9 @@ _cogl_texture_driver_upload_to_gl (CoglContext *ctx,
 
   if (_cogl_gl_util_catch_out_of_memory (ctx, error))
     status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += ((size_t) cogl_bitmap_get_width (source_bmp) *
+                                    cogl_bitmap_get_height (source_bmp) * bpp);
 
   _cogl_bitmap_gl_unbind (source_bmp);
 
@@ -409,6 +508,9 @@ _cogl_texture_driver_upload_to_gl_3d (CoglContext *ctx,
 
   if (_cogl_gl_util_catch_out_of_memory (ctx, error))
     status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += ((size_t) cogl_bitmap_get_width (source_bmp) *
+                                    height * depth * bpp);
 
   _cogl_bitmap_gl_unbind (source_bmp);
 
@@ -542,6 +644,7 @@ _cogl_texture_driver_gl =
     _cogl_texture_driver_gen,
     _cogl_texture_driver_prep_gl_for_pixels_upload,
     _cogl_texture_driver_upload_subregion_to_gl,
+    _cogl_texture_driver_upload_subregion_from_buffer,
     _cogl_texture_driver_upload_to_gl,
     _cogl_texture_driver_upload_to_gl_3d,
     _cogl_texture_driver_prep_gl_for_pixels_download,
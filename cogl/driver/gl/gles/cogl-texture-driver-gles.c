@@ -101,13 +101,16 @@ _cogl_texture_driver_gen (CoglContext *ctx,
   return tex;
 }
 
-static void
+/* Returns the number of GL calls made */
+static int
 prep_gl_for_pixels_upload_full (CoglContext *ctx,
                                 int pixels_rowstride,
                                 int pixels_src_x,
                                 int pixels_src_y,
                                 int pixels_bpp)
 {
+  int n_calls = 1;
+
   if (_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_UNPACK_SUBIMAGE))
     {
       GE( ctx, glPixelStorei (GL_UNPACK_ROW_LENGTH,
@@ -115,6 +118,8 @@ prep_gl_for_pixels_upload_full (CoglContext *ctx,
 
       GE( ctx, glPixelStorei (GL_UNPACK_SKIP_PIXELS, pixels_src_x) );
       GE( ctx, glPixelStorei (GL_UNPACK_SKIP_ROWS, pixels_src_y) );
+
+      n_calls += 3;
     }
   else
     {
@@ -123,17 +128,19 @@ prep_gl_for_pixels_upload_full (CoglContext *ctx,
     }
 
   _cogl_texture_gl_prep_alignment_for_pixels_upload (ctx, pixels_rowstride);
+
+  return n_calls;
 }
 
-static void
+static int
 _cogl_texture_driver_prep_gl_for_pixels_upload (CoglContext *ctx,
                                                 int pixels_rowstride,
                                                 int pixels_bpp)
 {
-  prep_gl_for_pixels_upload_full (ctx,
-                                  pixels_rowstride,
-                                  0, 0, /* src_x/y */
-                                  pixels_bpp);
+  return prep_gl_for_pixels_upload_full (ctx,
+                                         pixels_rowstride,
+                                         0, 0, /* src_x/y */
+                                         pixels_bpp);
 }
 
 static void
@@ -321,6 +328,8 @@ _cogl_texture_driver_upload_subregion_to_gl (CoglContext *ctx,
 
   if (_cogl_gl_util_catch_out_of_memory (ctx, error))
     status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += (size_t) width * height * bpp;
 
   _cogl_bitmap_gl_unbind (slice_bmp);
 
@@ -329,6 +338,94 @@ _cogl_texture_driver_upload_subregion_to_gl (CoglContext *ctx,
   return status;
 }
 
+/* The caller lays the data out with a rowstride that
+ * prep_gl_for_pixels_upload can describe using GL_UNPACK_ALIGNMENT
+ * alone so, unlike upload_subregion_to_gl, this never needs to copy
+ * the data even without GL_EXT_unpack_subimage */
+static CoglBool
+_cogl_texture_driver_upload_subregion_from_buffer (CoglContext *ctx,
+                                                   CoglTexture *texture,
+                                                   int dst_x,
+                                                   int dst_y,
+                                                   int width,
+                                                   int height,
+                                                   int level,
+                                                   uint8_t *bound_data,
+                                                   size_t offset,
+                                                   int bpp,
+                                                   GLuint source_gl_format,
+                                                   GLuint source_gl_type,
+                                                   CoglError **error)
+{
+  GLenum gl_target;
+  GLuint gl_handle;
+  GLenum gl_error;
+  CoglBool status = TRUE;
+  int level_width;
+  int level_height;
+
+  cogl_texture_get_gl_texture (texture, &gl_handle, &gl_target);
+
+  _cogl_bind_gl_texture_transient (gl_target, gl_handle, FALSE);
+
+  /* Clear any GL errors */
+  while ((gl_error = ctx->glGetError ()) != GL_NO_ERROR)
+    ;
+
+  _cogl_texture_get_level_size (texture,
+                                level,
+                                &level_width,
+                                &level_height,
+                                NULL);
+
+  /* Mipmap levels are initialized with glTexImage2D for the same
+   * reasons as in _cogl_texture_driver_upload_subregion_to_gl() */
+  if (level_width == width && level_height == height)
+    {
+      ctx->glTexImage2D (gl_target,
+                         level,
+                         _cogl_texture_gl_get_format (texture),
+                         width,
+                         height,
+                         0,
+                         source_gl_format,
+                         source_gl_type,
+                         bound_data + offset);
+    }
+  else
+    {
+      if (texture->max_level < level)
+        {
+          ctx->glTexImage2D (gl_target,
+                             level,
+                             _cogl_texture_gl_get_format (texture),
+                             level_width,
+                             level_height,
+                             0,
+                             source_gl_format,
+                             source_gl_type,
+                             NULL);
+        }
+
+      ctx->glTexSubImage2D (gl_target,
+                            level,
+                            dst_x, dst_y,
+                            width, height,
+                            source_gl_format,
+                            source_gl_type,
+                            bound_data + offset);
+    }
+
+  if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+    status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += (size_t) width * height * bpp;
+
+  _cogl_texture_gl_maybe_update_max_level (texture, level);
+
+  return status;
+}
+
 static CoglBool
 _cogl_texture_driver_upload_to_gl (CoglContext *ctx,
                                    GLenum gl_target,
@@ -391,6 +488,8 @@ _cogl_texture_driver_upload_to_gl (CoglContext *ctx,
 
   if (_cogl_gl_util_catch_out_of_memory (ctx, error))
     status = FALSE;
+  else
+    ctx->texture_bytes_uploaded += (size_t) bmp_width * bmp_height * bpp;
 
   _cogl_bitmap_gl_unbind (bmp);
 
@@ -546,6 +645,8 @@ _cogl_texture_driver_upload_to_gl_3d (CoglContext *ctx,
       _cogl_bitmap_gl_unbind (source_bmp);
     }
 
+  ctx->texture_bytes_uploaded += (size_t) bmp_width * height * depth * bpp;
+
   return TRUE;
 }
 
@@ -639,6 +740,7 @@ _cogl_texture_driver_gles =
     _cogl_texture_driver_gen,
     _cogl_texture_driver_prep_gl_for_pixels_upload,
     _cogl_texture_driver_upload_subregion_to_gl,
+    _cogl_texture_driver_upload_subregion_from_buffer,
     _cogl_texture_driver_upload_to_gl,
     _cogl_texture_driver_upload_to_gl_3d,
     _cogl_texture_driver_prep_gl_for_pixels_download,
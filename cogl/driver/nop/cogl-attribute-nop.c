@@ -37,6 +37,63 @@
 #include "cogl-attribute.h"
 #include "cogl-attribute-private.h"
 #include "cogl-attribute-nop-private.h"
+#include "cogl-command-log-nop-private.h"
+#include "cogl-pipeline-private.h"
+
+/* This does the same bookkeeping as _cogl_pipeline_flush_gl_state
+ * so that the NOP driver sees the same pipeline changes as the GL
+ * driver, but there's no program generation or GL state to update */
+static void
+flush_pipeline_state (CoglContext *ctx,
+                      CoglFramebuffer *framebuffer,
+                      CoglPipeline *pipeline,
+                      CoglBool with_color_attrib,
+                      CoglBool unknown_color_alpha)
+{
+  CoglPipeline *current_pipeline = ctx->current_pipeline;
+  unsigned long pipelines_difference;
+  CoglBool save_real_blend_enable = pipeline->real_blend_enable;
+
+  if (current_pipeline == pipeline &&
+      ctx->current_pipeline_age == pipeline->age &&
+      ctx->current_pipeline_with_color_attrib == with_color_attrib &&
+      ctx->current_pipeline_unknown_color_alpha == unknown_color_alpha)
+    return;
+
+  _cogl_pipeline_update_real_blend_enable (pipeline, unknown_color_alpha);
+
+  if (current_pipeline == pipeline)
+    {
+      pipelines_difference = ctx->current_pipeline_changes_since_flush;
+      if (save_real_blend_enable != pipeline->real_blend_enable)
+        pipelines_difference |= COGL_PIPELINE_STATE_REAL_BLEND_ENABLE;
+    }
+  else if (current_pipeline)
+    pipelines_difference =
+      ctx->current_pipeline_changes_since_flush |
+      _cogl_pipeline_compare_differences (current_pipeline, pipeline);
+  else
+    pipelines_difference = COGL_PIPELINE_STATE_ALL;
+
+  framebuffer->frame_stats.n_pipeline_flushes++;
+  if (pipelines_difference & (COGL_PIPELINE_STATE_BLEND |
+                              COGL_PIPELINE_STATE_REAL_BLEND_ENABLE))
+    framebuffer->frame_stats.n_blend_changes++;
+
+  _cogl_nop_command_log_record (ctx,
+                                COGL_NOP_COMMAND_PIPELINE,
+                                cogl_pipeline_get_n_layers (pipeline));
+
+  cogl_object_ref (pipeline);
+  if (current_pipeline != NULL)
+    cogl_object_unref (current_pipeline);
+  ctx->current_pipeline = pipeline;
+  ctx->current_pipeline_changes_since_flush = 0;
+  ctx->current_pipeline_with_color_attrib = with_color_attrib;
+  ctx->current_pipeline_unknown_color_alpha = unknown_color_alpha;
+  ctx->current_pipeline_age = pipeline->age;
+  ctx->current_pipeline_n_shader_clip_rects = ctx->n_shader_clip_rects;
+}
 
 void
 _cogl_nop_flush_attributes_state (CoglFramebuffer *framebuffer,
@@ -46,4 +103,37 @@ _cogl_nop_flush_attributes_state (CoglFramebuffer *framebuffer,
                                   CoglAttribute **attributes,
                                   int n_attributes)
 {
+  CoglContext *ctx = framebuffer->context;
+  CoglBool with_color_attrib = FALSE;
+  CoglBool unknown_color_alpha = FALSE;
+  CoglPipeline *copy = NULL;
+  int i;
+
+  for (i = 0; i < n_attributes; i++)
+    if (attributes[i]->name_state->name_id ==
+        COGL_ATTRIBUTE_NAME_ID_COLOR_ARRAY)
+      {
+        if ((flags & COGL_DRAW_COLOR_ATTRIBUTE_IS_OPAQUE) == 0 &&
+            _cogl_attribute_get_n_components (attributes[i]) == 4)
+          unknown_color_alpha = TRUE;
+        with_color_attrib = TRUE;
+      }
+
+  if (G_UNLIKELY (layers_state->options.flags))
+    {
+      copy = cogl_pipeline_copy (pipeline);
+      pipeline = copy;
+      _cogl_pipeline_apply_overrides (pipeline, &layers_state->options);
+    }
+
+  flush_pipeline_state (ctx,
+                        framebuffer,
+                        pipeline,
+                        with_color_attrib,
+                        unknown_color_alpha);
+
+  _cogl_nop_command_log_record (ctx, COGL_NOP_COMMAND_ATTRIBUTES, n_attributes);
+
+  if (copy)
+    cogl_object_unref (copy);
 }
@@ -35,9 +35,33 @@
 #include "cogl-clip-stack.h"
 #include "cogl-clip-stack-nop-private.h"
 #include "cogl-framebuffer-private.h"
+#include "cogl-context-private.h"
+#include "cogl-command-log-nop-private.h"
 
 void
 _cogl_clip_stack_nop_flush (CoglClipStack *stack,
                             CoglFramebuffer *framebuffer)
 {
+  CoglContext *ctx = framebuffer->context;
+  int x0, y0, x1, y1;
+
+  if (ctx->current_clip_stack_valid)
+    {
+      if (ctx->current_clip_stack == stack)
+        return;
+
+      _cogl_clip_stack_unref (ctx->current_clip_stack);
+    }
+
+  framebuffer->frame_stats.n_clip_flushes++;
+
+  ctx->current_clip_stack_valid = TRUE;
+  ctx->current_clip_stack = _cogl_clip_stack_ref (stack);
+
+  /* Record the area of the scissor that GL would be given */
+  _cogl_clip_stack_get_bounds (stack, &x0, &y0, &x1, &y1);
+
+  _cogl_nop_command_log_record (ctx,
+                                COGL_NOP_COMMAND_CLIP,
+                                MAX (x1 - x0, 0) * MAX (y1 - y0, 0));
 }
@@ -0,0 +1,106 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef _COGL_COMMAND_LOG_NOP_PRIVATE_H_
+#define _COGL_COMMAND_LOG_NOP_PRIVATE_H_
+
+#include "cogl-types.h"
+#include "cogl-context-private.h"
+
+/* The NOP driver doesn't talk to a GPU but it still does all of the
+ * CPU side work of flushing state and drawing. Each point where the
+ * GL driver would have made GL calls instead records a command in
+ * this log. The log keeps a count of each type of command and the
+ * most recent commands with an argument such as the number of
+ * vertices so that tests can check what would have been submitted */
+
+typedef enum
+{
+  COGL_NOP_COMMAND_BIND_FRAMEBUFFER,
+  COGL_NOP_COMMAND_VIEWPORT,
+  COGL_NOP_COMMAND_CLIP,
+  COGL_NOP_COMMAND_MODELVIEW,
+  COGL_NOP_COMMAND_PROJECTION,
+  COGL_NOP_COMMAND_PIPELINE,
+  COGL_NOP_COMMAND_ATTRIBUTES,
+  COGL_NOP_COMMAND_CLEAR,
+  COGL_NOP_COMMAND_DRAW_ARRAYS,
+  COGL_NOP_COMMAND_DRAW_ELEMENTS,
+  COGL_NOP_COMMAND_READ_PIXELS,
+  COGL_NOP_COMMAND_DISCARD,
+  COGL_NOP_COMMAND_FINISH,
+  COGL_NOP_COMMAND_TEXTURE_ALLOCATE,
+  COGL_NOP_COMMAND_TEXTURE_UPLOAD,
+  COGL_NOP_COMMAND_TEXTURE_COPY,
+  COGL_NOP_COMMAND_GENERATE_MIPMAP,
+
+  COGL_NOP_N_COMMANDS
+} CoglNopCommand;
+
+/* The number of recent commands that are kept in the log */
+#define COGL_NOP_COMMAND_LOG_SIZE 256
+
+typedef struct _CoglNopCommandLogEntry
+{
+  CoglNopCommand command;
+  int arg;
+} CoglNopCommandLogEntry;
+
+typedef struct _CoglNopCommandLog
+{
+  unsigned int counts[COGL_NOP_N_COMMANDS];
+
+  /* A ring buffer of the most recent commands. n_entries is the
+   * total number of commands recorded since the last reset */
+  CoglNopCommandLogEntry entries[COGL_NOP_COMMAND_LOG_SIZE];
+  unsigned int n_entries;
+} CoglNopCommandLog;
+
+void
+_cogl_nop_command_log_record (CoglContext *ctx,
+                              CoglNopCommand command,
+                              int arg);
+
+unsigned int
+_cogl_nop_command_log_get_count (CoglContext *ctx,
+                                 CoglNopCommand command);
+
+/* Returns the nth most recent command where 0 is the last one
+ * recorded. Returns NULL if the command is no longer in the log */
+const CoglNopCommandLogEntry *
+_cogl_nop_command_log_get_recent (CoglContext *ctx,
+                                  unsigned int n);
+
+void
+_cogl_nop_command_log_reset (CoglContext *ctx);
+
+const char *
+_cogl_nop_command_get_name (CoglNopCommand command);
+
+#endif /* _COGL_COMMAND_LOG_NOP_PRIVATE_H_ */
@@ -0,0 +1,194 @@
+/*
+ * Cogl
+ *
+ * A Low-Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2014 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cogl-command-log-nop-private.h"
+#include "cogl-debug.h"
+
+#include <string.h>
+
+#include <test-fixtures/test-unit.h>
+
+static const char *command_names[] =
+  {
+    "bind-framebuffer",
+    "viewport",
+    "clip",
+    "modelview",
+    "projection",
+    "pipeline",
+    "attributes",
+    "clear",
+    "draw-arrays",
+    "draw-elements",
+    "read-pixels",
+    "discard",
+    "finish",
+    "texture-allocate",
+    "texture-upload",
+    "texture-copy",
+    "generate-mipmap"
+  };
+
+_COGL_STATIC_ASSERT (G_N_ELEMENTS (command_names) == COGL_NOP_N_COMMANDS,
+                     "There should be a name for every NOP command");
+
+const char *
+_cogl_nop_command_get_name (CoglNopCommand command)
+{
+  return command_names[command];
+}
+
+void
+_cogl_nop_command_log_record (CoglContext *ctx,
+                              CoglNopCommand command,
+                              int arg)
+{
+  CoglNopCommandLog *log = ctx->nop_command_log;
+  CoglNopCommandLogEntry *entry;
+
+  COGL_NOTE (DRAW, "NOP command: %s (%i)", command_names[command], arg);
+
+  log->counts[command]++;
+
+  entry = log->entries + log->n_entries % COGL_NOP_COMMAND_LOG_SIZE;
+  entry->command = command;
+  entry->arg = arg;
+  log->n_entries++;
+}
+
+unsigned int
+_cogl_nop_command_log_get_count (CoglContext *ctx,
+                                 CoglNopCommand command)
+{
+  return ctx->nop_command_log->counts[command];
+}
+
+const CoglNopCommandLogEntry *
+_cogl_nop_command_log_get_recent (CoglContext *ctx,
+                                  unsigned int n)
+{
+  CoglNopCommandLog *log = ctx->nop_command_log;
+
+  if (n >= log->n_entries || n >= COGL_NOP_COMMAND_LOG_SIZE)
+    return NULL;
+
+  return log->entries + (log->n_entries - 1 - n) % COGL_NOP_COMMAND_LOG_SIZE;
+}
+
+void
+_cogl_nop_command_log_reset (CoglContext *ctx)
+{
+  memset (ctx->nop_command_log, 0, sizeof (CoglNopCommandLog));
+}
+
+UNIT_TEST (check_nop_command_log,
+           TEST_REQUIREMENT_NOP /* requirements */,
+           0 /* no failure cases */)
+{
+  CoglPipeline *pipeline;
+  const CoglNopCommandLogEntry *entry;
+  CoglFrameStats stats;
+  int i;
+
+  g_assert (test_ctx->nop_command_log != NULL);
+
+  pipeline = cogl_pipeline_new (test_ctx);
+
+  cogl_framebuffer_finish (test_fb);
+  _cogl_nop_command_log_reset (test_ctx);
+  cogl_framebuffer_reset_frame_stats (test_fb);
+
+  /* Rectangles with the same pipeline are batched into one draw of
+   * indexed quads */
+  for (i = 0; i < 10; i++)
+    cogl_framebuffer_draw_rectangle (test_fb, pipeline, i, 0, i + 1, 1);
+  cogl_framebuffer_finish (test_fb);
+
+  g_assert_cmpint (_cogl_nop_command_log_get_count (test_ctx,
+                                                    COGL_NOP_COMMAND_DRAW_ARRAYS),
+                   ==,
+                   0);
+  g_assert_cmpint (_cogl_nop_command_log_get_count (test_ctx,
+                                                    COGL_NOP_COMMAND_DRAW_ELEMENTS),
+                   ==,
+                   1);
+  g_assert_cmpint (_cogl_nop_command_log_get_count (test_ctx,
+                                                    COGL_NOP_COMMAND_PIPELINE),
+                   ==,
+                   1);
+  g_assert_cmpint (_cogl_nop_command_log_get_count (test_ctx,
+                                                    COGL_NOP_COMMAND_FINISH),
+                   ==,
+                   1);
+
+  /* The draw is the last command before the finish and it covers
+   * all of the vertices of the rectangles */
+  entry = _cogl_nop_command_log_get_recent (test_ctx, 0);
+  g_assert_cmpint (entry->command, ==, COGL_NOP_COMMAND_FINISH);
+  entry = _cogl_nop_command_log_get_recent (test_ctx, 1);
+  g_assert_cmpint (entry->command, ==, COGL_NOP_COMMAND_DRAW_ELEMENTS);
+  g_assert_cmpint (entry->arg, ==, 10 * 6);
+
+  /* The frame statistics see the same draw */
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.n_draw_calls, ==, 1);
+  g_assert_cmpint (stats.n_pipeline_flushes, ==, 1);
+
+  /* Flushing the same pipeline again doesn't record anything */
+  _cogl_nop_command_log_reset (test_ctx);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline, 0, 0, 1, 1);
+  cogl_framebuffer_finish (test_fb);
+  g_assert_cmpint (_cogl_nop_command_log_get_count (test_ctx,
+                                                    COGL_NOP_COMMAND_PIPELINE),
+                   ==,
+                   0);
+
+  /* Old entries drop out of the ring buffer */
+  _cogl_nop_command_log_reset (test_ctx);
+  for (i = 0; i < COGL_NOP_COMMAND_LOG_SIZE + 10; i++)
+    _cogl_nop_command_log_record (test_ctx, COGL_NOP_COMMAND_CLEAR, i);
+  entry = _cogl_nop_command_log_get_recent (test_ctx, 0);
+  g_assert_cmpint (entry->arg, ==, COGL_NOP_COMMAND_LOG_SIZE + 9);
+  entry = _cogl_nop_command_log_get_recent (test_ctx,
+                                            COGL_NOP_COMMAND_LOG_SIZE - 1);
+  g_assert_cmpint (entry->arg, ==, 10);
+  g_assert (_cogl_nop_command_log_get_recent (test_ctx,
+                                              COGL_NOP_COMMAND_LOG_SIZE) ==
+            NULL);
+  g_assert_cmpint (_cogl_nop_command_log_get_count (test_ctx,
+                                                    COGL_NOP_COMMAND_CLEAR),
+                   ==,
+                   COGL_NOP_COMMAND_LOG_SIZE + 10);
+
+  cogl_object_unref (pipeline);
+}
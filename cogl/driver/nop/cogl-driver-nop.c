@@ -39,10 +39,30 @@
 #include "cogl-feature-private.h"
 #include "cogl-renderer-private.h"
 #include "cogl-error-private.h"
+#include "cogl-journal-private.h"
 #include "cogl-framebuffer-nop-private.h"
 #include "cogl-texture-2d-nop-private.h"
 #include "cogl-attribute-nop-private.h"
 #include "cogl-clip-stack-nop-private.h"
+#include "cogl-command-log-nop-private.h"
+
+static CoglPixelFormat
+_cogl_driver_pixel_format_to_gl (CoglContext *context,
+                                 CoglPixelFormat format,
+                                 GLenum *out_glintformat,
+                                 GLenum *out_glformat,
+                                 GLenum *out_gltype)
+{
+  /* Every format can be "uploaded" as-is so no conversion is needed */
+  if (out_glintformat != NULL)
+    *out_glintformat = 0;
+  if (out_glformat != NULL)
+    *out_glformat = 0;
+  if (out_gltype != NULL)
+    *out_gltype = 0;
+
+  return format;
+}
 
 static CoglBool
 _cogl_driver_update_features (CoglContext *ctx,
@@ -52,6 +72,23 @@ _cogl_driver_update_features (CoglContext *ctx,
 
   memset (ctx->private_features, 0, sizeof (ctx->private_features));
 
+  /* Offscreen framebuffers and arbitrary texture sizes cost nothing
+   * without a GPU. Advertising them lets applications and benchmarks
+   * take the same code paths that they would with a real driver */
+  COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_OFFSCREEN, TRUE);
+  COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_NPOT_BASIC, TRUE);
+  COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_NPOT_MIPMAP, TRUE);
+  COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_NPOT_REPEAT, TRUE);
+  COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_NPOT, TRUE);
+
+  /* Batching quads with different textures only changes how the
+   * journal groups its draws so it can be exercised without a GPU */
+  ctx->max_batched_textures = COGL_JOURNAL_MAX_BATCHED_TEXTURES;
+  COGL_FLAGS_SET (ctx->private_features,
+                  COGL_PRIVATE_FEATURE_TEXTURE_BATCHING, TRUE);
+
+  ctx->nop_command_log = g_new0 (CoglNopCommandLog, 1);
+
   return TRUE;
 }
 
@@ -59,7 +96,7 @@ const CoglDriverVtable
 _cogl_driver_nop =
   {
     NULL, /* pixel_format_from_gl_internal */
-    NULL, /* pixel_format_to_gl */
+    _cogl_driver_pixel_format_to_gl,
     _cogl_driver_update_features,
     _cogl_offscreen_nop_allocate,
     _cogl_offscreen_nop_free,
@@ -33,15 +33,105 @@
 #endif
 
 #include "cogl-framebuffer-nop-private.h"
+#include "cogl-command-log-nop-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-attribute-private.h"
+#include "cogl-clip-stack.h"
 
 #include <glib.h>
+#include <stdlib.h>
 #include <string.h>
 
+/* This mirrors the state tracking of the GL driver so that the
+ * command log sees the same sequence of state changes that would be
+ * sent to GL */
 void
 _cogl_framebuffer_nop_flush_state (CoglFramebuffer *draw_buffer,
                                    CoglFramebuffer *read_buffer,
                                    CoglFramebufferState state)
 {
+  CoglContext *ctx = draw_buffer->context;
+  unsigned long differences;
+  int bit;
+
+  differences = ctx->current_draw_buffer_changes;
+  differences |= ~ctx->current_draw_buffer_state_flushed;
+  differences &= state;
+
+  if (ctx->current_draw_buffer != draw_buffer)
+    {
+      if (ctx->current_draw_buffer == NULL)
+        differences |= state;
+      else
+        differences |= _cogl_framebuffer_compare (ctx->current_draw_buffer,
+                                                  draw_buffer,
+                                                  state & ~differences);
+
+      ctx->current_draw_buffer = draw_buffer;
+      ctx->current_draw_buffer_state_flushed = 0;
+    }
+
+  if (ctx->current_read_buffer != read_buffer &&
+      state & COGL_FRAMEBUFFER_STATE_BIND)
+    {
+      differences |= COGL_FRAMEBUFFER_STATE_BIND;
+      ctx->current_read_buffer = read_buffer;
+    }
+
+  if (!differences)
+    return;
+
+  if (G_UNLIKELY (!draw_buffer->allocated))
+    cogl_framebuffer_allocate (draw_buffer, NULL);
+  if (G_UNLIKELY (!read_buffer->allocated))
+    cogl_framebuffer_allocate (read_buffer, NULL);
+
+  if (differences & COGL_FRAMEBUFFER_STATE_BIND)
+    {
+      _cogl_nop_command_log_record (ctx,
+                                    COGL_NOP_COMMAND_BIND_FRAMEBUFFER,
+                                    draw_buffer->type);
+      differences &= ~COGL_FRAMEBUFFER_STATE_BIND;
+    }
+
+  COGL_FLAGS_FOREACH_START (&differences, 1, bit)
+    {
+      switch (bit)
+        {
+        case COGL_FRAMEBUFFER_STATE_INDEX_VIEWPORT:
+          _cogl_nop_command_log_record (ctx,
+                                        COGL_NOP_COMMAND_VIEWPORT,
+                                        draw_buffer->viewport_width);
+          break;
+        case COGL_FRAMEBUFFER_STATE_INDEX_CLIP:
+          _cogl_clip_stack_flush (draw_buffer->clip_stack, draw_buffer);
+          break;
+        case COGL_FRAMEBUFFER_STATE_INDEX_MODELVIEW:
+          _cogl_context_set_current_modelview_entry
+            (ctx, _cogl_framebuffer_get_modelview_entry (draw_buffer));
+          _cogl_nop_command_log_record (ctx, COGL_NOP_COMMAND_MODELVIEW, 0);
+          break;
+        case COGL_FRAMEBUFFER_STATE_INDEX_PROJECTION:
+          _cogl_context_set_current_projection_entry
+            (ctx, _cogl_framebuffer_get_projection_entry (draw_buffer));
+          _cogl_nop_command_log_record (ctx, COGL_NOP_COMMAND_PROJECTION, 0);
+          break;
+        case COGL_FRAMEBUFFER_STATE_INDEX_COLOR_MASK:
+          /* The color mask is owned by the pipeline state */
+          ctx->current_pipeline_changes_since_flush |=
+            COGL_PIPELINE_STATE_LOGIC_OPS;
+          ctx->current_pipeline_age--;
+          break;
+        default:
+          /* Dither, face winding, depth write and stereo mode have no
+           * visible effect without a GPU */
+          break;
+        }
+    }
+  COGL_FLAGS_FOREACH_END;
+
+  ctx->current_draw_buffer_state_flushed |= state;
+  ctx->current_draw_buffer_changes &= ~state;
 }
 
 CoglBool
@@ -64,24 +154,42 @@ _cogl_framebuffer_nop_clear (CoglFramebuffer *framebuffer,
                              float blue,
                              float alpha)
 {
+  _cogl_nop_command_log_record (framebuffer->context,
+                                COGL_NOP_COMMAND_CLEAR,
+                                buffers);
 }
 
 void
 _cogl_framebuffer_nop_query_bits (CoglFramebuffer *framebuffer,
                                   CoglFramebufferBits *bits)
 {
+  const char *stencil_bits;
+
   memset (bits, 0, sizeof (CoglFramebufferBits));
+
+  /* There is no stencil buffer unless one is asked for so that the
+     code paths that depend on it can be benchmarked without changing
+     what the driver reports to everything else */
+  stencil_bits = g_getenv ("COGL_NOP_STENCIL_BITS");
+  if (stencil_bits)
+    bits->stencil = atoi (stencil_bits);
 }
 
 void
 _cogl_framebuffer_nop_finish (CoglFramebuffer *framebuffer)
 {
+  _cogl_nop_command_log_record (framebuffer->context,
+                                COGL_NOP_COMMAND_FINISH,
+                                0);
 }
 
 void
 _cogl_framebuffer_nop_discard_buffers (CoglFramebuffer *framebuffer,
                                        unsigned long buffers)
 {
+  _cogl_nop_command_log_record (framebuffer->context,
+                                COGL_NOP_COMMAND_DISCARD,
+                                buffers);
 }
 
 void
@@ -94,6 +202,13 @@ _cogl_framebuffer_nop_draw_attributes (CoglFramebuffer *framebuffer,
                                        int n_attributes,
                                        CoglDrawFlags flags)
 {
+  _cogl_flush_attributes_state (framebuffer, pipeline, flags,
+                                attributes, n_attributes);
+
+  _cogl_nop_command_log_record (framebuffer->context,
+                                COGL_NOP_COMMAND_DRAW_ARRAYS,
+                                n_vertices);
+  framebuffer->frame_stats.n_draw_calls++;
 }
 
 void
@@ -107,6 +222,13 @@ _cogl_framebuffer_nop_draw_indexed_attributes (CoglFramebuffer *framebuffer,
                                                int n_attributes,
                                                CoglDrawFlags flags)
 {
+  _cogl_flush_attributes_state (framebuffer, pipeline, flags,
+                                attributes, n_attributes);
+
+  _cogl_nop_command_log_record (framebuffer->context,
+                                COGL_NOP_COMMAND_DRAW_ELEMENTS,
+                                n_vertices);
+  framebuffer->frame_stats.n_draw_calls++;
 }
 
 CoglBool
@@ -117,5 +239,9 @@ _cogl_framebuffer_nop_read_pixels_into_bitmap (CoglFramebuffer *framebuffer,
                                                CoglBitmap *bitmap,
                                                CoglError **error)
 {
+  _cogl_nop_command_log_record (framebuffer->context,
+                                COGL_NOP_COMMAND_READ_PIXELS,
+                                cogl_bitmap_get_width (bitmap) *
+                                cogl_bitmap_get_height (bitmap));
   return TRUE;
 }
@@ -42,6 +42,8 @@
 #include "cogl-texture-2d-nop-private.h"
 #include "cogl-texture-2d-private.h"
 #include "cogl-error-private.h"
+#include "cogl-bitmap-private.h"
+#include "cogl-command-log-nop-private.h"
 
 void
 _cogl_texture_2d_nop_free (CoglTexture2D *tex_2d)
@@ -60,12 +62,52 @@ _cogl_texture_2d_nop_can_create (CoglContext *ctx,
 void
 _cogl_texture_2d_nop_init (CoglTexture2D *tex_2d)
 {
+  static GLuint next_texture_name = 1;
+
+  /* Each texture gets its own fake name because pipelines compare
+   * textures by their GL handle. If they were all 0 then the journal
+   * would batch together rectangles with different textures which
+   * it can't do with a real driver */
+  tex_2d->gl_texture = next_texture_name++;
 }
 
 CoglBool
 _cogl_texture_2d_nop_allocate (CoglTexture *tex,
                                CoglError **error)
 {
+  CoglTexture2D *tex_2d = COGL_TEXTURE_2D (tex);
+  CoglTextureLoader *loader = tex->loader;
+  CoglContext *ctx = tex->context;
+  CoglPixelFormat internal_format;
+
+  _COGL_RETURN_VAL_IF_FAIL (loader, FALSE);
+
+  if (loader->src_type == COGL_TEXTURE_SOURCE_TYPE_BITMAP)
+    {
+      CoglBitmap *bmp = loader->src.bitmap.bitmap;
+      CoglPixelFormat format = cogl_bitmap_get_format (bmp);
+
+      internal_format = _cogl_texture_determine_internal_format (tex, format);
+
+      ctx->texture_bytes_uploaded +=
+        ((size_t) cogl_bitmap_get_width (bmp) *
+         cogl_bitmap_get_height (bmp) *
+         _cogl_pixel_format_get_bytes_per_pixel (format));
+    }
+  else
+    internal_format =
+      _cogl_texture_determine_internal_format (tex, COGL_PIXEL_FORMAT_ANY);
+
+  _cogl_nop_command_log_record (ctx,
+                                COGL_NOP_COMMAND_TEXTURE_ALLOCATE,
+                                tex->width * tex->height);
+
+  tex_2d->internal_format = internal_format;
+
+  /* Setting the allocated size lets the memory accounting see the
+   * texture just as it would with a real driver */
+  _cogl_texture_set_allocated (tex, internal_format, tex->width, tex->height);
+
   return TRUE;
 }
 
@@ -95,17 +137,23 @@ _cogl_texture_2d_nop_copy_from_framebuffer (CoglTexture2D *tex_2d,
                                             int dst_y,
                                             int level)
 {
+  _cogl_nop_command_log_record (COGL_TEXTURE (tex_2d)->context,
+                                COGL_NOP_COMMAND_TEXTURE_COPY,
+                                width * height);
 }
 
 unsigned int
 _cogl_texture_2d_nop_get_gl_handle (CoglTexture2D *tex_2d)
 {
-  return 0;
+  return tex_2d->gl_texture;
 }
 
 void
 _cogl_texture_2d_nop_generate_mipmap (CoglTexture2D *tex_2d)
 {
+  _cogl_nop_command_log_record (COGL_TEXTURE (tex_2d)->context,
+                                COGL_NOP_COMMAND_GENERATE_MIPMAP,
+                                0);
 }
 
 CoglBool
@@ -120,6 +168,16 @@ _cogl_texture_2d_nop_copy_from_bitmap (CoglTexture2D *tex_2d,
                                        int level,
                                        CoglError **error)
 {
+  CoglContext *ctx = COGL_TEXTURE (tex_2d)->context;
+  int bpp =
+    _cogl_pixel_format_get_bytes_per_pixel (cogl_bitmap_get_format (bitmap));
+
+  ctx->texture_bytes_uploaded += (size_t) width * height * bpp;
+
+  _cogl_nop_command_log_record (ctx,
+                                COGL_NOP_COMMAND_TEXTURE_UPLOAD,
+                                width * height * bpp);
+
   return TRUE;
 }
 
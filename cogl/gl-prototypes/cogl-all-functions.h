@@ -319,6 +319,26 @@ COGL_EXT_FUNCTION (void, glDeleteSync,
 COGL_EXT_END ()
 #endif
 
+#ifdef GL_ARB_timer_query
+COGL_EXT_BEGIN (timer_query, 3, 3,
+                0, /* not in either GLES */
+                "ARB:\0",
+                "timer_query\0")
+COGL_EXT_FUNCTION (void, glGenQueries,
+                   (GLsizei n, GLuint *ids))
+COGL_EXT_FUNCTION (void, glDeleteQueries,
+                   (GLsizei n, const GLuint *ids))
+COGL_EXT_FUNCTION (void, glQueryCounter,
+                   (GLuint id, GLenum target))
+COGL_EXT_FUNCTION (void, glGetQueryObjectiv,
+                   (GLuint id, GLenum pname, GLint *params))
+COGL_EXT_FUNCTION (void, glGetQueryObjectui64v,
+                   (GLuint id, GLenum pname, GLuint64 *params))
+COGL_EXT_FUNCTION (void, glGetInteger64v,
+                   (GLenum pname, GLint64 *params))
+COGL_EXT_END ()
+#endif
+
 COGL_EXT_BEGIN (draw_buffers, 2, 0,
                 COGL_EXT_IN_GLES3,
                 "ARB\0EXT\0",
@@ -24,6 +24,12 @@ check_flags (TestFlags flags,
       return FALSE;
     }
 
+  if (flags & TEST_REQUIREMENT_NOP &&
+      cogl_renderer_get_driver (renderer) != COGL_DRIVER_NOP)
+    {
+      return FALSE;
+    }
+
   if (flags & TEST_REQUIREMENT_NPOT &&
       !cogl_has_feature (test_ctx, COGL_FEATURE_ID_TEXTURE_NPOT))
     {
@@ -42,7 +42,8 @@ typedef enum _TestFlags
   TEST_REQUIREMENT_GLSL = 1<<9,
   TEST_REQUIREMENT_OFFSCREEN = 1<<10,
   TEST_REQUIREMENT_FENCE = 1<<11,
-  TEST_REQUIREMENT_PER_VERTEX_POINT_SIZE = 1<<12
+  TEST_REQUIREMENT_PER_VERTEX_POINT_SIZE = 1<<12,
+  TEST_REQUIREMENT_NOP = 1<<13
 } TestFlags;
 
  /**
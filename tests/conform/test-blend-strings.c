@@ -353,6 +353,38 @@ paint (TestState *state)
                     "RGB = DOT3_RGBA (PREVIOUS, TEXTURE)"
                     "A = REPLACE (PREVIOUS)",
                     0x2a2a2abb); /* expected */
+
+  /* A layer that just copies the previous layer is generated as an
+   * assignment instead of a combine function */
+  test_tex_combine (state, 4, 1, /* position */
+                    0x8899aabb, /* texture 0 color */
+                    0x11111111, /* texture 1 color (not used) */
+                    TEX_CONSTANT_UNUSED,
+                    "RGB = REPLACE (PREVIOUS)"
+                    "A = REPLACE (PREVIOUS[A])",
+                    0x8899aabb); /* expected */
+
+  test_tex_combine (state, 5, 1, /* position */
+                    0x10101010, /* texture 0 color */
+                    0x30303030, /* texture 1 color */
+                    0x00000080, /* constant (alpha = 0.5) */
+                    "RGBA = INTERPOLATE (PREVIOUS, TEXTURE, CONSTANT[A])",
+                    0x20202020); /* expected */
+
+  test_tex_combine (state, 6, 1, /* position */
+                    0x80808080, /* texture 0 color */
+                    0x00000080, /* texture 1 color (alpha = 0.5) */
+                    TEX_CONSTANT_UNUSED,
+                    "RGB = MODULATE (PREVIOUS, 1-TEXTURE[A])"
+                    "A = REPLACE (PREVIOUS)",
+                    0x40404080); /* expected */
+
+  test_tex_combine (state, 7, 1, /* position */
+                    0x8899aabb, /* texture 0 color */
+                    0xbbaa9988, /* texture 1 color */
+                    TEX_CONSTANT_UNUSED,
+                    "RGBA = DOT3_RGB (PREVIOUS, TEXTURE)",
+                    0x2a2a2a2a); /* expected */
 }
 
 void
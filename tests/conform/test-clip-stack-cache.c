@@ -0,0 +1,170 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* This tests drawing with a series of nested primitive clips and then
+ * returning to each clip again while popping them. The clip stacks
+ * that are revisited can be reused from the stencil buffer if they
+ * are still cached. There are more levels than there are stencil bits
+ * so some of them will have been evicted and need to be redrawn */
+
+#define N_LEVELS 10
+
+typedef struct _TestState
+{
+  int fb_width;
+  int fb_height;
+  int cell_width;
+  int row_height;
+  CoglPipeline *pipeline;
+} TestState;
+
+static void
+push_level_clip (TestState *state, int level)
+{
+  float x2 = (N_LEVELS - level) * state->cell_width;
+  float y2 = state->fb_height;
+  CoglVertexP2 verts[4] =
+    {
+      { 0, 0 },
+      { 0, y2 },
+      { x2, 0 },
+      { x2, y2 }
+    };
+  CoglPrimitive *prim = cogl_primitive_new_p2 (test_ctx,
+                                               COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                               4, /* n_vertices */
+                                               verts);
+
+  cogl_framebuffer_push_primitive_clip (test_fb, prim, 0, 0, x2, y2);
+
+  cogl_object_unref (prim);
+}
+
+static void
+paint_row (TestState *state, int row)
+{
+  cogl_framebuffer_draw_rectangle (test_fb,
+                                   state->pipeline,
+                                   0,
+                                   row * state->row_height,
+                                   state->fb_width,
+                                   (row + 1) * state->row_height);
+}
+
+static void
+check_row (TestState *state, int row, int level)
+{
+  int y = row * state->row_height + state->row_height / 2;
+  int edge = (N_LEVELS - level) * state->cell_width;
+
+  test_utils_check_pixel (test_fb,
+                          edge - state->cell_width / 2, y,
+                          0x0000ffff);
+  test_utils_check_pixel (test_fb,
+                          edge + state->cell_width / 2, y,
+                          0xff0000ff);
+}
+
+void
+test_clip_stack_cache (void)
+{
+  TestState state;
+  CoglFrameStats stats;
+  int i;
+
+  state.fb_width = cogl_framebuffer_get_width (test_fb);
+  state.fb_height = cogl_framebuffer_get_height (test_fb);
+  state.cell_width = state.fb_width / (N_LEVELS + 1);
+  state.row_height = state.fb_height / (N_LEVELS * 2 + 1);
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, state.fb_width, state.fb_height,
+                                 -1, 100);
+
+  state.pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (state.pipeline, 0, 0, 255, 255);
+
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_STENCIL,
+                            1.0f, 0.0f, 0.0f, 1.0f);
+
+  /* Paint one row for each level while pushing the clips and another
+   * row while popping back to the same clip stacks */
+  for (i = 0; i < N_LEVELS; i++)
+    {
+      push_level_clip (&state, i);
+      paint_row (&state, i);
+    }
+  for (i = N_LEVELS - 1; i >= 0; i--)
+    {
+      paint_row (&state, N_LEVELS * 2 - 1 - i);
+      cogl_framebuffer_pop_clip (test_fb);
+    }
+
+  for (i = 0; i < N_LEVELS; i++)
+    {
+      check_row (&state, i, i);
+      check_row (&state, N_LEVELS * 2 - 1 - i, i);
+    }
+
+  /* Alternate between an outer clip stack and stacks nested inside
+   * it. Each nested stack is new so it has to be drawn but the outer
+   * one should be reused from the stencil buffer every time it comes
+   * back */
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_STENCIL,
+                            1.0f, 0.0f, 0.0f, 1.0f);
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  push_level_clip (&state, 1);
+  for (i = 0; i < 3; i++)
+    {
+      paint_row (&state, i * 2);
+      push_level_clip (&state, 2);
+      paint_row (&state, i * 2 + 1);
+      cogl_framebuffer_pop_clip (test_fb);
+    }
+  paint_row (&state, 6);
+  cogl_framebuffer_pop_clip (test_fb);
+  cogl_framebuffer_finish (test_fb);
+
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.n_stencil_clip_cache_hits, ==, 3);
+  g_assert_cmpint (stats.n_stencil_clip_cache_misses, ==, 4);
+
+  for (i = 0; i < 3; i++)
+    {
+      check_row (&state, i * 2, 1);
+      check_row (&state, i * 2 + 1, 2);
+    }
+  check_row (&state, 6, 1);
+
+  /* Clearing the stencil buffer must cause any cached clips to be
+   * redrawn. The second paint uses the same clip stack as the first
+   * one */
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_COLOR,
+                            1.0f, 0.0f, 0.0f, 1.0f);
+  push_level_clip (&state, N_LEVELS / 2);
+  paint_row (&state, 0);
+  cogl_framebuffer_finish (test_fb);
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_STENCIL,
+                            0.0f, 0.0f, 0.0f, 0.0f);
+  paint_row (&state, 1);
+  cogl_framebuffer_pop_clip (test_fb);
+  cogl_framebuffer_finish (test_fb);
+
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.n_stencil_clip_cache_hits, ==, 0);
+  g_assert_cmpint (stats.n_stencil_clip_cache_misses, ==, 1);
+
+  check_row (&state, 0, N_LEVELS / 2);
+  check_row (&state, 1, N_LEVELS / 2);
+
+  cogl_object_unref (state.pipeline);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,218 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This records rectangles, a clip, a matrix change and a primitive
+ * into a CoglCommandBuffer and checks that submitting it twice draws
+ * the same thing both times without disturbing the framebuffer's
+ * own modelview matrix */
+
+static CoglPipeline *
+create_color_pipeline (uint32_t color)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new (test_ctx);
+
+  cogl_pipeline_set_color4ub (pipeline,
+                              color >> 24,
+                              (color >> 16) & 0xff,
+                              (color >> 8) & 0xff,
+                              color & 0xff);
+
+  return pipeline;
+}
+
+static void
+check_drawing (void)
+{
+  /* The two merged red rectangles */
+  test_utils_check_pixel (test_fb, 5, 5, 0xff0000ff);
+  test_utils_check_pixel (test_fb, 15, 5, 0xff0000ff);
+  /* The translated green rectangle should be clipped to its left
+   * half */
+  test_utils_check_pixel (test_fb, 5, 25, 0x00ff00ff);
+  test_utils_check_pixel (test_fb, 15, 25, 0x000000ff);
+  /* The primitive is drawn after the clip is popped but still with
+   * the translation */
+  test_utils_check_pixel (test_fb, 25, 25, 0x0000ffff);
+  test_utils_check_pixel (test_fb, 25, 5, 0x000000ff);
+}
+
+void
+test_command_buffer (void)
+{
+  static const CoglVertexP2 quad[] =
+    { { 20, 0 }, { 20, 10 }, { 30, 0 }, { 30, 10 } };
+  static const float red_rects[] = { 0, 0, 10, 10, 10, 0, 20, 10 };
+  static const float green_rect[] = { 0, 0, 20, 10 };
+  CoglPipeline *red, *green, *blue;
+  CoglPrimitive *primitive;
+  CoglCommandBuffer *buffer;
+  CoglMatrix modelview, translation, after;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1, 100);
+
+  red = create_color_pipeline (0xff0000ff);
+  green = create_color_pipeline (0x00ff00ff);
+  blue = create_color_pipeline (0x0000ffff);
+  primitive = cogl_primitive_new_p2 (test_ctx,
+                                     COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                     G_N_ELEMENTS (quad),
+                                     quad);
+
+  buffer = cogl_command_buffer_new (test_ctx);
+  g_assert (cogl_is_command_buffer (buffer));
+
+  cogl_command_buffer_draw_rectangles (buffer, red, red_rects, 1);
+  /* This should be merged with the previous command */
+  cogl_command_buffer_draw_rectangles (buffer, red, red_rects + 4, 1);
+
+  cogl_framebuffer_get_modelview_matrix (test_fb, &modelview);
+  translation = modelview;
+  cogl_matrix_translate (&translation, 0, 20, 0);
+  cogl_command_buffer_set_modelview_matrix (buffer, &translation);
+
+  cogl_command_buffer_push_rectangle_clip (buffer, 0, 0, 10, 10);
+  cogl_command_buffer_draw_rectangles (buffer, green, green_rect, 1);
+  cogl_command_buffer_pop_clip (buffer);
+
+  cogl_command_buffer_draw_primitive (buffer, blue, primitive);
+
+  g_assert_cmpint (cogl_command_buffer_get_n_commands (buffer), ==, 6);
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_command_buffer_submit (buffer, test_fb);
+
+  /* The objects are only borrowed until the first submission. After
+   * that the buffer holds its own references */
+  cogl_object_unref (red);
+  cogl_object_unref (green);
+  cogl_object_unref (blue);
+  cogl_object_unref (primitive);
+
+  cogl_framebuffer_get_modelview_matrix (test_fb, &after);
+  g_assert (cogl_matrix_equal (&modelview, &after));
+
+  check_drawing ();
+
+  /* Submitting again should give the same result */
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_command_buffer_submit (buffer, test_fb);
+  check_drawing ();
+
+  cogl_command_buffer_clear (buffer);
+  g_assert_cmpint (cogl_command_buffer_get_n_commands (buffer), ==, 0);
+
+  cogl_object_unref (buffer);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
+
+typedef struct
+{
+  CoglCommandBuffer *buffer;
+  CoglPipeline *pipeline;
+  CoglPrimitive *primitive;
+} RecordData;
+
+static void *
+record_commands (void *user_data)
+{
+  static const float rects[] = { 0, 0, 10, 10, 10, 0, 20, 10 };
+  RecordData *data = user_data;
+  CoglMatrix translation;
+
+  /* Nothing here is allowed to touch the context */
+  cogl_command_buffer_draw_rectangles (data->buffer,
+                                       data->pipeline,
+                                       rects,
+                                       2);
+
+  cogl_matrix_init_identity (&translation);
+  cogl_matrix_translate (&translation, 0, 20, 0);
+  cogl_command_buffer_set_modelview_matrix (data->buffer, &translation);
+  cogl_command_buffer_draw_primitive (data->buffer,
+                                      data->pipeline,
+                                      data->primitive);
+
+  return NULL;
+}
+
+void
+test_command_buffer_thread (void)
+{
+  static const CoglVertexP2 quad[] =
+    { { 0, 0 }, { 0, 10 }, { 10, 0 }, { 10, 10 } };
+  RecordData data;
+  int i;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1, 100);
+
+  data.buffer = cogl_command_buffer_new (test_ctx);
+  data.pipeline = create_color_pipeline (0xff0000ff);
+  data.primitive = cogl_primitive_new_p2 (test_ctx,
+                                          COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                          G_N_ELEMENTS (quad),
+                                          quad);
+
+#ifdef COGL_HAS_GLIB_SUPPORT
+  {
+    CoglPipeline *other = create_color_pipeline (0x00ff00ff);
+    GThread *thread;
+
+    /* Record the buffer on another thread while this thread keeps
+     * using the context to draw */
+    thread = g_thread_new ("record-commands", record_commands, &data);
+
+    for (i = 0; i < 100; i++)
+      {
+        cogl_framebuffer_draw_rectangle (test_fb, other, 0, 0, 10, 10);
+        cogl_framebuffer_finish (test_fb);
+      }
+
+    g_thread_join (thread);
+
+    cogl_object_unref (other);
+  }
+#else
+  /* The standalone GLib subset has no threads so the recording can
+   * only be checked on this thread */
+  record_commands (&data);
+#endif
+
+  g_assert_cmpint (cogl_command_buffer_get_n_commands (data.buffer), ==, 3);
+
+  for (i = 0; i < 2; i++)
+    {
+      cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+      cogl_command_buffer_submit (data.buffer, test_fb);
+
+      test_utils_check_pixel (test_fb, 5, 5, 0xff0000ff);
+      test_utils_check_pixel (test_fb, 15, 5, 0xff0000ff);
+      test_utils_check_pixel (test_fb, 5, 25, 0xff0000ff);
+      test_utils_check_pixel (test_fb, 15, 25, 0x000000ff);
+
+      /* The buffer has taken its own references during the first
+       * submission so the second one works without the caller's */
+      if (i == 0)
+        {
+          cogl_object_unref (data.pipeline);
+          cogl_object_unref (data.primitive);
+        }
+    }
+
+  cogl_object_unref (data.buffer);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
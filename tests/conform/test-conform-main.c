@@ -58,7 +58,10 @@ main (int argc, char **argv)
   UNPORTED_TEST (test_readpixels);
 #ifdef COGL_HAS_COGL_PATH_SUPPORT
   ADD_TEST (test_path, 0, 0);
+  ADD_TEST (test_path_stencil, 0, 0);
   ADD_TEST (test_path_clip, 0, 0);
+  ADD_TEST (test_path_scale, 0, 0);
+  ADD_TEST (test_path_triangulate, 0, 0);
 #endif
   ADD_TEST (test_depth_test, 0, 0);
   ADD_TEST (test_color_mask, 0, 0);
@@ -153,6 +156,22 @@ main (int argc, char **argv)
 
   ADD_TEST (test_texture_rg, TEST_REQUIREMENT_TEXTURE_RG, 0);
 
+  ADD_TEST (test_transformed_clip, 0, 0);
+  ADD_TEST (test_clip_stack_cache, 0, 0);
+  ADD_TEST (test_damage_tracker, 0, 0);
+  ADD_TEST (test_texture_upload_batch, 0, 0);
+  ADD_TEST (test_read_pixels_async, 0, 0);
+  ADD_TEST (test_read_pixels_at_points, 0, 0);
+  ADD_TEST (test_texture_compressed, 0, 0);
+  ADD_TEST (test_texture_mipmap_filter, 0, 0);
+  ADD_TEST (test_memory_stats, 0, 0);
+  ADD_TEST (test_frame_stats, 0, 0);
+  ADD_TEST (test_shader_cache, TEST_REQUIREMENT_GLSL, 0);
+  ADD_TEST (test_texture_batching, TEST_REQUIREMENT_GLSL, 0);
+  ADD_TEST (test_command_buffer, 0, 0);
+  ADD_TEST (test_command_buffer_thread, 0, 0);
+  ADD_TEST (test_static_batch, 0, 0);
+
   g_printerr ("Unknown test name \"%s\"\n", argv[1]);
 
   return 1;
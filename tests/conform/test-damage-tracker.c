@@ -0,0 +1,141 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This tests the CoglDamageTracker with a real onscreen framebuffer
+ * so that it can run on the EGL null winsys. The repaint region
+ * depends on whether the winsys reports buffer ages so the test only
+ * checks that it covers everything that needs to be redrawn */
+
+#define ONSCREEN_SIZE 64
+
+typedef struct _TestState
+{
+  CoglOnscreen *onscreen;
+  CoglFramebuffer *fb;
+  CoglDamageTracker *tracker;
+  CoglPipeline *pipeline;
+} TestState;
+
+static CoglBool
+repaint_contains (TestState *state,
+                  int x, int y, int width, int height)
+{
+  const int *rects;
+  int n_rects, i;
+  int area = 0;
+
+  rects = cogl_damage_tracker_get_repaint_rectangles (state->tracker,
+                                                      &n_rects);
+
+  /* The rectangles don't overlap so the rectangle is covered if the
+   * sum of the intersections equals its area */
+  for (i = 0; i < n_rects; i++)
+    {
+      int x1 = MAX (x, rects[i * 4]);
+      int y1 = MAX (y, rects[i * 4 + 1]);
+      int x2 = MIN (x + width, rects[i * 4] + rects[i * 4 + 2]);
+      int y2 = MIN (y + height, rects[i * 4 + 1] + rects[i * 4 + 3]);
+
+      if (x2 > x1 && y2 > y1)
+        area += (x2 - x1) * (y2 - y1);
+    }
+
+  return area == width * height;
+}
+
+static void
+paint_frame (TestState *state,
+             uint8_t red, uint8_t green, uint8_t blue)
+{
+  cogl_pipeline_set_color4ub (state->pipeline, red, green, blue, 255);
+  cogl_framebuffer_draw_rectangle (state->fb,
+                                   state->pipeline,
+                                   -1, -1, 1, 1);
+}
+
+void
+test_damage_tracker (void)
+{
+  TestState state;
+  CoglError *error = NULL;
+  uint8_t pixel[4];
+  int i;
+
+  state.onscreen = cogl_onscreen_new (test_ctx, ONSCREEN_SIZE, ONSCREEN_SIZE);
+  state.fb = state.onscreen;
+  if (!cogl_framebuffer_allocate (state.fb, &error))
+    g_error ("Failed to allocate onscreen: %s", error->message);
+
+  state.pipeline = cogl_pipeline_new (test_ctx);
+  state.tracker = cogl_damage_tracker_new (state.onscreen);
+  g_assert (cogl_is_damage_tracker (state.tracker));
+
+  /* The first frame always needs a full repaint */
+  g_assert (cogl_damage_tracker_begin_frame (state.tracker));
+  g_assert (repaint_contains (&state, 0, 0, ONSCREEN_SIZE, ONSCREEN_SIZE));
+  paint_frame (&state, 255, 0, 0);
+  test_utils_check_pixel (state.fb, 1, 1, 0xff0000ff);
+  test_utils_check_pixel (state.fb,
+                          ONSCREEN_SIZE - 2, ONSCREEN_SIZE - 2,
+                          0xff0000ff);
+  cogl_damage_tracker_swap_buffers (state.tracker);
+
+  /* Nothing has changed so there is nothing to paint */
+  g_assert (!cogl_damage_tracker_begin_frame (state.tracker));
+
+  /* Damage outside of the framebuffer is ignored */
+  cogl_damage_tracker_add_damage (state.tracker, ONSCREEN_SIZE, 0, 10, 10);
+  g_assert (!cogl_damage_tracker_begin_frame (state.tracker));
+
+  /* Damage a few small parts of the framebuffer over several frames
+   * so that the history is used to repair older back buffers */
+  for (i = 0; i < 6; i++)
+    {
+      int x = (i % 3) * 20 + 2;
+      int y = (i / 3) * 20 + 2;
+
+      cogl_damage_tracker_add_damage (state.tracker, x, y, 10, 10);
+      g_assert (cogl_damage_tracker_begin_frame (state.tracker));
+      g_assert (repaint_contains (&state, x, y, 10, 10));
+
+      paint_frame (&state, 0, 0, 255);
+      test_utils_check_pixel (state.fb, x + 5, y + 5, 0x0000ffff);
+
+      /* The scissor should prevent painting outside of the repaint
+       * region. If the buffer age is known it won't need to cover
+       * the bottom right corner which is never damaged */
+      if (!repaint_contains (&state,
+                             ONSCREEN_SIZE - 4, ONSCREEN_SIZE - 4, 2, 2))
+        {
+          cogl_framebuffer_read_pixels (state.fb,
+                                        ONSCREEN_SIZE - 3,
+                                        ONSCREEN_SIZE - 3,
+                                        1, 1,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        pixel);
+          g_assert_cmpint (pixel[2], !=, 255);
+        }
+
+      cogl_damage_tracker_swap_buffers (state.tracker);
+    }
+
+  /* Full damage covers everything again */
+  cogl_damage_tracker_add_full_damage (state.tracker);
+  g_assert (cogl_damage_tracker_begin_frame (state.tracker));
+  g_assert (repaint_contains (&state, 0, 0, ONSCREEN_SIZE, ONSCREEN_SIZE));
+  paint_frame (&state, 0, 255, 0);
+  test_utils_check_pixel (state.fb,
+                          ONSCREEN_SIZE - 2, ONSCREEN_SIZE - 2,
+                          0x00ff00ff);
+  cogl_damage_tracker_swap_buffers (state.tracker);
+
+  cogl_object_unref (state.tracker);
+  cogl_object_unref (state.pipeline);
+  cogl_object_unref (state.onscreen);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
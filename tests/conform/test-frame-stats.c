@@ -0,0 +1,94 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This checks that drawing to a framebuffer is reflected in its frame
+ * statistics and that resetting them starts a new frame */
+
+static void
+draw_rectangles (CoglPipeline *pipeline_a,
+                 CoglPipeline *pipeline_b)
+{
+  int i;
+
+  /* Alternating between two pipelines that differ in blending forces
+   * the journal to split the rectangles into separate batches */
+  for (i = 0; i < 4; i++)
+    cogl_framebuffer_draw_rectangle (test_fb,
+                                     (i & 1) ? pipeline_b : pipeline_a,
+                                     i * 10, 0, i * 10 + 10, 10);
+
+  cogl_framebuffer_finish (test_fb);
+}
+
+void
+test_frame_stats (void)
+{
+  CoglFrameStats stats, zero;
+  CoglPipeline *pipeline_a, *pipeline_b;
+  CoglTexture2D *tex_2d;
+  uint8_t data[8 * 8 * 4];
+  CoglError *error = NULL;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1, 100);
+
+  pipeline_a = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (pipeline_a, 255, 0, 0, 255);
+
+  pipeline_b = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (pipeline_b, 0, 0, 255, 255);
+  g_assert (cogl_pipeline_set_blend (pipeline_b,
+                                     "RGBA = ADD (SRC_COLOR, DST_COLOR)",
+                                     NULL));
+
+  cogl_framebuffer_reset_frame_stats (test_fb);
+
+  memset (&zero, 0, sizeof (zero));
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert (memcmp (&stats, &zero, sizeof (stats)) == 0);
+
+  draw_rectangles (pipeline_a, pipeline_b);
+
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.n_journal_flushes, ==, 1);
+  g_assert_cmpint (stats.n_journal_entries, ==, 4);
+  g_assert_cmpint (stats.n_pipeline_batches, ==, 4);
+  g_assert_cmpint (stats.n_draw_calls, >=, 4);
+  g_assert_cmpint (stats.n_pipeline_flushes, >=, 4);
+  g_assert_cmpint (stats.n_blend_changes, >=, 1);
+  g_assert_cmpint (stats.vertex_bytes_uploaded, >, 0);
+
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert (memcmp (&stats, &zero, sizeof (stats)) == 0);
+
+  /* Uploading to a texture is counted in the current frame */
+  tex_2d = cogl_texture_2d_new_with_size (test_ctx, 8, 8);
+  g_assert (cogl_texture_allocate (tex_2d, &error));
+
+  memset (data, 0xff, sizeof (data));
+  g_assert (cogl_texture_set_region (tex_2d,
+                                     8, 8, /* width/height */
+                                     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                     8 * 4, /* rowstride */
+                                     data,
+                                     0, 0, /* dst_x/y */
+                                     0, /* level */
+                                     &error));
+
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.texture_bytes_uploaded, >=, sizeof (data));
+
+  cogl_object_unref (tex_2d);
+  cogl_object_unref (pipeline_b);
+  cogl_object_unref (pipeline_a);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
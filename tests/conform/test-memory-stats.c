@@ -0,0 +1,46 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* This checks that allocating and freeing textures and buffers is
+ * reflected in the memory statistics of the context */
+
+void
+test_memory_stats (void)
+{
+  CoglMemoryStats base, stats;
+  CoglTexture2D *tex_2d;
+  CoglAttributeBuffer *buffer;
+  CoglError *error = NULL;
+
+  cogl_context_get_memory_stats (test_ctx, &base);
+
+  tex_2d = cogl_texture_2d_new_with_size (test_ctx, 64, 32);
+  cogl_texture_set_components (tex_2d, COGL_TEXTURE_COMPONENTS_RGBA);
+
+  /* Nothing is counted until the texture is allocated */
+  cogl_context_get_memory_stats (test_ctx, &stats);
+  g_assert_cmpint (stats.texture_bytes, ==, base.texture_bytes);
+
+  g_assert (cogl_texture_allocate (tex_2d, &error));
+
+  cogl_context_get_memory_stats (test_ctx, &stats);
+  g_assert_cmpint (stats.texture_bytes, ==, base.texture_bytes + 64 * 32 * 4);
+  g_assert_cmpint (stats.total_bytes, ==, base.total_bytes + 64 * 32 * 4);
+
+  buffer = cogl_attribute_buffer_new_with_size (test_ctx, 1000);
+
+  cogl_context_get_memory_stats (test_ctx, &stats);
+  g_assert_cmpint (stats.buffer_bytes, ==, base.buffer_bytes + 1000);
+
+  cogl_object_unref (buffer);
+  cogl_object_unref (tex_2d);
+
+  cogl_context_get_memory_stats (test_ctx, &stats);
+  g_assert_cmpint (stats.texture_bytes, ==, base.texture_bytes);
+  g_assert_cmpint (stats.buffer_bytes, ==, base.buffer_bytes);
+  g_assert_cmpint (stats.total_bytes, ==, base.total_bytes);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,129 @@
+#include <cogl/cogl.h>
+#include <cogl-path/cogl-path.h>
+
+#include <string.h>
+#include <math.h>
+
+#include "test-utils.h"
+
+#define RADIUS 80
+
+/* Where the circle is drawn at its natural size, before and after it
+   is drawn at the other scales. The blocks include a pixel of
+   background around the circle */
+#define BLOCK_X (420 - RADIUS - 1)
+#define BLOCK_SIZE (RADIUS * 2 + 2)
+#define FIRST_BLOCK_Y (90 - RADIUS - 1)
+#define SECOND_BLOCK_Y (260 - RADIUS - 1)
+
+static void
+fill_at_scale (CoglPath *path,
+               CoglPipeline *pipeline,
+               float x, float y,
+               float scale)
+{
+  cogl_framebuffer_push_matrix (test_fb);
+  cogl_framebuffer_translate (test_fb, x, y, 0.0f);
+  cogl_framebuffer_scale (test_fb, scale, scale, 1.0f);
+  cogl_path_fill (path, test_fb, pipeline);
+  cogl_framebuffer_pop_matrix (test_fb);
+}
+
+/* Checks the pixels just inside and just outside the edge of a circle
+   drawn with the given radius at the given angles. The inside pixel
+   is only filled if the polygon for the circle is within a pixel of
+   the real edge */
+static void
+check_edge (int center_x, int center_y,
+            float radius,
+            float inset,
+            int first_angle,
+            int angle_step)
+{
+  int angle;
+
+  for (angle = first_angle; angle < 90; angle += angle_step)
+    {
+      float c = cosf (angle * G_PI / 180.0f);
+      float s = sinf (angle * G_PI / 180.0f);
+
+      test_utils_check_pixel (test_fb,
+                              center_x + floorf ((radius - inset) * c),
+                              center_y + floorf ((radius - inset) * s),
+                              0xffffffff);
+      test_utils_check_pixel (test_fb,
+                              center_x + floorf ((radius + 1.0f) * c),
+                              center_y + floorf ((radius + 1.0f) * s),
+                              0x000000ff);
+    }
+}
+
+static void
+run_test (CoglPathFillMode fill_mode)
+{
+  CoglPipeline *white = cogl_pipeline_new (test_ctx);
+  CoglPath *path = cogl_path_new (test_ctx);
+  uint8_t first[BLOCK_SIZE * BLOCK_SIZE * 4];
+  uint8_t second[BLOCK_SIZE * BLOCK_SIZE * 4];
+
+  cogl_pipeline_set_color4f (white, 1, 1, 1, 1);
+
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_COLOR |
+                            COGL_BUFFER_BIT_STENCIL,
+                            0.0f, 0.0f, 0.0f, 1.0f);
+
+  cogl_path_set_fill_mode (path, fill_mode);
+  cogl_path_ellipse (path, 0, 0, RADIUS, RADIUS);
+
+  fill_at_scale (path, white, 420, 90, 1.0f);
+
+  /* Only the bottom right quarter of the enlarged circle is on the
+     screen. The ellipse is built from 10° steps which would leave
+     the middle of each chord more than a pixel inside the edge at
+     this size, so the inside pixels between the steps are only filled
+     if the arc is flattened again */
+  fill_at_scale (path, white, 0, 0, 4.0f);
+
+  fill_at_scale (path, white, 420, 400, 0.25f);
+
+  /* Going back to the natural size should use exactly the same
+     triangles as the first time */
+  fill_at_scale (path, white, 420, 260, 1.0f);
+
+  check_edge (0, 0, RADIUS * 4.0f, 0.8f, 15, 10);
+  check_edge (420, 400, RADIUS * 0.25f, 1.5f, 10, 20);
+
+  cogl_framebuffer_read_pixels (test_fb,
+                                BLOCK_X, FIRST_BLOCK_Y,
+                                BLOCK_SIZE, BLOCK_SIZE,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                first);
+  cogl_framebuffer_read_pixels (test_fb,
+                                BLOCK_X, SECOND_BLOCK_Y,
+                                BLOCK_SIZE, BLOCK_SIZE,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                second);
+
+  g_assert (memcmp (first, second, sizeof (first)) == 0);
+
+  cogl_object_unref (path);
+  cogl_object_unref (white);
+}
+
+void
+test_path_scale (void)
+{
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1,
+                                 100);
+
+  run_test (COGL_PATH_FILL_MODE_TESSELLATE);
+  run_test (COGL_PATH_FILL_MODE_STENCIL);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,201 @@
+#include <cogl/cogl.h>
+#include <cogl-path/cogl-path.h>
+
+#include <string.h>
+
+/* These will be redefined in config.h */
+#undef COGL_ENABLE_EXPERIMENTAL_2_0_API
+#undef COGL_ENABLE_EXPERIMENTAL_API
+
+#include "test-utils.h"
+#include "config.h"
+
+/* The debug flags are private but they are needed to switch off the
+   simple triangulator */
+#define COGL_COMPILATION
+#include <cogl/cogl-debug.h>
+#undef COGL_COMPILATION
+
+#define BLOCK_SIZE 48
+
+/* Each shape is drawn once in the top row using the simple
+   triangulator and again underneath using the GLU tesselator. All of
+   the vertices are at whole pixels and no edge passes through the
+   centre of a pixel so the two fills should be identical however the
+   shape is split into triangles */
+
+typedef struct
+{
+  float x, y;
+} Point;
+
+typedef struct
+{
+  const char *name;
+  /* Each sub-path ends with a point at -1,-1 */
+  const Point *points;
+  int n_points;
+  /* A pixel that should be filled and one that shouldn't */
+  int inside_x, inside_y;
+  int outside_x, outside_y;
+} Shape;
+
+static const Point l_shape_points[] =
+  {
+    { 4, 4 }, { 16, 4 }, { 16, 28 }, { 36, 28 }, { 36, 40 }, { 4, 40 },
+    { -1, -1 }
+  };
+
+static const Point star_points[] =
+  {
+    { 20, 2 }, { 24, 16 }, { 38, 20 }, { 24, 24 },
+    { 20, 38 }, { 16, 24 }, { 2, 20 }, { 16, 16 },
+    { -1, -1 }
+  };
+
+/* A U shape with extra points in the middle of straight edges,
+   including one on the edge of the notch, and a repeated point */
+static const Point collinear_points[] =
+  {
+    { 4, 4 }, { 14, 4 }, { 14, 17 }, { 14, 30 }, { 20, 30 }, { 26, 30 },
+    { 26, 4 }, { 36, 4 }, { 36, 4 }, { 36, 40 }, { 20, 40 }, { 4, 40 },
+    { 4, 22 },
+    { -1, -1 }
+  };
+
+/* Two concave sub-paths whose bounding boxes don't overlap */
+static const Point disjoint_points[] =
+  {
+    { 4, 4 }, { 18, 4 }, { 18, 12 }, { 10, 12 }, { 10, 40 }, { 4, 40 },
+    { -1, -1 },
+    { 22, 4 }, { 36, 20 }, { 22, 40 }, { 28, 20 },
+    { -1, -1 }
+  };
+
+/* This intersects itself so it can't be triangulated without adding a
+   vertex. Filling it as a fan would cover the gap at the top */
+static const Point bow_tie_points[] =
+  {
+    { 4, 4 }, { 36, 40 }, { 36, 4 }, { 4, 40 },
+    { -1, -1 }
+  };
+
+#define SHAPE(name, points, ix, iy, ox, oy) \
+  { name, points, G_N_ELEMENTS (points), ix, iy, ox, oy }
+
+static const Shape shapes[] =
+  {
+    SHAPE ("L shape", l_shape_points, 8, 34, 28, 12),
+    SHAPE ("star", star_points, 20, 20, 34, 6),
+    SHAPE ("collinear", collinear_points, 8, 10, 20, 12),
+    SHAPE ("disjoint", disjoint_points, 32, 20, 24, 20),
+    SHAPE ("bow tie", bow_tie_points, 8, 22, 20, 8)
+  };
+
+#undef SHAPE
+
+static void
+fill_shape (const Shape *shape,
+            CoglPipeline *pipeline,
+            int x, int y)
+{
+  CoglPath *path = cogl_path_new (test_ctx);
+  CoglBool new_sub_path = TRUE;
+  int i;
+
+  cogl_path_set_fill_mode (path, COGL_PATH_FILL_MODE_TESSELLATE);
+
+  for (i = 0; i < shape->n_points; i++)
+    {
+      const Point *point = shape->points + i;
+
+      if (point->x < 0)
+        {
+          cogl_path_close (path);
+          new_sub_path = TRUE;
+        }
+      else if (new_sub_path)
+        {
+          cogl_path_move_to (path, point->x, point->y);
+          new_sub_path = FALSE;
+        }
+      else
+        cogl_path_line_to (path, point->x, point->y);
+    }
+
+  cogl_framebuffer_push_matrix (test_fb);
+  cogl_framebuffer_translate (test_fb, x, y, 0.0f);
+  cogl_path_fill (path, test_fb, pipeline);
+  cogl_framebuffer_pop_matrix (test_fb);
+
+  cogl_object_unref (path);
+}
+
+static void
+check_shape (const Shape *shape, int x)
+{
+  uint8_t simple[BLOCK_SIZE * BLOCK_SIZE * 4];
+  uint8_t glu[BLOCK_SIZE * BLOCK_SIZE * 4];
+
+  test_utils_check_pixel (test_fb,
+                          x + shape->inside_x, shape->inside_y,
+                          0xffffffff);
+  test_utils_check_pixel (test_fb,
+                          x + shape->outside_x, shape->outside_y,
+                          0x000000ff);
+
+  cogl_framebuffer_read_pixels (test_fb,
+                                x, 0,
+                                BLOCK_SIZE, BLOCK_SIZE,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                simple);
+  cogl_framebuffer_read_pixels (test_fb,
+                                x, BLOCK_SIZE,
+                                BLOCK_SIZE, BLOCK_SIZE,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                glu);
+
+  if (cogl_test_verbose ())
+    g_print ("%s\n", shape->name);
+
+  g_assert (memcmp (simple, glu, sizeof (simple)) == 0);
+}
+
+void
+test_path_triangulate (void)
+{
+  CoglPipeline *white = cogl_pipeline_new (test_ctx);
+  int i;
+
+  cogl_pipeline_set_color4f (white, 1, 1, 1, 1);
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1,
+                                 100);
+
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_COLOR,
+                            0.0f, 0.0f, 0.0f, 1.0f);
+
+  /* The triangles are generated when the path is first filled so the
+     flag only needs to be set around the second fill of each shape */
+  for (i = 0; i < G_N_ELEMENTS (shapes); i++)
+    {
+      fill_shape (shapes + i, white, i * BLOCK_SIZE, 0);
+
+      COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_FAST_PATH_FILL);
+      fill_shape (shapes + i, white, i * BLOCK_SIZE, BLOCK_SIZE);
+      COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_FAST_PATH_FILL);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (shapes); i++)
+    check_shape (shapes + i, i * BLOCK_SIZE);
+
+  cogl_object_unref (white);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
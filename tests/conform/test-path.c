@@ -12,9 +12,19 @@
 
 typedef struct _TestState
 {
-  int dummy;
+  CoglPathFillMode fill_mode;
 } TestState;
 
+static CoglPath *
+new_path (TestState *state)
+{
+  CoglPath *path = cogl_path_new (test_ctx);
+
+  cogl_path_set_fill_mode (path, state->fill_mode);
+
+  return path;
+}
+
 static void
 draw_path_at (CoglPath *path, CoglPipeline *pipeline, int x, int y)
 {
@@ -74,7 +84,7 @@ paint (TestState *state)
 
   /* Create a path filling just a quarter of a block. It will use two
      rectangles so that we have a sub path in the path */
-  path_a = cogl_path_new (test_ctx);
+  path_a = new_path (state);
   cogl_path_rectangle (path_a,
                        BLOCK_SIZE * 3 / 4, BLOCK_SIZE / 2,
                        BLOCK_SIZE, BLOCK_SIZE);
@@ -84,7 +94,7 @@ paint (TestState *state)
   draw_path_at (path_a, white, 0, 0);
 
   /* Create another path filling the whole block */
-  path_b = cogl_path_new (test_ctx);
+  path_b = new_path (state);
   cogl_path_rectangle (path_b, 0, 0, BLOCK_SIZE, BLOCK_SIZE);
   draw_path_at (path_b, white, 1, 0);
 
@@ -127,7 +137,7 @@ paint (TestState *state)
 
   /* Draw a self-intersecting path. The part that intersects should be
      inverted */
-  path_a = cogl_path_new (test_ctx);
+  path_a = new_path (state);
   cogl_path_rectangle (path_a, 0, 0, BLOCK_SIZE, BLOCK_SIZE);
   cogl_path_line_to (path_a, 0, BLOCK_SIZE / 2);
   cogl_path_line_to (path_a, BLOCK_SIZE / 2, BLOCK_SIZE / 2);
@@ -138,7 +148,7 @@ paint (TestState *state)
 
   /* Draw two sub paths. Where the paths intersect it should be
      inverted */
-  path_a = cogl_path_new (test_ctx);
+  path_a = new_path (state);
   cogl_path_rectangle (path_a, 0, 0, BLOCK_SIZE, BLOCK_SIZE);
   cogl_path_rectangle (path_a,
                        BLOCK_SIZE / 2, BLOCK_SIZE / 2, BLOCK_SIZE, BLOCK_SIZE);
@@ -146,7 +156,7 @@ paint (TestState *state)
   cogl_object_unref (path_a);
 
   /* Draw a clockwise outer path */
-  path_a = cogl_path_new (test_ctx);
+  path_a = new_path (state);
   cogl_path_move_to (path_a, 0, 0);
   cogl_path_line_to (path_a, BLOCK_SIZE, 0);
   cogl_path_line_to (path_a, BLOCK_SIZE, BLOCK_SIZE);
@@ -191,11 +201,13 @@ validate_result ()
   check_block (11, 0, 0xd /* all but top right */);
 }
 
-void
-test_path (void)
+static void
+run_test (CoglPathFillMode fill_mode)
 {
   TestState state;
 
+  state.fill_mode = fill_mode;
+
   cogl_framebuffer_orthographic (test_fb,
                                  0, 0,
                                  cogl_framebuffer_get_width (test_fb),
@@ -205,6 +217,24 @@ test_path (void)
 
   paint (&state);
   validate_result ();
+}
+
+void
+test_path (void)
+{
+  run_test (COGL_PATH_FILL_MODE_TESSELLATE);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
+
+void
+test_path_stencil (void)
+{
+  /* The same paths should give the same result when they are filled
+     using the stencil buffer. The last block uses the non-zero fill
+     rule which is still tessellated */
+  run_test (COGL_PATH_FILL_MODE_STENCIL);
 
   if (cogl_test_verbose ())
     g_print ("OK\n");
@@ -0,0 +1,146 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* This tests reading back a ring of bitmaps asynchronously. Each
+ * bitmap is read after clearing the framebuffer to a different color
+ * so the test can check that every callback gets the data from the
+ * right point in the command stream and that they arrive in order */
+
+#define N_BITMAPS 3
+#define BITMAP_SIZE 8
+
+typedef struct _TestState
+{
+  CoglBitmap *bitmaps[N_BITMAPS];
+  int n_callbacks;
+  CoglBool cancelled_callback_called;
+} TestState;
+
+static const uint32_t
+colors[N_BITMAPS] = { 0xff0000ff, 0x00ff00ff, 0x0000ffff };
+
+static void
+read_pixels_cb (CoglFramebuffer *framebuffer,
+                CoglBitmap *bitmap,
+                const uint8_t *data,
+                void *user_data)
+{
+  TestState *state = user_data;
+  int rowstride = cogl_bitmap_get_rowstride (bitmap);
+  int index = state->n_callbacks++;
+  int x, y;
+
+  g_assert (framebuffer == test_fb);
+  g_assert (bitmap == state->bitmaps[index]);
+  g_assert (data != NULL);
+
+  for (y = 0; y < BITMAP_SIZE; y++)
+    for (x = 0; x < BITMAP_SIZE; x++)
+      test_utils_compare_pixel (data + y * rowstride + x * 4,
+                                colors[index]);
+}
+
+static void
+cancelled_cb (CoglFramebuffer *framebuffer,
+              CoglBitmap *bitmap,
+              const uint8_t *data,
+              void *user_data)
+{
+  TestState *state = user_data;
+
+  state->cancelled_callback_called = TRUE;
+}
+
+static void
+wait_for_callbacks (TestState *state)
+{
+  CoglRenderer *renderer = cogl_context_get_renderer (test_ctx);
+  int i;
+
+  /* Once the GPU has finished, the fences are all signalled so the
+   * callbacks should be dispatched without having to block */
+  cogl_framebuffer_finish (test_fb);
+
+  for (i = 0; i < 10 && state->n_callbacks < N_BITMAPS; i++)
+    {
+      CoglPollFD *poll_fds;
+      int n_poll_fds;
+      int64_t timeout;
+
+      cogl_poll_renderer_get_info (renderer, &poll_fds, &n_poll_fds, &timeout);
+      cogl_poll_renderer_dispatch (renderer, poll_fds, n_poll_fds);
+    }
+}
+
+void
+test_read_pixels_async (void)
+{
+  TestState state;
+  CoglReadPixelsClosure *closure;
+  CoglBitmap *cancelled_bitmap;
+  CoglError *error = NULL;
+  int i;
+
+  state.n_callbacks = 0;
+  state.cancelled_callback_called = FALSE;
+
+  for (i = 0; i < N_BITMAPS; i++)
+    {
+      uint8_t red = colors[i] >> 24;
+      uint8_t green = colors[i] >> 16;
+      uint8_t blue = colors[i] >> 8;
+
+      state.bitmaps[i] =
+        cogl_bitmap_new_with_size (test_ctx,
+                                   BITMAP_SIZE, BITMAP_SIZE,
+                                   COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+
+      cogl_framebuffer_clear4f (test_fb,
+                                COGL_BUFFER_BIT_COLOR,
+                                red / 255.0f,
+                                green / 255.0f,
+                                blue / 255.0f,
+                                1.0f);
+
+      closure = cogl_framebuffer_read_pixels_async (test_fb,
+                                                    0, 0,
+                                                    COGL_READ_PIXELS_COLOR_BUFFER,
+                                                    state.bitmaps[i],
+                                                    read_pixels_cb,
+                                                    &state,
+                                                    &error);
+      if (closure == NULL)
+        g_error ("Failed to start read: %s", error->message);
+    }
+
+  /* None of the callbacks should be invoked until the main loop runs */
+  g_assert_cmpint (state.n_callbacks, ==, 0);
+
+  /* A cancelled read should never call its callback */
+  cancelled_bitmap = cogl_bitmap_new_with_size (test_ctx,
+                                                BITMAP_SIZE, BITMAP_SIZE,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  closure = cogl_framebuffer_read_pixels_async (test_fb,
+                                                0, 0,
+                                                COGL_READ_PIXELS_COLOR_BUFFER,
+                                                cancelled_bitmap,
+                                                cancelled_cb,
+                                                &state,
+                                                &error);
+  if (closure == NULL)
+    g_error ("Failed to start read: %s", error->message);
+  cogl_framebuffer_cancel_read_pixels_callback (test_fb, closure);
+  cogl_object_unref (cancelled_bitmap);
+
+  wait_for_callbacks (&state);
+
+  g_assert_cmpint (state.n_callbacks, ==, N_BITMAPS);
+  g_assert (!state.cancelled_callback_called);
+
+  for (i = 0; i < N_BITMAPS; i++)
+    cogl_object_unref (state.bitmaps[i]);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
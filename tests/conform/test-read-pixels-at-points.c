@@ -0,0 +1,102 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* This draws enough overlapping rectangles that the journal builds
+ * its pick index and then reads back a lot of points. The points are
+ * read both while the rectangles are still in the journal and after
+ * a rectangle that can't be handled by the fast path has been added
+ * so that the fallback to reading from the framebuffer is tested
+ * too */
+
+#define GRID_SIZE 8
+
+static uint32_t
+cell_color (int cx, int cy)
+{
+  return (((cx * 32) << 24) | ((cy * 32) << 16) | (0x80 << 8) | 0xff);
+}
+
+static void
+check_points (int cell_size, int n_points, const int *points)
+{
+  uint8_t *pixels = g_malloc (n_points * 4);
+  int i;
+
+  g_assert (cogl_framebuffer_read_pixels_at_points (test_fb,
+                                                    points,
+                                                    n_points,
+                                                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                    pixels));
+
+  for (i = 0; i < n_points; i++)
+    {
+      int cx = points[i * 2] / cell_size;
+      int cy = points[i * 2 + 1] / cell_size;
+
+      test_utils_compare_pixel (pixels + i * 4, cell_color (cx, cy));
+    }
+
+  g_free (pixels);
+}
+
+void
+test_read_pixels_at_points (void)
+{
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+  int cell_size = MIN (fb_width, fb_height) / GRID_SIZE;
+  CoglPipeline *pipeline = cogl_pipeline_new (test_ctx);
+  int points[GRID_SIZE * GRID_SIZE * 2];
+  int cx, cy;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, fb_width, fb_height, -1, 100);
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  /* Draw a large rectangle under the grid so every point has more
+   * than one candidate entry */
+  cogl_pipeline_set_color4ub (pipeline, 255, 255, 255, 255);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline,
+                                   0, 0,
+                                   cell_size * GRID_SIZE,
+                                   cell_size * GRID_SIZE);
+
+  for (cy = 0; cy < GRID_SIZE; cy++)
+    for (cx = 0; cx < GRID_SIZE; cx++)
+      {
+        uint32_t color = cell_color (cx, cy);
+
+        cogl_pipeline_set_color4ub (pipeline,
+                                    color >> 24,
+                                    color >> 16,
+                                    color >> 8,
+                                    color);
+        cogl_framebuffer_draw_rectangle (test_fb, pipeline,
+                                         cx * cell_size,
+                                         cy * cell_size,
+                                         (cx + 1) * cell_size,
+                                         (cy + 1) * cell_size);
+
+        points[(cy * GRID_SIZE + cx) * 2] = cx * cell_size + cell_size / 2;
+        points[(cy * GRID_SIZE + cx) * 2 + 1] = cy * cell_size + cell_size / 2;
+      }
+
+  /* Read every point more than the old limit of fast reads so
+   * that the pick index has to be reused */
+  check_points (cell_size, GRID_SIZE * GRID_SIZE, points);
+  check_points (cell_size, GRID_SIZE * GRID_SIZE, points);
+
+  /* A translucent rectangle over the top left cell means that point
+   * can't be resolved from the journal */
+  cogl_pipeline_set_color4ub (pipeline, 0, 0, 0, 0);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline,
+                                   0, 0, cell_size, cell_size);
+  check_points (cell_size, GRID_SIZE * GRID_SIZE, points);
+
+  cogl_object_unref (pipeline);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,69 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This checks that two pipelines with different snippet objects that
+ * generate the same GLSL source share the compiled shaders */
+
+static CoglPipeline *
+create_pipeline (void)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new (test_ctx);
+  CoglSnippet *snippet;
+
+  /* A new snippet is created each time so the pipelines won't be
+   * found in the pipeline cache */
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                              NULL,
+                              "cogl_color_out = vec4 (0.0, 1.0, 0.0, 1.0);");
+  cogl_pipeline_add_snippet (pipeline, snippet);
+  cogl_object_unref (snippet);
+
+  return pipeline;
+}
+
+static void
+draw_pipeline (CoglPipeline *pipeline,
+               int x)
+{
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline, x, 0, x + 10, 10);
+  cogl_framebuffer_finish (test_fb);
+}
+
+void
+test_shader_cache (void)
+{
+  CoglPipeline *pipeline_a, *pipeline_b;
+  CoglFrameStats stats;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1, 100);
+
+  pipeline_a = create_pipeline ();
+  pipeline_b = create_pipeline ();
+
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  draw_pipeline (pipeline_a, 0);
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.n_shader_compiles, >=, 1);
+
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  draw_pipeline (pipeline_b, 10);
+  cogl_framebuffer_get_frame_stats (test_fb, &stats);
+  g_assert_cmpint (stats.n_shader_compiles, ==, 0);
+  g_assert_cmpint (stats.n_shader_cache_hits, >=, 1);
+
+  test_utils_check_pixel (test_fb, 5, 5, 0x00ff00ff);
+  test_utils_check_pixel (test_fb, 15, 5, 0x00ff00ff);
+
+  cogl_object_unref (pipeline_a);
+  cogl_object_unref (pipeline_b);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
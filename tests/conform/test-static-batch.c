@@ -0,0 +1,151 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This builds a CoglStaticBatch out of colored and textured
+ * rectangles and checks that drawing it with and without an extra
+ * transform gives the same result as drawing the rectangles
+ * directly */
+
+static CoglPipeline *
+create_color_pipeline (uint32_t color)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new (test_ctx);
+
+  cogl_pipeline_set_color4ub (pipeline,
+                              color >> 24,
+                              (color >> 16) & 0xff,
+                              (color >> 8) & 0xff,
+                              color & 0xff);
+
+  return pipeline;
+}
+
+static CoglPipeline *
+create_texture_pipeline (void)
+{
+  static const uint8_t tex_data[] =
+    {
+      0xff, 0x00, 0x00, 0xff, /* red */ 0x00, 0xff, 0x00, 0xff, /* green */
+      0x00, 0x00, 0xff, 0xff, /* blue */ 0xff, 0xff, 0xff, 0xff, /* white */
+    };
+  CoglPipeline *pipeline = cogl_pipeline_new (test_ctx);
+  CoglTexture *tex;
+
+  /* The texture may end up in the atlas which also checks that the
+   * batch copes with it being migrated */
+  tex = test_utils_texture_new_from_data (test_ctx,
+                                          2, 2, /* width, height */
+                                          TEST_UTILS_TEXTURE_NONE,
+                                          COGL_PIXEL_FORMAT_RGBA_8888,
+                                          8, /* rowstride */
+                                          tex_data);
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, tex);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+
+  cogl_object_unref (tex);
+
+  return pipeline;
+}
+
+static void
+check_drawing (int y_offset)
+{
+  /* The colored rectangles */
+  test_utils_check_pixel (test_fb, 5, y_offset + 5, 0xff0000ff);
+  test_utils_check_pixel (test_fb, 15, y_offset + 5, 0x00ff00ff);
+
+  /* The rectangle showing the whole texture */
+  test_utils_check_pixel (test_fb, 5, y_offset + 15, 0xff0000ff);
+  test_utils_check_pixel (test_fb, 15, y_offset + 15, 0x00ff00ff);
+  test_utils_check_pixel (test_fb, 5, y_offset + 25, 0x0000ffff);
+  test_utils_check_pixel (test_fb, 15, y_offset + 25, 0xffffffff);
+
+  /* The rectangle repeating the texture twice in each direction */
+  test_utils_check_pixel (test_fb, 22, y_offset + 12, 0xff0000ff);
+  test_utils_check_pixel (test_fb, 27, y_offset + 12, 0x00ff00ff);
+  test_utils_check_pixel (test_fb, 32, y_offset + 12, 0xff0000ff);
+  test_utils_check_pixel (test_fb, 22, y_offset + 17, 0x0000ffff);
+  test_utils_check_pixel (test_fb, 37, y_offset + 27, 0xffffffff);
+
+  /* Nothing is drawn outside of the rectangles */
+  test_utils_check_pixel (test_fb, 45, y_offset + 5, 0x000000ff);
+}
+
+void
+test_static_batch (void)
+{
+  static const float red_rect[] = { 0, 0, 10, 10 };
+  static const float green_rect[] = { 10, 0, 20, 10 };
+  static const float textured_rects[] =
+    {
+      0, 10, 20, 30, 0, 0, 1, 1,
+      20, 10, 40, 30, 0, 0, 2, 2
+    };
+  CoglPipeline *red, *green, *textured;
+  CoglStaticBatch *batch;
+  CoglMatrix modelview, transform, after;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1, 100);
+
+  red = create_color_pipeline (0xff0000ff);
+  green = create_color_pipeline (0x00ff00ff);
+  textured = create_texture_pipeline ();
+
+  batch = cogl_static_batch_new (test_ctx);
+  g_assert (cogl_is_static_batch (batch));
+
+  cogl_static_batch_add_rectangles (batch, red, red_rect, 1);
+  /* The pipelines only differ by color so this should be in the same
+   * group */
+  cogl_static_batch_add_rectangles (batch, green, green_rect, 1);
+  /* The second rectangle needs its texture to be repeated so it
+   * should be in a group of its own */
+  cogl_static_batch_add_textured_rectangles (batch,
+                                             textured,
+                                             textured_rects,
+                                             2);
+
+  g_assert_cmpint (cogl_static_batch_get_n_batches (batch), ==, 3);
+
+  /* The batch keeps a copy of the pipelines so changing them now
+   * shouldn't affect it */
+  cogl_pipeline_set_color4ub (red, 0, 0, 0xff, 0xff);
+  cogl_object_unref (red);
+  cogl_object_unref (green);
+  cogl_object_unref (textured);
+
+  cogl_framebuffer_get_modelview_matrix (test_fb, &modelview);
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_static_batch_draw (batch, test_fb, NULL);
+  check_drawing (0);
+
+  /* Draw it again with an extra transform */
+  cogl_matrix_init_identity (&transform);
+  cogl_matrix_translate (&transform, 0, 40, 0);
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_static_batch_draw (batch, test_fb, &transform);
+  check_drawing (40);
+  test_utils_check_pixel (test_fb, 5, 5, 0x000000ff);
+
+  cogl_framebuffer_get_modelview_matrix (test_fb, &after);
+  g_assert (cogl_matrix_equal (&modelview, &after));
+
+  g_assert_cmpint (cogl_static_batch_get_n_batches (batch), ==, 3);
+
+  cogl_object_unref (batch);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,133 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This draws rectangles with a different texture each using separate
+ * pipelines. With texture batching enabled these should be combined
+ * into fewer draws but each rectangle should still get its own
+ * texture */
+
+#define N_TEXTURES 12
+
+static const uint32_t
+colors[N_TEXTURES] =
+  {
+    0xff0000ff, 0x00ff00ff, 0x0000ffff, 0xffff00ff,
+    0xff00ffff, 0x00ffffff, 0x800000ff, 0x008000ff,
+    0x000080ff, 0x808000ff, 0x800080ff, 0x008080ff
+  };
+
+static void
+draw_rectangles (CoglPipeline **pipelines,
+                 CoglPipeline *black_pipeline)
+{
+  int i;
+
+  for (i = 0; i < N_TEXTURES; i++)
+    cogl_framebuffer_draw_rectangle (test_fb,
+                                     pipelines[i],
+                                     i * 10, 0, i * 10 + 10, 10);
+
+  /* A rectangle with the first texture again and a different color
+   * to check that the color is still taken from the pipeline */
+  cogl_framebuffer_draw_rectangle (test_fb, black_pipeline, 0, 10, 10, 20);
+}
+
+static void
+check_rectangles (void)
+{
+  int i;
+
+  for (i = 0; i < N_TEXTURES; i++)
+    test_utils_check_pixel (test_fb, i * 10 + 5, 5, colors[i]);
+
+  test_utils_check_pixel (test_fb, 5, 15, 0x000000ff);
+}
+
+static void
+set_mipmap_filter (CoglPipeline *pipeline)
+{
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST_MIPMAP_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+}
+
+void
+test_texture_batching (void)
+{
+  CoglPipeline *pipelines[N_TEXTURES], *black_pipeline;
+  CoglFrameStats unbatched_stats, batched_stats;
+  int i;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (test_fb),
+                                 cogl_framebuffer_get_height (test_fb),
+                                 -1, 100);
+
+  for (i = 0; i < N_TEXTURES; i++)
+    {
+      CoglTexture *texture =
+        test_utils_create_color_texture (test_ctx, colors[i]);
+
+      pipelines[i] = cogl_pipeline_new (test_ctx);
+      cogl_pipeline_set_layer_texture (pipelines[i], 0, texture);
+      cogl_pipeline_set_layer_filters (pipelines[i], 0,
+                                       COGL_PIPELINE_FILTER_NEAREST,
+                                       COGL_PIPELINE_FILTER_NEAREST);
+      cogl_object_unref (texture);
+    }
+
+  black_pipeline = cogl_pipeline_copy (pipelines[0]);
+  cogl_pipeline_set_color4ub (black_pipeline, 0x00, 0x00, 0x00, 0xff);
+
+  g_assert (!cogl_framebuffer_get_texture_batching_enabled (test_fb));
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  draw_rectangles (pipelines, black_pipeline);
+  cogl_framebuffer_finish (test_fb);
+  cogl_framebuffer_get_frame_stats (test_fb, &unbatched_stats);
+  check_rectangles ();
+
+  cogl_framebuffer_set_texture_batching_enabled (test_fb, TRUE);
+  g_assert (cogl_framebuffer_get_texture_batching_enabled (test_fb));
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  draw_rectangles (pipelines, black_pipeline);
+  cogl_framebuffer_finish (test_fb);
+  cogl_framebuffer_get_frame_stats (test_fb, &batched_stats);
+  check_rectangles ();
+
+  g_assert_cmpint (batched_stats.n_texture_batches, >=, 1);
+  g_assert_cmpint (batched_stats.n_draw_calls,
+                   <,
+                   unbatched_stats.n_draw_calls);
+
+  /* Mipmap filters depend on derivatives which aren't defined for
+   * the branches in the batch snippet so they mustn't be batched */
+  for (i = 0; i < N_TEXTURES; i++)
+    set_mipmap_filter (pipelines[i]);
+  set_mipmap_filter (black_pipeline);
+
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_framebuffer_reset_frame_stats (test_fb);
+  draw_rectangles (pipelines, black_pipeline);
+  cogl_framebuffer_finish (test_fb);
+  cogl_framebuffer_get_frame_stats (test_fb, &batched_stats);
+  check_rectangles ();
+
+  g_assert_cmpint (batched_stats.n_texture_batches, ==, 0);
+
+  cogl_framebuffer_set_texture_batching_enabled (test_fb, FALSE);
+
+  for (i = 0; i < N_TEXTURES; i++)
+    cogl_object_unref (pipelines[i]);
+  cogl_object_unref (black_pipeline);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,85 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This creates a texture from a DDS file in memory containing a
+ * single DXT1 block. Depending on the GPU the data is either uploaded
+ * directly or decoded on the CPU so either way the result should be
+ * the same */
+
+static void
+write_uint32 (uint8_t *p, uint32_t value)
+{
+  p[0] = value;
+  p[1] = value >> 8;
+  p[2] = value >> 16;
+  p[3] = value >> 24;
+}
+
+void
+test_texture_compressed (void)
+{
+  /* Red and blue end points. The rows alternate between them */
+  static const uint8_t block[] =
+    { 0x00, 0xf8, 0x1f, 0x00, 0x00, 0x55, 0x00, 0x55 };
+  uint8_t dds[128 + sizeof (block)];
+  CoglTexture2D *tex_2d;
+  CoglPipeline *pipeline;
+  CoglError *error = NULL;
+  int fb_width, fb_height;
+  int y;
+
+  memset (dds, 0, sizeof (dds));
+  memcpy (dds, "DDS ", 4);
+  write_uint32 (dds + 4, 124); /* header size */
+  write_uint32 (dds + 12, 4); /* height */
+  write_uint32 (dds + 16, 4); /* width */
+  write_uint32 (dds + 76, 32); /* pixel format size */
+  write_uint32 (dds + 80, 0x4); /* DDPF_FOURCC */
+  memcpy (dds + 84, "DXT1", 4);
+  memcpy (dds + 128, block, sizeof (block));
+
+  /* A truncated file should be rejected */
+  tex_2d = cogl_texture_2d_new_from_compressed_data (test_ctx,
+                                                     dds, sizeof (dds) - 1,
+                                                     &error);
+  g_assert (tex_2d == NULL);
+  g_assert (error != NULL);
+  g_assert (error->domain == COGL_BITMAP_ERROR);
+  cogl_error_free (error);
+  error = NULL;
+
+  tex_2d = cogl_texture_2d_new_from_compressed_data (test_ctx,
+                                                     dds, sizeof (dds),
+                                                     &error);
+  g_assert (tex_2d != NULL);
+  g_assert_cmpint (cogl_texture_get_width (tex_2d), ==, 4);
+  g_assert_cmpint (cogl_texture_get_height (tex_2d), ==, 4);
+
+  fb_width = cogl_framebuffer_get_width (test_fb);
+  fb_height = cogl_framebuffer_get_height (test_fb);
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, fb_width, fb_height, -1, 100);
+
+  pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_layer_texture (pipeline, 0, tex_2d);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+
+  /* Draw each texel as a 4x4 square */
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline, 0, 0, 16, 16);
+
+  for (y = 0; y < 4; y++)
+    test_utils_check_pixel (test_fb,
+                            6, y * 4 + 2,
+                            (y & 1) ? 0x0000ffff : 0xff0000ff);
+
+  cogl_object_unref (pipeline);
+  cogl_object_unref (tex_2d);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,111 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This creates a texture whose mipmaps are generated on the CPU with
+ * a box filter. The smallest level should be the average of the whole
+ * texture and it should be updated when part of the first level is
+ * replaced */
+
+#define TEX_SIZE 64
+
+static void
+fill_region (uint8_t *data,
+             int width,
+             int height,
+             int rowstride,
+             uint32_t color)
+{
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        uint8_t *p = data + y * rowstride + x * 4;
+
+        p[0] = color >> 24;
+        p[1] = color >> 16;
+        p[2] = color >> 8;
+        p[3] = color;
+      }
+}
+
+static void
+draw_smallest_level (CoglPipeline *pipeline)
+{
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR,
+                            0.0f, 0.0f, 0.0f, 1.0f);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline, 0, 0, 1, 1);
+}
+
+void
+test_texture_mipmap_filter (void)
+{
+  uint8_t *data = g_malloc (TEX_SIZE * TEX_SIZE * 4);
+  CoglBitmap *bmp;
+  CoglTexture2D *tex_2d;
+  CoglPipeline *pipeline;
+  CoglError *error = NULL;
+  int fb_width, fb_height;
+
+  /* Red on the left and blue on the right */
+  fill_region (data, TEX_SIZE / 2, TEX_SIZE, TEX_SIZE * 4, 0xff0000ff);
+  fill_region (data + TEX_SIZE / 2 * 4,
+               TEX_SIZE / 2, TEX_SIZE, TEX_SIZE * 4,
+               0x0000ffff);
+
+  bmp = cogl_bitmap_new_for_data (test_ctx,
+                                  TEX_SIZE, TEX_SIZE,
+                                  COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                  TEX_SIZE * 4,
+                                  data);
+  tex_2d = cogl_texture_2d_new_from_bitmap (bmp);
+  cogl_object_unref (bmp);
+
+  cogl_texture_2d_set_mipmap_filter (tex_2d,
+                                     COGL_TEXTURE_2D_MIPMAP_FILTER_BOX);
+  g_assert_cmpint (cogl_texture_2d_get_mipmap_filter (tex_2d),
+                   ==,
+                   COGL_TEXTURE_2D_MIPMAP_FILTER_BOX);
+  g_assert (!cogl_texture_2d_get_mipmap_srgb (tex_2d));
+
+  g_assert (cogl_texture_allocate (tex_2d, &error));
+
+  fb_width = cogl_framebuffer_get_width (test_fb);
+  fb_height = cogl_framebuffer_get_height (test_fb);
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, fb_width, fb_height, -1, 100);
+
+  pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_layer_texture (pipeline, 0, tex_2d);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST_MIPMAP_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+
+  draw_smallest_level (pipeline);
+  test_utils_check_pixel (test_fb, 0, 0, 0x800080ff);
+
+  /* Replace the red half with green. Only the affected part of each
+   * level needs to be regenerated */
+  fill_region (data, TEX_SIZE / 2, TEX_SIZE, TEX_SIZE / 2 * 4, 0x00ff00ff);
+  g_assert (cogl_texture_set_region (tex_2d,
+                                     TEX_SIZE / 2, TEX_SIZE,
+                                     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                     TEX_SIZE / 2 * 4,
+                                     data,
+                                     0, 0, /* dst_x/y */
+                                     0, /* level */
+                                     &error));
+
+  draw_smallest_level (pipeline);
+  test_utils_check_pixel (test_fb, 0, 0, 0x008080ff);
+
+  cogl_object_unref (pipeline);
+  cogl_object_unref (tex_2d);
+  g_free (data);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
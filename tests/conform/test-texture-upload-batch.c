@@ -0,0 +1,220 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+/* This tests uploading regions of two textures with a
+ * CoglTextureUploadBatch. Consecutive rows of the same texture should
+ * be merged into a single upload while regions that overlap must
+ * still be applied in the order they were added */
+
+#define TEX_SIZE 64
+
+typedef struct _TestTexture
+{
+  CoglTexture *texture;
+  uint8_t expected[TEX_SIZE * TEX_SIZE * 4];
+} TestTexture;
+
+static void
+init_test_texture (TestTexture *tex)
+{
+  memset (tex->expected, 0, sizeof (tex->expected));
+
+  tex->texture = cogl_texture_2d_new_from_data (test_ctx,
+                                                TEX_SIZE, TEX_SIZE,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                TEX_SIZE * 4,
+                                                tex->expected,
+                                                NULL);
+}
+
+static void
+add_region (CoglTextureUploadBatch *batch,
+            TestTexture *tex,
+            int x, int y, int width, int height,
+            const uint8_t *pixel)
+{
+  uint8_t *data = g_malloc (width * height * 4);
+  int i, j;
+
+  for (j = 0; j < height; j++)
+    for (i = 0; i < width; i++)
+      {
+        memcpy (data + (j * width + i) * 4, pixel, 4);
+        memcpy (tex->expected + ((y + j) * TEX_SIZE + x + i) * 4, pixel, 4);
+      }
+
+  cogl_texture_upload_batch_add_region (batch,
+                                        tex->texture,
+                                        width, height,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        0, /* rowstride */
+                                        data,
+                                        x, y,
+                                        0, /* level */
+                                        NULL);
+
+  g_free (data);
+}
+
+static void
+add_rgb_region (CoglTextureUploadBatch *batch,
+                TestTexture *tex,
+                int x, int y, int width, int height,
+                const uint8_t *pixel)
+{
+  /* Use a rowstride with some padding to check that it is honoured */
+  int rowstride = width * 3 + 5;
+  uint8_t *data = g_malloc0 (rowstride * height);
+  int i, j;
+
+  for (j = 0; j < height; j++)
+    for (i = 0; i < width; i++)
+      {
+        uint8_t *p = tex->expected + ((y + j) * TEX_SIZE + x + i) * 4;
+
+        memcpy (data + j * rowstride + i * 3, pixel, 3);
+        memcpy (p, pixel, 3);
+        p[3] = 0xff;
+      }
+
+  cogl_texture_upload_batch_add_region (batch,
+                                        tex->texture,
+                                        width, height,
+                                        COGL_PIXEL_FORMAT_RGB_888,
+                                        rowstride,
+                                        data,
+                                        x, y,
+                                        0, /* level */
+                                        NULL);
+
+  g_free (data);
+}
+
+static void
+check_texture (TestTexture *tex)
+{
+  uint8_t *data = g_malloc (TEX_SIZE * TEX_SIZE * 4);
+  int x, y;
+
+  cogl_texture_get_data (tex->texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TEX_SIZE * 4,
+                         data);
+
+  for (y = 0; y < TEX_SIZE; y++)
+    for (x = 0; x < TEX_SIZE; x++)
+      {
+        int offset = (y * TEX_SIZE + x) * 4;
+        uint32_t expected = ((tex->expected[offset] << 24) |
+                             (tex->expected[offset + 1] << 16) |
+                             (tex->expected[offset + 2] << 8) |
+                             tex->expected[offset + 3]);
+        uint32_t actual = ((data[offset] << 24) |
+                           (data[offset + 1] << 16) |
+                           (data[offset + 2] << 8) |
+                           data[offset + 3]);
+
+        if (actual != expected)
+          {
+            g_printerr ("Mismatch at %i,%i: expected 0x%08x, got 0x%08x\n",
+                        x, y, expected, actual);
+            g_assert_not_reached ();
+          }
+      }
+
+  g_free (data);
+}
+
+void
+test_texture_upload_batch (void)
+{
+  static const uint8_t red[] = { 0xff, 0x00, 0x00, 0xff };
+  static const uint8_t green[] = { 0x00, 0xff, 0x00, 0xff };
+  static const uint8_t blue[] = { 0x00, 0x00, 0xff, 0xff };
+  static const uint8_t rgb[] = { 0x10, 0x20, 0x30 };
+  CoglRenderer *renderer =
+    cogl_display_get_renderer (cogl_context_get_display (test_ctx));
+  CoglTextureUploadBatch *batch;
+  TestTexture tex_a, tex_b;
+  uint8_t row_pixel[4];
+  int y;
+
+  init_test_texture (&tex_a);
+  init_test_texture (&tex_b);
+
+  batch = cogl_texture_upload_batch_new (test_ctx);
+  g_assert (cogl_is_texture_upload_batch (batch));
+
+  /* Eight single rows which should be merged into one upload */
+  for (y = 0; y < 8; y++)
+    {
+      row_pixel[0] = y * 16;
+      row_pixel[1] = 0x80;
+      row_pixel[2] = 0x40;
+      row_pixel[3] = 0xff;
+      add_region (batch, &tex_a, 8, 8 + y, 32, 1, row_pixel);
+    }
+
+  /* A region in another texture breaks the run */
+  add_region (batch, &tex_b, 0, 0, 8, 8, red);
+
+  /* Another eight rows continuing the first ones */
+  for (y = 8; y < 16; y++)
+    {
+      row_pixel[0] = y * 16;
+      row_pixel[1] = 0x40;
+      row_pixel[2] = 0x80;
+      row_pixel[3] = 0xff;
+      add_region (batch, &tex_a, 8, 8 + y, 32, 1, row_pixel);
+    }
+
+  /* Overlapping regions must be applied in order */
+  add_region (batch, &tex_b, 16, 0, 8, 8, green);
+  add_region (batch, &tex_b, 20, 4, 8, 8, blue);
+
+  /* A region that needs converting */
+  add_rgb_region (batch, &tex_b, 40, 40, 7, 5, rgb);
+
+  g_assert (cogl_texture_upload_batch_flush (batch, NULL));
+
+  g_assert_cmpint (cogl_texture_upload_batch_get_n_regions (batch), ==, 20);
+  g_assert_cmpint (cogl_texture_upload_batch_get_n_uploads (batch), ==, 6);
+  g_assert_cmpint (cogl_texture_upload_batch_get_n_bytes (batch), >=,
+                   (16 * 32 + 3 * 8 * 8 + 7 * 5) * 4);
+
+  /* The two uploads for tex_a and the three 8x8 uploads for tex_b
+   * have the same layout so they should share the pixel store state.
+   * The nop driver doesn't upload anything itself so nothing is
+   * saved there */
+  if (cogl_renderer_get_driver (renderer) == COGL_DRIVER_NOP)
+    g_assert_cmpint (cogl_texture_upload_batch_get_n_gl_calls_saved (batch),
+                     ==,
+                     0);
+  else
+    g_assert_cmpint (cogl_texture_upload_batch_get_n_gl_calls_saved (batch),
+                     >,
+                     0);
+
+  check_texture (&tex_a);
+  check_texture (&tex_b);
+
+  /* Flushing an empty batch does nothing */
+  g_assert (cogl_texture_upload_batch_flush (batch, NULL));
+  g_assert_cmpint (cogl_texture_upload_batch_get_n_uploads (batch), ==, 0);
+
+  /* The batch can be reused after flushing */
+  add_region (batch, &tex_a, 0, 60, 64, 4, red);
+  g_assert (cogl_texture_upload_batch_flush (batch, NULL));
+  g_assert_cmpint (cogl_texture_upload_batch_get_n_uploads (batch), ==, 1);
+  check_texture (&tex_a);
+
+  cogl_object_unref (batch);
+  cogl_object_unref (tex_a.texture);
+  cogl_object_unref (tex_b.texture);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
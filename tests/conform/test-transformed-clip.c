@@ -0,0 +1,112 @@
+#include <cogl/cogl.h>
+
+#include <math.h>
+
+#include "test-utils.h"
+
+/* This tests clipping to rectangles that can't be represented with
+ * the scissor. Depending on the driver these may be implemented with
+ * the stencil buffer, clip planes or a test in the fragment shader.
+ * The second part pushes more rectangles than can be handled in the
+ * shader so that the fallback is used in combination */
+
+static void
+push_rotated_clip (float angle, float size)
+{
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+
+  cogl_framebuffer_push_matrix (test_fb);
+  cogl_framebuffer_translate (test_fb, fb_width / 2, fb_height / 2, 0.0f);
+  cogl_framebuffer_rotate (test_fb, angle, 0.0f, 0.0f, 1.0f);
+  cogl_framebuffer_push_rectangle_clip (test_fb,
+                                        -size, -size,
+                                        size, size);
+  cogl_framebuffer_pop_matrix (test_fb);
+}
+
+static void
+paint_blue (CoglPipeline *pipeline)
+{
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+
+  cogl_framebuffer_clear4f (test_fb,
+                            COGL_BUFFER_BIT_COLOR,
+                            1.0f, 0.0f, 0.0f, 1.0f);
+  cogl_framebuffer_draw_rectangle (test_fb,
+                                   pipeline,
+                                   0, 0, fb_width, fb_height);
+}
+
+static void
+check_diagonal (float size, float distance, uint32_t expected)
+{
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+  float offset = distance * size * sqrtf (0.5f);
+
+  test_utils_check_pixel (test_fb,
+                          fb_width / 2 + offset,
+                          fb_height / 2 + offset,
+                          expected);
+  test_utils_check_pixel (test_fb,
+                          fb_width / 2 - offset,
+                          fb_height / 2 - offset,
+                          expected);
+}
+
+void
+test_transformed_clip (void)
+{
+  CoglPipeline *pipeline;
+  int fb_width, fb_height;
+  float size;
+  int i;
+
+  fb_width = cogl_framebuffer_get_width (test_fb);
+  fb_height = cogl_framebuffer_get_height (test_fb);
+  size = MIN (fb_width, fb_height) / 4;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, fb_width, fb_height, -1, 100);
+
+  pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (pipeline, 0, 0, 255, 255);
+
+  /* A single square rotated by 45 degrees becomes a diamond whose
+   * corners reach size * √2 along the axes and whose edges are size
+   * away along the diagonals */
+  push_rotated_clip (45.0f, size);
+  paint_blue (pipeline);
+  cogl_framebuffer_pop_clip (test_fb);
+
+  test_utils_check_pixel (test_fb, fb_width / 2, fb_height / 2, 0x0000ffff);
+  test_utils_check_pixel (test_fb,
+                          fb_width / 2 + size * 1.2f, fb_height / 2,
+                          0x0000ffff);
+  /* This is inside the bounding box of the diamond but outside of
+   * the diamond itself */
+  test_utils_check_pixel (test_fb,
+                          fb_width / 2 + size, fb_height / 2 + size * 0.8f,
+                          0xff0000ff);
+  check_diagonal (size, 0.9f, 0x0000ffff);
+
+  /* Intersect five squares rotated by different amounts. The squares
+   * rotated by 40 and 50 degrees are nearly aligned with the diagonal
+   * so they limit it to just over size */
+  for (i = 1; i <= 5; i++)
+    push_rotated_clip (i * 10.0f, size);
+  paint_blue (pipeline);
+  for (i = 1; i <= 5; i++)
+    cogl_framebuffer_pop_clip (test_fb);
+
+  test_utils_check_pixel (test_fb, fb_width / 2, fb_height / 2, 0x0000ffff);
+  check_diagonal (size, 0.9f, 0x0000ffff);
+  check_diagonal (size, 1.1f, 0xff0000ff);
+
+  cogl_object_unref (pipeline);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
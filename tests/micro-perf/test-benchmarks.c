@@ -0,0 +1,1474 @@
+/*
+ * A headless micro-benchmark suite for the CPU side of Cogl.
+ *
+ * Each benchmark runs a small operation a fixed number of times per
+ * sample and the time per operation of every sample is written out
+ * as JSON together with a statistical summary so that the results of
+ * two runs can be compared by a script.
+ *
+ * The benchmarks draw to an offscreen framebuffer so no window is
+ * needed. The driver and winsys are picked with the usual
+ * environment variables so for example the suite can be run with
+ * COGL_DRIVER=nop to measure Cogl alone or with
+ * LIBGL_ALWAYS_SOFTWARE=1 and COGL_RENDERER=egl_null to include the
+ * cost of Mesa's software rasterizer. The NOP driver doesn't support
+ * offscreen framebuffers so in that case an onscreen framebuffer is
+ * allocated instead but it is never shown.
+ *
+ * Usage: test-benchmarks [--samples=N] [--scale=F] [--output=FILE]
+ *                        [--list] [BENCHMARK...]
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "cogl-context-private.h"
+#include "cogl-debug.h"
+#include "cogl-pipeline-private.h"
+#include "cogl-bitmap-private.h"
+#include "cogl-rectangle-map.h"
+#include "cogl-id-map.h"
+#include "cogl-offscreen.h"
+#include "cogl-onscreen.h"
+#include "cogl-texture-2d.h"
+#include "cogl-matrix-stack.h"
+#include "cogl-static-batch.h"
+#include "cogl-version.h"
+
+#ifdef COGL_HAS_COGL_PATH_SUPPORT
+#include <cogl-path/cogl-path.h>
+#include <cogl-path/cogl-path-private.h>
+#endif
+
+#ifdef HAVE_COGL_PANGO
+#include <cogl-pango/cogl-pango.h>
+#endif
+
+#define FRAMEBUFFER_WIDTH 512
+#define FRAMEBUFFER_HEIGHT 512
+
+#define DEFAULT_N_SAMPLES 10
+
+/* The number of distinct pipelines that the hash and equal
+ * benchmarks cycle through */
+#define N_HASH_PIPELINES 16
+
+/* The state compared by the hash and equal benchmarks. This is
+ * everything except the color, which the journal ignores, and the
+ * uniforms, which can't be hashed */
+#define HASH_PIPELINE_STATE \
+  (COGL_PIPELINE_STATE_ALL & \
+   ~(COGL_PIPELINE_STATE_COLOR | COGL_PIPELINE_STATE_UNIFORMS))
+
+/* The number of separate textures drawn by the distinct textures
+ * benchmarks. Each one has its own pipeline */
+#define N_DISTINCT_TEXTURES 64
+
+/* The number of GL object names tracked by the GLES2 object lookup
+ * benchmarks */
+#define N_GLES2_OBJECTS 256
+
+/* The number of rectangles in the static scene drawn by the static
+ * batch benchmarks. The first half are solid and the rest are
+ * textured */
+#define N_STATIC_RECTANGLES 256
+
+/* The number of items in the list drawn by the rotated clip
+ * benchmarks */
+#define N_ROTATED_LIST_ITEMS 32
+
+/* The number of glyph-sized rectangles drawn in each list item. This
+ * needs to be at least the journal's hardware clip threshold (8) or
+ * the journal would clip the rectangles in software instead */
+#define N_ROTATED_LIST_GLYPHS 16
+
+typedef struct _Data
+{
+  CoglContext *ctx;
+  CoglFramebuffer *fb;
+
+  CoglPipeline *pipeline;
+  CoglPipeline *textured_pipeline;
+  CoglPipeline *hash_pipelines[N_HASH_PIPELINES];
+  CoglPipeline *equal_pipelines[N_HASH_PIPELINES];
+  CoglPipeline *texture_pipelines[N_DISTINCT_TEXTURES];
+
+  CoglMatrixStack *matrix_stack;
+  CoglBitmap *bitmap;
+
+  /* The same objects stored in the two kinds of map that the GLES2
+   * context wrappers could use */
+  GHashTable *gles2_object_hash_table;
+  CoglIdMap gles2_object_id_map;
+
+  /* The coordinates of the static scene as [x_1, y_1, x_2, y_2, s_1,
+   * t_1, s_2, t_2] for each rectangle and the same scene in a
+   * static batch */
+  float static_rectangles[N_STATIC_RECTANGLES * 8];
+  CoglStaticBatch *static_batch;
+
+  /* The param of the benchmark that is currently running */
+  float param;
+  uint8_t *bitmap_data;
+
+#ifdef HAVE_COGL_PANGO
+  CoglPangoFontMap *font_map;
+  PangoContext *pango_context;
+  PangoLayout *layout;
+#endif
+
+  /* The results of the hash and equal benchmarks are accumulated
+   * here so that the compiler can't discard the calls */
+  volatile unsigned int sink;
+} Data;
+
+typedef struct _Benchmark
+{
+  const char *name;
+  const char *description;
+  /* The number of operations in each sample */
+  int n_iterations;
+  /* Called before each sample without being timed */
+  void (* prepare) (Data *data, int n_iterations);
+  /* The timed part of the sample */
+  void (* run) (Data *data, int n_iterations);
+  /* Called after each sample without being timed */
+  void (* finish) (Data *data, int n_iterations);
+  /* A parameter for benchmarks that share the same functions */
+  float param;
+  /* Optionally measures a quantity that is reported alongside the
+   * timings, such as the number of vertices generated */
+  const char *count_name;
+  int (* count) (Data *data);
+} Benchmark;
+
+typedef struct _BenchmarkResult
+{
+  const Benchmark *benchmark;
+  int n_iterations;
+  int n_samples;
+  /* Nanoseconds per operation for each sample */
+  double *samples;
+  double min, max, mean, median, stddev;
+  int count;
+} BenchmarkResult;
+
+static int64_t
+get_time_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * (int64_t) 1000000000 + ts.tv_nsec;
+}
+
+static void
+log_rectangles (Data *data, int n_rectangles)
+{
+  int i;
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      float x = (i * 7) % FRAMEBUFFER_WIDTH;
+      float y = (i * 13) % FRAMEBUFFER_HEIGHT;
+
+      /* Changing the color and the modelview for every rectangle
+       * exercises the software transform and color batching in the
+       * journal */
+      cogl_framebuffer_push_matrix (data->fb);
+      cogl_framebuffer_translate (data->fb, x, y, 0);
+      cogl_framebuffer_rotate (data->fb, 45, 0, 0, 1);
+
+      cogl_pipeline_set_color4ub (data->pipeline, i & 0xff, 0x80, 0x40, 0xff);
+      cogl_framebuffer_draw_rectangle (data->fb,
+                                       data->pipeline,
+                                       0, 0, 5, 5);
+
+      cogl_framebuffer_pop_matrix (data->fb);
+    }
+}
+
+static void
+flush_framebuffer (Data *data, int n_iterations)
+{
+  cogl_framebuffer_finish (data->fb);
+}
+
+static void
+run_journal_log (Data *data, int n_iterations)
+{
+  log_rectangles (data, n_iterations);
+}
+
+static void
+prepare_journal_flush (Data *data, int n_iterations)
+{
+  log_rectangles (data, n_iterations);
+}
+
+static void
+run_journal_flush (Data *data, int n_iterations)
+{
+  cogl_framebuffer_finish (data->fb);
+}
+
+static void
+draw_distinct_textures (Data *data, int n_rectangles)
+{
+  int i;
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      float x = (i * 7) % FRAMEBUFFER_WIDTH;
+      float y = (i * 13) % FRAMEBUFFER_HEIGHT;
+
+      cogl_framebuffer_draw_rectangle (data->fb,
+                                       data->texture_pipelines[
+                                         i % N_DISTINCT_TEXTURES],
+                                       x, y, x + 8, y + 8);
+    }
+
+  cogl_framebuffer_finish (data->fb);
+}
+
+static void
+prepare_distinct_textures (Data *data, int n_iterations)
+{
+  cogl_framebuffer_set_texture_batching_enabled (data->fb,
+                                                 data->param != 0.0f);
+}
+
+static void
+run_distinct_textures (Data *data, int n_iterations)
+{
+  draw_distinct_textures (data, n_iterations);
+}
+
+static void
+finish_distinct_textures (Data *data, int n_iterations)
+{
+  cogl_framebuffer_set_texture_batching_enabled (data->fb, FALSE);
+}
+
+static int
+count_distinct_textures_draw_calls (Data *data)
+{
+  CoglFrameStats stats;
+
+  prepare_distinct_textures (data, N_DISTINCT_TEXTURES);
+  cogl_framebuffer_reset_frame_stats (data->fb);
+  draw_distinct_textures (data, N_DISTINCT_TEXTURES);
+  cogl_framebuffer_get_frame_stats (data->fb, &stats);
+  finish_distinct_textures (data, N_DISTINCT_TEXTURES);
+
+  return stats.n_draw_calls;
+}
+
+static void
+draw_static_rectangles (Data *data)
+{
+  if (data->param != 0.0f)
+    cogl_static_batch_draw (data->static_batch, data->fb, NULL);
+  else
+    {
+      /* This is what an application has to do every frame without a
+       * static batch even though nothing has changed */
+      cogl_framebuffer_draw_textured_rectangles (data->fb,
+                                                 data->pipeline,
+                                                 data->static_rectangles,
+                                                 N_STATIC_RECTANGLES / 2);
+      cogl_framebuffer_draw_textured_rectangles (data->fb,
+                                                 data->textured_pipeline,
+                                                 data->static_rectangles +
+                                                 N_STATIC_RECTANGLES / 2 * 8,
+                                                 N_STATIC_RECTANGLES / 2);
+    }
+
+  cogl_framebuffer_finish (data->fb);
+}
+
+static void
+run_static_rectangles (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    draw_static_rectangles (data);
+}
+
+static int
+count_static_rectangles_draw_calls (Data *data)
+{
+  CoglFrameStats stats;
+
+  cogl_framebuffer_reset_frame_stats (data->fb);
+  draw_static_rectangles (data);
+  cogl_framebuffer_get_frame_stats (data->fb, &stats);
+
+  return stats.n_draw_calls;
+}
+
+/* A list in a rotated container, like a menu that is being animated.
+ * Each item clips its contents to its own box so every item has a
+ * different clip rectangle under a rotated modelview. That can either
+ * be done in the fragment shader or with the stencil buffer */
+static void
+draw_rotated_list (Data *data)
+{
+  int i, j;
+
+  cogl_framebuffer_push_matrix (data->fb);
+  cogl_framebuffer_translate (data->fb,
+                              FRAMEBUFFER_WIDTH / 2,
+                              FRAMEBUFFER_HEIGHT / 2,
+                              0);
+  cogl_framebuffer_rotate (data->fb, 30, 0, 0, 1);
+
+  for (i = 0; i < N_ROTATED_LIST_ITEMS; i++)
+    {
+      float y = (i - N_ROTATED_LIST_ITEMS / 2) * 12;
+
+      cogl_framebuffer_push_rectangle_clip (data->fb,
+                                            -100, y, 100, y + 10);
+      /* The contents overflow the item so the clip matters */
+      for (j = 0; j < N_ROTATED_LIST_GLYPHS; j++)
+        {
+          float x = -120 + j * 15;
+
+          cogl_framebuffer_draw_rectangle (data->fb,
+                                           data->pipeline,
+                                           x, y - 4, x + 12, y + 14);
+        }
+      cogl_framebuffer_pop_clip (data->fb);
+    }
+
+  cogl_framebuffer_pop_matrix (data->fb);
+
+  cogl_framebuffer_finish (data->fb);
+}
+
+static void
+prepare_rotated_list_clip (Data *data, int n_iterations)
+{
+  /* The param selects the stencil buffer for comparison */
+  if (data->param)
+    COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_SHADER_CLIP);
+}
+
+static void
+run_rotated_list_clip (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    draw_rotated_list (data);
+}
+
+static void
+finish_rotated_list_clip (Data *data, int n_iterations)
+{
+  COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_SHADER_CLIP);
+}
+
+/* Drawing the silhouettes into the stencil buffer shows up as extra
+ * draw calls. The number of clip flushes is the same either way */
+static int
+count_rotated_list_clip_draw_calls (Data *data)
+{
+  CoglFrameStats stats;
+
+  prepare_rotated_list_clip (data, 1);
+  cogl_framebuffer_reset_frame_stats (data->fb);
+  draw_rotated_list (data);
+  cogl_framebuffer_get_frame_stats (data->fb, &stats);
+  finish_rotated_list_clip (data, 1);
+
+  return stats.n_draw_calls;
+}
+
+static void
+run_pipeline_copy (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      CoglPipeline *copy = cogl_pipeline_copy (data->textured_pipeline);
+
+      cogl_pipeline_set_color4ub (copy, i & 0xff, 0, 0, 0xff);
+      cogl_object_unref (copy);
+    }
+}
+
+static void
+run_pipeline_hash (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      CoglPipeline *pipeline = data->hash_pipelines[i % N_HASH_PIPELINES];
+
+      data->sink += _cogl_pipeline_hash (pipeline,
+                                         HASH_PIPELINE_STATE,
+                                         COGL_PIPELINE_LAYER_STATE_ALL,
+                                         0 /* flags */);
+    }
+}
+
+static void
+run_pipeline_equal (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      int index = i % N_HASH_PIPELINES;
+
+      data->sink += _cogl_pipeline_equal (data->hash_pipelines[index],
+                                          data->equal_pipelines[index],
+                                          HASH_PIPELINE_STATE,
+                                          COGL_PIPELINE_LAYER_STATE_ALL,
+                                          0 /* flags */);
+    }
+}
+
+static void
+run_matrix_stack (Data *data, int n_iterations)
+{
+  CoglMatrix matrix;
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      cogl_matrix_stack_push (data->matrix_stack);
+      cogl_matrix_stack_translate (data->matrix_stack, i, i * 2, 0);
+      cogl_matrix_stack_rotate (data->matrix_stack, i % 360, 0, 0, 1);
+      cogl_matrix_stack_scale (data->matrix_stack, 1.5f, 1.5f, 1.0f);
+      cogl_matrix_stack_get (data->matrix_stack, &matrix);
+      cogl_matrix_stack_pop (data->matrix_stack);
+    }
+}
+
+static void
+run_bitmap_convert (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      CoglBitmap *converted =
+        _cogl_bitmap_convert (data->bitmap,
+                              COGL_PIXEL_FORMAT_BGRA_8888_PRE,
+                              NULL);
+
+      if (converted)
+        cogl_object_unref (converted);
+    }
+}
+
+static void
+run_atlas_allocate (Data *data, int n_iterations)
+{
+  CoglRectangleMap *map = _cogl_rectangle_map_new (1024, 1024, NULL);
+  CoglRectangleMapEntry position;
+  int i;
+
+  /* This only measures the packing of the rectangles and not the
+   * texture uploads so the map is big enough to hold everything
+   * without having to grow. The sizes are a mix similar to what a
+   * glyph cache would see */
+  for (i = 0; i < n_iterations; i++)
+    _cogl_rectangle_map_add (map,
+                             8 + (i * 7) % 24,
+                             8 + (i * 13) % 24,
+                             NULL,
+                             &position);
+
+  _cogl_rectangle_map_free (map);
+}
+
+/* Does the lookups that the GLES2 context wrappers do for a draw call
+ * where the application changes the program and uploads to a
+ * texture */
+static void
+run_gles2_object_lookup (Data *data, int n_iterations)
+{
+  int i;
+
+  if (data->param)
+    {
+      for (i = 0; i < n_iterations; i++)
+        {
+          unsigned int program = (i * 2 + 1) % (N_GLES2_OBJECTS * 2);
+          unsigned int texture = (i * 14 + 3) % (N_GLES2_OBJECTS * 2);
+
+          data->sink +=
+            GPOINTER_TO_UINT (_cogl_id_map_lookup (&data->gles2_object_id_map,
+                                                   program));
+          data->sink +=
+            GPOINTER_TO_UINT (_cogl_id_map_lookup (&data->gles2_object_id_map,
+                                                   texture));
+        }
+    }
+  else
+    {
+      for (i = 0; i < n_iterations; i++)
+        {
+          unsigned int program = (i * 2 + 1) % (N_GLES2_OBJECTS * 2);
+          unsigned int texture = (i * 14 + 3) % (N_GLES2_OBJECTS * 2);
+
+          data->sink +=
+            GPOINTER_TO_UINT (g_hash_table_lookup (data->gles2_object_hash_table,
+                                                   GUINT_TO_POINTER (program)));
+          data->sink +=
+            GPOINTER_TO_UINT (g_hash_table_lookup (data->gles2_object_hash_table,
+                                                   GUINT_TO_POINTER (texture)));
+        }
+    }
+}
+
+#ifdef COGL_HAS_COGL_PATH_SUPPORT
+
+static CoglPath *
+create_curved_path (Data *data)
+{
+  CoglPath *path = cogl_path_new (data->ctx);
+
+  /* A self-intersecting shape with curves so that the tessellator
+   * has to flatten and split the edges */
+  cogl_path_move_to (path, 10, 10);
+  cogl_path_curve_to (path, 200, 0, 300, 400, 50, 300);
+  cogl_path_line_to (path, 400, 50);
+  cogl_path_curve_to (path, 450, 200, 100, 450, 10, 10);
+  cogl_path_close (path);
+  cogl_path_ellipse (path, 250, 250, 100, 60);
+
+  return path;
+}
+
+static void
+run_path_tessellate (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      CoglPath *path = create_curved_path (data);
+
+      /* Filling the path is what triggers the tessellation */
+      cogl_path_fill (path, data->fb, data->pipeline);
+
+      cogl_object_unref (path);
+    }
+}
+
+static void
+run_path_zoom (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      CoglPath *path = create_curved_path (data);
+
+      /* The curves are flattened for the scale of the modelview */
+      cogl_framebuffer_push_matrix (data->fb);
+      cogl_framebuffer_scale (data->fb, data->param, data->param, 1.0f);
+      cogl_path_fill (path, data->fb, data->pipeline);
+      cogl_framebuffer_pop_matrix (data->fb);
+
+      cogl_object_unref (path);
+    }
+}
+
+static int
+count_path_zoom_vertices (Data *data)
+{
+  CoglPath *path = create_curved_path (data);
+  int n_vertices = _cogl_path_get_n_fill_vertices (path, data->param);
+
+  cogl_object_unref (path);
+
+  return n_vertices;
+}
+
+/* Outlines of some common 24x24 icons from SVG icon sets. These are
+ * all simple polygons once the curves are flattened */
+static const char * const
+svg_icon_paths[] =
+  {
+    /* heart */
+    "M12 21.35l-1.45-1.32C5.4 15.36 2 12.28 2 8.5 2 5.42 4.42 3 7.5 3"
+    "c1.74 0 3.41.81 4.5 2.09C13.09 3.81 14.76 3 16.5 3 19.58 3 22 5.42 "
+    "22 8.5c0 3.78-3.4 6.86-8.55 11.54L12 21.35z",
+    /* home */
+    "M10 20v-6h4v6h5v-8h3L12 3 2 12h3v8z",
+    /* star */
+    "M12 17.27L18.18 21l-1.64-7.03L22 9.24l-7.19-.61L12 2 9.19 8.63 "
+    "2 9.24l5.46 4.73L5.82 21z",
+    /* bookmark */
+    "M17 3H7c-1.1 0-1.99.9-1.99 2L5 21l7-3 7 3V5c0-1.1-.9-2-2-2z",
+    /* send */
+    "M2.01 21L23 12 2.01 3 2 10l15 2-15 2z",
+    /* cloud */
+    "M19.35 10.04C18.67 6.59 15.64 4 12 4 9.11 4 6.6 5.64 5.35 8.04 "
+    "2.34 8.36 0 10.91 0 14c0 3.31 2.69 6 6 6h13c2.76 0 5-2.24 5-5 "
+    "0-2.64-2.05-4.78-4.65-4.96z"
+  };
+
+/* The icons are enlarged so that the curves are flattened into a
+ * realistic number of segments */
+#define SVG_ICON_SCALE 20.0f
+
+/* Handles the subset of the SVG path syntax used by the icons */
+static CoglPath *
+create_svg_path (Data *data, const char *svg)
+{
+  CoglPath *path = cogl_path_new (data->ctx);
+  float pen_x = 0.0f, pen_y = 0.0f;
+  char command = 'M';
+
+  while (TRUE)
+    {
+      float args[6];
+      int n_args, i;
+      CoglBool relative;
+
+      while (*svg == ' ' || *svg == ',')
+        svg++;
+
+      if (*svg == '\0')
+        break;
+
+      if (strchr ("MmLlHhVvCcZz", *svg))
+        command = *svg++;
+
+      if (command == 'Z' || command == 'z')
+        {
+          cogl_path_close (path);
+          continue;
+        }
+
+      switch (command)
+        {
+        case 'H': case 'h': case 'V': case 'v':
+          n_args = 1;
+          break;
+        case 'C': case 'c':
+          n_args = 6;
+          break;
+        default:
+          n_args = 2;
+          break;
+        }
+
+      for (i = 0; i < n_args; i++)
+        {
+          char *end;
+
+          while (*svg == ' ' || *svg == ',')
+            svg++;
+          args[i] = strtod (svg, &end);
+          svg = end;
+        }
+
+      relative = g_ascii_islower (command);
+
+      switch (command)
+        {
+        case 'M': case 'm':
+          pen_x = args[0] + (relative ? pen_x : 0.0f);
+          pen_y = args[1] + (relative ? pen_y : 0.0f);
+          cogl_path_move_to (path,
+                             pen_x * SVG_ICON_SCALE,
+                             pen_y * SVG_ICON_SCALE);
+          /* Further coordinates are implicit line-tos */
+          command = relative ? 'l' : 'L';
+          break;
+
+        case 'L': case 'l': case 'H': case 'h': case 'V': case 'v':
+          if (command == 'L' || command == 'l' ||
+              command == 'H' || command == 'h')
+            pen_x = args[0] + (relative ? pen_x : 0.0f);
+          if (command == 'L' || command == 'l')
+            pen_y = args[1] + (relative ? pen_y : 0.0f);
+          else if (command == 'V' || command == 'v')
+            pen_y = args[0] + (relative ? pen_y : 0.0f);
+          cogl_path_line_to (path,
+                             pen_x * SVG_ICON_SCALE,
+                             pen_y * SVG_ICON_SCALE);
+          break;
+
+        case 'C': case 'c':
+          if (relative)
+            for (i = 0; i < 6; i += 2)
+              {
+                args[i] += pen_x;
+                args[i + 1] += pen_y;
+              }
+          cogl_path_curve_to (path,
+                              args[0] * SVG_ICON_SCALE,
+                              args[1] * SVG_ICON_SCALE,
+                              args[2] * SVG_ICON_SCALE,
+                              args[3] * SVG_ICON_SCALE,
+                              args[4] * SVG_ICON_SCALE,
+                              args[5] * SVG_ICON_SCALE);
+          pen_x = args[4];
+          pen_y = args[5];
+          break;
+        }
+    }
+
+  return path;
+}
+
+static void
+run_path_svg_icons (Data *data, int n_iterations)
+{
+  int i, j;
+
+  /* The param selects the GLU tesselator for comparison */
+  if (data->param)
+    COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_FAST_PATH_FILL);
+
+  for (i = 0; i < n_iterations; i++)
+    for (j = 0; j < G_N_ELEMENTS (svg_icon_paths); j++)
+      {
+        CoglPath *path = create_svg_path (data, svg_icon_paths[j]);
+
+        cogl_path_fill (path, data->fb, data->pipeline);
+
+        cogl_object_unref (path);
+      }
+
+  COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_FAST_PATH_FILL);
+}
+
+static int
+count_path_svg_icons_vertices (Data *data)
+{
+  int n_vertices = 0;
+  int i;
+
+  if (data->param)
+    COGL_DEBUG_SET_FLAG (COGL_DEBUG_DISABLE_FAST_PATH_FILL);
+
+  for (i = 0; i < G_N_ELEMENTS (svg_icon_paths); i++)
+    {
+      CoglPath *path = create_svg_path (data, svg_icon_paths[i]);
+
+      n_vertices += _cogl_path_get_n_fill_vertices (path, 1.0f);
+
+      cogl_object_unref (path);
+    }
+
+  COGL_DEBUG_CLEAR_FLAG (COGL_DEBUG_DISABLE_FAST_PATH_FILL);
+
+  return n_vertices;
+}
+
+#define CHART_N_SAMPLES 512
+
+/* A line chart whose values change every frame so nothing can be
+   reused from the previous path */
+static CoglPath *
+create_chart_path (Data *data, int frame)
+{
+  CoglPath *path = cogl_path_new (data->ctx);
+  int i;
+
+  /* The param selects the stencil fill mode */
+  if (data->param)
+    cogl_path_set_fill_mode (path, COGL_PATH_FILL_MODE_STENCIL);
+
+  cogl_path_move_to (path, 0, 400);
+
+  for (i = 0; i < CHART_N_SAMPLES; i++)
+    {
+      float t = (i + frame) * 0.05f;
+
+      cogl_path_line_to (path,
+                         i * 500.0f / (CHART_N_SAMPLES - 1),
+                         200 + sinf (t) * 100 + sinf (t * 3.7f) * 50);
+    }
+
+  cogl_path_line_to (path, 500, 400);
+  cogl_path_close (path);
+
+  return path;
+}
+
+/* The NOP driver only reports a stencil buffer when it is asked for
+   one. Without it the stencil fill mode would fall back to
+   tessellating so only the stencil variant turns it on */
+static void
+prepare_path_chart (Data *data, int n_iterations)
+{
+  if (data->param)
+    g_setenv ("COGL_NOP_STENCIL_BITS", "8", TRUE);
+  else
+    g_unsetenv ("COGL_NOP_STENCIL_BITS");
+}
+
+static void
+run_path_chart (Data *data, int n_iterations)
+{
+  int i;
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      CoglPath *path = create_chart_path (data, i);
+
+      cogl_path_fill (path, data->fb, data->pipeline);
+
+      cogl_object_unref (path);
+    }
+}
+
+static int
+count_path_chart_vertices (Data *data)
+{
+  CoglPath *path = create_chart_path (data, 0);
+  int n_vertices = _cogl_path_get_n_fill_vertices (path, 1.0f);
+
+  cogl_object_unref (path);
+
+  return n_vertices;
+}
+
+#endif /* COGL_HAS_COGL_PATH_SUPPORT */
+
+#ifdef HAVE_COGL_PANGO
+
+static void
+run_pango_layout (Data *data, int n_iterations)
+{
+  CoglColor color;
+  int i;
+
+  cogl_color_init_from_4ub (&color, 0, 0, 0, 255);
+
+  for (i = 0; i < n_iterations; i++)
+    {
+      /* Changing the text throws away the display list cached on the
+       * layout so that it has to be built again */
+      pango_layout_set_text (data->layout,
+                             (i & 1) ?
+                             "The quick brown fox jumps over the lazy dog" :
+                             "Pack my box with five dozen liquor jugs",
+                             -1);
+      cogl_pango_show_layout (data->fb, data->layout, 0, 0, &color);
+    }
+}
+
+#endif /* HAVE_COGL_PANGO */
+
+static const Benchmark benchmarks[] =
+  {
+    { "journal-log",
+      "Logging rotated rectangles with changing colors into the journal",
+      10000, NULL, run_journal_log, flush_framebuffer },
+    { "journal-flush",
+      "Flushing a journal of rotated rectangles to the driver",
+      10000, prepare_journal_flush, run_journal_flush, NULL },
+    { "journal-distinct-textures",
+      "Drawing and flushing rectangles that each use a different texture",
+      1000, prepare_distinct_textures, run_distinct_textures,
+      finish_distinct_textures,
+      0.0f, "draw_calls", count_distinct_textures_draw_calls },
+    { "journal-distinct-textures-batched",
+      "Drawing rectangles with different textures with texture batching",
+      1000, prepare_distinct_textures, run_distinct_textures,
+      finish_distinct_textures,
+      1.0f, "draw_calls", count_distinct_textures_draw_calls },
+    { "static-batch-relog",
+      "Drawing a static scene of rectangles through the journal",
+      100, NULL, run_static_rectangles, NULL,
+      0.0f, "draw_calls", count_static_rectangles_draw_calls },
+    { "static-batch-replay",
+      "Drawing a static scene of rectangles from a CoglStaticBatch",
+      100, NULL, run_static_rectangles, NULL,
+      1.0f, "draw_calls", count_static_rectangles_draw_calls },
+    { "clip-rotated-list-shader",
+      "Drawing a rotated list whose items each have their own clip",
+      100, prepare_rotated_list_clip, run_rotated_list_clip,
+      finish_rotated_list_clip,
+      0.0f, "draw_calls", count_rotated_list_clip_draw_calls },
+    { "clip-rotated-list-stencil",
+      "Drawing the rotated list with shader clipping disabled",
+      100, prepare_rotated_list_clip, run_rotated_list_clip,
+      finish_rotated_list_clip,
+      1.0f, "draw_calls", count_rotated_list_clip_draw_calls },
+    { "pipeline-copy",
+      "Copying a textured pipeline and modifying the copy",
+      10000, NULL, run_pipeline_copy, NULL },
+    { "pipeline-hash",
+      "Hashing the state of pipelines as the journal would compare it",
+      10000, NULL, run_pipeline_hash, NULL },
+    { "pipeline-equal",
+      "Comparing the state of pipelines with no common ancestor",
+      10000, NULL, run_pipeline_equal, NULL },
+    { "matrix-stack",
+      "Pushing, transforming, resolving and popping a matrix stack",
+      10000, NULL, run_matrix_stack, NULL },
+    { "bitmap-convert",
+      "Converting a 256x256 RGBA bitmap to premultiplied BGRA",
+      20, NULL, run_bitmap_convert, NULL },
+    { "atlas-allocate",
+      "Packing glyph sized rectangles into an atlas map",
+      2000, NULL, run_atlas_allocate, NULL },
+    { "gles2-object-lookup-hash-table",
+      "Looking up GLES2 program and texture data in a GHashTable",
+      100000, NULL, run_gles2_object_lookup, NULL,
+      0.0f },
+    { "gles2-object-lookup-id-map",
+      "Looking up GLES2 program and texture data in a CoglIdMap",
+      100000, NULL, run_gles2_object_lookup, NULL,
+      1.0f },
+#ifdef COGL_HAS_COGL_PATH_SUPPORT
+    { "path-tessellate",
+      "Tessellating and filling a path with curves",
+      100, NULL, run_path_tessellate, flush_framebuffer },
+    { "path-zoom-0.25x",
+      "Tessellating a curved path drawn at a quarter of its size",
+      100, NULL, run_path_zoom, flush_framebuffer,
+      0.25f, "vertices", count_path_zoom_vertices },
+    { "path-zoom-1x",
+      "Tessellating a curved path drawn at its natural size",
+      100, NULL, run_path_zoom, flush_framebuffer,
+      1.0f, "vertices", count_path_zoom_vertices },
+    { "path-zoom-4x",
+      "Tessellating a curved path drawn at four times its size",
+      100, NULL, run_path_zoom, flush_framebuffer,
+      4.0f, "vertices", count_path_zoom_vertices },
+    { "path-zoom-16x",
+      "Tessellating a curved path drawn at sixteen times its size",
+      100, NULL, run_path_zoom, flush_framebuffer,
+      16.0f, "vertices", count_path_zoom_vertices },
+    { "path-svg-icons",
+      "Filling simple SVG icon outlines with the fast triangulator",
+      100, NULL, run_path_svg_icons, flush_framebuffer,
+      0.0f, "vertices", count_path_svg_icons_vertices },
+    { "path-svg-icons-glu",
+      "Filling simple SVG icon outlines with the GLU tesselator",
+      100, NULL, run_path_svg_icons, flush_framebuffer,
+      1.0f, "vertices", count_path_svg_icons_vertices },
+    { "path-chart-tessellate",
+      "Filling a chart that changes every frame by tessellating it",
+      100, prepare_path_chart, run_path_chart, flush_framebuffer,
+      0.0f, "vertices", count_path_chart_vertices },
+    { "path-chart-stencil",
+      "Filling a chart that changes every frame with the stencil buffer",
+      100, prepare_path_chart, run_path_chart, flush_framebuffer,
+      1.0f, "vertices", count_path_chart_vertices },
+#endif
+#ifdef HAVE_COGL_PANGO
+    { "pango-layout",
+      "Building and drawing the display list of a Pango layout",
+      100, NULL, run_pango_layout, flush_framebuffer },
+#endif
+  };
+
+static void
+init_data (Data *data)
+{
+  CoglTexture2D *tex;
+  CoglError *error = NULL;
+  int i;
+
+  data->ctx = cogl_context_new (NULL, &error);
+  if (!data->ctx)
+    {
+      fprintf (stderr, "Failed to create a CoglContext: %s\n",
+               error->message);
+      exit (1);
+    }
+
+  tex = cogl_texture_2d_new_with_size (data->ctx,
+                                       FRAMEBUFFER_WIDTH,
+                                       FRAMEBUFFER_HEIGHT);
+  data->fb =
+    COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (COGL_TEXTURE (tex)));
+  cogl_object_unref (tex);
+
+  if (!cogl_framebuffer_allocate (data->fb, &error))
+    {
+      /* The onscreen framebuffer is never shown so this still
+       * doesn't need a window system */
+      cogl_error_free (error);
+      error = NULL;
+      cogl_object_unref (data->fb);
+
+      data->fb = COGL_FRAMEBUFFER (cogl_onscreen_new (data->ctx,
+                                                      FRAMEBUFFER_WIDTH,
+                                                      FRAMEBUFFER_HEIGHT));
+      if (!cogl_framebuffer_allocate (data->fb, &error))
+        {
+          fprintf (stderr, "Failed to allocate a framebuffer: %s\n",
+                   error->message);
+          exit (1);
+        }
+    }
+
+  cogl_framebuffer_orthographic (data->fb,
+                                 0, 0,
+                                 FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT,
+                                 -1, 100);
+
+  data->pipeline = cogl_pipeline_new (data->ctx);
+
+  tex = cogl_texture_2d_new_with_size (data->ctx, 64, 64);
+  data->textured_pipeline = cogl_pipeline_new (data->ctx);
+  cogl_pipeline_set_layer_texture (data->textured_pipeline, 0,
+                                   COGL_TEXTURE (tex));
+  cogl_pipeline_set_layer_texture (data->textured_pipeline, 1,
+                                   COGL_TEXTURE (tex));
+  cogl_pipeline_set_layer_combine (data->textured_pipeline, 1,
+                                   "RGBA = MODULATE (PREVIOUS, TEXTURE)",
+                                   NULL);
+
+  /* The pipelines for the equal benchmark are created separately
+   * from the ones for the hash benchmark so that the comparison
+   * can't take the shortcut of finding a shared authority */
+  for (i = 0; i < N_HASH_PIPELINES; i++)
+    {
+      int j;
+
+      for (j = 0; j < 2; j++)
+        {
+          CoglPipeline *pipeline = cogl_pipeline_new (data->ctx);
+
+          cogl_pipeline_set_layer_texture (pipeline, 0, COGL_TEXTURE (tex));
+          cogl_pipeline_set_layer_filters (pipeline, 0,
+                                           (i & 1) ?
+                                           COGL_PIPELINE_FILTER_NEAREST :
+                                           COGL_PIPELINE_FILTER_LINEAR,
+                                           COGL_PIPELINE_FILTER_LINEAR);
+          if (i & 2)
+            cogl_pipeline_set_blend (pipeline,
+                                     "RGBA = ADD (SRC_COLOR, DST_COLOR)",
+                                     NULL);
+          if (i & 4)
+            cogl_pipeline_set_alpha_test_function (pipeline,
+                                                   COGL_PIPELINE_ALPHA_FUNC_GREATER,
+                                                   i / (float) N_HASH_PIPELINES);
+          if (i & 8)
+            cogl_pipeline_set_point_size (pipeline, i);
+
+          if (j == 0)
+            data->hash_pipelines[i] = pipeline;
+          else
+            data->equal_pipelines[i] = pipeline;
+        }
+    }
+
+  cogl_object_unref (tex);
+
+  for (i = 0; i < N_DISTINCT_TEXTURES; i++)
+    {
+      tex = cogl_texture_2d_new_with_size (data->ctx, 8, 8);
+      data->texture_pipelines[i] = cogl_pipeline_new (data->ctx);
+      cogl_pipeline_set_layer_texture (data->texture_pipelines[i], 0,
+                                       COGL_TEXTURE (tex));
+      cogl_object_unref (tex);
+    }
+
+  data->matrix_stack = cogl_matrix_stack_new (data->ctx);
+
+  /* A grid of rectangles like the chrome of a user interface */
+  for (i = 0; i < N_STATIC_RECTANGLES; i++)
+    {
+      float *coords = data->static_rectangles + i * 8;
+      float x = (i % 16) * 32;
+      float y = (i / 16) * 32;
+
+      coords[0] = x;
+      coords[1] = y;
+      coords[2] = x + 30;
+      coords[3] = y + 30;
+      coords[4] = 0;
+      coords[5] = 0;
+      coords[6] = 1;
+      coords[7] = 1;
+    }
+
+  data->static_batch = cogl_static_batch_new (data->ctx);
+  cogl_static_batch_add_textured_rectangles (data->static_batch,
+                                             data->pipeline,
+                                             data->static_rectangles,
+                                             N_STATIC_RECTANGLES / 2);
+  cogl_static_batch_add_textured_rectangles (data->static_batch,
+                                             data->textured_pipeline,
+                                             data->static_rectangles +
+                                             N_STATIC_RECTANGLES / 2 * 8,
+                                             N_STATIC_RECTANGLES / 2);
+
+  /* The odd names are used by the application and the even ones by
+   * Cogl so that half of the lookups miss */
+  data->gles2_object_hash_table = g_hash_table_new (g_direct_hash,
+                                                    g_direct_equal);
+  _cogl_id_map_init (&data->gles2_object_id_map, NULL);
+  for (i = 0; i < N_GLES2_OBJECTS; i++)
+    {
+      unsigned int id = i * 2 + 1;
+
+      g_hash_table_insert (data->gles2_object_hash_table,
+                           GUINT_TO_POINTER (id),
+                           GUINT_TO_POINTER (id));
+      _cogl_id_map_insert (&data->gles2_object_id_map,
+                           id,
+                           GUINT_TO_POINTER (id));
+    }
+
+  data->bitmap_data = malloc (256 * 256 * 4);
+  for (i = 0; i < 256 * 256 * 4; i++)
+    data->bitmap_data[i] = i;
+  data->bitmap = cogl_bitmap_new_for_data (data->ctx,
+                                           256, 256,
+                                           COGL_PIXEL_FORMAT_RGBA_8888,
+                                           256 * 4,
+                                           data->bitmap_data);
+
+#ifdef HAVE_COGL_PANGO
+  {
+    PangoFontDescription *font_desc;
+
+    data->font_map = COGL_PANGO_FONT_MAP (cogl_pango_font_map_new (data->ctx));
+    data->pango_context =
+      pango_font_map_create_context (PANGO_FONT_MAP (data->font_map));
+    data->layout = pango_layout_new (data->pango_context);
+
+    font_desc = pango_font_description_from_string ("Sans 12");
+    pango_layout_set_font_description (data->layout, font_desc);
+    pango_font_description_free (font_desc);
+    pango_layout_set_width (data->layout, 200 * PANGO_SCALE);
+  }
+#endif
+}
+
+static void
+fini_data (Data *data)
+{
+  int i;
+
+#ifdef HAVE_COGL_PANGO
+  g_object_unref (data->layout);
+  g_object_unref (data->pango_context);
+  g_object_unref (data->font_map);
+#endif
+
+  cogl_object_unref (data->bitmap);
+  free (data->bitmap_data);
+
+  cogl_object_unref (data->static_batch);
+  cogl_object_unref (data->matrix_stack);
+
+  g_hash_table_destroy (data->gles2_object_hash_table);
+  _cogl_id_map_destroy (&data->gles2_object_id_map);
+
+  for (i = 0; i < N_HASH_PIPELINES; i++)
+    {
+      cogl_object_unref (data->hash_pipelines[i]);
+      cogl_object_unref (data->equal_pipelines[i]);
+    }
+
+  for (i = 0; i < N_DISTINCT_TEXTURES; i++)
+    cogl_object_unref (data->texture_pipelines[i]);
+
+  cogl_object_unref (data->textured_pipeline);
+  cogl_object_unref (data->pipeline);
+  cogl_object_unref (data->fb);
+  cogl_object_unref (data->ctx);
+}
+
+static int
+compare_doubles (const void *a, const void *b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return da < db ? -1 : da > db ? 1 : 0;
+}
+
+static void
+summarize (BenchmarkResult *result)
+{
+  double *sorted;
+  double sum = 0.0, variance = 0.0;
+  int n = result->n_samples;
+  int i;
+
+  sorted = malloc (sizeof (double) * n);
+  memcpy (sorted, result->samples, sizeof (double) * n);
+  qsort (sorted, n, sizeof (double), compare_doubles);
+
+  result->min = sorted[0];
+  result->max = sorted[n - 1];
+
+  if (n & 1)
+    result->median = sorted[n / 2];
+  else
+    result->median = (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+
+  for (i = 0; i < n; i++)
+    sum += sorted[i];
+  result->mean = sum / n;
+
+  for (i = 0; i < n; i++)
+    variance += (sorted[i] - result->mean) * (sorted[i] - result->mean);
+  result->stddev = n > 1 ? sqrt (variance / (n - 1)) : 0.0;
+
+  free (sorted);
+}
+
+static void
+run_benchmark (Data *data,
+               const Benchmark *benchmark,
+               int n_samples,
+               float scale,
+               BenchmarkResult *result)
+{
+  int n_iterations = MAX (1, benchmark->n_iterations * scale);
+  int sample;
+
+  result->benchmark = benchmark;
+  result->n_iterations = n_iterations;
+  result->n_samples = n_samples;
+  result->samples = malloc (sizeof (double) * n_samples);
+
+  data->param = benchmark->param;
+
+  /* The first run is only to warm up the caches and isn't recorded */
+  for (sample = -1; sample < n_samples; sample++)
+    {
+      int64_t start, end;
+
+      if (benchmark->prepare)
+        benchmark->prepare (data, n_iterations);
+
+      start = get_time_ns ();
+      benchmark->run (data, n_iterations);
+      end = get_time_ns ();
+
+      if (benchmark->finish)
+        benchmark->finish (data, n_iterations);
+
+      if (sample >= 0)
+        result->samples[sample] = (end - start) / (double) n_iterations;
+    }
+
+  summarize (result);
+
+  if (benchmark->count)
+    result->count = benchmark->count (data);
+}
+
+static const char *
+get_driver_name (CoglContext *ctx)
+{
+  CoglRenderer *renderer =
+    cogl_display_get_renderer (cogl_context_get_display (ctx));
+
+  switch (cogl_renderer_get_driver (renderer))
+    {
+    case COGL_DRIVER_NOP:
+      return "nop";
+    case COGL_DRIVER_GL:
+      return "gl";
+    case COGL_DRIVER_GL3:
+      return "gl3";
+    case COGL_DRIVER_GLES1:
+      return "gles1";
+    case COGL_DRIVER_GLES2:
+      return "gles2";
+    case COGL_DRIVER_WEBGL:
+      return "webgl";
+    case COGL_DRIVER_ANY:
+      break;
+    }
+
+  return "unknown";
+}
+
+static void
+write_json (FILE *out,
+            Data *data,
+            BenchmarkResult *results,
+            int n_results)
+{
+  int i, j;
+
+  fprintf (out,
+           "{\n"
+           "  \"cogl_version\": \"%s\",\n"
+           "  \"driver\": \"%s\",\n"
+           "  \"framebuffer\": \"%s\",\n"
+           "  \"unit\": \"ns/iteration\",\n"
+           "  \"benchmarks\": [\n",
+           COGL_VERSION_STRING,
+           get_driver_name (data->ctx),
+           cogl_is_offscreen (data->fb) ? "offscreen" : "onscreen");
+
+  for (i = 0; i < n_results; i++)
+    {
+      BenchmarkResult *result = results + i;
+
+      fprintf (out,
+               "    {\n"
+               "      \"name\": \"%s\",\n"
+               "      \"description\": \"%s\",\n"
+               "      \"iterations\": %i,\n",
+               result->benchmark->name,
+               result->benchmark->description,
+               result->n_iterations);
+
+      if (result->benchmark->count_name)
+        fprintf (out,
+                 "      \"%s\": %i,\n",
+                 result->benchmark->count_name,
+                 result->count);
+
+      fprintf (out,
+               "      \"min\": %.3f,\n"
+               "      \"max\": %.3f,\n"
+               "      \"mean\": %.3f,\n"
+               "      \"median\": %.3f,\n"
+               "      \"stddev\": %.3f,\n"
+               "      \"samples\": [",
+               result->min,
+               result->max,
+               result->mean,
+               result->median,
+               result->stddev);
+
+      for (j = 0; j < result->n_samples; j++)
+        fprintf (out, "%s%.3f", j ? ", " : "", result->samples[j]);
+
+      fprintf (out, "]\n    }%s\n", i + 1 < n_results ? "," : "");
+    }
+
+  fprintf (out, "  ]\n}\n");
+}
+
+static CoglBool
+benchmark_is_selected (const Benchmark *benchmark,
+                       int n_filters,
+                       char **filters)
+{
+  int i;
+
+  if (n_filters == 0)
+    return TRUE;
+
+  for (i = 0; i < n_filters; i++)
+    if (strstr (benchmark->name, filters[i]))
+      return TRUE;
+
+  return FALSE;
+}
+
+static void
+usage (const char *program)
+{
+  fprintf (stderr,
+           "Usage: %s [--samples=N] [--scale=F] [--output=FILE] "
+           "[--list] [BENCHMARK...]\n",
+           program);
+  exit (1);
+}
+
+int
+main (int argc, char **argv)
+{
+  Data data;
+  BenchmarkResult *results;
+  int n_benchmarks = G_N_ELEMENTS (benchmarks);
+  int n_samples = DEFAULT_N_SAMPLES;
+  float scale = 1.0f;
+  const char *output = NULL;
+  char **filters;
+  int n_filters = 0;
+  int n_results = 0;
+  FILE *out = stdout;
+  int i;
+
+  filters = malloc (sizeof (char *) * argc);
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!strncmp (argv[i], "--samples=", 10))
+        {
+          n_samples = atoi (argv[i] + 10);
+          if (n_samples < 1)
+            usage (argv[0]);
+        }
+      else if (!strncmp (argv[i], "--scale=", 8))
+        {
+          scale = atof (argv[i] + 8);
+          if (scale <= 0.0f)
+            usage (argv[0]);
+        }
+      else if (!strncmp (argv[i], "--output=", 9))
+        output = argv[i] + 9;
+      else if (!strcmp (argv[i], "--list"))
+        {
+          for (i = 0; i < n_benchmarks; i++)
+            printf ("%-20s %s\n",
+                    benchmarks[i].name,
+                    benchmarks[i].description);
+          return 0;
+        }
+      else if (argv[i][0] == '-')
+        usage (argv[0]);
+      else
+        filters[n_filters++] = argv[i];
+    }
+
+  init_data (&data);
+
+  results = malloc (sizeof (BenchmarkResult) * n_benchmarks);
+
+  for (i = 0; i < n_benchmarks; i++)
+    {
+      if (!benchmark_is_selected (benchmarks + i, n_filters, filters))
+        continue;
+
+      fprintf (stderr, "Running %s...\n", benchmarks[i].name);
+      run_benchmark (&data,
+                     benchmarks + i,
+                     n_samples,
+                     scale,
+                     results + n_results++);
+    }
+
+  if (output)
+    {
+      out = fopen (output, "w");
+      if (out == NULL)
+        {
+          fprintf (stderr, "Failed to open %s\n", output);
+          return 1;
+        }
+    }
+
+  write_json (out, &data, results, n_results);
+
+  if (out != stdout)
+    fclose (out);
+
+  for (i = 0; i < n_results; i++)
+    free (results[i].samples);
+  free (results);
+  free (filters);
+
+  fini_data (&data);
+
+  return 0;
+}